@@ -14,11 +14,12 @@ namespace CPUSolver
 		return std::thread::hardware_concurrency();
 	}
 
-	std::string cpuSolver::getNewSolutionTemplate(std::string kingAddress)
+	// Non-zero seed gives the same template on every run, to replay jobs with identical nonces
+	std::string cpuSolver::getNewSolutionTemplate(std::string kingAddress, uint64_t const seed)
 	{
 		byte32_t b_solutionTemp;
 		std::random_device rand;
-		std::mt19937_64 rGen{ rand() };
+		std::mt19937_64 rGen{ (seed > 0ull) ? seed : rand() };
 		std::uniform_int_distribution<uint64_t> uInt_d{ 0, UINT64_MAX };
 
 		for (uint32_t i{ 0u }; i < UINT256_LENGTH; i += UINT64_LENGTH)
@@ -43,8 +44,9 @@ namespace CPUSolver
 	// --------------------------------------------------------------------
 
 	cpuSolver::cpuSolver(std::string const threads) noexcept :
+		m_TargetLaunchDuration{ 0u },
+		m_isFinding{ false },
 		m_miningThreadCount{ 0u },
-		m_hashStartTime{ new std::chrono::steady_clock::time_point[std::stoi(threads)] },
 		s_address{ "" },
 		s_challenge{ "" },
 		s_target{ "" },
@@ -75,11 +77,20 @@ namespace CPUSolver
 			token = strtok_s(NULL, delim, &nextToken);
 		}
 		#endif
-		m_miningThreadAffinities = new uint32_t[m_miningThreadCount];
-		m_threadHashes = new uint64_t[m_miningThreadCount];
-		m_isThreadMining = new bool[m_miningThreadCount];
-		memset(m_threadHashes, 0, UINT64_LENGTH * m_miningThreadCount);
-		memset(m_isThreadMining, 0, sizeof(bool) * m_miningThreadCount);
+		m_maxThreadCount = std::max(m_miningThreadCount, getLogicalProcessorsCount());
+		m_miningThreadAffinities.reset(new std::atomic<uint32_t>[m_maxThreadCount]);
+		m_threadHashes.reset(new uint64_t[m_maxThreadCount]());
+		m_hashStartTime.reset(new std::chrono::steady_clock::time_point[m_maxThreadCount]);
+		m_isThreadMining.reset(new std::atomic<bool>[m_maxThreadCount]);
+		m_isThreadEnabled.reset(new std::atomic<bool>[m_maxThreadCount]);
+		m_threadMetrics.reset(new SolverMetrics[m_maxThreadCount]);
+		m_threadTraces.reset(new TraceBuffer[m_maxThreadCount]);
+		for (uint32_t i{ 0 }; i < m_maxThreadCount; ++i)
+		{
+			m_miningThreadAffinities[i] = 0u;
+			m_isThreadMining[i] = false;
+			m_isThreadEnabled[i] = true;
+		}
 
 		uint32_t threadElement{ 0 };
 		#ifdef __linux__
@@ -116,9 +127,6 @@ namespace CPUSolver
 	cpuSolver::~cpuSolver() noexcept
 	{
 		stopFinding();
-
-		free(m_miningThreadAffinities);
-		free(m_isThreadMining);
 	}
 
 	void cpuSolver::setGetKingAddressCallback(GetKingAddressCallback kingAddressCallback)
@@ -126,34 +134,19 @@ namespace CPUSolver
 		m_getKingAddressCallback = kingAddressCallback;
 	}
 
-	void cpuSolver::setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback)
-	{
-		m_getWorkPositionCallback = workPositionCallback;
-	}
-
-	void cpuSolver::setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback)
-	{
-		m_resetWorkPositionCallback = resetWorkPositionCallback;
-	}
-
-	void cpuSolver::setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback)
-	{
-		m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-	}
-
 	void cpuSolver::setGetSolutionTemplateCallback(GetSolutionTemplateCallback solutionTemplateCallback)
 	{
 		m_getSolutionTemplateCallback = solutionTemplateCallback;
 	}
 
-	void cpuSolver::setMessageCallback(MessageCallback messageCallback)
+	void cpuSolver::setSolutionCallback(SolutionCallback solutionCallback)
 	{
-		m_messageCallback = messageCallback;
+		m_solutionCallback = solutionCallback;
 	}
 
-	void cpuSolver::setSolutionCallback(SolutionCallback solutionCallback)
+	void cpuSolver::setNoncePool(nonce_pool_t *noncePool)
 	{
-		m_solutionCallback = solutionCallback;
+		m_nonceSpace.setPool(noncePool);
 	}
 
 	bool cpuSolver::isMining()
@@ -179,6 +172,7 @@ namespace CPUSolver
 
 		if (tempPrefix == m_prefix) return;
 
+		m_challengeTime = std::chrono::steady_clock::now();
 		s_challenge = prefix.substr(0, 2 + UINT256_LENGTH * 2);
 		s_address = "0x" + prefix.substr(2 + UINT256_LENGTH * 2, ADDRESS_LENGTH * 2);
 
@@ -223,6 +217,19 @@ namespace CPUSolver
 		else return 0ull;
 	}
 
+	void cpuSolver::getMetricsByThreadID(uint32_t const threadID, uint64_t *values)
+	{
+		if (threadID < m_miningThreadCount)
+			m_threadMetrics[threadID].getValues(values);
+		else
+			std::memset(values, 0, UINT64_LENGTH * SolverMetrics::VALUE_COUNT);
+	}
+
+	uint32_t cpuSolver::getTraceEventsByThreadID(uint32_t const threadID, trace_event_t *events, uint32_t const maxCount)
+	{
+		return (threadID < m_miningThreadCount) ? m_threadTraces[threadID].drain(events, maxCount) : 0u;
+	}
+
 	bool cpuSolver::islessThan(byte32_t &left, byte32_t &right)
 	{
 		for (uint32_t i{ 0 }; i < UINT256_LENGTH; ++i)
@@ -235,10 +242,14 @@ namespace CPUSolver
 
 	void cpuSolver::startFinding()
 	{
+		std::lock_guard<std::mutex> lock(m_threadsMutex);
+		m_isFinding = true;
+
 		for (uint32_t id{ 0 }; id < m_miningThreadCount; ++id)
 		{
 			m_hashStartTime[id] = std::chrono::steady_clock::now();
-			std::thread t{ &cpuSolver::findSolution, this, id, m_miningThreadAffinities[id] };
+			m_isThreadMining[id] = true; // before thread starts, so a stop issued meanwhile is not overwritten
+			std::thread t{ &cpuSolver::findSolution, this, id, m_miningThreadAffinities[id].load() };
 			t.detach();
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
@@ -246,7 +257,11 @@ namespace CPUSolver
 
 	void cpuSolver::stopFinding()
 	{
-		for (uint32_t i{ 0 }; i < m_miningThreadCount; ++i) m_isThreadMining[i] = false;
+		{
+			std::lock_guard<std::mutex> lock(m_threadsMutex); // so addThread can not start a thread that is never stopped
+			m_isFinding = false;
+			for (uint32_t i{ 0 }; i < m_miningThreadCount; ++i) m_isThreadMining[i] = false;
+		}
 
 		std::this_thread::sleep_for(std::chrono::seconds(1));
 	}
@@ -256,6 +271,48 @@ namespace CPUSolver
 		m_pause = pauseFinding;
 	}
 
+	uint32_t cpuSolver::getThreadCount()
+	{
+		return m_miningThreadCount;
+	}
+
+	bool cpuSolver::setThreadAffinity(uint32_t const threadID, uint32_t const affinity)
+	{
+		if (threadID >= m_miningThreadCount) return false;
+
+		m_miningThreadAffinities[threadID] = affinity;
+		return true;
+	}
+
+	bool cpuSolver::setThreadEnabled(uint32_t const threadID, bool const isEnabled)
+	{
+		if (threadID >= m_miningThreadCount) return false;
+
+		m_isThreadEnabled[threadID] = isEnabled;
+		return true;
+	}
+
+	int cpuSolver::addThread(uint32_t const affinity)
+	{
+		std::lock_guard<std::mutex> lock(m_threadsMutex);
+		if (m_miningThreadCount >= m_maxThreadCount) return -1;
+
+		uint32_t const id{ m_miningThreadCount };
+		m_miningThreadAffinities[id] = affinity;
+		m_isThreadEnabled[id] = true;
+		m_threadHashes[id] = 0ull;
+		m_hashStartTime[id] = std::chrono::steady_clock::now();
+		m_miningThreadCount++; // after its state is set, as other threads read up to count
+
+		if (m_isFinding)
+		{
+			m_isThreadMining[id] = true;
+			std::thread t{ &cpuSolver::findSolution, this, id, affinity };
+			t.detach();
+		}
+		return (int)id;
+	}
+
 	// --------------------------------------------------------------------
 	// Private
 	// --------------------------------------------------------------------
@@ -278,24 +335,9 @@ namespace CPUSolver
 		m_getSolutionTemplateCallback(solutionTemplate->data());
 	}
 
-	void cpuSolver::getWorkPosition(uint64_t &workPosition)
-	{
-		m_getWorkPositionCallback(workPosition);
-	}
-
-	void cpuSolver::resetWorkPosition(uint64_t &lastPosition)
-	{
-		m_resetWorkPositionCallback(lastPosition);
-	}
-
-	void cpuSolver::incrementWorkPosition(uint64_t &lastPosition, uint64_t increment)
-	{
-		m_incrementWorkPositionCallback(lastPosition, increment);
-	}
-
 	void cpuSolver::onMessage(int threadID, const char* type, const char* message)
 	{
-		m_messageCallback(threadID, type, message);
+		m_log.push(LogRing::getLevel(type), threadID, "", message);
 	}
 
 	void cpuSolver::onMessage(int threadID, std::string type, std::string message)
@@ -303,7 +345,7 @@ namespace CPUSolver
 		onMessage(threadID, type.c_str(), message.c_str());
 	}
 
-	void cpuSolver::onSolution(byte32_t const solution, byte32_t const digest, std::string challenge)
+	void cpuSolver::onSolution(byte32_t const solution, byte32_t const digest, std::string challenge, uint32_t const threadID, std::chrono::steady_clock::time_point const foundTime)
 	{
 		if (!m_SubmitStale && challenge != s_challenge)
 			return;
@@ -314,11 +356,12 @@ namespace CPUSolver
 
 		if (!m_SubmitStale && challenge != s_challenge) return;
 
+		auto const verifyStartTime = std::chrono::steady_clock::now();
 		std::string solutionStr{ bytesToHexString(solution) };
 
 		std::string digestStr = bytesToHexString(digest);
 		arith_uint256 arithDigest = arith_uint256(digestStr);
-		onMessage(-1, "Debug", "Digest: 0x" + digestStr);
+		if (m_log.isLogged(LOG_DEBUG)) onMessage(-1, "Debug", "Digest: 0x" + digestStr);
 
 		if (arithDigest >= m_target)
 		{
@@ -328,11 +371,16 @@ namespace CPUSolver
 				+ "\nSolution: 0x" + solutionStr
 				+ "\nDigest: 0x" + digestStr
 				+ "\nTarget: " + s_target);
+			m_threadTraces[threadID].recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 0ull);
+			m_threadMetrics[threadID].recordVerify(verifyStartTime);
 		}
 		else
 		{
+			m_threadTraces[threadID].recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 1ull);
+			m_threadMetrics[threadID].recordVerify(verifyStartTime);
 			onMessage(-1, "Info", "Solution verified, submitting nonce 0x" + solutionStr + "...");
 			m_solutionCallback(("0x" + digestStr).c_str(), s_address.c_str(), challenge.c_str(), s_target.c_str(), ("0x" + solutionStr).c_str());
+			m_threadMetrics[threadID].recordSolution(foundTime);
 		}
 	}
 
@@ -356,33 +404,46 @@ namespace CPUSolver
 	{
 		try
 		{
-			uint64_t const nonceSize{ 100000ull };
-			uint64_t beginNonce{ 0 };
+			uint64_t nonceSize{ 100000ull };
 			uint64_t endNonce{ 0 };
+			nonce_range_t nonceRange{ 0ull, 0ull, m_nonceSpace.getEpoch() };
 
 			uint64_t nonce{ 0 };
 			byte32_t digest{ 0 };
 			message_t miningMessage{ 0 }; // challenge32 + address20 + solution32
 			byte32_t currentSolution{ 0 };
 			std::string currentChallenge{ "" };
+			std::chrono::steady_clock::time_point chunkStartTime;
+			bool isChunkCut{ false }; // by pause or new challenge, not a valid duration sample
+			SolverMetrics &metrics{ m_threadMetrics[threadID] };
+			TraceBuffer &trace{ m_threadTraces[threadID] };
+			uint64_t chunkPosition{ 0ull };
+			uint32_t currentAffinity{ affinityMask };
+
+			LaunchController launchController;
+			launchController.setTarget(m_TargetLaunchDuration);
+			launchController.setLimits(1000ull, 1000ull, UINT32_MAX);
 
 			getKingAddress(&m_kingAddress);
 			getSolutionTemplate(&currentSolution);
 
 			m_threadHashes[threadID] = 0ull;
-			m_isThreadMining[threadID] = setCurrentThreadAffinity(affinityMask);
-
-			if (m_isThreadMining[threadID])
+			if (setCurrentThreadAffinity(affinityMask))
 			{
 				onMessage(threadID, "Info", "Affinity masked to CPU " + std::to_string(affinityMask));
 				onMessage(threadID, "Info", "Start mining...");
 			}
-			else onMessage(threadID, "Error", "Failed to set affinity mask to CPU " + std::to_string(affinityMask));
+			else
+			{
+				onMessage(threadID, "Error", "Failed to set affinity mask to CPU " + std::to_string(affinityMask));
+				m_isThreadMining[threadID] = false;
+			}
 
-			while (m_isThreadMining[threadID])
+			while (m_isThreadMining[threadID] && m_isFinding)
 			{
-				while (m_pause)
+				while (m_pause || !m_isThreadEnabled[threadID])
 				{
+					isChunkCut = true;
 					m_threadHashes[threadID] = 0ull;
 					m_hashStartTime[threadID] = std::chrono::steady_clock::now();
 
@@ -391,22 +452,48 @@ namespace CPUSolver
 
 				if (currentChallenge != s_challenge)
 				{
-					char *c_currentChallenge = (char *)malloc(s_challenge.size());
-					#ifdef __linux__
-					strcpy(c_currentChallenge, s_challenge.c_str());
-					#else
-					strcpy_s(c_currentChallenge, s_challenge.size() + 1, s_challenge.c_str());
-					#endif
-					currentChallenge = std::string{ c_currentChallenge };
+					bool const isChallengeSwitch{ !currentChallenge.empty() };
+					if (isChallengeSwitch) metrics.recordChallengeSwitch(m_challengeTime);
+					currentChallenge = s_challenge;
+
+					trace.recordInstant(TRACE_JOB_SWITCH, isChallengeSwitch ? 1ull : 0ull);
+					nonceRange.next = nonce; // unhashed remainder of current chunk is abandoned with the range
+					m_nonceSpace.abandonRange(nonceRange);
+					endNonce = nonce;
+					isChunkCut = true;
 				}
 
-				nonce++;
-
-				if (nonce > endNonce)
+				if (nonce >= endNonce)
 				{
-					incrementWorkPosition(beginNonce, nonceSize);
-					endNonce = beginNonce + nonceSize;
-					nonce = beginNonce;
+					if (nonceRange.end > 0ull) // not before first chunk
+					{
+						metrics.recordLaunch(chunkStartTime, nonce - chunkPosition); // up to where a new challenge cut it
+						trace.recordSpan(TRACE_KERNEL, chunkStartTime, chunkPosition);
+						if (!isChunkCut) nonceSize = launchController.update(nonceSize, chunkStartTime);
+					}
+					isChunkCut = false;
+
+					uint32_t affinity{ m_miningThreadAffinities[threadID].load() };
+					if (affinity != currentAffinity) // moved by host
+					{
+						if (setCurrentThreadAffinity(affinity))
+						{
+							currentAffinity = affinity;
+							onMessage(threadID, "Info", "Affinity masked to CPU " + std::to_string(currentAffinity));
+						}
+						else
+						{
+							onMessage(threadID, "Error", "Failed to set affinity mask to CPU " + std::to_string(affinity));
+							m_miningThreadAffinities[threadID].compare_exchange_strong(affinity, currentAffinity); // unless moved again meanwhile
+						}
+					}
+					chunkStartTime = std::chrono::steady_clock::now();
+
+					nonce = m_nonceSpace.getNextPosition(nonceRange, nonceSize);
+					endNonce = nonce + nonceSize;
+					chunkPosition = nonce;
+					metrics.addPositions(nonceSize);
+					trace.recordSpan(TRACE_WORK_ALLOCATION, chunkStartTime, nonce);
 				}
 				m_threadHashes[threadID]++;
 
@@ -423,12 +510,13 @@ namespace CPUSolver
 
 				if (islessThan(digest, b_target))
 				{
-					std::thread t{ &cpuSolver::onSolution, this, currentSolution, digest, currentChallenge };
+					std::thread t{ &cpuSolver::onSolution, this, currentSolution, digest, currentChallenge, threadID, std::chrono::steady_clock::now() };
 					t.detach();
 
 					m_threadHashes[threadID] = 0ull;
 					m_hashStartTime[threadID] = std::chrono::steady_clock::now();
 				}
+				nonce++;
 			}
 		}
 		catch (std::exception &ex) { onMessage(threadID, "Error", ex.what()); }
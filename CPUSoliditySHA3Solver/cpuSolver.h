@@ -1,12 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <thread>
 #include <vector>
 #include "types.h"
+#include "launchController.h"
+#include "logRing.h"
+#include "nonceSpace.h"
+#include "solverMetrics.h"
+#include "traceBuffer.h"
 #include "uint256/arith_uint256.h"
 
 #ifndef __CPU_SOLVER__
@@ -15,11 +24,7 @@
 namespace CPUSolver
 {
 	typedef void(*GetKingAddressCallback)(uint8_t *kingAddress);
-	typedef void(*GetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*ResetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*IncrementWorkPositionCallback)(uint64_t &lastWorkPosition, uint64_t incrementSize);
 	typedef void(*GetSolutionTemplateCallback)(uint8_t *solutionTemplate);
-	typedef void(*MessageCallback)(int threadID, const char *type, const char *message);
 	typedef void(*SolutionCallback)(const char *digest, const char *address, const char *challenge, const char *target, const char *solution);
 
 	class cpuSolver
@@ -27,13 +32,12 @@ namespace CPUSolver
 	public:
 		GetKingAddressCallback m_getKingAddressCallback;
 		GetSolutionTemplateCallback m_getSolutionTemplateCallback;
-		GetWorkPositionCallback m_getWorkPositionCallback;
-		ResetWorkPositionCallback m_resetWorkPositionCallback;
-		IncrementWorkPositionCallback m_incrementWorkPositionCallback;
-		MessageCallback m_messageCallback;
 		SolutionCallback m_solutionCallback;
+		LogRing m_log;
 
 		bool m_SubmitStale;
+		uint32_t m_TargetLaunchDuration; // milliseconds of each work chunk, 0 for fixed chunk size
+		NonceSpace m_nonceSpace;
 
 	private:
 		static bool m_pause;
@@ -49,27 +53,32 @@ namespace CPUSolver
 		address_t m_kingAddress;
 		prefix_t m_prefix; // challenge32 + address20
 
+		std::mutex m_threadsMutex;
+		std::atomic<bool> m_isFinding;
+		uint32_t m_maxThreadCount; // per thread state is allocated up front, so threads can be added while mining
 		uint32_t m_miningThreadCount;
-		uint32_t *m_miningThreadAffinities;
-		bool *m_isThreadMining;
+		std::unique_ptr<std::atomic<uint32_t>[]> m_miningThreadAffinities; // changed by host while mining, applied by thread on its next work chunk
+		std::unique_ptr<std::atomic<bool>[]> m_isThreadMining; // set by host under m_threadsMutex before thread starts, cleared to stop it
+		std::unique_ptr<std::atomic<bool>[]> m_isThreadEnabled; // disabled thread idles as if paused, until enabled again
 
-		uint64_t *m_threadHashes;
-		std::chrono::steady_clock::time_point *m_hashStartTime;
+		std::unique_ptr<uint64_t[]> m_threadHashes;
+		std::unique_ptr<std::chrono::steady_clock::time_point[]> m_hashStartTime;
+
+		std::unique_ptr<SolverMetrics[]> m_threadMetrics;
+		std::unique_ptr<TraceBuffer[]> m_threadTraces;
+		std::chrono::steady_clock::time_point m_challengeTime;
 
 	public:
 		static uint32_t getLogicalProcessorsCount();
-		static std::string getNewSolutionTemplate(std::string kingAddress = "");
+		static std::string getNewSolutionTemplate(std::string kingAddress = "", uint64_t const seed = 0ull);
 
 		cpuSolver(std::string const threads) noexcept;
 		~cpuSolver() noexcept;
 
 		void setGetKingAddressCallback(GetKingAddressCallback kingAddressCallback);
-		void setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback);
-		void setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback);
-		void setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback);
 		void setGetSolutionTemplateCallback(GetSolutionTemplateCallback solutionTemplateCallback);
-		void setMessageCallback(MessageCallback messageCallback);
 		void setSolutionCallback(SolutionCallback solutionCallback);
+		void setNoncePool(nonce_pool_t *noncePool);
 
 		bool isMining();
 		bool isPaused();
@@ -79,22 +88,26 @@ namespace CPUSolver
 
 		uint64_t getTotalHashRate();
 		uint64_t getHashRateByThreadID(uint32_t const threadID);
+		void getMetricsByThreadID(uint32_t const threadID, uint64_t *values);
+		uint32_t getTraceEventsByThreadID(uint32_t const threadID, trace_event_t *events, uint32_t const maxCount);
 
 		void startFinding();
 		void stopFinding();
 		void pauseFinding(bool pauseFinding);
 
+		uint32_t getThreadCount();
+		bool setThreadAffinity(uint32_t const threadID, uint32_t const affinity);
+		bool setThreadEnabled(uint32_t const threadID, bool const isEnabled);
+		int addThread(uint32_t const affinity);
+
 	private:
 		bool islessThan(byte32_t &left, byte32_t &right);
 		bool isAddressEmpty(address_t kingAddress);
 		void getKingAddress(address_t *kingAddress);
 		void getSolutionTemplate(byte32_t *solutionTemplate);
-		void getWorkPosition(uint64_t &workPosition);
-		void resetWorkPosition(uint64_t &lastPosition);
-		void incrementWorkPosition(uint64_t &lastPosition, uint64_t increment);
 		void onMessage(int threadID, const char* type, const char* message);
 		void onMessage(int threadID, std::string type, std::string message);
-		void onSolution(byte32_t const solution, byte32_t const digest, std::string challenge);
+		void onSolution(byte32_t const solution, byte32_t const digest, std::string challenge, uint32_t const threadID, std::chrono::steady_clock::time_point const foundTime);
 		bool setCurrentThreadAffinity(uint32_t const affinityMask);
 		void findSolution(uint32_t const threadID, uint32_t const affinityMask);
 	};
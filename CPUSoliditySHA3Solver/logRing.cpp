@@ -0,0 +1,110 @@
+#include "logRing.h"
+
+namespace CPUSolver
+{
+	// --------------------------------------------------------------------
+	// Static
+	// --------------------------------------------------------------------
+
+	log_level_t LogRing::getLevel(char const *type)
+	{
+		switch (type[0])
+		{
+		case 'D': return LOG_DEBUG;
+		case 'W': return LOG_WARN;
+		case 'E': return LOG_ERROR;
+		default: return LOG_INFO;
+		}
+	}
+
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	LogRing::LogRing() noexcept :
+		m_head{ 0ull },
+		m_tail{ 0ull },
+		m_droppedCount{ 0ull },
+		m_level{ LOG_INFO }
+	{
+		for (uint64_t i{ 0ull }; i < CAPACITY; ++i)
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bool LogRing::isLogged(log_level_t const level)
+	{
+		return level >= m_level.load(std::memory_order_relaxed);
+	}
+
+	void LogRing::setLevel(log_level_t const level)
+	{
+		m_level.store(level);
+	}
+
+	void LogRing::push(log_level_t const level, int32_t const device, char const *source, char const *message)
+	{
+		if (!isLogged(level)) return;
+
+		uint64_t position{ m_head.load(std::memory_order_relaxed) };
+
+		while (true)
+		{
+			slot_t &slot{ m_slots[position & (CAPACITY - 1ull)] };
+			int64_t const difference{ (int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)position };
+
+			if (difference == 0)
+			{
+				if (m_head.compare_exchange_weak(position, position + 1ull, std::memory_order_relaxed))
+				{
+					slot.entry.device = device;
+					slot.entry.level = level;
+					copyString(slot.entry.source, source, log_entry_t::SOURCE_LENGTH);
+					copyString(slot.entry.message, message, log_entry_t::MESSAGE_LENGTH);
+
+					slot.sequence.store(position + 1ull, std::memory_order_release);
+					return;
+				}
+			}
+			else if (difference < 0) // full, host is not draining fast enough
+			{
+				m_droppedCount.fetch_add(1ull, std::memory_order_relaxed);
+				return;
+			}
+			else position = m_head.load(std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t LogRing::drain(log_entry_t *entries, uint32_t const maxCount)
+	{
+		uint32_t count{ 0u };
+
+		while (count < maxCount)
+		{
+			slot_t &slot{ m_slots[m_tail & (CAPACITY - 1ull)] };
+			if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1ull) break; // empty, or producer not done yet
+
+			entries[count++] = slot.entry;
+			slot.sequence.store(m_tail + CAPACITY, std::memory_order_release);
+			++m_tail;
+		}
+		return count;
+	}
+
+	uint64_t LogRing::getDroppedCount()
+	{
+		return m_droppedCount.load(std::memory_order_relaxed);
+	}
+
+	// --------------------------------------------------------------------
+	// Private
+	// --------------------------------------------------------------------
+
+	void LogRing::copyString(char *destination, char const *source, uint32_t const length)
+	{
+		uint32_t i{ 0u };
+		for (; i < length - 1u && source[i] != '\0'; ++i)
+			destination[i] = source[i];
+
+		destination[i] = '\0';
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef __LOG_RING__
+#define __LOG_RING__
+
+namespace CPUSolver
+{
+	// Ordered by severity, values must match Miner.LogEntry.LogLevel
+	enum log_level_t : uint32_t
+	{
+		LOG_DEBUG,
+		LOG_INFO,
+		LOG_WARN,
+		LOG_ERROR
+	};
+
+	// Layout must match Miner.LogEntry
+	struct log_entry_t
+	{
+		static uint32_t const SOURCE_LENGTH{ 64u };
+		static uint32_t const MESSAGE_LENGTH{ 952u }; // whole entry is 1 KiB
+
+		int32_t device; // -1 for messages not from a device (or CPU thread)
+		uint32_t level;
+		char source[SOURCE_LENGTH]; // platform name on OpenCL, empty otherwise
+		char message[MESSAGE_LENGTH]; // truncated if longer
+	};
+
+	// Bounded lock-free queue of log messages of one solver instance, many producers and single consumer (host drain).
+	// Messages below the set level are discarded before being copied, and messages are dropped when full,
+	// rather than stalling the mining loop.
+	class LogRing
+	{
+	public:
+		static uint64_t const CAPACITY{ 1024ull }; // power of 2
+
+	private:
+		struct slot_t
+		{
+			std::atomic<uint64_t> sequence;
+			log_entry_t entry;
+		};
+
+		slot_t m_slots[CAPACITY];
+		std::atomic<uint64_t> m_head;
+		uint64_t m_tail;
+		std::atomic<uint64_t> m_droppedCount;
+		std::atomic<uint32_t> m_level;
+
+	public:
+		static log_level_t getLevel(char const *type);
+
+		LogRing() noexcept;
+
+		bool isLogged(log_level_t const level);
+		void setLevel(log_level_t const level);
+
+		void push(log_level_t const level, int32_t const device, char const *source, char const *message);
+
+		uint32_t drain(log_entry_t *entries, uint32_t const maxCount);
+		uint64_t getDroppedCount();
+
+	private:
+		static void copyString(char *destination, char const *source, uint32_t const length);
+	};
+}
+
+#endif // !__LOG_RING__
@@ -0,0 +1,72 @@
+#include "nonceSpace.h"
+
+namespace CPUSolver
+{
+	// --------------------------------------------------------------------
+	// Static
+	// --------------------------------------------------------------------
+
+	nonce_pool_t NonceSpace::m_localPool{};
+
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	NonceSpace::NonceSpace() noexcept :
+		m_pool{ &m_localPool }
+	{
+	}
+
+	void NonceSpace::setPool(nonce_pool_t *pool)
+	{
+		m_pool = (pool == nullptr) ? &m_localPool : pool;
+	}
+
+	uint64_t NonceSpace::getPosition()
+	{
+		return m_pool->position.load(std::memory_order_relaxed);
+	}
+
+	uint64_t NonceSpace::getEpoch()
+	{
+		return m_pool->epoch.load(std::memory_order_relaxed);
+	}
+
+	uint64_t NonceSpace::getAbandonedCount()
+	{
+		return m_pool->abandoned.load(std::memory_order_relaxed);
+	}
+
+	uint64_t NonceSpace::getNextPosition(nonce_range_t &range, uint64_t const workSize, uint64_t const refillCount)
+	{
+		uint64_t const epoch{ m_pool->epoch.load(std::memory_order_acquire) };
+
+		if (range.epoch != epoch)
+		{
+			abandonRange(range);
+			range.epoch = epoch;
+		}
+
+		if (range.end - range.next < workSize)
+		{
+			abandonRange(range); // remainder smaller than work size (i.e. work size changed)
+
+			uint64_t const refillSize{ workSize * refillCount };
+			range.next = m_pool->position.fetch_add(refillSize, std::memory_order_relaxed);
+			range.end = range.next + refillSize;
+		}
+
+		uint64_t const position{ range.next };
+		range.next += workSize;
+
+		return position;
+	}
+
+	void NonceSpace::abandonRange(nonce_range_t &range)
+	{
+		if (range.end > range.next)
+			m_pool->abandoned.fetch_add(range.end - range.next, std::memory_order_relaxed);
+
+		range.next = range.end;
+	}
+}
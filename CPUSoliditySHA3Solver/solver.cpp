@@ -7,9 +7,9 @@ namespace CPUSolver
 		*processorCount = cpuSolver::getLogicalProcessorsCount();
 	}
 
-	void GetNewSolutionTemplate(const char *kingAddress, const char *solutionTemplate)
+	void GetNewSolutionTemplate(const char *kingAddress, uint64_t const seed, const char *solutionTemplate)
 	{
-		auto newTemplate = cpuSolver::getNewSolutionTemplate(kingAddress);
+		auto newTemplate = cpuSolver::getNewSolutionTemplate(kingAddress, seed);
 		auto newTemplateStr = newTemplate.c_str();
 		std::memcpy((void *)solutionTemplate, newTemplateStr, UINT256_LENGTH * 2 + 2);
 	}
@@ -26,36 +26,17 @@ namespace CPUSolver
 		return getSolutionTemplateCallback;
 	}
 
-	GetWorkPositionCallback SetOnGetWorkPositionHandler(cpuSolver *instance, GetWorkPositionCallback getWorkPositionCallback)
-	{
-		instance->m_getWorkPositionCallback = getWorkPositionCallback;
-		return getWorkPositionCallback;
-	}
-
-	ResetWorkPositionCallback SetOnResetWorkPositionHandler(cpuSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback)
-	{
-		instance->m_resetWorkPositionCallback = resetWorkPositionCallback;
-		return resetWorkPositionCallback;
-	}
-
-	IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(cpuSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback)
-	{
-		instance->m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-		return incrementWorkPositionCallback;
-	}
-
-	MessageCallback SetOnMessageHandler(cpuSolver *instance, MessageCallback messageCallback)
-	{
-		instance->m_messageCallback = messageCallback;
-		return messageCallback;
-	}
-
 	SolutionCallback SetOnSolutionHandler(cpuSolver *instance, SolutionCallback solutionCallback)
 	{
 		instance->m_solutionCallback = solutionCallback;
 		return solutionCallback;
 	}
 
+	void SetNoncePool(cpuSolver *instance, nonce_pool_t *noncePool)
+	{
+		instance->setNoncePool(noncePool);
+	}
+
 	cpuSolver *GetInstance(const char *threads) noexcept
 	{
 		try { return new cpuSolver(threads); }
@@ -77,6 +58,11 @@ namespace CPUSolver
 		instance->m_SubmitStale = submitStale;
 	}
 
+	void SetTargetLaunchDuration(cpuSolver *instance, const uint32_t targetLaunchDuration)
+	{
+		instance->m_TargetLaunchDuration = targetLaunchDuration;
+	}
+
 	void IsMining(cpuSolver *instance, bool *isMining)
 	{
 		*isMining = instance->isMining();
@@ -92,6 +78,32 @@ namespace CPUSolver
 		*hashRate = instance->getHashRateByThreadID(threadID);
 	}
 
+	void GetMetricsByThreadID(cpuSolver *instance, const uint32_t threadID, uint64_t *metrics)
+	{
+		instance->getMetricsByThreadID(threadID, metrics);
+	}
+
+	void SetTraceEnabled(cpuSolver *, const bool isEnabled) // tracing is process-wide
+	{
+		TraceBuffer::setEnabled(isEnabled);
+	}
+
+	void GetTraceEventsByThreadID(cpuSolver *instance, const uint32_t threadID, trace_event_t *events, const uint32_t maxCount, uint32_t *count)
+	{
+		*count = instance->getTraceEventsByThreadID(threadID, events, maxCount);
+	}
+
+	void SetLogLevel(cpuSolver *instance, const uint32_t level)
+	{
+		instance->m_log.setLevel((log_level_t)level);
+	}
+
+	void GetLogEntries(cpuSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount)
+	{
+		*count = instance->m_log.drain(entries, maxCount);
+		*droppedCount = instance->m_log.getDroppedCount();
+	}
+
 	void GetTotalHashRate(cpuSolver *instance, uint64_t *totalHashRate)
 	{
 		*totalHashRate = instance->getTotalHashRate();
@@ -121,4 +133,24 @@ namespace CPUSolver
 	{
 		instance->stopFinding();
 	}
+
+	void GetThreadCount(cpuSolver *instance, uint32_t *threadCount)
+	{
+		*threadCount = instance->getThreadCount();
+	}
+
+	void SetThreadAffinity(cpuSolver *instance, const uint32_t threadID, const uint32_t affinity, bool *isFound)
+	{
+		*isFound = instance->setThreadAffinity(threadID, affinity);
+	}
+
+	void SetThreadEnabled(cpuSolver *instance, const uint32_t threadID, const bool isEnabled, bool *isFound)
+	{
+		*isFound = instance->setThreadEnabled(threadID, isEnabled);
+	}
+
+	void AddThread(cpuSolver *instance, const uint32_t affinity, int *threadID)
+	{
+		*threadID = instance->addThread(affinity);
+	}
 }
\ No newline at end of file
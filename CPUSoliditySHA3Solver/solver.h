@@ -19,7 +19,7 @@ namespace CPUSolver
 	{
 		EXPORT void __CDECL__ GetLogicalProcessorsCount(uint32_t *processorCount);
 
-		EXPORT void __CDECL__ GetNewSolutionTemplate(const char *kingAddress, const char *solutionTemplate);
+		EXPORT void __CDECL__ GetNewSolutionTemplate(const char *kingAddress, uint64_t const seed, const char *solutionTemplate);
 
 		EXPORT cpuSolver *__CDECL__ GetInstance(const char *threads) noexcept;
 
@@ -29,24 +29,30 @@ namespace CPUSolver
 
 		EXPORT GetSolutionTemplateCallback __CDECL__ SetOnGetSolutionTemplateHandler(cpuSolver *instance, GetSolutionTemplateCallback getSolutionTemplateCallback);
 
-		EXPORT GetWorkPositionCallback __CDECL__ SetOnGetWorkPositionHandler(cpuSolver *instance, GetWorkPositionCallback getWorkPositionCallback);
-
-		EXPORT ResetWorkPositionCallback __CDECL__ SetOnResetWorkPositionHandler(cpuSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback);
-
-		EXPORT IncrementWorkPositionCallback __CDECL__ SetOnIncrementWorkPositionHandler(cpuSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
-
-		EXPORT MessageCallback __CDECL__ SetOnMessageHandler(cpuSolver *instance, MessageCallback messageCallback);
-
 		EXPORT SolutionCallback __CDECL__ SetOnSolutionHandler(cpuSolver *instance, SolutionCallback solutionCallback);
 
+		EXPORT void __CDECL__ SetNoncePool(cpuSolver *instance, nonce_pool_t *noncePool);
+
 		EXPORT void __CDECL__ SetSubmitStale(cpuSolver *instance, const bool submitStale);
 
+		EXPORT void __CDECL__ SetTargetLaunchDuration(cpuSolver *instance, const uint32_t targetLaunchDuration);
+
 		EXPORT void __CDECL__ IsMining(cpuSolver *instance, bool *isMining);
 
 		EXPORT void __CDECL__ IsPaused(cpuSolver *instance, bool *isPaused);
 
 		EXPORT void __CDECL__ GetHashRateByThreadID(cpuSolver *instance, const uint32_t threadID, uint64_t *hashRate);
 
+		EXPORT void __CDECL__ GetMetricsByThreadID(cpuSolver *instance, const uint32_t threadID, uint64_t *metrics);
+
+		EXPORT void __CDECL__ SetTraceEnabled(cpuSolver *instance, const bool isEnabled);
+
+		EXPORT void __CDECL__ GetTraceEventsByThreadID(cpuSolver *instance, const uint32_t threadID, trace_event_t *events, const uint32_t maxCount, uint32_t *count);
+
+		EXPORT void __CDECL__ SetLogLevel(cpuSolver *instance, const uint32_t level);
+
+		EXPORT void __CDECL__ GetLogEntries(cpuSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount);
+
 		EXPORT void __CDECL__ GetTotalHashRate(cpuSolver *instance, uint64_t *totalHashRate);
 
 		EXPORT void __CDECL__ UpdatePrefix(cpuSolver *instance, const char *prefix);
@@ -58,6 +64,14 @@ namespace CPUSolver
 		EXPORT void __CDECL__ StartFinding(cpuSolver *instance);
 
 		EXPORT void __CDECL__ StopFinding(cpuSolver *instance);
+
+		EXPORT void __CDECL__ GetThreadCount(cpuSolver *instance, uint32_t *threadCount);
+
+		EXPORT void __CDECL__ SetThreadAffinity(cpuSolver *instance, const uint32_t threadID, const uint32_t affinity, bool *isFound);
+
+		EXPORT void __CDECL__ SetThreadEnabled(cpuSolver *instance, const uint32_t threadID, const bool isEnabled, bool *isFound);
+
+		EXPORT void __CDECL__ AddThread(cpuSolver *instance, const uint32_t affinity, int *threadID);
 	
 	}
 }
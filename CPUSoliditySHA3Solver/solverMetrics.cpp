@@ -0,0 +1,106 @@
+#include "solverMetrics.h"
+
+namespace CPUSolver
+{
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	SolverMetrics::SolverMetrics() noexcept
+	{
+		reset(m_launchDuration);
+		reset(m_challengeSwitch);
+		reset(m_solutionLatency);
+		reset(m_solutionVerify);
+		m_positionsAllocated.store(0ull);
+		m_launchesAborted.store(0ull);
+		m_restarts.store(0ull);
+		m_hashesCompleted.store(0ull);
+	}
+
+	void SolverMetrics::recordLaunch(std::chrono::steady_clock::time_point const startTime, uint64_t const hashCount)
+	{
+		record(m_launchDuration, startTime);
+		m_hashesCompleted.fetch_add(hashCount, std::memory_order_relaxed);
+	}
+
+	void SolverMetrics::recordChallengeSwitch(std::chrono::steady_clock::time_point const challengeTime)
+	{
+		record(m_challengeSwitch, challengeTime);
+	}
+
+	void SolverMetrics::recordSolution(std::chrono::steady_clock::time_point const foundTime)
+	{
+		record(m_solutionLatency, foundTime);
+	}
+
+	void SolverMetrics::recordVerify(std::chrono::steady_clock::time_point const verifyStartTime)
+	{
+		record(m_solutionVerify, verifyStartTime);
+	}
+
+	void SolverMetrics::addPositions(uint64_t const count)
+	{
+		m_positionsAllocated.fetch_add(count, std::memory_order_relaxed);
+	}
+
+	void SolverMetrics::addAbortedLaunch()
+	{
+		m_launchesAborted.fetch_add(1ull, std::memory_order_relaxed);
+	}
+
+	void SolverMetrics::addRestart()
+	{
+		m_restarts.fetch_add(1ull, std::memory_order_relaxed);
+	}
+
+	void SolverMetrics::getValues(uint64_t *values)
+	{
+		values = copy(m_launchDuration, values);
+		values = copy(m_challengeSwitch, values);
+		values = copy(m_solutionLatency, values);
+		values = copy(m_solutionVerify, values);
+		values[0] = m_positionsAllocated.load(std::memory_order_relaxed);
+		values[1] = m_launchesAborted.load(std::memory_order_relaxed);
+		values[2] = m_restarts.load(std::memory_order_relaxed);
+		values[3] = m_hashesCompleted.load(std::memory_order_relaxed);
+	}
+
+	// --------------------------------------------------------------------
+	// Private
+	// --------------------------------------------------------------------
+
+	void SolverMetrics::reset(duration_histogram_t &histogram)
+	{
+		for (uint32_t i{ 0u }; i < duration_histogram_t::BUCKET_COUNT; ++i)
+			histogram.buckets[i].store(0ull);
+
+		histogram.count.store(0ull);
+		histogram.sum.store(0ull);
+	}
+
+	void SolverMetrics::record(duration_histogram_t &histogram, std::chrono::steady_clock::time_point const startTime)
+	{
+		using namespace std::chrono;
+		auto const elapsed = duration_cast<microseconds>(steady_clock::now() - startTime).count();
+		uint64_t const duration{ (elapsed > 0) ? (uint64_t)elapsed : 0ull };
+
+		uint32_t bucket{ 0u };
+		while (bucket < (duration_histogram_t::BUCKET_COUNT - 1u) && (1ull << bucket) < duration) ++bucket;
+
+		histogram.buckets[bucket].fetch_add(1ull, std::memory_order_relaxed);
+		histogram.count.fetch_add(1ull, std::memory_order_relaxed);
+		histogram.sum.fetch_add(duration, std::memory_order_relaxed);
+	}
+
+	uint64_t *SolverMetrics::copy(duration_histogram_t &histogram, uint64_t *values)
+	{
+		for (uint32_t i{ 0u }; i < duration_histogram_t::BUCKET_COUNT; ++i)
+			values[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+
+		values[duration_histogram_t::BUCKET_COUNT] = histogram.count.load(std::memory_order_relaxed);
+		values[duration_histogram_t::BUCKET_COUNT + 1u] = histogram.sum.load(std::memory_order_relaxed);
+
+		return values + duration_histogram_t::VALUE_COUNT;
+	}
+}
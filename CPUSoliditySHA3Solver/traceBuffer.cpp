@@ -0,0 +1,115 @@
+#include "traceBuffer.h"
+
+namespace CPUSolver
+{
+	// --------------------------------------------------------------------
+	// Static
+	// --------------------------------------------------------------------
+
+	std::atomic<bool> TraceBuffer::m_isEnabled{ false };
+
+	bool TraceBuffer::isEnabled()
+	{
+		return m_isEnabled.load(std::memory_order_relaxed);
+	}
+
+	void TraceBuffer::setEnabled(bool const isEnabled)
+	{
+		m_isEnabled.store(isEnabled);
+	}
+
+	uint64_t TraceBuffer::getTimestamp(std::chrono::steady_clock::time_point const time)
+	{
+		using namespace std::chrono;
+		return (uint64_t)duration_cast<microseconds>(time.time_since_epoch()).count();
+	}
+
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	TraceBuffer::TraceBuffer() noexcept :
+		m_head{ 0ull },
+		m_tail{ 0ull },
+		m_droppedCount{ 0ull }
+	{
+		for (uint64_t i{ 0ull }; i < CAPACITY; ++i)
+			m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	void TraceBuffer::recordInstant(trace_event_type const type, uint64_t const value)
+	{
+		if (!isEnabled()) return;
+
+		push({ getTimestamp(std::chrono::steady_clock::now()), 0ull, value, type });
+	}
+
+	void TraceBuffer::recordSpan(trace_event_type const type, std::chrono::steady_clock::time_point const startTime, uint64_t const value)
+	{
+		if (!isEnabled()) return;
+
+		uint64_t const timestamp{ getTimestamp(startTime) };
+		uint64_t const endTimestamp{ getTimestamp(std::chrono::steady_clock::now()) };
+
+		push({ timestamp, (endTimestamp > timestamp) ? (endTimestamp - timestamp) : 0ull, value, type });
+	}
+
+	void TraceBuffer::recordSpan(trace_event_type const type, uint64_t const timestamp, uint64_t const duration, uint64_t const value)
+	{
+		if (!isEnabled()) return;
+
+		push({ timestamp, duration, value, type });
+	}
+
+	uint32_t TraceBuffer::drain(trace_event_t *events, uint32_t const maxCount)
+	{
+		uint32_t count{ 0u };
+
+		while (count < maxCount)
+		{
+			slot_t &slot{ m_slots[m_tail & (CAPACITY - 1ull)] };
+			if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1ull) break; // empty, or producer not done yet
+
+			events[count++] = slot.event;
+			slot.sequence.store(m_tail + CAPACITY, std::memory_order_release);
+			++m_tail;
+		}
+		return count;
+	}
+
+	uint64_t TraceBuffer::getDroppedCount()
+	{
+		return m_droppedCount.load(std::memory_order_relaxed);
+	}
+
+	// --------------------------------------------------------------------
+	// Private
+	// --------------------------------------------------------------------
+
+	void TraceBuffer::push(trace_event_t const &event)
+	{
+		uint64_t position{ m_head.load(std::memory_order_relaxed) };
+
+		while (true)
+		{
+			slot_t &slot{ m_slots[position & (CAPACITY - 1ull)] };
+			int64_t const difference{ (int64_t)slot.sequence.load(std::memory_order_acquire) - (int64_t)position };
+
+			if (difference == 0)
+			{
+				if (m_head.compare_exchange_weak(position, position + 1ull, std::memory_order_relaxed))
+				{
+					slot.event = event;
+					slot.sequence.store(position + 1ull, std::memory_order_release);
+					return;
+				}
+			}
+			else if (difference < 0) // full, host is not draining fast enough
+			{
+				m_droppedCount.fetch_add(1ull, std::memory_order_relaxed);
+				return;
+			}
+			else position = m_head.load(std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __TRACE_BUFFER__
+#define __TRACE_BUFFER__
+
+namespace CPUSolver
+{
+	// Layout must match Miner.TraceEvent, type names are listed in the same order
+	enum trace_event_type : uint64_t
+	{
+		TRACE_WORK_ALLOCATION, // nonces reserved from the nonce space, value is work position
+		TRACE_KERNEL_ENQUEUE, // value is work position
+		TRACE_KERNEL, // launch (work chunk on CPU), value is work position
+		TRACE_READBACK, // solutions read back from device, value is solution count
+		TRACE_JOB_SWITCH, // new challenge or target pushed to device, value is 1 on challenge change
+		TRACE_SOLUTION_VERIFY // candidate verified by host, value is 1 when it met the target
+	};
+
+	struct trace_event_t
+	{
+		uint64_t timestamp; // microseconds of steady clock, the same monotonic OS clock as managed Stopwatch
+		uint64_t duration; // microseconds, 0 for instant event
+		uint64_t value;
+		uint64_t type;
+	};
+
+	// Bounded lock-free queue of trace events of one device (or CPU thread), many producers and single consumer (host drain).
+	// Events are dropped when full, rather than stalling the mining loop.
+	class TraceBuffer
+	{
+	public:
+		static uint64_t const CAPACITY{ 4096ull }; // power of 2
+
+	private:
+		struct slot_t
+		{
+			std::atomic<uint64_t> sequence;
+			trace_event_t event;
+		};
+
+		static std::atomic<bool> m_isEnabled;
+
+		slot_t m_slots[CAPACITY];
+		std::atomic<uint64_t> m_head;
+		uint64_t m_tail;
+		std::atomic<uint64_t> m_droppedCount;
+
+	public:
+		static bool isEnabled();
+		static void setEnabled(bool const isEnabled);
+		static uint64_t getTimestamp(std::chrono::steady_clock::time_point const time);
+
+		TraceBuffer() noexcept;
+
+		void recordInstant(trace_event_type const type, uint64_t const value);
+		void recordSpan(trace_event_type const type, std::chrono::steady_clock::time_point const startTime, uint64_t const value);
+		void recordSpan(trace_event_type const type, uint64_t const timestamp, uint64_t const duration, uint64_t const value);
+
+		uint32_t drain(trace_event_t *events, uint32_t const maxCount);
+		uint64_t getDroppedCount();
+
+	private:
+		void push(trace_event_t const &event);
+	};
+}
+
+#endif // !__TRACE_BUFFER__
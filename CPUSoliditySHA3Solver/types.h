@@ -2,6 +2,7 @@
 
 #include <array>
 #include <assert.h>
+#include <stdexcept>
 
 static const unsigned short UINT32_LENGTH{ 4u };
 static const unsigned short UINT64_LENGTH{ 8u };
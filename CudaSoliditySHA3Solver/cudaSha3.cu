@@ -124,8 +124,13 @@ __device__ __forceinline__ nonce_t rotr(nonce_t input, uint32_t const offset)
 	return input;
 }
 
-__global__ void hashMidstate(uint64_t *__restrict__ solutions, uint32_t *__restrict__ solutionCount, uint64_t startPosition)
+__global__ void hashMidstate(uint64_t *__restrict__ solutions, uint32_t *__restrict__ solutionCount, uint64_t startPosition, uint32_t const volatile *abortFlag)
 {
+	__shared__ uint32_t isAborted;
+	if (threadIdx.x == 0u) isAborted = *abortFlag; // one read of mapped host memory per block
+	__syncthreads();
+	if (isAborted) return;
+
 	nonce_t nonce, state[25], C[5], D[5], n[11];
 	nonce.uint64 = blockDim.x * blockIdx.x + threadIdx.x + startPosition;
 
@@ -308,8 +313,6 @@ namespace CUDASolver
 	void CudaSolver::pushMessage(std::unique_ptr<Device> &device)
 	{
 		cudaMemcpyToSymbol(d_midstate, &device->currentMidstate, SPONGE_LENGTH, 0, cudaMemcpyHostToDevice);
-
-		device->isNewMessage = false;
 	}
 
 	void CudaSolver::pushTarget(std::unique_ptr<Device> &device)
@@ -332,22 +335,22 @@ namespace CUDASolver
 		if (!errorMessage.empty())
 			onMessage(device->deviceID, "Error", errorMessage);
 
-		char *c_currentChallenge = (char *)malloc(s_challenge.size());
-		#ifdef __linux__
-		strcpy(c_currentChallenge, s_challenge.c_str());
-		#else
-		strcpy_s(c_currentChallenge, s_challenge.size() + 1, s_challenge.c_str());
-		#endif
+		std::string currentChallenge{ s_challenge };
 
 		onMessage(device->deviceID, "Info", "Start mining...");
-		onMessage(device->deviceID, "Debug", "Threads: " + std::to_string(device->threads()) + " Grid size: " + std::to_string(device->grid().x) + " Block size:" + std::to_string(device->block().x));
+		if (m_log.isLogged(LOG_DEBUG)) onMessage(device->deviceID, "Debug", "Threads: " + std::to_string(device->threads()) + " Grid size: " + std::to_string(device->grid().x) + " Block size:" + std::to_string(device->block().x));
+
+		device->launchController.setTarget(targetLaunchDuration);
+		device->launchController.setLimits(device->block().x, device->block().x, 1ull << 31);
+		if (device->launchController.isEnabled())
+			onMessage(device->deviceID, "Info", "Target launch duration: " + std::to_string(targetLaunchDuration) + "ms");
 
 		device->mining = true;
 		device->hashCount.store(0ull);
 		device->hashStartTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(1000); // reduce excessive high hashrate reporting at start
 		do
 		{
-			while (m_pause)
+			while (m_pause || device->dutyCycle.isPaused())
 			{
 				device->hashCount.store(0ull);
 				device->hashStartTime = std::chrono::steady_clock::now();
@@ -355,9 +358,14 @@ namespace CUDASolver
 				std::this_thread::sleep_for(std::chrono::milliseconds(500));
 			}
 
-			checkInputs(device, c_currentChallenge);
+			applyTuning(device);
+			checkInputs(device, currentChallenge);
 
-			hashMidstate<<<device->grid(), device->block()>>>(device->d_Solutions, device->d_SolutionCount, getNextWorkPosition(device));
+			uint64_t const workPosition{ getNextWorkPosition(device) };
+
+			auto const launchStartTime = std::chrono::steady_clock::now();
+			hashMidstate<<<device->grid(), device->block()>>>(device->d_Solutions, device->d_SolutionCount, workPosition, device->d_AbortFlag);
+			device->trace.recordSpan(TRACE_KERNEL_ENQUEUE, launchStartTime, workPosition);
 
 			errorMessage = CudaSyncAndCheckError();
 			if (!errorMessage.empty())
@@ -366,9 +374,21 @@ namespace CUDASolver
 				device->mining = false;
 				break;
 			}
+			device->trace.recordSpan(TRACE_KERNEL, launchStartTime, workPosition);
+
+			if (device->h_AbortFlag->load() == 0u)
+			{
+				device->metrics.recordLaunch(launchStartTime, device->threads());
+
+				if (device->launchController.isEnabled()) // thread count follows measured launch duration
+					device->setThreads((uint32_t)device->launchController.update(device->threads(), launchStartTime));
+			}
+			else
+				device->metrics.addAbortedLaunch(); // cut short by new challenge, relaunched on next iteration
 
 			if (*device->h_SolutionCount > 0u)
 			{
+				auto const readbackStartTime = std::chrono::steady_clock::now();
 				std::set<uint64_t> uniqueSolutions;
 
 				for (uint32_t i{ 0u }; i < MAX_SOLUTION_COUNT_DEVICE && i < *device->h_SolutionCount; ++i)
@@ -379,11 +399,14 @@ namespace CUDASolver
 						uniqueSolutions.emplace(tempSolution);
 				}
 
-				std::thread t{ &CudaSolver::submitSolutions, this, uniqueSolutions, std::string{ c_currentChallenge }, device->deviceID };
+				std::thread t{ &CudaSolver::submitSolutions, this, uniqueSolutions, currentChallenge, device->deviceID, std::chrono::steady_clock::now() };
 				t.detach();
 
 				std::memset(device->h_SolutionCount, 0u, UINT32_LENGTH);
+				device->trace.recordSpan(TRACE_READBACK, readbackStartTime, uniqueSolutions.size());
 			}
+
+			device->dutyCycle.idle(launchStartTime); // after solutions are handed over
 		} while (device->mining);
 
 		onMessage(device->deviceID, "Info", "Stop mining...");
@@ -393,6 +416,9 @@ namespace CUDASolver
 		if (!errorMessage.empty())
 			onMessage(device->deviceID, "Error", errorMessage);
 		errorMessage = CudaSafeCall(cudaFreeHost(device->h_Solutions));
+		if (!errorMessage.empty())
+			onMessage(device->deviceID, "Error", errorMessage);
+		errorMessage = CudaSafeCall(cudaHostUnregister(device->h_AbortFlag)); // flag itself is kept, host thread may still raise it
 		if (!errorMessage.empty())
 			onMessage(device->deviceID, "Error", errorMessage);
 		errorMessage = CudaSafeCall(cudaDeviceReset());
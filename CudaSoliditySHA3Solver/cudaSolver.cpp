@@ -90,6 +90,9 @@ namespace CUDASolver
 	// --------------------------------------------------------------------
 
 	CudaSolver::CudaSolver() noexcept :
+		targetLaunchDuration{ 0u },
+		m_isStarting{ false },
+		m_isStarted{ false },
 		s_address{ "" },
 		s_challenge{ "" },
 		s_target{ "" },
@@ -120,29 +123,14 @@ namespace CUDASolver
 		m_getSolutionTemplateCallback = solutionTemplateCallback;
 	}
 
-	void CudaSolver::setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback)
-	{
-		m_getWorkPositionCallback = workPositionCallback;
-	}
-
-	void CudaSolver::setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback)
-	{
-		m_resetWorkPositionCallback = resetWorkPositionCallback;
-	}
-
-	void CudaSolver::setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback)
-	{
-		m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-	}
-
-	void CudaSolver::setMessageCallback(MessageCallback messageCallback)
+	void CudaSolver::setSolutionCallback(SolutionCallback solutionCallback)
 	{
-		m_messageCallback = messageCallback;
+		m_solutionCallback = solutionCallback;
 	}
 
-	void CudaSolver::setSolutionCallback(SolutionCallback solutionCallback)
+	void CudaSolver::setNoncePool(nonce_pool_t *noncePool)
 	{
-		m_solutionCallback = solutionCallback;
+		m_nonceSpace.setPool(noncePool);
 	}
 
 	bool CudaSolver::assignDevice(int const deviceID, uint32_t &pciBusID, float &intensity)
@@ -270,6 +258,8 @@ namespace CUDASolver
 	{
 		assert(prefix.length() == ((UINT256_LENGTH + ADDRESS_LENGTH) * 2 + 2));
 
+		bool const isChallengeChanged{ prefix.substr(0, 2 + UINT256_LENGTH * 2) != s_challenge };
+
 		s_challenge = prefix.substr(0, 2 + UINT256_LENGTH * 2);
 		s_address = "0x" + prefix.substr(2 + UINT256_LENGTH * 2, ADDRESS_LENGTH * 2);
 
@@ -280,6 +270,7 @@ namespace CUDASolver
 		m_miningMessage.structure.solution = m_solutionTemplate;
 
 		sponge_ut midState = getMidState(m_miningMessage);
+		auto const challengeTime = std::chrono::steady_clock::now();
 
 		for (auto& device : m_devices)
 		{
@@ -287,6 +278,10 @@ namespace CUDASolver
 
 			device->currentMessage = m_miningMessage;
 			device->currentMidstate = midState;
+			device->challengeTime = challengeTime;
+
+			if (isChallengeChanged && device->mining) device->h_AbortFlag->store(1u); // raise before new message, cleared once it is pushed
+			device->messageGeneration++;
 			device->isNewMessage = true;
 		}
 	}
@@ -316,6 +311,8 @@ namespace CUDASolver
 
 	void CudaSolver::startFinding()
 	{
+		m_isStarting = true;
+
 		for (auto& device : m_devices)
 		{
 			if (m_isKingMaking)
@@ -325,11 +322,20 @@ namespace CUDASolver
 			device->miningThread.detach();
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
+
+		m_isStarted = true;
+		m_isStarting = false;
 	}
 
 	void CudaSolver::stopFinding()
 	{
-		for (auto& device : m_devices) device->mining = false;
+		m_isStarted = false;
+
+		for (auto& device : m_devices)
+		{
+			device->dutyCycle.setPercent(DutyCycle::FULL); // a device paused by duty cycle would not leave its loop
+			device->mining = false;
+		}
 
 		std::this_thread::sleep_for(std::chrono::seconds(1));
 	}
@@ -339,6 +345,86 @@ namespace CUDASolver
 		m_pause = pauseFinding;
 	}
 
+	void CudaSolver::setDeviceDutyCycle(int deviceID, uint32_t const dutyCycle)
+	{
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+				device->dutyCycle.setPercent(dutyCycle);
+	}
+
+	bool CudaSolver::setDeviceTuning(int deviceID, float const intensity, uint32_t const blockSize)
+	{
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+			{
+				device->tuningRequest.request(intensity, blockSize);
+				return true;
+			}
+
+		return false;
+	}
+
+	bool CudaSolver::isDeviceMining(int deviceID)
+	{
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+				return device->mining;
+
+		return false;
+	}
+
+	bool CudaSolver::isDevicePaused(int deviceID)
+	{
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+				return m_pause || device->dutyCycle.isPaused();
+
+		return m_pause;
+	}
+
+	// Stops mining thread of one device and re-initializes it, other devices keep mining.
+	// Returns false if mining is not started (or still starting), device is unknown or its thread did not leave a hung launch in time.
+	bool CudaSolver::restartDevice(int deviceID)
+	{
+		if (m_isStarting || !m_isStarted) return false;
+
+		auto deviceIterator = std::find_if(m_devices.begin(), m_devices.end(), [&](std::unique_ptr<Device>& device) { return device->deviceID == deviceID; });
+		if (deviceIterator == m_devices.end()) return false;
+
+		auto& device = *deviceIterator;
+		onMessage(deviceID, "Info", "Restarting device...");
+
+		auto const dutyCyclePercent = device->dutyCycle.getPercent();
+		device->dutyCycle.setPercent(DutyCycle::FULL); // a paused device would not leave its idle loop to stop
+		device->mining = false;
+
+		auto const stopDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(RESTART_STOP_TIMEOUT_S);
+		while (device->initialized && std::chrono::steady_clock::now() < stopDeadline)
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		device->dutyCycle.setPercent(dutyCyclePercent); // as set by host (e.g. thermal control), kept by restarted device
+
+		if (device->initialized)
+		{
+			onMessage(deviceID, "Error", "Device did not stop in time, restart deferred.");
+			return false;
+		}
+
+		initializeDevice(device); // device reset is included
+
+		device->isNewMessage = !s_challenge.empty(); // constant memory is lost on reset, push current work again
+		device->isNewTarget = !s_target.empty();
+		device->metrics.addRestart();
+
+		if (m_isKingMaking)
+			device->miningThread = std::thread(&CudaSolver::findSolutionKing, this, device->deviceID);
+		else
+			device->miningThread = std::thread(&CudaSolver::findSolution, this, device->deviceID);
+		device->miningThread.detach();
+
+		return true;
+	}
+
 	uint64_t CudaSolver::getTotalHashRate()
 	{
 		uint64_t totalHashRate{ 0ull };
@@ -357,6 +443,24 @@ namespace CUDASolver
 		return 0ull;
 	}
 
+	void CudaSolver::getMetricsByDeviceID(int const deviceID, uint64_t *values)
+	{
+		std::memset(values, 0, UINT64_LENGTH * SolverMetrics::VALUE_COUNT);
+
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+				device->metrics.getValues(values);
+	}
+
+	uint32_t CudaSolver::getTraceEventsByDeviceID(int const deviceID, trace_event_t *events, uint32_t const maxCount)
+	{
+		for (auto& device : m_devices)
+			if (device->deviceID == deviceID)
+				return device->trace.drain(events, maxCount);
+
+		return 0u;
+	}
+
 	int CudaSolver::getDeviceSettingMaxCoreClock(int deviceID)
 	{
 		std::string errorMessage;
@@ -535,24 +639,9 @@ namespace CUDASolver
 		m_getSolutionTemplateCallback(solutionTemplate->data());
 	}
 
-	void CudaSolver::getWorkPosition(uint64_t &workPosition)
-	{
-		m_getWorkPositionCallback(workPosition);
-	}
-
-	void CudaSolver::resetWorkPosition(uint64_t &lastPosition)
-	{
-		m_resetWorkPositionCallback(lastPosition);
-	}
-
-	void CudaSolver::incrementWorkPosition(uint64_t &lastPosition, uint64_t increment)
-	{
-		m_incrementWorkPositionCallback(lastPosition, increment);
-	}
-
 	void CudaSolver::onMessage(int deviceID, const char *type, const char *message)
 	{
-		m_messageCallback(deviceID, type, message);
+		m_log.push(LogRing::getLevel(type), deviceID, "", message);
 	}
 
 	void CudaSolver::onMessage(int deviceID, std::string type, std::string message)
@@ -560,7 +649,7 @@ namespace CUDASolver
 		onMessage(deviceID, type.c_str(), message.c_str());
 	}
 
-	void CudaSolver::onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device)
+	void CudaSolver::onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device, std::chrono::steady_clock::time_point const foundTime)
 	{
 		if (!isSubmitStale && challenge != s_challenge)
 			return;
@@ -569,6 +658,7 @@ namespace CUDASolver
 		else
 			onMessage(device->deviceID, "Info", "GPU found solution, verifying...");
 
+		auto const verifyStartTime = std::chrono::steady_clock::now();
 		byte32_t emptySolution;
 		std::memset(&emptySolution, 0u, UINT256_LENGTH);
 		if (solution == emptySolution)
@@ -592,7 +682,7 @@ namespace CUDASolver
 		std::string digestStr = bytesToHexString(bDigest);
 		arith_uint256 digest = arith_uint256(digestStr);
 
-		onMessage(device->deviceID, "Debug", "Digest: 0x" + digestStr);
+		if (m_log.isLogged(LOG_DEBUG)) onMessage(device->deviceID, "Debug", "Digest: 0x" + digestStr);
 
 		if (digest >= m_target)
 		{
@@ -611,21 +701,26 @@ namespace CUDASolver
 					+ "\nDigest: 0x" + digestStr
 					+ "\nTarget: " + s_target);
 			}
+			device->trace.recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 0ull);
+			device->metrics.recordVerify(verifyStartTime);
 		}
 		else
 		{
+			device->trace.recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 1ull);
+			device->metrics.recordVerify(verifyStartTime);
 			onMessage(device->deviceID, "Info", "Solution verified by CPU, submitting nonce 0x" + solutionStr + "...");
-			onMessage(device->deviceID, "Debug", std::string{ "Solution details..." }
+			if (m_log.isLogged(LOG_DEBUG)) onMessage(device->deviceID, "Debug", std::string{ "Solution details..." }
 				+"\nChallenge: " + challenge
 				+ "\nAddress: " + s_address
 				+ "\nSolution: 0x" + solutionStr
 				+ "\nDigest: 0x" + digestStr
 				+ "\nTarget: " + s_target);
 			m_solutionCallback(("0x" + digestStr).c_str(), s_address.c_str(), challenge.c_str(), s_target.c_str(), ("0x" + solutionStr).c_str());
+			device->metrics.recordSolution(foundTime);
 		}
 	}
 
-	void CudaSolver::submitSolutions(std::set<uint64_t> solutions, std::string challenge, int const deviceID)
+	void CudaSolver::submitSolutions(std::set<uint64_t> solutions, std::string challenge, int const deviceID, std::chrono::steady_clock::time_point const foundTime)
 	{
 		auto& device = *std::find_if(m_devices.begin(), m_devices.end(), [&](std::unique_ptr<Device>& device) { return device->deviceID == deviceID; });
 
@@ -646,18 +741,20 @@ namespace CUDASolver
 			else
 				std::memcpy(&solution[12], &midStateSolution, UINT64_LENGTH); // keep first and last 12 bytes, fill middle 8 bytes for mid state
 
-			onSolution(solution, challenge, device);
+			onSolution(solution, challenge, device, foundTime);
 		}
 		m_isSubmitting = false;
 	}
 
 	uint64_t CudaSolver::getNextWorkPosition(std::unique_ptr<Device> &device)
 	{
-		uint64_t lastPosition;
-		incrementWorkPosition(lastPosition, device->threads());
+		auto const allocationStartTime = std::chrono::steady_clock::now();
+		uint64_t const workPosition{ m_nonceSpace.getNextPosition(device->nonceRange, device->threads()) };
 		device->hashCount += device->threads();
+		device->metrics.addPositions(device->threads());
+		device->trace.recordSpan(TRACE_WORK_ALLOCATION, allocationStartTime, workPosition);
 
-		return lastPosition;
+		return workPosition;
 	}
 
 	sponge_ut const CudaSolver::getMidState(message_ut &newMessage)
@@ -718,19 +815,19 @@ namespace CUDASolver
 			onMessage(deviceID, "Info", "Initializing device...");
 			CudaSafeCall(cudaSetDevice(deviceID));
 
-			device->h_Solutions = reinterpret_cast<uint64_t *>(malloc(MAX_SOLUTION_COUNT_DEVICE * UINT64_LENGTH));
-			device->h_SolutionCount = reinterpret_cast<uint32_t *>(malloc(UINT32_LENGTH));
-			std::memset(device->h_Solutions, 0u, MAX_SOLUTION_COUNT_DEVICE * UINT64_LENGTH);
-			std::memset(device->h_SolutionCount, 0u, UINT32_LENGTH);
-
 			CudaSafeCall(cudaDeviceReset());
 			CudaSafeCall(cudaSetDeviceFlags(cudaDeviceScheduleBlockingSync | cudaDeviceMapHost));
 
 			CudaSafeCall(cudaHostAlloc(reinterpret_cast<void **>(&device->h_SolutionCount), UINT32_LENGTH, cudaHostAllocMapped));
 			CudaSafeCall(cudaHostAlloc(reinterpret_cast<void **>(&device->h_Solutions), MAX_SOLUTION_COUNT_DEVICE * UINT64_LENGTH, cudaHostAllocMapped));
+			CudaSafeCall(cudaHostRegister(reinterpret_cast<void *>(device->h_AbortFlag), UINT32_LENGTH, cudaHostRegisterMapped)); // allocated with device, mapped per context
+			std::memset(device->h_SolutionCount, 0u, UINT32_LENGTH);
+			std::memset(device->h_Solutions, 0u, MAX_SOLUTION_COUNT_DEVICE * UINT64_LENGTH);
+			device->h_AbortFlag->store(0u);
 
 			CudaSafeCall(cudaHostGetDevicePointer(reinterpret_cast<void **>(&device->d_SolutionCount), reinterpret_cast<void *>(device->h_SolutionCount), 0));
 			CudaSafeCall(cudaHostGetDevicePointer(reinterpret_cast<void **>(&device->d_Solutions), reinterpret_cast<void *>(device->h_Solutions), 0));
+			CudaSafeCall(cudaHostGetDevicePointer(reinterpret_cast<void **>(&device->d_AbortFlag), reinterpret_cast<void *>(device->h_AbortFlag), 0));
 
 			device->initialized = true;
 
@@ -767,12 +864,28 @@ namespace CUDASolver
 		}
 	}
 
-	void CudaSolver::checkInputs(std::unique_ptr<Device>& device, char *currentChallenge)
+	void CudaSolver::applyTuning(std::unique_ptr<Device>& device)
+	{
+		float intensity{ 0.0f };
+		uint32_t blockSize{ 0u };
+		if (!device->tuningRequest.take(intensity, blockSize)) return;
+
+		if (blockSize > 0u) device->setBlockSize(blockSize);
+		if (intensity > 0.0f) // at least one block, threads fit in uint32; threads and grid follow on next launch
+			device->intensity = std::max((float)std::log2((double)device->block().x), std::min(MAX_INTENSITY, intensity));
+
+		device->launchController.setLimits(device->block().x, device->block().x, 1ull << 31); // requested intensity is its new starting point
+
+		onMessage(device->deviceID, "Info", "Retuned to intensity: " + std::to_string(device->intensity)
+			+ ", block size: " + std::to_string(device->block().x));
+	}
+
+	void CudaSolver::checkInputs(std::unique_ptr<Device>& device, std::string &currentChallenge)
 	{
 		if (device->isNewMessage || device->isNewTarget)
 		{
-			uint64_t lastPosition;
-			getWorkPosition(lastPosition);
+			auto const switchStartTime = std::chrono::steady_clock::now();
+			bool isChallengeSwitch{ false };
 
 			device->hashCount.store(0ull);
 			device->hashStartTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(500); // reduce hashrate spike on new challenge
@@ -787,17 +900,23 @@ namespace CUDASolver
 
 			if (device->isNewMessage)
 			{
+				isChallengeSwitch = (!currentChallenge.empty() && s_challenge != currentChallenge);
+
+				auto const generation = device->messageGeneration.load();
+				device->isNewMessage = false; // before push, so a message arriving meanwhile is pushed on next check
+
 				if (m_isKingMaking)
 					pushMessageKing(device);
 				else
 					pushMessage(device);
 
-				#ifdef __linux__
-				strcpy(currentChallenge, s_challenge.c_str());
-				#else
-				strcpy_s(currentChallenge, s_challenge.size() + 1, s_challenge.c_str());
-				#endif
+				if (device->messageGeneration.load() == generation) device->h_AbortFlag->store(0u); // otherwise newer message keeps it raised
+
+				currentChallenge = s_challenge;
+
+				if (isChallengeSwitch) device->metrics.recordChallengeSwitch(device->challengeTime);
 			}
+			device->trace.recordSpan(TRACE_JOB_SWITCH, switchStartTime, isChallengeSwitch ? 1ull : 0ull);
 		}
 	}
 }
\ No newline at end of file
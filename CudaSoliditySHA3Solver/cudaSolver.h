@@ -1,11 +1,13 @@
 ﻿#pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <random>
 #include <set>
 #include <thread>
+#include "logRing.h"
 #include "sha3.h"
 #include "device/device.h"
 #include "uint256/arith_uint256.h"
@@ -22,6 +24,7 @@
 
 #define MAX_SOLUTION_COUNT_DEVICE			4
 #define NONCE_POSITION						UINT256_LENGTH + ADDRESS_LENGTH + ADDRESS_LENGTH
+#define RESTART_STOP_TIMEOUT_S				10
 
 __constant__ static uint64_t const Keccak_f1600_RC[24] =
 {
@@ -39,10 +42,6 @@ namespace CUDASolver
 {
 	typedef void(*GetKingAddressCallback)(uint8_t *kingAddress);
 	typedef void(*GetSolutionTemplateCallback)(uint8_t *solutionTemplate);
-	typedef void(*GetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*ResetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*IncrementWorkPositionCallback)(uint64_t &lastWorkPosition, uint64_t incrementSize);
-	typedef void(*MessageCallback)(int deviceID, const char *type, const char *message);
 	typedef void(*SolutionCallback)(const char *digest, const char *address, const char *challenge, const char *target, const char *solution);
 
 	class CudaSolver
@@ -50,17 +49,18 @@ namespace CUDASolver
 	public:
 		GetKingAddressCallback m_getKingAddressCallback;
 		GetSolutionTemplateCallback m_getSolutionTemplateCallback;
-		GetWorkPositionCallback m_getWorkPositionCallback;
-		ResetWorkPositionCallback m_resetWorkPositionCallback;
-		IncrementWorkPositionCallback m_incrementWorkPositionCallback;
-		MessageCallback m_messageCallback;
 		SolutionCallback m_solutionCallback;
+		LogRing m_log;
+		NonceSpace m_nonceSpace;
 
 		bool isSubmitStale;
+		uint32_t targetLaunchDuration; // milliseconds of each launch, 0 for fixed intensity
 
 	private:
 		std::vector<std::unique_ptr<Device>> m_devices;
 		std::thread m_runThread;
+		std::atomic<bool> m_isStarting; // devices are being initialized by startFinding
+		std::atomic<bool> m_isStarted; // set once startFinding is done, until stopFinding
 
 		static bool m_pause;
 		static bool m_isSubmitting;
@@ -91,11 +91,8 @@ namespace CUDASolver
 
 		void setGetKingAddressCallback(GetKingAddressCallback kingAddressCallback);
 		void setGetSolutionTemplateCallback(GetSolutionTemplateCallback solutionTemplateCallback);
-		void setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback);
-		void setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback);
-		void setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback);
-		void setMessageCallback(MessageCallback messageCallback);
 		void setSolutionCallback(SolutionCallback solutionCallback);
+		void setNoncePool(nonce_pool_t *noncePool);
 
 		bool assignDevice(int const deviceID, uint32_t &pciBusID, float &intensity);
 		bool isAssigned();
@@ -109,9 +106,16 @@ namespace CUDASolver
 		void startFinding();
 		void stopFinding();
 		void pauseFinding(bool pauseFinding);
+		void setDeviceDutyCycle(int deviceID, uint32_t const dutyCycle);
+		bool setDeviceTuning(int deviceID, float const intensity, uint32_t const blockSize);
+		bool isDeviceMining(int deviceID);
+		bool isDevicePaused(int deviceID);
+		bool restartDevice(int deviceID);
 
 		uint64_t getTotalHashRate();
 		uint64_t getHashRateByDeviceID(int const deviceID);
+		void getMetricsByDeviceID(int const deviceID, uint64_t *values);
+		uint32_t getTraceEventsByDeviceID(int const deviceID, trace_event_t *events, uint32_t const maxCount);
 
 		int getDeviceSettingMaxCoreClock(int deviceID);
 		int getDeviceSettingMaxMemoryClock(int deviceID);
@@ -132,22 +136,20 @@ namespace CUDASolver
 		bool isAddressEmpty(address_t &address);
 		void getKingAddress(address_t *kingAddress);
 		void getSolutionTemplate(byte32_t *solutionTemplate);
-		void getWorkPosition(uint64_t &workPosition);
-		void resetWorkPosition(uint64_t &lastPosition);
-		void incrementWorkPosition(uint64_t &lastPosition, uint64_t increment);
 		void onMessage(int deviceID, const char *type, const char *message);
 		void onMessage(int deviceID, std::string type, std::string message);
 
-		void onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device);
+		void onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device, std::chrono::steady_clock::time_point const foundTime);
 
 		void findSolution(int const deviceID);
 		void findSolutionKing(int const deviceID);
-		void checkInputs(std::unique_ptr<Device> &device, char *currentChallenge);
+		void checkInputs(std::unique_ptr<Device> &device, std::string &currentChallenge);
+		void applyTuning(std::unique_ptr<Device> &device);
 		void pushTarget(std::unique_ptr<Device> &device);
 		void pushTargetKing(std::unique_ptr<Device> &device);
 		void pushMessage(std::unique_ptr<Device> &device);
 		void pushMessageKing(std::unique_ptr<Device> &device);
-		void submitSolutions(std::set<uint64_t> solutions, std::string challenge, int const deviceID);
+		void submitSolutions(std::set<uint64_t> solutions, std::string challenge, int const deviceID, std::chrono::steady_clock::time_point const foundTime);
 
 		uint64_t getNextWorkPosition(std::unique_ptr<Device> &device);
 		sponge_ut const getMidState(message_ut &newMessage);
@@ -1,4 +1,5 @@
 #include "device.h"
+#include <algorithm>
 #include <string>
 
 namespace CUDASolver
@@ -16,6 +17,10 @@ namespace CUDASolver
 		mining{ false },
 		hashCount{ 0ull },
 		hashStartTime{ std::chrono::steady_clock::now() },
+		nonceRange{ 0ull, 0ull, 0ull },
+		d_AbortFlag{ nullptr },
+		h_AbortFlag{ new std::atomic<uint32_t>{ 0u } },
+		messageGeneration{ 0ull },
 		m_block{ 1u },
 		m_lastCompute{ 0u },
 		m_grid{ 1u },
@@ -30,6 +35,12 @@ namespace CUDASolver
 			m_api.assignPciBusID(pciBusID);
 		}
 	}
+
+	Device::~Device()
+	{
+		static_assert(sizeof(std::atomic<uint32_t>) == UINT32_LENGTH, "Abort flag is shared with device as uint32");
+		delete h_AbortFlag;
+	}
 	
 	uint32_t Device::getPciBusID()
 	{
@@ -162,13 +173,21 @@ namespace CUDASolver
 
 		if (intensity != m_lastIntensity)
 		{
-			m_lastThreads = (uint32_t)std::pow(2, intensity);
+			m_lastThreads = (uint32_t)std::min(std::pow(2.0, (double)intensity), (double)UINT32_MAX);
 			m_lastIntensity = intensity;
 			m_lastBlockX = 0u;
 		}
 		return m_lastThreads;
 	}
 
+	// Sets thread count exactly (e.g. in multiples of block size), intensity follows for reporting only
+	void Device::setThreads(uint32_t const threadCount)
+	{
+		m_lastThreads = threadCount;
+		m_lastIntensity = intensity = (float)std::log2((double)threadCount);
+		m_lastBlockX = 0u;
+	}
+
 	dim3 Device::block()
 	{
 		if (m_lastCompute != computeVersion)
@@ -203,12 +222,18 @@ namespace CUDASolver
 	{
 		if (m_lastBlockX != block().x)
 		{
-			m_grid.x = uint32_t((threads() + block().x - 1) / block().x);
+			m_grid.x = uint32_t(((uint64_t)threads() + block().x - 1) / block().x);
 			m_lastBlockX = block().x;
 		}
 		return m_grid;
 	}
 
+	void Device::setBlockSize(uint32_t const blockSize)
+	{
+		block(); // default of compute version is set on first call, after which it is kept
+		m_block.x = std::max(32u, std::min(1024u, blockSize / 32u * 32u)); // in multiples of warp size
+	}
+
 	uint64_t Device::hashRate()
 	{
 		using namespace std::chrono;
@@ -6,11 +6,18 @@
 #include <cuda_runtime.h>
 #include <thread>
 #include "nv_api.h"
+#include "../dutyCycle.h"
+#include "../launchController.h"
+#include "../nonceSpace.h"
+#include "../solverMetrics.h"
+#include "../traceBuffer.h"
+#include "../tuningRequest.h"
 #include "../types.h"
 
 namespace CUDASolver
 {
 	constexpr float DEFALUT_INTENSITY{ 24.0f };
+	constexpr float MAX_INTENSITY{ 32.0f }; // threads are counted in uint32
 
 	class Device
 	{
@@ -26,15 +33,26 @@ namespace CUDASolver
 		std::thread miningThread;
 		std::atomic<uint64_t> hashCount;
 		std::chrono::steady_clock::time_point hashStartTime;
+		nonce_range_t nonceRange;
+
+		SolverMetrics metrics;
+		LaunchController launchController;
+		DutyCycle dutyCycle;
+		TuningRequest tuningRequest;
+		TraceBuffer trace;
+		std::chrono::steady_clock::time_point challengeTime;
 
 		uint64_t* d_Solutions;
 		uint64_t* h_Solutions;
 		uint32_t* d_SolutionCount;
 		uint32_t* h_SolutionCount;
+		uint32_t* d_AbortFlag; // mapped host memory, raised on new challenge so in-flight blocks exit early
+		std::atomic<uint32_t>* h_AbortFlag; // allocated for lifetime of device, host thread may raise it while device restarts
 
 		bool checkChanges;
 		bool isNewTarget;
-		bool isNewMessage;
+		std::atomic<bool> isNewMessage;
+		std::atomic<uint64_t> messageGeneration; // bumped per new message, abort flag is cleared only if unchanged after push
 
 		message_ut currentMessage;
 		sponge_ut currentMidstate;
@@ -55,6 +73,7 @@ namespace CUDASolver
 
 	public:
 		Device(int deviceID);
+		~Device();
 		uint32_t getPciBusID();
 
 		bool getSettingMaxCoreClock(int *maxCoreClock, std::string *errorMessage);
@@ -72,8 +91,10 @@ namespace CUDASolver
 		bool getCurrentThrottleReasons(std::string *reasons, std::string *errorMessage);
 
 		uint32_t threads();
+		void setThreads(uint32_t const threadCount);
 		dim3 block();
 		dim3 grid();
+		void setBlockSize(uint32_t const blockSize);
 
 		uint64_t hashRate();
 	};
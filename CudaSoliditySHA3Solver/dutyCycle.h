@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifndef __DUTY_CYCLE__
+#define __DUTY_CYCLE__
+
+namespace CUDASolver
+{
+	// Share of time one device mines, set by host to hold the device within a temperature or power envelope.
+	// Idle time is inserted after each launch in proportion to its duration, so the device cools without a change of intensity.
+	class DutyCycle
+	{
+	public:
+		static uint32_t const FULL{ 100u }; // percent, no idle time
+		static uint32_t const IDLE_CHECK_INTERVAL{ 100u }; // milliseconds between checks of a changed duty cycle while idle
+
+	private:
+		std::atomic<uint32_t> m_percent; // 0 pauses device
+
+	public:
+		DutyCycle() noexcept;
+
+		void setPercent(uint32_t const percent);
+		uint32_t getPercent();
+		bool isPaused();
+
+		// To be called by device loop after each launch
+		void idle(std::chrono::steady_clock::time_point const launchStartTime);
+	};
+}
+
+#endif // !__DUTY_CYCLE__
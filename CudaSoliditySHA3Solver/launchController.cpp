@@ -0,0 +1,60 @@
+#include "launchController.h"
+
+namespace CUDASolver
+{
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	LaunchController::LaunchController() noexcept :
+		m_targetDuration{ 0u },
+		m_isResetRequested{ false },
+		m_granularity{ 1ull },
+		m_minWorkSize{ 1ull },
+		m_maxWorkSize{ UINT64_MAX },
+		m_noncesPerMicrosecond{ 0.0 }
+	{
+	}
+
+	void LaunchController::setTarget(uint32_t const targetDuration)
+	{
+		m_targetDuration.store(targetDuration);
+		m_isResetRequested.store(true);
+	}
+
+	void LaunchController::setLimits(uint64_t const granularity, uint64_t const minWorkSize, uint64_t const maxWorkSize)
+	{
+		m_granularity = (granularity > 0ull) ? granularity : 1ull;
+		m_minWorkSize = (minWorkSize > m_granularity) ? minWorkSize : m_granularity;
+		m_maxWorkSize = (maxWorkSize > m_minWorkSize) ? maxWorkSize : m_minWorkSize;
+	}
+
+	bool LaunchController::isEnabled()
+	{
+		return m_targetDuration.load(std::memory_order_relaxed) > 0u;
+	}
+
+	uint64_t LaunchController::update(uint64_t const workSize, std::chrono::steady_clock::time_point const launchStartTime, uint32_t const launchCount)
+	{
+		using namespace std::chrono;
+		uint32_t const targetDuration{ m_targetDuration.load(std::memory_order_relaxed) };
+		if (targetDuration == 0u) return workSize;
+
+		if (m_isResetRequested.exchange(false)) m_noncesPerMicrosecond = 0.0;
+
+		auto const elapsed = duration_cast<microseconds>(steady_clock::now() - launchStartTime).count();
+		double const noncesPerMicrosecond{ (double)workSize * ((launchCount > 0u) ? launchCount : 1u) / ((elapsed > 0) ? elapsed : 1) };
+
+		m_noncesPerMicrosecond = (m_noncesPerMicrosecond > 0.0)
+			? m_noncesPerMicrosecond * (1.0 - AVERAGE_WEIGHT) + noncesPerMicrosecond * AVERAGE_WEIGHT
+			: noncesPerMicrosecond;
+
+		double nextWorkSize{ m_noncesPerMicrosecond * targetDuration * 1000.0 };
+
+		if (nextWorkSize > (double)workSize * MAX_GROWTH_FACTOR) nextWorkSize = (double)workSize * MAX_GROWTH_FACTOR;
+		if (nextWorkSize > (double)m_maxWorkSize) nextWorkSize = (double)m_maxWorkSize;
+		if (nextWorkSize < (double)m_minWorkSize) nextWorkSize = (double)m_minWorkSize;
+
+		return ((uint64_t)nextWorkSize / m_granularity) * m_granularity;
+	}
+}
@@ -45,39 +45,25 @@ namespace CUDASolver
 		return getSolutionTemplateCallback;
 	}
 
-	GetWorkPositionCallback SetOnGetWorkPositionHandler(CudaSolver *instance, GetWorkPositionCallback getWorkPositionCallback)
-	{
-		instance->m_getWorkPositionCallback = getWorkPositionCallback;
-		return getWorkPositionCallback;
-	}
-
-	ResetWorkPositionCallback SetOnResetWorkPositionHandler(CudaSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback)
-	{
-		instance->m_resetWorkPositionCallback = resetWorkPositionCallback;
-		return resetWorkPositionCallback;
-	}
-
-	IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(CudaSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback)
+	SolutionCallback SetOnSolutionHandler(CudaSolver *instance, SolutionCallback solutionCallback)
 	{
-		instance->m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-		return incrementWorkPositionCallback;
+		instance->m_solutionCallback = solutionCallback;
+		return solutionCallback;
 	}
 
-	MessageCallback SetOnMessageHandler(CudaSolver *instance, MessageCallback messageCallback)
+	void SetNoncePool(CudaSolver *instance, nonce_pool_t *noncePool)
 	{
-		instance->m_messageCallback = messageCallback;
-		return messageCallback;
+		instance->setNoncePool(noncePool);
 	}
 
-	SolutionCallback SetOnSolutionHandler(CudaSolver *instance, SolutionCallback solutionCallback)
+	void SetSubmitStale(CudaSolver *instance, const bool submitStale)
 	{
-		instance->m_solutionCallback = solutionCallback;
-		return solutionCallback;
+		instance->isSubmitStale = submitStale;
 	}
 
-	void SetSubmitStale(CudaSolver *instance, const bool submitStale)
+	void SetTargetLaunchDuration(CudaSolver *instance, const uint32_t targetLaunchDuration)
 	{
-		instance->isSubmitStale = submitStale;
+		instance->targetLaunchDuration = targetLaunchDuration;
 	}
 
 	void AssignDevice(CudaSolver *instance, const int deviceID, unsigned int *pciBusID, float *intensity)
@@ -110,6 +96,32 @@ namespace CUDASolver
 		*hashRate = instance->getHashRateByDeviceID(deviceID);
 	}
 
+	void GetMetricsByDeviceID(CudaSolver *instance, const uint32_t deviceID, uint64_t *metrics)
+	{
+		instance->getMetricsByDeviceID(deviceID, metrics);
+	}
+
+	void SetTraceEnabled(CudaSolver *, const bool isEnabled) // tracing is process-wide
+	{
+		TraceBuffer::setEnabled(isEnabled);
+	}
+
+	void GetTraceEventsByDeviceID(CudaSolver *instance, const uint32_t deviceID, trace_event_t *events, const uint32_t maxCount, uint32_t *count)
+	{
+		*count = instance->getTraceEventsByDeviceID(deviceID, events, maxCount);
+	}
+
+	void SetLogLevel(CudaSolver *instance, const uint32_t level)
+	{
+		instance->m_log.setLevel((log_level_t)level);
+	}
+
+	void GetLogEntries(CudaSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount)
+	{
+		*count = instance->m_log.drain(entries, maxCount);
+		*droppedCount = instance->m_log.getDroppedCount();
+	}
+
 	void GetTotalHashRate(CudaSolver *instance, uint64_t *totalHashRate)
 	{
 		*totalHashRate = instance->getTotalHashRate();
@@ -130,6 +142,31 @@ namespace CUDASolver
 		instance->pauseFinding(pause);
 	}
 
+	void SetDeviceDutyCycle(CudaSolver *instance, const int deviceID, const uint32_t dutyCycle)
+	{
+		instance->setDeviceDutyCycle(deviceID, dutyCycle);
+	}
+
+	void SetDeviceTuning(CudaSolver *instance, const int deviceID, const float intensity, const uint32_t blockSize, bool *isFound)
+	{
+		*isFound = instance->setDeviceTuning(deviceID, intensity, blockSize);
+	}
+
+	void IsDeviceMining(CudaSolver *instance, const int deviceID, bool *isMining)
+	{
+		*isMining = instance->isDeviceMining(deviceID);
+	}
+
+	void IsDevicePaused(CudaSolver *instance, const int deviceID, bool *isPaused)
+	{
+		*isPaused = instance->isDevicePaused(deviceID);
+	}
+
+	void RestartDevice(CudaSolver *instance, const int deviceID, bool *isRestarted)
+	{
+		*isRestarted = instance->restartDevice(deviceID);
+	}
+
 	void StartFinding(CudaSolver *instance)
 	{
 		instance->startFinding();
@@ -31,18 +31,14 @@ namespace CUDASolver
 
 		EXPORT GetSolutionTemplateCallback __CDECL__ SetOnGetSolutionTemplateHandler(CudaSolver *instance, GetSolutionTemplateCallback getSolutionTemplateCallback);
 
-		EXPORT GetWorkPositionCallback __CDECL__ SetOnGetWorkPositionHandler(CudaSolver *instance, GetWorkPositionCallback getWorkPositionCallback);
-
-		EXPORT ResetWorkPositionCallback __CDECL__ SetOnResetWorkPositionHandler(CudaSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback);
-
-		EXPORT IncrementWorkPositionCallback __CDECL__ SetOnIncrementWorkPositionHandler(CudaSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
-
-		EXPORT MessageCallback __CDECL__ SetOnMessageHandler(CudaSolver *instance, MessageCallback messageCallback);
-
 		EXPORT SolutionCallback __CDECL__ SetOnSolutionHandler(CudaSolver *instance, SolutionCallback solutionCallback);
 
+		EXPORT void __CDECL__ SetNoncePool(CudaSolver *instance, nonce_pool_t *noncePool);
+
 		EXPORT void __CDECL__ SetSubmitStale(CudaSolver *instance, const bool submitStale);
 
+		EXPORT void __CDECL__ SetTargetLaunchDuration(CudaSolver *instance, const uint32_t targetLaunchDuration);
+
 		EXPORT void __CDECL__ AssignDevice(CudaSolver *instance, const int deviceID, unsigned int *pciBusID, float *intensity);
 
 		EXPORT void __CDECL__ IsAssigned(CudaSolver *instance, bool *isAssigned);
@@ -55,6 +51,16 @@ namespace CUDASolver
 
 		EXPORT void __CDECL__ GetHashRateByDeviceID(CudaSolver *instance, const uint32_t deviceID, uint64_t *hashRate);
 
+		EXPORT void __CDECL__ GetMetricsByDeviceID(CudaSolver *instance, const uint32_t deviceID, uint64_t *metrics);
+
+		EXPORT void __CDECL__ SetTraceEnabled(CudaSolver *instance, const bool isEnabled);
+
+		EXPORT void __CDECL__ GetTraceEventsByDeviceID(CudaSolver *instance, const uint32_t deviceID, trace_event_t *events, const uint32_t maxCount, uint32_t *count);
+
+		EXPORT void __CDECL__ SetLogLevel(CudaSolver *instance, const uint32_t level);
+
+		EXPORT void __CDECL__ GetLogEntries(CudaSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount);
+
 		EXPORT void __CDECL__ GetTotalHashRate(CudaSolver *instance, uint64_t *totalHashRate);
 
 		EXPORT void __CDECL__ UpdatePrefix(CudaSolver *instance, const char *prefix);
@@ -63,6 +69,16 @@ namespace CUDASolver
 
 		EXPORT void __CDECL__ PauseFinding(CudaSolver *instance, const bool pause);
 
+		EXPORT void __CDECL__ SetDeviceDutyCycle(CudaSolver *instance, const int deviceID, const uint32_t dutyCycle);
+
+		EXPORT void __CDECL__ SetDeviceTuning(CudaSolver *instance, const int deviceID, const float intensity, const uint32_t blockSize, bool *isFound);
+
+		EXPORT void __CDECL__ IsDeviceMining(CudaSolver *instance, const int deviceID, bool *isMining);
+
+		EXPORT void __CDECL__ IsDevicePaused(CudaSolver *instance, const int deviceID, bool *isPaused);
+
+		EXPORT void __CDECL__ RestartDevice(CudaSolver *instance, const int deviceID, bool *isRestarted);
+
 		EXPORT void __CDECL__ StartFinding(CudaSolver *instance);
 
 		EXPORT void __CDECL__ StopFinding(CudaSolver *instance);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __SOLVER_METRICS__
+#define __SOLVER_METRICS__
+
+namespace CUDASolver
+{
+	// Histogram of durations in microseconds, bucket i counts samples up to 2^i us (last bucket counts the rest)
+	struct duration_histogram_t
+	{
+		static uint32_t const BUCKET_COUNT{ 24u }; // 2^23 us ~ 8.4 seconds
+		static uint32_t const VALUE_COUNT{ BUCKET_COUNT + 2u }; // buckets, count, sum
+
+		std::atomic<uint64_t> buckets[BUCKET_COUNT];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+	};
+
+	// Counters of one device (or CPU thread), recorded with relaxed atomics only so the mining loop never takes a lock.
+	// Values are read by the host as a flat array, layout must match Miner.SolverMetrics.
+	class SolverMetrics
+	{
+	public:
+		static uint32_t const VALUE_COUNT{ duration_histogram_t::VALUE_COUNT * 4u + 4u };
+
+	private:
+		duration_histogram_t m_launchDuration; // per kernel launch (work chunk on CPU)
+		duration_histogram_t m_challengeSwitch; // from host updating the challenge to device mining on it
+		duration_histogram_t m_solutionLatency; // from solution found to handed to host
+		duration_histogram_t m_solutionVerify; // digest check of each candidate by host, valid or not
+		std::atomic<uint64_t> m_positionsAllocated; // nonces reserved from the nonce space
+		std::atomic<uint64_t> m_launchesAborted; // launches cut short by a new challenge
+		std::atomic<uint64_t> m_restarts; // device torn down and re-initialized while mining
+		std::atomic<uint64_t> m_hashesCompleted; // nonces hashed by completed (not aborted) launches
+
+	public:
+		SolverMetrics() noexcept;
+
+		void recordLaunch(std::chrono::steady_clock::time_point const startTime, uint64_t const hashCount);
+		void recordChallengeSwitch(std::chrono::steady_clock::time_point const challengeTime);
+		void recordSolution(std::chrono::steady_clock::time_point const foundTime);
+		void recordVerify(std::chrono::steady_clock::time_point const verifyStartTime);
+		void addPositions(uint64_t const count);
+		void addAbortedLaunch();
+		void addRestart();
+
+		void getValues(uint64_t *values);
+
+	private:
+		static void reset(duration_histogram_t &histogram);
+		static void record(duration_histogram_t &histogram, std::chrono::steady_clock::time_point const startTime);
+		static uint64_t *copy(duration_histogram_t &histogram, uint64_t *values);
+	};
+}
+
+#endif // !__SOLVER_METRICS__
@@ -0,0 +1,29 @@
+#include "tuningRequest.h"
+
+namespace CUDASolver
+{
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	TuningRequest::TuningRequest() noexcept :
+		m_intensity{ 0.0f },
+		m_blockSize{ 0u }
+	{
+	}
+
+	void TuningRequest::request(float const intensity, uint32_t const blockSize)
+	{
+		if (blockSize > 0u) m_blockSize.store(blockSize);
+		if (intensity > 0.0f) m_intensity.store(intensity);
+	}
+
+	bool TuningRequest::take(float &intensity, uint32_t &blockSize)
+	{
+		if (m_intensity.load(std::memory_order_relaxed) == 0.0f && m_blockSize.load(std::memory_order_relaxed) == 0u) return false;
+
+		intensity = m_intensity.exchange(0.0f);
+		blockSize = m_blockSize.exchange(0u);
+		return intensity > 0.0f || blockSize > 0u;
+	}
+}
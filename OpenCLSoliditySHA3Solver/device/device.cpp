@@ -163,12 +163,18 @@ namespace OpenCLSolver
 		deviceType{ devType },
 		hashCount{ 0ull },
 		hashStartTime{ std::chrono::steady_clock::now() },
+		nonceRange{ 0ull, 0ull, 0ull },
 		initialized{ false },
 		kernelWaitSleepDuration{ 1000u },
 		mining{ false },
 		platformID{ devPlatformID },
 		userDefinedIntensity{ userDefIntensity },
-		pciBusID{ 0 }
+		pciBusID{ 0 },
+		messageGeneration{ 0ull },
+		h_solutionCount{ nullptr },
+		h_solutions{ nullptr },
+		h_abortFlag{ nullptr },
+		m_mappedAbortFlag{ nullptr }
 	{
 		char charBuffer[1024];
 		size_t sizeBuffer[3];
@@ -241,11 +247,8 @@ namespace OpenCLSolver
 				}
 		}
 
-		if (userLocalWorkSize > 0)
-		{
-			localWorkSize = (userLocalWorkSize > maxWorkGroupSize) ? maxWorkGroupSize : userLocalWorkSize;
-			localWorkSize = (uint32_t)(localWorkSize / 64) * 64; // in multiples of 64
-		}
+		if (userLocalWorkSize > 0) setLocalWorkSize(userLocalWorkSize);
+
 		else if (isINTEL()) localWorkSize = 64; // iGPU
 
 		else localWorkSize = DEFAULT_LOCAL_WORK_SIZE;
@@ -253,6 +256,47 @@ namespace OpenCLSolver
 		setIntensity(userDefinedIntensity, isKingMaking);
 	}
 
+	Device::Device(int devEnum, simulation_settings_t const settings, bool isKingMaking, float const userDefIntensity) :
+		status{ CL_SUCCESS },
+		computeCapability{ 0 },
+		deviceEnum{ devEnum },
+		deviceID{ NULL },
+		deviceType{ CL_DEVICE_TYPE_CPU },
+		hashCount{ 0ull },
+		hashStartTime{ std::chrono::steady_clock::now() },
+		nonceRange{ 0ull, 0ull, 0ull },
+		initialized{ false },
+		kernelWaitSleepDuration{ 1000u },
+		mining{ false },
+		platformID{ NULL },
+		userDefinedIntensity{ userDefIntensity },
+		pciBusID{ 0 },
+		platformName{ SIMULATED_PLATFORM },
+		openCLVersion{ "None" },
+		vendor{ "None" },
+		name{ "Simulated device" },
+		messageGeneration{ 0ull },
+		maxWorkGroupSize{ DEFAULT_LOCAL_WORK_SIZE },
+		maxComputeUnits{ 1u },
+		maxMemAllocSize{ 0ull },
+		globalMemSize{ 0ull },
+		localWorkSize{ DEFAULT_LOCAL_WORK_SIZE },
+		h_solutionCount{ nullptr },
+		h_solutions{ nullptr },
+		h_abortFlag{ nullptr },
+		simulator{ new SimulatedDevice(settings, isKingMaking, (uint32_t)devEnum) },
+		m_mappedAbortFlag{ nullptr }
+	{
+		setIntensity(userDefinedIntensity, isKingMaking);
+	}
+
+	Device::~Device()
+	{
+		if (h_solutions != nullptr) free(h_solutions);
+		if (h_solutionCount != nullptr) free(h_solutionCount);
+		delete h_abortFlag;
+	}
+
 	bool Device::isAPP()
 	{
 		std::string tempPlatform{ platformName };
@@ -274,6 +318,11 @@ namespace OpenCLSolver
 		return tempPlatform.find("INTEL") != std::string::npos;
 	}
 
+	bool Device::isSimulated()
+	{
+		return simulator != nullptr;
+	}
+
 	std::string Device::getName()
 	{
 		return name;
@@ -379,12 +428,41 @@ namespace OpenCLSolver
 			return false;
 		}
 
+		status = clSetKernelArg(kernel, 5u, sizeof(cl_mem), &abortFlagBuffer);
+		if (status != CL_SUCCESS)
+		{
+			errorMessage = std::string{ "Error setting abort flag buffer to kernel (" } +Device::getOpenCLErrorCodeStr(status) + ")...";
+			return false;
+		}
+
 		return true;
 	}
 
 	void Device::initialize(std::string& errorMessage, bool const isKingMaking)
 	{
 		errorMessage = "";
+
+		// Host buffers are kept across restarts and freed with device, mapping a CL_MEM_USE_HOST_PTR buffer returns the same pointer
+		if (h_solutions == nullptr)
+			h_solutions = reinterpret_cast<uint64_t *>(malloc(UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE));
+		std::memset(h_solutions, 0u, UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE);
+
+		if (h_solutionCount == nullptr)
+			h_solutionCount = reinterpret_cast<uint32_t *>(malloc(UINT32_LENGTH));
+		std::memset(h_solutionCount, 0u, UINT32_LENGTH);
+
+		static_assert(sizeof(std::atomic<uint32_t>) == UINT32_LENGTH, "Abort flag is shared with device as uint32");
+		if (h_abortFlag == nullptr) // host thread may still raise it while device is stopping
+			h_abortFlag = new std::atomic<uint32_t>{ 0u };
+		h_abortFlag->store(0u);
+
+		if (isSimulated())
+		{
+			simulator->start(h_solutionCount, h_solutions, h_abortFlag);
+			initialized = true;
+			return;
+		}
+
 		cl_context_properties contextProp[] = { CL_CONTEXT_PLATFORM, (cl_context_properties)platformID, 0 };
 
 		context = clCreateContext(contextProp, 1u, &deviceID, NULL, NULL, &status);
@@ -394,16 +472,13 @@ namespace OpenCLSolver
 			return;
 		}
 
-		queue = clCreateCommandQueue(context, deviceID, 0, &status);
+		queue = clCreateCommandQueue(context, deviceID, TraceBuffer::isEnabled() ? CL_QUEUE_PROFILING_ENABLE : 0, &status);
 		if (status != CL_SUCCESS)
 		{
 			errorMessage = std::string{ "Failed to create command queue (" } +getOpenCLErrorCodeStr(status) + ')';
 			return;
 		}
 
-		h_solutions = reinterpret_cast<uint64_t *>(malloc(UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE));
-		std::memset(h_solutions, 0u, UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE);
-
 		solutionsBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE, h_solutions, &status);
 		if (status != CL_SUCCESS)
 		{
@@ -411,9 +486,6 @@ namespace OpenCLSolver
 			return;
 		}
 
-		h_solutionCount = reinterpret_cast<uint32_t *>(malloc(UINT32_LENGTH));
-		std::memset(h_solutionCount, 0u, UINT32_LENGTH);
-
 		solutionCountBuffer = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, UINT32_LENGTH, h_solutionCount, &status);
 		if (status != CL_SUCCESS)
 		{
@@ -421,6 +493,14 @@ namespace OpenCLSolver
 			return;
 		}
 
+		// Pinned host memory, read in place by devices that access it over the bus (discrete GPUs included) once mapped
+		abortFlagBuffer = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, UINT32_LENGTH, NULL, &status);
+		if (status != CL_SUCCESS)
+		{
+			errorMessage = std::string{ "Failed to allocate abort flag buffer (" } +Device::getOpenCLErrorCodeStr(status) + ')';
+			return;
+		}
+
 		std::string newSource;
 		std::string kernelEntryName;
 
@@ -505,15 +585,56 @@ namespace OpenCLSolver
 
 		if (!setKernelArgs(errorMessage, isKingMaking)) return;;
 
+		auto const mappedAbortFlag = clEnqueueMapBuffer(queue, abortFlagBuffer, CL_TRUE, CL_MAP_WRITE, 0u, UINT32_LENGTH, 0, NULL, NULL, &status);
+		if (status != CL_SUCCESS)
+		{
+			errorMessage = std::string{ "Failed to map abort flag buffer (" } +getOpenCLErrorCodeStr(status) + ')';
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_abortFlagMutex);
+			m_mappedAbortFlag = reinterpret_cast<uint32_t volatile *>(mappedAbortFlag); // kept mapped until device stops
+			*m_mappedAbortFlag = 0u;
+		}
+
 		initialized = true;
 	}
 
 	void Device::setIntensity(float const intensity, bool isKingMaking)
 	{
 		if (isINTEL()) userDefinedIntensity = (intensity > 1.0f) ? intensity : 17.0f; // iGPU
+		else if (isSimulated()) userDefinedIntensity = (intensity > 1.0f) ? intensity : DEFAULT_INTENSITY_SIMULATED; // hashed on host
 		else userDefinedIntensity = (intensity > 1.0f) ? intensity : (isKingMaking ? DEFAULT_INTENSITY_KING : DEFAULT_INTENSITY);
 
-		auto userTotalWorkSize = (uint32_t)std::pow(2, userDefinedIntensity);
-		globalWorkSize = (uint32_t)(userTotalWorkSize / localWorkSize) * localWorkSize; // in multiples of localWorkSize
+		auto userTotalWorkSize = (uint32_t)std::min(std::pow(2.0, (double)userDefinedIntensity), (double)UINT32_MAX);
+		globalWorkSize = std::max<size_t>(1u, userTotalWorkSize / localWorkSize) * localWorkSize; // in multiples of localWorkSize, at least one work group
+	}
+
+	// Host flag is read by mining thread (and simulator), mapped flag by kernel
+	void Device::setAbortFlag(uint32_t const value)
+	{
+		h_abortFlag->store(value);
+
+		std::lock_guard<std::mutex> lock(m_abortFlagMutex);
+		if (m_mappedAbortFlag != nullptr) *m_mappedAbortFlag = value;
+	}
+
+	void Device::unmapAbortFlag()
+	{
+		std::lock_guard<std::mutex> lock(m_abortFlagMutex);
+		if (m_mappedAbortFlag == nullptr) return;
+
+		clEnqueueUnmapMemObject(queue, abortFlagBuffer, const_cast<uint32_t *>(m_mappedAbortFlag), 0, NULL, NULL);
+		clFinish(queue);
+		m_mappedAbortFlag = nullptr;
+	}
+
+	void Device::setLocalWorkSize(uint32_t const userLocalWorkSize)
+	{
+		if (isSimulated()) return; // hashed on host, no work group
+
+		localWorkSize = (userLocalWorkSize > maxWorkGroupSize) ? maxWorkGroupSize : userLocalWorkSize;
+		localWorkSize = (uint32_t)(localWorkSize / 64) * 64; // in multiples of 64
+		if (localWorkSize == 0) localWorkSize = 64;
 	}
 }
\ No newline at end of file
@@ -4,9 +4,17 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <mutex>
 #include <thread>
 #include <string.h>
 #include "adl_api.h"
+#include "simulatedDevice.h"
+#include "../dutyCycle.h"
+#include "../launchController.h"
+#include "../nonceSpace.h"
+#include "../solverMetrics.h"
+#include "../traceBuffer.h"
+#include "../tuningRequest.h"
 #include "../types.h"
 
 #if defined(__APPLE__) || defined(__MACOSX)
@@ -19,6 +27,7 @@ namespace OpenCLSolver
 {
 	#define DEFAULT_INTENSITY 24.056f
 	#define DEFAULT_INTENSITY_KING 24.12f
+	#define MAX_INTENSITY 32.0f // global work size is counted in uint32
 	#define DEFAULT_LOCAL_WORK_SIZE 128u
 	#define MAX_SOLUTION_COUNT_DEVICE 4u
 
@@ -56,6 +65,14 @@ namespace OpenCLSolver
 		std::thread miningThread;
 		std::atomic<uint64_t> hashCount;
 		std::chrono::steady_clock::time_point hashStartTime;
+		nonce_range_t nonceRange;
+
+		SolverMetrics metrics;
+		LaunchController launchController;
+		DutyCycle dutyCycle;
+		TuningRequest tuningRequest;
+		TraceBuffer trace;
+		std::chrono::steady_clock::time_point challengeTime;
 
 		std::string platformName;
 		std::string openCLVersion;
@@ -65,7 +82,8 @@ namespace OpenCLSolver
 
 		bool checkChanges;
 		bool isNewTarget;
-		bool isNewMessage;
+		std::atomic<bool> isNewMessage;
+		std::atomic<uint64_t> messageGeneration; // bumped per new message, abort flag is cleared only if unchanged after push
 
 		message_ut currentMessage;
 		sponge_ut currentMidstate;
@@ -83,10 +101,12 @@ namespace OpenCLSolver
 
 		uint32_t *h_solutionCount;
 		uint64_t *h_solutions;
+		std::atomic<uint32_t> *h_abortFlag; // raised on new challenge so queued launches exit early, kept for lifetime of device
 
 		cl_mem messageBuffer;
 		cl_mem solutionCountBuffer;
 		cl_mem solutionsBuffer;
+		cl_mem abortFlagBuffer;
 		cl_mem midstateBuffer;
 		cl_mem targetBuffer;
 
@@ -98,17 +118,25 @@ namespace OpenCLSolver
 		cl_event kernelWaitEvent;
 		uint32_t kernelWaitSleepDuration;
 
+		std::unique_ptr<SimulatedDevice> simulator; // set on SIMULATED_PLATFORM only, replaces OpenCL context and queue
+
 	private:
 		ADL_API m_api;
 		uint32_t computeCapability;
 
+		std::mutex m_abortFlagMutex; // host thread raises flag while device may be unmapping it
+		uint32_t volatile *m_mappedAbortFlag; // pinned host memory of abortFlagBuffer, mapped while initialized
+
 	public:
 		Device(int devEnum, cl_device_id devID, cl_device_type devType, cl_platform_id devPlatformID, bool isKingMaking,
 			float const userDefIntensity = 0, uint32_t userLocalWorkSize = 0);
+		Device(int devEnum, simulation_settings_t const settings, bool isKingMaking, float const userDefIntensity = 0);
+		~Device();
 
 		bool isAPP();
 		bool isCUDA();
 		bool isINTEL();
+		bool isSimulated();
 
 		std::string getName();
 
@@ -128,6 +156,9 @@ namespace OpenCLSolver
 
 		void initialize(std::string& errorMessage, bool const isKingMaking);
 		void setIntensity(float const intensity, bool isKingMaking);
+		void setLocalWorkSize(uint32_t const userLocalWorkSize);
+		void setAbortFlag(uint32_t const value);
+		void unmapAbortFlag();
 
 	private:
 		bool setKernelArgs(std::string& errorMessage, bool const isKingMaking);
@@ -0,0 +1,174 @@
+#include "device.h"
+
+namespace OpenCLSolver
+{
+	static uint64_t const ABORT_CHECK_INTERVAL{ 4096ull }; // nonces hashed between checks of abort flag
+
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	SimulatedDevice::SimulatedDevice(simulation_settings_t const settings, bool const isKingMaking, uint32_t const seed) noexcept :
+		m_settings{ settings },
+		m_isKingMaking{ isKingMaking },
+		m_random{ seed },
+		m_solutionCount{ nullptr },
+		m_solutions{ nullptr },
+		m_abortFlag{ nullptr },
+		m_message{ 0 },
+		m_target{ 0 },
+		m_high64Target{ 0ull },
+		m_isRunning{ false }
+	{
+	}
+
+	SimulatedDevice::~SimulatedDevice() noexcept
+	{
+		stop();
+	}
+
+	void SimulatedDevice::start(uint32_t *solutionCount, uint64_t *solutions, std::atomic<uint32_t> const *abortFlag)
+	{
+		m_solutionCount = solutionCount;
+		m_solutions = solutions;
+		m_abortFlag = abortFlag;
+
+		m_isRunning = true;
+		m_nextCandidateTime = std::chrono::steady_clock::now();
+		m_thread = std::thread(&SimulatedDevice::run, this);
+	}
+
+	void SimulatedDevice::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_isRunning = false;
+		}
+		m_condition.notify_all();
+
+		if (m_thread.joinable()) m_thread.join();
+	}
+
+	void SimulatedDevice::writeMessage(message_ut const &message)
+	{
+		finish(); // blocking write, as to an in-order queue
+		m_message = message;
+	}
+
+	void SimulatedDevice::writeTarget(byte32_t const &target, uint64_t const high64Target)
+	{
+		finish();
+		m_target = target;
+		m_high64Target = high64Target;
+	}
+
+	void SimulatedDevice::enqueue(uint64_t const startPosition, uint64_t const workSize)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_launches.push_back(launch_t{ startPosition, workSize });
+		}
+		m_condition.notify_all();
+	}
+
+	void SimulatedDevice::finish()
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_condition.wait(lock, [&]() { return m_launches.empty(); });
+	}
+
+	// --------------------------------------------------------------------
+	// Private
+	// --------------------------------------------------------------------
+
+	void SimulatedDevice::run()
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		while (true)
+		{
+			m_condition.wait(lock, [&]() { return !m_launches.empty() || !m_isRunning; });
+			if (m_launches.empty()) return; // stopped, queued launches are done
+
+			launch_t const nextLaunch{ m_launches.front() };
+			lock.unlock();
+
+			launch(nextLaunch);
+
+			lock.lock();
+			m_launches.pop_front(); // dequeued once done, so finish() waits for it
+			m_condition.notify_all();
+		}
+	}
+
+	void SimulatedDevice::launch(launch_t const &launch)
+	{
+		using namespace std::chrono;
+		auto launchEndTime = steady_clock::now() + microseconds(m_settings.launchLatency);
+
+		if (m_settings.hashRate > 0ull)
+			launchEndTime += microseconds(launch.workSize * 1000000ull / m_settings.hashRate);
+
+		for (uint64_t i{ 0ull }; i < launch.workSize; ++i)
+		{
+			if ((i % ABORT_CHECK_INTERVAL) == 0ull && isAborted()) return; // challenge changed, skip rest of launch
+
+			if (isSolution(launch.startPosition + i)) addSolution(launch.startPosition + i);
+		}
+
+		injectCandidates(launch);
+
+		while (!isAborted())
+		{
+			auto const remainingTime = launchEndTime - steady_clock::now();
+			if (remainingTime <= steady_clock::duration::zero()) break;
+
+			std::this_thread::sleep_for(std::min<steady_clock::duration>(remainingTime, milliseconds(1)));
+		}
+	}
+
+	void SimulatedDevice::injectCandidates(launch_t const &launch)
+	{
+		using namespace std::chrono;
+		if (m_settings.candidateRate == 0u) return;
+
+		auto const candidateInterval = duration_cast<steady_clock::duration>(duration<double>(1.0 / m_settings.candidateRate));
+		auto const now = steady_clock::now();
+
+		if (m_nextCandidateTime + seconds(1) < now) m_nextCandidateTime = now; // no burst of backlog after pause
+
+		for (; m_nextCandidateTime <= now; m_nextCandidateTime += candidateInterval)
+			addSolution(launch.startPosition + m_random() % launch.workSize);
+	}
+
+	void SimulatedDevice::addSolution(uint64_t const nonce)
+	{
+		uint32_t const position{ m_solutionCount[0]++ };
+		if (position < MAX_SOLUTION_COUNT_DEVICE) m_solutions[position] = nonce;
+	}
+
+	// Same digest as the kernels: nonce replaces middle 8 bytes of solution (shifted for King address), compared to
+	// high 64 bits of target (or whole target when King making)
+	bool SimulatedDevice::isSolution(uint64_t const nonce)
+	{
+		if (m_isKingMaking)
+			std::memcpy(&m_message.structure.solution[ADDRESS_LENGTH], &nonce, UINT64_LENGTH);
+		else
+			std::memcpy(&m_message.structure.solution[12], &nonce, UINT64_LENGTH);
+
+		byte32_t digest;
+		keccak_256(&digest[0], UINT256_LENGTH, &m_message.byteArray[0], MESSAGE_LENGTH);
+
+		if (m_isKingMaking) return std::memcmp(&digest[0], &m_target[0], UINT256_LENGTH) < 0;
+
+		uint64_t high64Digest{ 0ull };
+		for (uint32_t i{ 0u }; i < UINT64_LENGTH; ++i)
+			high64Digest = (high64Digest << 8) | digest[i];
+
+		return high64Digest <= m_high64Target;
+	}
+
+	bool SimulatedDevice::isAborted()
+	{
+		return m_abortFlag->load(std::memory_order_acquire) != 0u;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "../sha3.h"
+#include "../types.h"
+
+#ifndef __SIMULATED_DEVICE__
+#define __SIMULATED_DEVICE__
+
+namespace OpenCLSolver
+{
+	#define SIMULATED_PLATFORM "Simulated"
+	#define DEFAULT_INTENSITY_SIMULATED 16.0f
+
+	// Timing model of simulated devices, set by host before devices are assigned
+	struct simulation_settings_t
+	{
+		uint32_t launchLatency; // microseconds added to each launch, as launch and readback overhead
+		uint64_t hashRate; // hashes per second of each device, launches are slowed down to it (0 for host speed)
+		uint32_t candidateRate; // invalid candidates per second injected into solutions, to stress readback, verification and submission
+	};
+
+	// CPU emulation of an OpenCL device, to run the host pipeline without a GPU.
+	// Launches run in order on a host thread like an in-order command queue, hashing the same message and nonce layout as the kernels.
+	// Solution and abort buffers are host memory of Device, shared as on zero-copy devices.
+	class SimulatedDevice
+	{
+	private:
+		struct launch_t
+		{
+			uint64_t startPosition;
+			uint64_t workSize;
+		};
+
+		simulation_settings_t const m_settings;
+		bool const m_isKingMaking;
+		std::mt19937_64 m_random; // seeded by device, so injected candidates repeat across runs
+
+		uint32_t *m_solutionCount;
+		uint64_t *m_solutions;
+		std::atomic<uint32_t> const *m_abortFlag; // raised by host thread
+
+		message_ut m_message;
+		byte32_t m_target;
+		uint64_t m_high64Target;
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<launch_t> m_launches;
+		bool m_isLaunching;
+		bool m_isRunning;
+
+		std::chrono::steady_clock::time_point m_nextCandidateTime;
+
+	public:
+		SimulatedDevice(simulation_settings_t const settings, bool const isKingMaking, uint32_t const seed) noexcept;
+		~SimulatedDevice() noexcept;
+
+		void start(uint32_t *solutionCount, uint64_t *solutions, std::atomic<uint32_t> const *abortFlag);
+		void stop();
+
+		void writeMessage(message_ut const &message);
+		void writeTarget(byte32_t const &target, uint64_t const high64Target);
+		void enqueue(uint64_t const startPosition, uint64_t const workSize);
+		void finish();
+
+	private:
+		void run();
+		void launch(launch_t const &launch);
+		void injectCandidates(launch_t const &launch);
+		void addSolution(uint64_t const nonce);
+		bool isSolution(uint64_t const nonce);
+		bool isAborted();
+	};
+}
+
+#endif // !__SIMULATED_DEVICE__
@@ -0,0 +1,46 @@
+#include "dutyCycle.h"
+
+namespace OpenCLSolver
+{
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	DutyCycle::DutyCycle() noexcept :
+		m_percent{ FULL }
+	{
+	}
+
+	void DutyCycle::setPercent(uint32_t const percent)
+	{
+		m_percent.store((percent < FULL) ? percent : FULL);
+	}
+
+	uint32_t DutyCycle::getPercent()
+	{
+		return m_percent.load(std::memory_order_relaxed);
+	}
+
+	bool DutyCycle::isPaused()
+	{
+		return getPercent() == 0u;
+	}
+
+	void DutyCycle::idle(std::chrono::steady_clock::time_point const launchStartTime)
+	{
+		using namespace std::chrono;
+		uint32_t const percent{ getPercent() };
+		if (percent == 0u || percent >= FULL) return; // paused by device loop instead
+
+		auto const launchDuration = steady_clock::now() - launchStartTime;
+		auto const idleEndTime = steady_clock::now() + launchDuration * (FULL - percent) / percent;
+
+		while (getPercent() == percent) // cut short when host changes duty cycle
+		{
+			auto const remainingTime = idleEndTime - steady_clock::now();
+			if (remainingTime <= steady_clock::duration::zero()) break;
+
+			std::this_thread::sleep_for(std::min<steady_clock::duration>(remainingTime, milliseconds(IDLE_CHECK_INTERVAL)));
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#ifndef __LAUNCH_CONTROLLER__
+#define __LAUNCH_CONTROLLER__
+
+namespace OpenCLSolver
+{
+	// Sizes launches (work chunks on CPU) of one device to take about the target duration, from a moving average
+	// of measured throughput, so that clock changes and throttling do not stretch launches. Only used by the device loop.
+	class LaunchController
+	{
+	public:
+		static uint64_t const MAX_GROWTH_FACTOR{ 2ull }; // per launch, a single fast outlier can not overshoot the target by far
+		static double constexpr AVERAGE_WEIGHT{ 0.25 }; // of newest sample
+
+	private:
+		std::atomic<uint32_t> m_targetDuration; // milliseconds, 0 to keep work size fixed
+		std::atomic<bool> m_isResetRequested; // average is reset by update(), setTarget() may be called from another thread
+		uint64_t m_granularity;
+		uint64_t m_minWorkSize;
+		uint64_t m_maxWorkSize;
+		double m_noncesPerMicrosecond; // 0 until first launch is measured
+
+	public:
+		LaunchController() noexcept;
+
+		void setTarget(uint32_t const targetDuration);
+		void setLimits(uint64_t const granularity, uint64_t const minWorkSize, uint64_t const maxWorkSize);
+		bool isEnabled();
+
+		// To be called after completed (not aborted) launches of the same work size, queued back to back since launchStartTime,
+		// returns work size of next launch
+		uint64_t update(uint64_t const workSize, std::chrono::steady_clock::time_point const launchStartTime, uint32_t const launchCount = 1u);
+	};
+}
+
+#endif // !__LAUNCH_CONTROLLER__
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef __NONCE_SPACE__
+#define __NONCE_SPACE__
+
+namespace OpenCLSolver
+{
+	// Shared nonce pool, allocated by the host (Miner.Work.NoncePool) so that every solver loaded in the process
+	// draws from the same 64-bit nonce space. Each field sits on its own cache line, layout must match Miner.Work.
+	struct nonce_pool_t
+	{
+		alignas(64) std::atomic<uint64_t> position;
+		alignas(64) std::atomic<uint64_t> epoch; // incremented by host on new challenge
+		alignas(64) std::atomic<uint64_t> abandoned; // nonces reserved but not hashed before the challenge changed
+	};
+
+	// Pre-sized range reserved by one device (or CPU thread), only touched by its owner
+	struct nonce_range_t
+	{
+		uint64_t next;
+		uint64_t end;
+		uint64_t epoch;
+	};
+
+	class NonceSpace
+	{
+	public:
+		static uint64_t const DEFAULT_REFILL_COUNT{ 16ull }; // number of work sizes reserved per refill
+
+	private:
+		static nonce_pool_t m_localPool; // used until the host assigns a shared pool
+
+		nonce_pool_t *m_pool;
+
+	public:
+		NonceSpace() noexcept;
+
+		void setPool(nonce_pool_t *pool);
+
+		uint64_t getPosition();
+		uint64_t getEpoch();
+		uint64_t getAbandonedCount();
+
+		uint64_t getNextPosition(nonce_range_t &range, uint64_t const workSize, uint64_t const refillCount = DEFAULT_REFILL_COUNT);
+		void abandonRange(nonce_range_t &range);
+	};
+}
+
+#endif // !__NONCE_SPACE__
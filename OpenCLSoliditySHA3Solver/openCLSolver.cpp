@@ -140,6 +140,10 @@ namespace OpenCLSolver
 	// --------------------------------------------------------------------
 
 	openCLSolver::openCLSolver() noexcept :
+		targetLaunchDuration{ 0u },
+		simulation{ 0u, 0ull, 0u },
+		m_isStarting{ false },
+		m_isStarted{ false },
 		s_address{ "" },
 		s_challenge{ "" },
 		s_target{ "" },
@@ -167,29 +171,14 @@ namespace OpenCLSolver
 		m_getSolutionTemplateCallback = solutionTemplateCallback;
 	}
 
-	void openCLSolver::setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback)
-	{
-		m_getWorkPositionCallback = workPositionCallback;
-	}
-
-	void openCLSolver::setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback)
-	{
-		m_resetWorkPositionCallback = resetWorkPositionCallback;
-	}
-
-	void openCLSolver::setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback)
-	{
-		m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-	}
-
-	void openCLSolver::setMessageCallback(MessageCallback messageCallback)
+	void openCLSolver::setSolutionCallback(SolutionCallback solutionCallback)
 	{
-		m_messageCallback = messageCallback;
+		m_solutionCallback = solutionCallback;
 	}
 
-	void openCLSolver::setSolutionCallback(SolutionCallback solutionCallback)
+	void openCLSolver::setNoncePool(nonce_pool_t *noncePool)
 	{
-		m_solutionCallback = solutionCallback;
+		m_nonceSpace.setPool(noncePool);
 	}
 
 	bool openCLSolver::isAssigned()
@@ -229,6 +218,30 @@ namespace OpenCLSolver
 		getKingAddress(&m_kingAddress);
 		m_isKingMaking = (!isAddressEmpty(m_kingAddress));
 
+		if (platformName == SIMULATED_PLATFORM)
+		{
+			onMessage(platformName, deviceEnum, "Info", "Assigning simulated device...");
+
+			m_devices.emplace_back(new Device(deviceEnum, simulation, m_isKingMaking, intensity));
+
+			auto &assignDevice = m_devices.back();
+			intensity = assignDevice->userDefinedIntensity;
+			pciBusID = assignDevice->pciBusID;
+
+			#ifdef __linux__
+			strcpy((char *)deviceName, assignDevice->name.c_str());
+			#else
+			strcpy_s((char *)deviceName, assignDevice->name.size() + 1, assignDevice->name.c_str());
+			#endif
+
+			onMessage(platformName, deviceEnum, "Info", "Assigned simulated device (latency: " + std::to_string(simulation.launchLatency) + "us"
+				+ ", hashrate: " + (simulation.hashRate > 0ull ? std::to_string(simulation.hashRate) + "H/s" : std::string{ "unthrottled" })
+				+ ", candidates: " + std::to_string(simulation.candidateRate) + "/s)...");
+			onMessage(platformName, deviceEnum, "Info", "Intensity: " + std::to_string(assignDevice->userDefinedIntensity));
+
+			return true;
+		}
+
 		cl_int status{ CL_SUCCESS };
 
 		for (auto& platform : platforms)
@@ -319,6 +332,8 @@ namespace OpenCLSolver
 	{
 		assert(prefix.length() == ((UINT256_LENGTH + ADDRESS_LENGTH) * 2 + 2));
 
+		bool const isChallengeChanged{ prefix.substr(0, 2 + UINT256_LENGTH * 2) != s_challenge };
+
 		s_challenge = prefix.substr(0, 2 + UINT256_LENGTH * 2);
 		s_address = "0x" + prefix.substr(2 + UINT256_LENGTH * 2, ADDRESS_LENGTH * 2);
 
@@ -329,6 +344,7 @@ namespace OpenCLSolver
 		m_miningMessage.structure.solution = m_solutionTemplate;
 
 		sponge_ut midState = getMidState(m_miningMessage);
+		auto const challengeTime = std::chrono::steady_clock::now();
 
 		for (auto& device : m_devices)
 		{
@@ -336,6 +352,10 @@ namespace OpenCLSolver
 
 			device->currentMessage = m_miningMessage;
 			device->currentMidstate = midState;
+			device->challengeTime = challengeTime;
+
+			if (isChallengeChanged && device->mining) device->setAbortFlag(1u); // raise before new message, cleared once it is pushed
+			device->messageGeneration++;
 			device->isNewMessage = true;
 		}
 	}
@@ -381,6 +401,24 @@ namespace OpenCLSolver
 		return 0ull;
 	}
 
+	void openCLSolver::getMetricsByDevice(std::string platformName, int const deviceEnum, uint64_t *values)
+	{
+		std::memset(values, 0, UINT64_LENGTH * SolverMetrics::VALUE_COUNT);
+
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+				device->metrics.getValues(values);
+	}
+
+	uint32_t openCLSolver::getTraceEventsByDevice(std::string platformName, int const deviceEnum, trace_event_t *events, uint32_t const maxCount)
+	{
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+				return device->trace.drain(events, maxCount);
+
+		return 0u;
+	}
+
 	int openCLSolver::getDeviceSettingMaxCoreClock(std::string platformName, int deviceEnum)
 	{
 		std::string errorMessage;
@@ -503,6 +541,8 @@ namespace OpenCLSolver
 
 	void openCLSolver::startFinding()
 	{
+		m_isStarting = true;
+
 		for (auto& device : m_devices)
 		{
 			onMessage(device->platformName, device->deviceEnum, "Info", "Initializing device...");
@@ -521,11 +561,20 @@ namespace OpenCLSolver
 			device->miningThread = std::thread(&openCLSolver::findSolution, this, device->platformName, device->deviceEnum);
 			device->miningThread.detach();
 		}
+
+		m_isStarted = true;
+		m_isStarting = false;
 	}
 
 	void openCLSolver::stopFinding()
 	{
-		for (auto& device : m_devices) device->mining = false;
+		m_isStarted = false;
+
+		for (auto& device : m_devices)
+		{
+			device->dutyCycle.setPercent(DutyCycle::FULL); // a device paused by duty cycle would not leave its loop
+			device->mining = false;
+		}
 		std::this_thread::sleep_for(std::chrono::seconds(1));
 	}
 
@@ -534,6 +583,94 @@ namespace OpenCLSolver
 		m_pause = pauseFinding;
 	}
 
+	void openCLSolver::setDeviceDutyCycle(std::string platformName, int deviceEnum, uint32_t const dutyCycle)
+	{
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+				device->dutyCycle.setPercent(dutyCycle);
+	}
+
+	bool openCLSolver::setDeviceTuning(std::string platformName, int deviceEnum, float const intensity, uint32_t const localWorkSize)
+	{
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+			{
+				device->tuningRequest.request(intensity, localWorkSize);
+				return true;
+			}
+
+		return false;
+	}
+
+	bool openCLSolver::isDeviceMining(std::string platformName, int deviceEnum)
+	{
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+				return device->mining;
+
+		return false;
+	}
+
+	bool openCLSolver::isDevicePaused(std::string platformName, int deviceEnum)
+	{
+		for (auto& device : m_devices)
+			if (device->platformName == platformName && device->deviceEnum == deviceEnum)
+				return m_pause || device->dutyCycle.isPaused();
+
+		return m_pause;
+	}
+
+	// Stops mining thread of one device, which releases its context, and initializes it again while other devices keep mining.
+	// Returns false if mining is not started (or still starting), device is unknown,
+	// its thread did not leave a hung launch in time or it failed to initialize.
+	bool openCLSolver::restartDevice(std::string platformName, int deviceEnum)
+	{
+		if (m_isStarting || !m_isStarted) return false;
+
+		auto deviceIterator = std::find_if(m_devices.begin(), m_devices.end(), [&](std::unique_ptr<Device>& device)
+		{
+			return device->platformName == platformName && device->deviceEnum == deviceEnum;
+		});
+		if (deviceIterator == m_devices.end()) return false;
+
+		auto& device = *deviceIterator;
+		onMessage(device->platformName, device->deviceEnum, "Info", "Restarting device...");
+
+		auto const dutyCyclePercent = device->dutyCycle.getPercent();
+		device->dutyCycle.setPercent(DutyCycle::FULL); // a paused device would not leave its idle loop to stop
+		device->mining = false;
+
+		auto const stopDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(RESTART_STOP_TIMEOUT_S);
+		while (device->initialized && std::chrono::steady_clock::now() < stopDeadline)
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		device->dutyCycle.setPercent(dutyCyclePercent); // as set by host (e.g. thermal control), kept by restarted device
+
+		if (device->initialized)
+		{
+			onMessage(device->platformName, device->deviceEnum, "Error", "Device did not stop in time, restart deferred.");
+			return false;
+		}
+
+		std::string errorMessage;
+		device->initialize(errorMessage, m_isKingMaking);
+		if (!device->initialized)
+		{
+			if (errorMessage != "") onMessage(device->platformName, device->deviceEnum, "Error", errorMessage);
+			else onMessage(device->platformName, device->deviceEnum, "Error", "Failed to initialize device.");
+			return false;
+		}
+
+		device->isNewMessage = !s_challenge.empty(); // buffers are new, push current work again
+		device->isNewTarget = !s_target.empty();
+		device->metrics.addRestart();
+
+		device->miningThread = std::thread(&openCLSolver::findSolution, this, device->platformName, device->deviceEnum);
+		device->miningThread.detach();
+
+		return true;
+	}
+
 	// --------------------------------------------------------------------
 	// Private
 	// --------------------------------------------------------------------
@@ -556,27 +693,12 @@ namespace OpenCLSolver
 		m_getSolutionTemplateCallback(solutionTemplate->data());
 	}
 
-	void openCLSolver::getWorkPosition(uint64_t &workPosition)
-	{
-		m_getWorkPositionCallback(workPosition);
-	}
-
-	void openCLSolver::resetWorkPosition(uint64_t &lastPosition)
-	{
-		m_resetWorkPositionCallback(lastPosition);
-	}
-
-	void openCLSolver::incrementWorkPosition(uint64_t &lastPosition, uint64_t increment)
-	{
-		m_incrementWorkPositionCallback(lastPosition, increment);
-	}
-
-	void openCLSolver::onMessage(std::string platformName, int deviceEnum, std::string type, std::string message)
+	void openCLSolver::onMessage(std::string const &platformName, int deviceEnum, std::string const &type, std::string const &message)
 	{
-		m_messageCallback(platformName.empty() ? "OpenCL" : (platformName + " (OpenCL)").c_str(), deviceEnum, type.c_str(), message.c_str());
+		m_log.push(LogRing::getLevel(type.c_str()), deviceEnum, platformName.c_str(), message.c_str());
 	}
 
-	void openCLSolver::onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device)
+	void openCLSolver::onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device, std::chrono::steady_clock::time_point const foundTime)
 	{
 		if (!isSubmitStale && challenge != s_challenge)
 			return;
@@ -585,6 +707,8 @@ namespace OpenCLSolver
 		else
 			onMessage(device->platformName, device->deviceEnum, "Info", "GPU found solution, verifying...");
 
+		auto const verifyStartTime = std::chrono::steady_clock::now();
+
 		byte32_t emptySolution;
 		std::memset(&emptySolution, 0u, UINT256_LENGTH);
 		if (solution == emptySolution)
@@ -608,7 +732,7 @@ namespace OpenCLSolver
 		std::string digestStr = bytesToHexString(bDigest);
 		arith_uint256 digest = arith_uint256(digestStr);
 
-		onMessage(device->platformName, device->deviceEnum, "Debug", "Digest: 0x" + digestStr);
+		if (m_log.isLogged(LOG_DEBUG)) onMessage(device->platformName, device->deviceEnum, "Debug", "Digest: 0x" + digestStr);
 
 		if (digest >= m_target)
 		{
@@ -627,21 +751,48 @@ namespace OpenCLSolver
 					+ "\nDigest: 0x" + digestStr
 					+ "\nTarget: " + s_target);
 			}
+			device->trace.recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 0ull);
+			device->metrics.recordVerify(verifyStartTime);
 		}
 		else
 		{
+			device->trace.recordSpan(TRACE_SOLUTION_VERIFY, verifyStartTime, 1ull);
+			device->metrics.recordVerify(verifyStartTime);
 			onMessage(device->platformName, device->deviceEnum, "Info", "Solution verified by CPU, submitting nonce 0x" + solutionStr + "...");
-			onMessage(device->platformName, device->deviceEnum, "Debug", std::string{ "Solution details..." }
+			if (m_log.isLogged(LOG_DEBUG)) onMessage(device->platformName, device->deviceEnum, "Debug", std::string{ "Solution details..." }
 				+"\nChallenge: " + challenge
 				+ "\nAddress: " + s_address
 				+ "\nSolution: 0x" + solutionStr
 				+ "\nDigest: 0x" + digestStr
 				+ "\nTarget: " + s_target);
 			m_solutionCallback(("0x" + digestStr).c_str(), s_address.c_str(), challenge.c_str(), s_target.c_str(), ("0x" + solutionStr).c_str());
+			device->metrics.recordSolution(foundTime);
+		}
+	}
+
+	void openCLSolver::traceLaunches(std::unique_ptr<Device> &device, cl_event *launchEvents, uint64_t *workPositions, std::chrono::steady_clock::time_point const launchStartTime)
+	{
+		cl_ulong startTimes[MAX_WORK_POSITION_STORE], endTimes[MAX_WORK_POSITION_STORE]; // nanoseconds of device clock
+
+		for (uint32_t q{ 0 }; q < MAX_WORK_POSITION_STORE; ++q)
+		{
+			if (launchEvents[q] == NULL
+				|| clGetEventProfilingInfo(launchEvents[q], CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &startTimes[q], NULL) != CL_SUCCESS
+				|| clGetEventProfilingInfo(launchEvents[q], CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &endTimes[q], NULL) != CL_SUCCESS)
+			{
+				device->trace.recordSpan(TRACE_KERNEL, launchStartTime, workPositions[0]); // profiling not available, whole batch as seen by host
+				return;
+			}
 		}
+
+		// Device clock is aligned to host by the end of last launch, which completed just before its readback returned
+		int64_t const clockOffset{ (int64_t)TraceBuffer::getTimestamp(std::chrono::steady_clock::now()) - (int64_t)(endTimes[MAX_WORK_POSITION_STORE - 1] / 1000u) };
+
+		for (uint32_t q{ 0 }; q < MAX_WORK_POSITION_STORE; ++q)
+			device->trace.recordSpan(TRACE_KERNEL, (uint64_t)((int64_t)(startTimes[q] / 1000u) + clockOffset), (endTimes[q] - startTimes[q]) / 1000u, workPositions[q]);
 	}
 
-	void openCLSolver::submitSolutions(std::set<uint64_t> solutions, std::string challenge, std::string platformName, int const deviceEnum)
+	void openCLSolver::submitSolutions(std::set<uint64_t> solutions, std::string challenge, std::string platformName, int const deviceEnum, std::chrono::steady_clock::time_point const foundTime)
 	{
 		auto& device = *std::find_if(m_devices.begin(), m_devices.end(), [&](std::unique_ptr<Device>& device)
 		{
@@ -665,7 +816,7 @@ namespace OpenCLSolver
 			else
 				std::memcpy(&solution[12], &midStateSolution, UINT64_LENGTH); // keep first and last 12 bytes, fill middle 8 bytes for mid state
 
-			onSolution(solution, challenge, device);
+			onSolution(solution, challenge, device, foundTime);
 		}
 		m_isSubmitting = false;
 	}
@@ -721,52 +872,88 @@ namespace OpenCLSolver
 
 	uint64_t const openCLSolver::getNextWorkPosition(std::unique_ptr<Device> &device)
 	{
-		uint64_t lastPosition;
-		incrementWorkPosition(lastPosition, device->globalWorkSize);
+		auto const allocationStartTime = std::chrono::steady_clock::now();
+		uint64_t const workPosition{ m_nonceSpace.getNextPosition(device->nonceRange, device->globalWorkSize) };
 		device->hashCount += device->globalWorkSize;
+		device->metrics.addPositions(device->globalWorkSize);
+		device->trace.recordSpan(TRACE_WORK_ALLOCATION, allocationStartTime, workPosition);
 
-		return lastPosition;
+		return workPosition;
 	}
 
 	void openCLSolver::pushTarget(std::unique_ptr<Device> &device)
 	{
-		device->status = clEnqueueWriteBuffer(device->queue, device->targetBuffer, CL_TRUE, 0u, UINT64_LENGTH, device->currentHigh64Target, 0, NULL, NULL);
-		if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting target buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		if (device->isSimulated())
+			device->simulator->writeTarget(device->currentTarget, device->currentHigh64Target[0]);
+		else
+		{
+			device->status = clEnqueueWriteBuffer(device->queue, device->targetBuffer, CL_TRUE, 0u, UINT64_LENGTH, device->currentHigh64Target, 0, NULL, NULL);
+			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting target buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		}
 
 		device->isNewTarget = false;
 	}
 
 	void openCLSolver::pushTargetKing(std::unique_ptr<Device> &device)
 	{
-		device->status = clEnqueueWriteBuffer(device->queue, device->targetBuffer, CL_TRUE, 0u, UINT256_LENGTH, &device->currentTarget, 0, NULL, NULL);
-		if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting target buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		if (device->isSimulated())
+			device->simulator->writeTarget(device->currentTarget, device->currentHigh64Target[0]);
+		else
+		{
+			device->status = clEnqueueWriteBuffer(device->queue, device->targetBuffer, CL_TRUE, 0u, UINT256_LENGTH, &device->currentTarget, 0, NULL, NULL);
+			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting target buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		}
 
 		device->isNewTarget = false;
 	}
 
 	void openCLSolver::pushMessage(std::unique_ptr<Device> &device)
 	{
-		device->status = clEnqueueWriteBuffer(device->queue, device->midstateBuffer, CL_TRUE, 0u, SPONGE_LENGTH, &device->currentMidstate, 0, NULL, NULL);
-		if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error writing to midstate buffer (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
-
-		device->isNewMessage = false;
+		if (device->isSimulated())
+			device->simulator->writeMessage(device->currentMessage); // hashed in full, same digest as from midstate
+		else
+		{
+			device->status = clEnqueueWriteBuffer(device->queue, device->midstateBuffer, CL_TRUE, 0u, SPONGE_LENGTH, &device->currentMidstate, 0, NULL, NULL);
+			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error writing to midstate buffer (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		}
 	}
 
 	void openCLSolver::pushMessageKing(std::unique_ptr<Device> &device)
 	{
-		device->status = clEnqueueWriteBuffer(device->queue, device->messageBuffer, CL_TRUE, 0u, MESSAGE_LENGTH, &device->currentMessage, 0, NULL, NULL);
-		if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error writing to message buffer (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
-
-		device->isNewMessage = false;
+		if (device->isSimulated())
+			device->simulator->writeMessage(device->currentMessage);
+		else
+		{
+			device->status = clEnqueueWriteBuffer(device->queue, device->messageBuffer, CL_TRUE, 0u, MESSAGE_LENGTH, &device->currentMessage, 0, NULL, NULL);
+			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error writing to message buffer (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+		}
 	}
 
-	void openCLSolver::checkInputs(std::unique_ptr<Device> &device, char *currentChallenge)
+	void openCLSolver::applyTuning(std::unique_ptr<Device> &device)
 	{
-		uint64_t lastPosition;
-		getWorkPosition(lastPosition);
+		float intensity{ 0.0f };
+		uint32_t localWorkSize{ 0u };
+		if (!device->tuningRequest.take(intensity, localWorkSize)) return;
+
+		if (localWorkSize > 0u) device->setLocalWorkSize(localWorkSize);
+		if (intensity > 0.0f) // at least one work group, global work size fits in uint32
+			intensity = std::max((float)std::log2((double)device->localWorkSize), std::min(MAX_INTENSITY, intensity));
+
+		device->setIntensity((intensity > 0.0f) ? intensity : device->userDefinedIntensity, m_isKingMaking); // global work size in multiples of local work size
 
+		device->launchController.setLimits(device->localWorkSize, device->localWorkSize, 1ull << 32); // requested intensity is its new starting point
+
+		onMessage(device->platformName, device->deviceEnum, "Info", "Retuned to intensity: " + std::to_string(device->userDefinedIntensity)
+			+ ", local work size: " + std::to_string(device->localWorkSize));
+	}
+
+	void openCLSolver::checkInputs(std::unique_ptr<Device> &device, std::string &currentChallenge)
+	{
 		if (device->isNewMessage || device->isNewTarget)
 		{
+			auto const switchStartTime = std::chrono::steady_clock::now();
+			bool isChallengeSwitch{ false };
+
 			device->hashCount.store(0ull);
 			device->hashStartTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(500); // reduce hashrate spike on new challenge
 
@@ -780,17 +967,23 @@ namespace OpenCLSolver
 
 			if (device->isNewMessage)
 			{
+				isChallengeSwitch = (!currentChallenge.empty() && s_challenge != currentChallenge);
+
+				auto const generation = device->messageGeneration.load();
+				device->isNewMessage = false; // before push, so a message arriving meanwhile is pushed on next check
+
 				if (m_isKingMaking)
 					pushMessageKing(device);
 				else
 					pushMessage(device);
 
-				#ifdef __linux__
-				strcpy(currentChallenge, s_challenge.c_str());
-				#else
-				strcpy_s(currentChallenge, s_challenge.size() + 1, s_challenge.c_str());
-				#endif
+				if (device->messageGeneration.load() == generation) device->setAbortFlag(0u); // otherwise newer message keeps it raised
+
+				currentChallenge = s_challenge;
+
+				if (isChallengeSwitch) device->metrics.recordChallengeSwitch(device->challengeTime);
 			}
+			device->trace.recordSpan(TRACE_JOB_SWITCH, switchStartTime, isChallengeSwitch ? 1ull : 0ull);
 		}
 	}
 
@@ -804,19 +997,26 @@ namespace OpenCLSolver
 		if (!device->initialized) return;
 
 		bool isCUDAorIntel = device->isCUDA() | device->isINTEL(); // cache value here
+		bool isSimulated = device->isSimulated();
 
 		onMessage(device->platformName, device->deviceEnum, "Info", "Start mining...");
-		onMessage(device->platformName, device->deviceEnum, "Debug", "Threads: " + std::to_string(device->globalWorkSize) + " Local work size: " + std::to_string(device->localWorkSize) + " Block size:" + std::to_string(device->globalWorkSize / device->localWorkSize));
+		if (m_log.isLogged(LOG_DEBUG)) onMessage(device->platformName, device->deviceEnum, "Debug", "Threads: " + std::to_string(device->globalWorkSize) + " Local work size: " + std::to_string(device->localWorkSize) + " Block size:" + std::to_string(device->globalWorkSize / device->localWorkSize));
+
+		device->launchController.setTarget(targetLaunchDuration);
+		device->launchController.setLimits(device->localWorkSize, device->localWorkSize, 1ull << 32);
+		if (device->launchController.isEnabled())
+			onMessage(device->platformName, device->deviceEnum, "Info", "Target launch duration: " + std::to_string(targetLaunchDuration) + "ms");
 
 		device->mining = true;
 		device->hashCount.store(0ull);
 		device->hashStartTime = std::chrono::steady_clock::now() - std::chrono::milliseconds(500); // reduce excessive high hashrate reporting at start
 
 		uint64_t workPosition[MAX_WORK_POSITION_STORE];
-		char *c_currentChallenge = (char *)malloc(s_challenge.size());
+		cl_event launchEvents[MAX_WORK_POSITION_STORE];
+		std::string currentChallenge; // empty until first message is pushed
 		do
 		{
-			while (m_pause)
+			while (m_pause || device->dutyCycle.isPaused())
 			{
 				device->hashCount.store(0ull);
 				device->hashStartTime = std::chrono::steady_clock::now();
@@ -824,19 +1024,31 @@ namespace OpenCLSolver
 				std::this_thread::sleep_for(std::chrono::milliseconds(500));
 			}
 
-			checkInputs(device, c_currentChallenge);
+			applyTuning(device);
+			checkInputs(device, currentChallenge);
 
+			auto const launchStartTime = std::chrono::steady_clock::now(); // one sample per batch of queued launches
 			for (uint32_t q{ 0 }; q < MAX_WORK_POSITION_STORE; ++q)
 			{
 				workPosition[q] = getNextWorkPosition(device);
+				launchEvents[q] = NULL;
+				auto const enqueueStartTime = std::chrono::steady_clock::now();
+
+				if (isSimulated)
+					device->simulator->enqueue(workPosition[q], device->globalWorkSize);
+				else
+				{
+					device->status = clSetKernelArg(device->kernel, 2u, UINT64_LENGTH, &workPosition[q]);
+					if (device->status != CL_SUCCESS)
+						onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting work positon buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
 
-				device->status = clSetKernelArg(device->kernel, 2u, UINT64_LENGTH, &workPosition[q]);
-				if (device->status != CL_SUCCESS)
-					onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error setting work positon buffer to kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+					device->status = clEnqueueNDRangeKernel(device->queue, device->kernel, 1u, NULL, &device->globalWorkSize, &device->localWorkSize, 0, NULL, &launchEvents[q]);
+					if (device->status != CL_SUCCESS)
+						onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error starting kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
 
-				device->status = clEnqueueNDRangeKernel(device->queue, device->kernel, 1u, NULL, &device->globalWorkSize, &device->localWorkSize, 0, NULL, &device->kernelWaitEvent);
-				if (device->status != CL_SUCCESS)
-					onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error starting kernel (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+					device->kernelWaitEvent = launchEvents[q];
+				}
+				device->trace.recordSpan(TRACE_KERNEL_ENQUEUE, enqueueStartTime, workPosition[q]);
 			}
 
 			if (isCUDAorIntel) // CUDA and Intel 100% CPU workaround
@@ -859,13 +1071,38 @@ namespace OpenCLSolver
 				else if (waitKernelCount < 5u && device->kernelWaitSleepDuration > 0u) device->kernelWaitSleepDuration--;
 			}
 
-			device->h_solutionCount = (uint32_t *)clEnqueueMapBuffer(device->queue, device->solutionCountBuffer, CL_TRUE, CL_MAP_READ, 0, UINT32_LENGTH, 0, NULL, NULL, &device->status);
-			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solution count from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+			if (isSimulated)
+				device->simulator->finish();
+			else
+			{
+				device->h_solutionCount = (uint32_t *)clEnqueueMapBuffer(device->queue, device->solutionCountBuffer, CL_TRUE, CL_MAP_READ, 0, UINT32_LENGTH, 0, NULL, NULL, &device->status);
+				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solution count from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+			}
+
+			if (TraceBuffer::isEnabled()) traceLaunches(device, launchEvents, workPosition, launchStartTime);
+
+			for (uint32_t q{ 0 }; q < MAX_WORK_POSITION_STORE; ++q)
+				if (launchEvents[q] != NULL) clReleaseEvent(launchEvents[q]);
+
+			if (device->h_abortFlag->load() == 0u)
+			{
+				device->metrics.recordLaunch(launchStartTime, device->globalWorkSize * MAX_WORK_POSITION_STORE);
+
+				if (device->launchController.isEnabled()) // sized per launch, measured over the queued batch
+					device->globalWorkSize = (size_t)device->launchController.update(device->globalWorkSize, launchStartTime, MAX_WORK_POSITION_STORE);
+			}
+			else
+				device->metrics.addAbortedLaunch(); // cut short by new challenge, relaunched on next iteration
 
 			if (device->h_solutionCount[0] > 0u)
 			{
-				device->h_solutions = (uint64_t *)clEnqueueMapBuffer(device->queue, device->solutionsBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE, 0, NULL, NULL, &device->status);
-				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solutions from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+				auto const readbackStartTime = std::chrono::steady_clock::now();
+
+				if (!isSimulated) // simulated device writes host memory directly
+				{
+					device->h_solutions = (uint64_t *)clEnqueueMapBuffer(device->queue, device->solutionsBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, UINT64_LENGTH * MAX_SOLUTION_COUNT_DEVICE, 0, NULL, NULL, &device->status);
+					if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solutions from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+				}
 
 				std::set<uint64_t> uniqueSolutions;
 
@@ -876,36 +1113,54 @@ namespace OpenCLSolver
 						uniqueSolutions.emplace(tempSolution);
 				}
 
-				std::thread t{ &openCLSolver::submitSolutions, this, uniqueSolutions, std::string{ c_currentChallenge }, device->platformName, device->deviceEnum };
+				std::thread t{ &openCLSolver::submitSolutions, this, uniqueSolutions, currentChallenge, device->platformName, device->deviceEnum, std::chrono::steady_clock::now() };
 				t.detach();
 
-				device->status = clEnqueueUnmapMemObject(device->queue, device->solutionsBuffer, device->h_solutions, 0, NULL, NULL);
-				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solutions from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+				if (!isSimulated)
+				{
+					device->status = clEnqueueUnmapMemObject(device->queue, device->solutionsBuffer, device->h_solutions, 0, NULL, NULL);
+					if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solutions from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
 
-				device->status = clEnqueueUnmapMemObject(device->queue, device->solutionCountBuffer, device->h_solutionCount, 0, NULL, NULL);
-				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solution count from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+					device->status = clEnqueueUnmapMemObject(device->queue, device->solutionCountBuffer, device->h_solutionCount, 0, NULL, NULL);
+					if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solution count from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
 
-				device->h_solutionCount = (uint32_t *)clEnqueueMapBuffer(device->queue, device->solutionCountBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, UINT32_LENGTH, 0, NULL, NULL, &device->status);
-				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solution count from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+					device->h_solutionCount = (uint32_t *)clEnqueueMapBuffer(device->queue, device->solutionCountBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, UINT32_LENGTH, 0, NULL, NULL, &device->status);
+					if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error getting solution count from device (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+				}
 
 				device->h_solutionCount[0] = 0u;
+				device->trace.recordSpan(TRACE_READBACK, readbackStartTime, uniqueSolutions.size());
+			}
+
+			if (!isSimulated)
+			{
+				device->status = clEnqueueUnmapMemObject(device->queue, device->solutionCountBuffer, device->h_solutionCount, 0, NULL, NULL);
+				if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solution count from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
 			}
 
-			device->status = clEnqueueUnmapMemObject(device->queue, device->solutionCountBuffer, device->h_solutionCount, 0, NULL, NULL);
-			if (device->status != CL_SUCCESS) onMessage(device->platformName, device->deviceEnum, "Error", std::string{ "Error unmapping solution count from host (" } +Device::getOpenCLErrorCodeStr(device->status) + ")...");
+			device->dutyCycle.idle(launchStartTime); // after solutions are handed over
 		} while (device->mining);
 
 		onMessage(device->platformName, device->deviceEnum, "Info", "Stop mining...");
 		device->hashCount.store(0ull);
 
-		clFinish(device->queue);
-
-		clReleaseKernel(device->kernel);
-		clReleaseProgram(device->program);
-		clReleaseMemObject(device->solutionsBuffer);
-		clReleaseMemObject(device->midstateBuffer);
-		clReleaseCommandQueue(device->queue);
-		clReleaseContext(device->context);
+		if (isSimulated)
+			device->simulator->stop();
+		else
+		{
+			clFinish(device->queue);
+			device->unmapAbortFlag();
+
+			clReleaseKernel(device->kernel);
+			clReleaseProgram(device->program);
+			clReleaseMemObject(device->solutionsBuffer);
+			clReleaseMemObject(device->solutionCountBuffer);
+			clReleaseMemObject(device->abortFlagBuffer);
+			clReleaseMemObject(m_isKingMaking ? device->messageBuffer : device->midstateBuffer);
+			clReleaseMemObject(device->targetBuffer);
+			clReleaseCommandQueue(device->queue);
+			clReleaseContext(device->context);
+		}
 
 		device->initialized = false;
 		onMessage(device->platformName, device->deviceEnum, "Info", "Mining stopped.");
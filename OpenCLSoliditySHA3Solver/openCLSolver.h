@@ -1,13 +1,16 @@
 #pragma once
 
 #define MAX_WORK_POSITION_STORE 2
+#define RESTART_STOP_TIMEOUT_S 10
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <random>
 #include <set>
 #include <thread>
+#include "logRing.h"
 #include "sha3.h"
 #include "device/device.h"
 #include "uint256/arith_uint256.h"
@@ -22,10 +25,6 @@ namespace OpenCLSolver
 {
 	typedef void(*GetKingAddressCallback)(uint8_t *kingAddress);
 	typedef void(*GetSolutionTemplateCallback)(uint8_t *solutionTemplate);
-	typedef void(*GetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*ResetWorkPositionCallback)(uint64_t &lastWorkPosition);
-	typedef void(*IncrementWorkPositionCallback)(uint64_t &lastWorkPosition, uint64_t incrementSize);
-	typedef void(*MessageCallback)(const char *platform, int deviceEnum, const char *type, const char *message);
 	typedef void(*SolutionCallback)(const char *digest, const char *address, const char *challenge, const char *target, const char *solution);
 
 	typedef struct { cl_platform_id id; std::string name; } Platform;
@@ -41,19 +40,21 @@ namespace OpenCLSolver
 
 		GetKingAddressCallback m_getKingAddressCallback;
 		GetSolutionTemplateCallback m_getSolutionTemplateCallback;
-		GetWorkPositionCallback m_getWorkPositionCallback;
-		ResetWorkPositionCallback m_resetWorkPositionCallback;
-		IncrementWorkPositionCallback m_incrementWorkPositionCallback;
-		MessageCallback m_messageCallback;
 		SolutionCallback m_solutionCallback;
+		LogRing m_log;
+		NonceSpace m_nonceSpace;
 
 		bool isSubmitStale;
+		uint32_t targetLaunchDuration; // milliseconds of each launch, 0 for fixed intensity
+		simulation_settings_t simulation; // timing model of devices assigned on SIMULATED_PLATFORM
 
 	private:
 		static std::vector<Platform> platforms;
 
 		std::vector<std::unique_ptr<Device>> m_devices;
 		std::thread m_runThread;
+		std::atomic<bool> m_isStarting; // devices are being initialized by startFinding
+		std::atomic<bool> m_isStarted; // set once startFinding is done, until stopFinding
 
 		static bool m_pause;
 		static bool m_isSubmitting;
@@ -76,11 +77,8 @@ namespace OpenCLSolver
 
 		void setGetKingAddressCallback(GetKingAddressCallback kingAddressCallback);
 		void setGetSolutionTemplateCallback(GetSolutionTemplateCallback solutionTemplateCallback);
-		void setGetWorkPositionCallback(GetWorkPositionCallback workPositionCallback);
-		void setResetWorkPositionCallback(ResetWorkPositionCallback resetWorkPositionCallback);
-		void setIncrementWorkPositionCallback(IncrementWorkPositionCallback incrementWorkPositionCallback);
-		void setMessageCallback(MessageCallback messageCallback);
 		void setSolutionCallback(SolutionCallback solutionCallback);
+		void setNoncePool(nonce_pool_t *noncePool);
 
 		bool isAssigned();
 		bool isAnyInitialised();
@@ -93,6 +91,8 @@ namespace OpenCLSolver
 
 		uint64_t getTotalHashRate();
 		uint64_t getHashRateByDevice(std::string platformName, int const deviceEnum);
+		void getMetricsByDevice(std::string platformName, int const deviceEnum, uint64_t *values);
+		uint32_t getTraceEventsByDevice(std::string platformName, int const deviceEnum, trace_event_t *events, uint32_t const maxCount);
 
 		int getDeviceSettingMaxCoreClock(std::string platformName, int deviceEnum);
 		int getDeviceSettingMaxMemoryClock(std::string platformName, int deviceEnum);
@@ -109,24 +109,28 @@ namespace OpenCLSolver
 		void startFinding();
 		void stopFinding();
 		void pauseFinding(bool pauseFinding);
+		void setDeviceDutyCycle(std::string platformName, int deviceEnum, uint32_t const dutyCycle);
+		bool setDeviceTuning(std::string platformName, int deviceEnum, float const intensity, uint32_t const localWorkSize);
+		bool isDeviceMining(std::string platformName, int deviceEnum);
+		bool isDevicePaused(std::string platformName, int deviceEnum);
+		bool restartDevice(std::string platformName, int deviceEnum);
 
 	private:
 		bool isAddressEmpty(address_t &address);
 		void getKingAddress(address_t *kingAddress);
 		void getSolutionTemplate(byte32_t *solutionTemplate);
-		void getWorkPosition(uint64_t &workPosition);
-		void resetWorkPosition(uint64_t &lastPosition);
-		void incrementWorkPosition(uint64_t &lastPosition, uint64_t increment);
-		void onMessage(std::string platformName, int deviceEnum, std::string type, std::string message);
-		void onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device);
+		void onMessage(std::string const &platformName, int deviceEnum, std::string const &type, std::string const &message);
+		void onSolution(byte32_t const solution, std::string challenge, std::unique_ptr<Device> &device, std::chrono::steady_clock::time_point const foundTime);
 
 		void findSolution(std::string platformName, int const deviceEnum);
-		void checkInputs(std::unique_ptr<Device> &device, char *currentChallenge);
+		void checkInputs(std::unique_ptr<Device> &device, std::string &currentChallenge);
+		void applyTuning(std::unique_ptr<Device> &device);
 		void pushTarget(std::unique_ptr<Device> &device);
 		void pushTargetKing(std::unique_ptr<Device> &device);
 		void pushMessage(std::unique_ptr<Device> &device);
 		void pushMessageKing(std::unique_ptr<Device> &device);
-		void submitSolutions(std::set<uint64_t> solutions, std::string challenge, std::string platformName, int const deviceEnum);
+		void traceLaunches(std::unique_ptr<Device> &device, cl_event *launchEvents, uint64_t *workPositions, std::chrono::steady_clock::time_point const launchStartTime);
+		void submitSolutions(std::set<uint64_t> solutions, std::string challenge, std::string platformName, int const deviceEnum, std::chrono::steady_clock::time_point const foundTime);
 
 		uint64_t const getNextWorkPosition(std::unique_ptr<Device> &device);
 		sponge_ut const getMidState(message_ut &newMessage);
@@ -85,39 +85,30 @@ namespace OpenCLSolver
 		return getSolutionTemplateCallback;
 	}
 
-	GetWorkPositionCallback SetOnGetWorkPositionHandler(openCLSolver *instance, GetWorkPositionCallback getWorkPositionCallback)
-	{
-		instance->m_getWorkPositionCallback = getWorkPositionCallback;
-		return getWorkPositionCallback;
-	}
-
-	ResetWorkPositionCallback SetOnResetWorkPositionHandler(openCLSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback)
+	SolutionCallback SetOnSolutionHandler(openCLSolver *instance, SolutionCallback solutionCallback)
 	{
-		instance->m_resetWorkPositionCallback = resetWorkPositionCallback;
-		return resetWorkPositionCallback;
+		instance->m_solutionCallback = solutionCallback;
+		return solutionCallback;
 	}
 
-	IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(openCLSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback)
+	void SetNoncePool(openCLSolver *instance, nonce_pool_t *noncePool)
 	{
-		instance->m_incrementWorkPositionCallback = incrementWorkPositionCallback;
-		return incrementWorkPositionCallback;
+		instance->setNoncePool(noncePool);
 	}
 
-	MessageCallback SetOnMessageHandler(openCLSolver *instance, MessageCallback messageCallback)
+	void SetSubmitStale(openCLSolver *instance, const bool submitStale)
 	{
-		instance->m_messageCallback = messageCallback;
-		return messageCallback;
+		instance->isSubmitStale = submitStale;
 	}
 
-	SolutionCallback SetOnSolutionHandler(openCLSolver *instance, SolutionCallback solutionCallback)
+	void SetTargetLaunchDuration(openCLSolver *instance, const uint32_t targetLaunchDuration)
 	{
-		instance->m_solutionCallback = solutionCallback;
-		return solutionCallback;
+		instance->targetLaunchDuration = targetLaunchDuration;
 	}
 
-	void SetSubmitStale(openCLSolver *instance, const bool submitStale)
+	void SetSimulation(openCLSolver *instance, const uint32_t launchLatency, const uint64_t hashRate, const uint32_t candidateRate)
 	{
-		instance->isSubmitStale = submitStale;
+		instance->simulation = simulation_settings_t{ launchLatency, hashRate, candidateRate };
 	}
 
 	void AssignDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, float *intensity, unsigned int *pciBusID, const char *deviceName, uint64_t *nameSize)
@@ -150,6 +141,32 @@ namespace OpenCLSolver
 		*hashRate = instance->getHashRateByDevice(platformName, deviceEnum);
 	}
 
+	void GetMetricsByDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, uint64_t *metrics)
+	{
+		instance->getMetricsByDevice(platformName, deviceEnum, metrics);
+	}
+
+	void SetTraceEnabled(openCLSolver *, const bool isEnabled) // tracing is process-wide
+	{
+		TraceBuffer::setEnabled(isEnabled);
+	}
+
+	void GetTraceEventsByDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, trace_event_t *events, const uint32_t maxCount, uint32_t *count)
+	{
+		*count = instance->getTraceEventsByDevice(platformName, deviceEnum, events, maxCount);
+	}
+
+	void SetLogLevel(openCLSolver *instance, const uint32_t level)
+	{
+		instance->m_log.setLevel((log_level_t)level);
+	}
+
+	void GetLogEntries(openCLSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount)
+	{
+		*count = instance->m_log.drain(entries, maxCount);
+		*droppedCount = instance->m_log.getDroppedCount();
+	}
+
 	void GetTotalHashRate(openCLSolver *instance, uint64_t *totalHashRate)
 	{
 		*totalHashRate = instance->getTotalHashRate();
@@ -170,6 +187,31 @@ namespace OpenCLSolver
 		instance->pauseFinding(pause);
 	}
 
+	void SetDeviceDutyCycle(openCLSolver *instance, const char *platformName, const int deviceEnum, const uint32_t dutyCycle)
+	{
+		instance->setDeviceDutyCycle(platformName, deviceEnum, dutyCycle);
+	}
+
+	void SetDeviceTuning(openCLSolver *instance, const char *platformName, const int deviceEnum, const float intensity, const uint32_t localWorkSize, bool *isFound)
+	{
+		*isFound = instance->setDeviceTuning(platformName, deviceEnum, intensity, localWorkSize);
+	}
+
+	void IsDeviceMining(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isMining)
+	{
+		*isMining = instance->isDeviceMining(platformName, deviceEnum);
+	}
+
+	void IsDevicePaused(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isPaused)
+	{
+		*isPaused = instance->isDevicePaused(platformName, deviceEnum);
+	}
+
+	void RestartDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isRestarted)
+	{
+		*isRestarted = instance->restartDevice(platformName, deviceEnum);
+	}
+
 	void StartFinding(openCLSolver *instance)
 	{
 		instance->startFinding();
@@ -35,17 +35,15 @@ namespace OpenCLSolver
 
 		EXPORT GetSolutionTemplateCallback __CDECL__ SetOnGetSolutionTemplateHandler(openCLSolver *instance, GetSolutionTemplateCallback getSolutionTemplateCallback);
 
-		EXPORT GetWorkPositionCallback __CDECL__ SetOnGetWorkPositionHandler(openCLSolver *instance, GetWorkPositionCallback getWorkPositionCallback);
-
-		EXPORT ResetWorkPositionCallback __CDECL__ SetOnResetWorkPositionHandler(openCLSolver *instance, ResetWorkPositionCallback resetWorkPositionCallback);
+		EXPORT SolutionCallback __CDECL__ SetOnSolutionHandler(openCLSolver *instance, SolutionCallback solutionCallback);
 
-		EXPORT IncrementWorkPositionCallback __CDECL__ SetOnIncrementWorkPositionHandler(openCLSolver *instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
+		EXPORT void __CDECL__ SetNoncePool(openCLSolver *instance, nonce_pool_t *noncePool);
 
-		EXPORT MessageCallback __CDECL__ SetOnMessageHandler(openCLSolver *instance, MessageCallback messageCallback);
+		EXPORT void __CDECL__ SetSubmitStale(openCLSolver *instance, const bool submitStale);
 
-		EXPORT SolutionCallback __CDECL__ SetOnSolutionHandler(openCLSolver *instance, SolutionCallback solutionCallback);
+		EXPORT void __CDECL__ SetTargetLaunchDuration(openCLSolver *instance, const uint32_t targetLaunchDuration);
 
-		EXPORT void __CDECL__ SetSubmitStale(openCLSolver *instance, const bool submitStale);
+		EXPORT void __CDECL__ SetSimulation(openCLSolver *instance, const uint32_t launchLatency, const uint64_t hashRate, const uint32_t candidateRate);
 
 		EXPORT void __CDECL__ AssignDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, float *intensity, unsigned int *pciBusID, const char *deviceName, uint64_t *nameSize);
 
@@ -59,6 +57,16 @@ namespace OpenCLSolver
 
 		EXPORT void __CDECL__ GetHashRateByDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, uint64_t *hashRate);
 
+		EXPORT void __CDECL__ GetMetricsByDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, uint64_t *metrics);
+
+		EXPORT void __CDECL__ SetTraceEnabled(openCLSolver *instance, const bool isEnabled);
+
+		EXPORT void __CDECL__ GetTraceEventsByDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, trace_event_t *events, const uint32_t maxCount, uint32_t *count);
+
+		EXPORT void __CDECL__ SetLogLevel(openCLSolver *instance, const uint32_t level);
+
+		EXPORT void __CDECL__ GetLogEntries(openCLSolver *instance, log_entry_t *entries, const uint32_t maxCount, uint32_t *count, uint64_t *droppedCount);
+
 		EXPORT void __CDECL__ GetTotalHashRate(openCLSolver *instance, uint64_t *totalHashRate);
 
 		EXPORT void __CDECL__ UpdatePrefix(openCLSolver *instance, const char *prefix);
@@ -67,6 +75,16 @@ namespace OpenCLSolver
 
 		EXPORT void __CDECL__ PauseFinding(openCLSolver *instance, const bool pause);
 
+		EXPORT void __CDECL__ SetDeviceDutyCycle(openCLSolver *instance, const char *platformName, const int deviceEnum, const uint32_t dutyCycle);
+
+		EXPORT void __CDECL__ SetDeviceTuning(openCLSolver *instance, const char *platformName, const int deviceEnum, const float intensity, const uint32_t localWorkSize, bool *isFound);
+
+		EXPORT void __CDECL__ IsDeviceMining(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isMining);
+
+		EXPORT void __CDECL__ IsDevicePaused(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isPaused);
+
+		EXPORT void __CDECL__ RestartDevice(openCLSolver *instance, const char *platformName, const int deviceEnum, bool *isRestarted);
+
 		EXPORT void __CDECL__ StartFinding(openCLSolver *instance);
 
 		EXPORT void __CDECL__ StopFinding(openCLSolver *instance);
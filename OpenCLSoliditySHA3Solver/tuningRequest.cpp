@@ -0,0 +1,29 @@
+#include "tuningRequest.h"
+
+namespace OpenCLSolver
+{
+	// --------------------------------------------------------------------
+	// Public
+	// --------------------------------------------------------------------
+
+	TuningRequest::TuningRequest() noexcept :
+		m_intensity{ 0.0f },
+		m_localWorkSize{ 0u }
+	{
+	}
+
+	void TuningRequest::request(float const intensity, uint32_t const localWorkSize)
+	{
+		if (localWorkSize > 0u) m_localWorkSize.store(localWorkSize);
+		if (intensity > 0.0f) m_intensity.store(intensity);
+	}
+
+	bool TuningRequest::take(float &intensity, uint32_t &localWorkSize)
+	{
+		if (m_intensity.load(std::memory_order_relaxed) == 0.0f && m_localWorkSize.load(std::memory_order_relaxed) == 0u) return false;
+
+		intensity = m_intensity.exchange(0.0f);
+		localWorkSize = m_localWorkSize.exchange(0u);
+		return intensity > 0.0f || localWorkSize > 0u;
+	}
+}
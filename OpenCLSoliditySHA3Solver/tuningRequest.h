@@ -0,0 +1,30 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef __TUNING_REQUEST__
+#define __TUNING_REQUEST__
+
+namespace OpenCLSolver
+{
+	// Intensity and local work size requested by host while mining, taken by the device loop at its next launch boundary
+	// so that a running device is retuned without being reinitialized.
+	class TuningRequest
+	{
+	private:
+		std::atomic<float> m_intensity; // 0 if not requested
+		std::atomic<uint32_t> m_localWorkSize; // 0 if not requested
+
+	public:
+		TuningRequest() noexcept;
+
+		// Zero keeps current value
+		void request(float const intensity, uint32_t const localWorkSize);
+
+		// To be called by device loop before each launch, returns false if nothing is requested
+		bool take(float &intensity, uint32_t &localWorkSize);
+	};
+}
+
+#endif // !__TUNING_REQUEST__
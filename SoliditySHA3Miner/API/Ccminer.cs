@@ -11,16 +11,20 @@ namespace SoliditySHA3Miner.API
     {
         private const string ALGO = "soliditysha3";
         private const string EMULATE_API_VERSION = "1.9";
-        private const string API_FORMAT = "Name={0};VER={1};API={2};ALGO={3};GPUS={4:D};KHS={5:F2};SOLV={6:D};ACC={7:D};REJ={8:D};ACCMN={9:F3};DIFF={10:F6};NETKHS={11:F0};POOLS={12:D};WAIT={13:D};UPTIME={14:F0};TS={15:D}|\r\n";
+        private const string API_FORMAT = "Name={0};VER={1};API={2};ALGO={3};GPUS={4:D};KHS={5:F2};SOLV={6:D};ACC={7:D};REJ={8:D};ACCMN={9:F3};DIFF={10:F6};NETKHS={11:F0};POOLS={12:D};WAIT={13:D};UPTIME={14:F0};";
+        private const string TIMESTAMP_FORMAT = "TS={0:D}|\r\n"; // appended per request, summary is sampled in background
+        private const string POOL_FORMAT = "POOL={0};ALGO={1};URL={2};USER={3};SOLV={4:D};ACC={5:D};REJ={6:D};DIFF={7:F6};PING={8:D};LAST={9:D};" +
+                                           "PARAM50={10:D};PARAM95={11:D};PARAM99={12:D};SUBMIT50={13:D};SUBMIT95={14:D};SUBMIT99={15:D};" +
+                                           "TX50={16:D};TX95={17:D};TX99={18:D};UPTIME={19:F0}|\r\n";
 
         private static Thread m_apiThread;
-        private static Miner.IMiner[] m_miners;
+        private static TelemetrySampler m_sampler;
         private static TcpListener m_currentListener;
         private static bool m_isRunning;
 
         private static uint GetUNIXCurrentTimestamp => (uint)(DateTime.UtcNow.Subtract(new DateTime(1970, 1, 1))).TotalSeconds;
 
-        public static void StartListening(string apiBind, params Miner.IMiner[] miners)
+        public static void StartListening(string apiBind, TelemetrySampler sampler)
         {
             if (m_apiThread != null
                 && (m_apiThread.ThreadState != ThreadState.Aborted || m_apiThread.ThreadState != ThreadState.Stopped)) return;
@@ -61,7 +65,7 @@ namespace SoliditySHA3Miner.API
                 return;
             }
 
-            m_miners = miners;
+            m_sampler = sampler;
 
             m_apiThread = new Thread(() => Listen(ipAddress, port))
             {
@@ -89,6 +93,47 @@ namespace SoliditySHA3Miner.API
             }
         }
         
+        internal static string GetSummaryResponse(Miner.IMiner[] miners)
+        {
+            var gpus = miners.SelectMany(m => m.Devices).Count(d => d.AllowDevice);
+            var khs = miners.Sum((m => (long)m.GetTotalHashrate())) / 1000.0M;
+            var solv = miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.SubmittedShares));
+            var rej = miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.RejectedShares));
+            var acc = solv - rej;
+            var uptime = (DateTime.Now - Program.LaunchTime).TotalSeconds;
+            var accmn = (60.0 * acc) / (uptime > 0.0 ? uptime : 1.0);
+            var diff = miners.Any() ? miners.Average(m => (long)m.NetworkInterface.Difficulty) : 0;
+            var netkhs = 0; // TODO: get network hashrate
+            var pools = miners.Select(m => m.NetworkInterface).OfType<NetworkInterface.PoolInterface>().Distinct().Count();
+            var wait = Program.WaitSeconds;
+
+            return string.Format(API_FORMAT,
+                                 Program.GetApplicationName(), Program.GetApplicationVersion(), EMULATE_API_VERSION, ALGO,
+                                 gpus, khs, solv, acc, rej, accmn, diff, netkhs, pools, wait, uptime);
+        }
+
+        internal static string GetPoolResponse(Miner.IMiner[] miners)
+        {
+            var networkInterface = miners.Select(m => m.NetworkInterface).FirstOrDefault(i => i != null);
+            if (networkInterface == null) return string.Empty;
+
+            var paramLatency = networkInterface.ParameterLatencyHistogram.GetSnapshot();
+            var submitLatency = networkInterface.SubmitLatencyHistogram.GetSnapshot();
+            var txLatency = networkInterface.BroadcastLatencyHistogram.GetSnapshot();
+
+            return string.Format(POOL_FORMAT,
+                                 networkInterface.IsPool ? "pool" : "solo", ALGO, networkInterface.SubmitURL, networkInterface.MinerAddress,
+                                 (long)networkInterface.SubmittedShares,
+                                 (long)(networkInterface.SubmittedShares - networkInterface.RejectedShares),
+                                 (long)networkInterface.RejectedShares,
+                                 (double)networkInterface.Difficulty,
+                                 networkInterface.Latency, networkInterface.LastSubmitLatency,
+                                 paramLatency.P50, paramLatency.P95, paramLatency.P99,
+                                 submitLatency.P50, submitLatency.P95, submitLatency.P99,
+                                 txLatency.P50, txLatency.P95, txLatency.P99,
+                                 (DateTime.Now - Program.LaunchTime).TotalSeconds);
+        }
+
         private static void Listen(IPAddress ipAddress, int port)
         {
             try
@@ -115,25 +160,14 @@ namespace SoliditySHA3Miner.API
                                                          Replace('\n'.ToString(), string.Empty);
 
                             var response = string.Empty;
-                            switch (request)
+                            switch (request) // pre-formatted by sampler
                             {
                                 case "summary":
-                                    var gpus = m_miners.SelectMany(m => m.Devices).Count(d => d.AllowDevice);
-                                    var khs = m_miners.Sum((m => (long)m.GetTotalHashrate())) / 1000.0M;
-                                    var solv = m_miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.SubmittedShares));
-                                    var rej = m_miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.RejectedShares));
-                                    var acc = solv - rej;
-                                    var uptime = (DateTime.Now - Program.LaunchTime).TotalSeconds;
-                                    var accmn = (60.0 * acc) / (uptime > 0.0 ? uptime : 1.0);
-                                    var diff = m_miners.Average(m => (long)m.NetworkInterface.Difficulty);
-                                    var netkhs = 0; // TODO: get network hashrate
-                                    var pools = m_miners.Select(m => m.NetworkInterface).OfType<NetworkInterface.PoolInterface>().Distinct().Count();
-                                    var wait = Program.WaitSeconds;
-                                    var ts = GetUNIXCurrentTimestamp;
-
-                                    response = string.Format(API_FORMAT,
-                                                             Program.GetApplicationName(), Program.GetApplicationVersion(), EMULATE_API_VERSION, ALGO,
-                                                             gpus, khs, solv, acc, rej, accmn, diff, netkhs, pools, wait, uptime, ts);
+                                    response = m_sampler.Snapshot.CcminerSummary + string.Format(TIMESTAMP_FORMAT, GetUNIXCurrentTimestamp);
+                                    break;
+
+                                case "pool":
+                                    response = m_sampler.Snapshot.CcminerPool;
                                     break;
                             }
                             stream.Write(Encoding.ASCII.GetBytes(response), 0, response.Length);
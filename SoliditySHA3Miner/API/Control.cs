@@ -0,0 +1,150 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.Linq;
+using System.Net;
+using System.Text;
+
+namespace SoliditySHA3Miner.API
+{
+    // Retunes running miners from 'POST /control' of JSON-API, authorized by 'Authorization: Bearer {minerControlToken}'.
+    // Request: { "devices": [{ "type", "platform" (OpenCL only), "deviceID", "intensity", "localWorkSize" }], "cpuIDs": [...] }
+    // Intensity and local work size (block size of CUDA) are taken by each device at its next launch, zero or missing keeps current value.
+    // Devices clamp intensity to their range, from log2 of local work size up to 32.
+    // CPU threads mine on exactly 'cpuIDs' from their next work chunk, by moving, disabling or adding threads.
+    public static class Control
+    {
+        public const string PATH = "/control";
+
+        private const float MAX_INTENSITY = 32.0f; // thread count (global work size) is counted in uint32, devices clamp further
+
+        public static bool IsAuthorized(HttpListenerRequest request, string token)
+        {
+            if (string.IsNullOrEmpty(token)) return false;
+
+            var authorization = request.Headers["Authorization"] ?? string.Empty;
+            if (!authorization.StartsWith("Bearer ", StringComparison.OrdinalIgnoreCase)) return false;
+
+            return IsTokenMatch(token, authorization.Substring("Bearer ".Length).Trim());
+        }
+
+        // Also used by proxy to authorize downstream miners
+        public static bool IsTokenMatch(string token, string candidate)
+        {
+            if (string.IsNullOrEmpty(token)) return false;
+
+            var expected = Encoding.UTF8.GetBytes(token);
+            var actual = Encoding.UTF8.GetBytes(candidate ?? string.Empty);
+
+            var difference = expected.Length ^ actual.Length; // compared in full, so time taken does not leak matching prefix
+            for (var i = 0; i < expected.Length; i++)
+                difference |= expected[i] ^ ((i < actual.Length) ? actual[i] : 0);
+
+            return difference == 0;
+        }
+
+        // Returns result of each change, isApplied is false if any change is rejected
+        public static JObject Apply(JObject request, Miner.IMiner[] miners, out bool isApplied)
+        {
+            isApplied = true;
+            var response = new JObject();
+
+            if (request["devices"] is JArray devices)
+            {
+                var deviceResults = new JArray();
+                foreach (var device in devices.OfType<JObject>())
+                {
+                    var result = ApplyDeviceTuning(device, miners);
+                    isApplied &= result.Value<bool>("applied");
+                    deviceResults.Add(result);
+                }
+                response["devices"] = deviceResults;
+            }
+
+            if (request["cpuIDs"] is JArray cpuIDs)
+            {
+                var result = ApplyCpuThreads(cpuIDs.Values<int>().ToArray(), miners);
+                isApplied &= result.Value<bool>("applied");
+                response["cpu"] = result;
+            }
+
+            if (!response.HasValues)
+            {
+                isApplied = false;
+                response["error"] = "Nothing to change, set 'devices' or 'cpuIDs'";
+            }
+            return response;
+        }
+
+        private static JObject ApplyDeviceTuning(JObject request, Miner.IMiner[] miners)
+        {
+            var type = request.Value<string>("type") ?? string.Empty;
+            var platform = request.Value<string>("platform");
+            var deviceID = request.Value<int?>("deviceID") ?? -1;
+            var intensity = request.Value<float?>("intensity") ?? 0.0f;
+            var localWorkSize = request.Value<uint?>("localWorkSize") ?? 0u;
+
+            var result = new JObject
+            {
+                ["type"] = type,
+                ["platform"] = platform,
+                ["deviceID"] = deviceID,
+                ["intensity"] = intensity,
+                ["localWorkSize"] = localWorkSize,
+                ["applied"] = false
+            };
+
+            var errorMessage = string.Empty;
+            var miner = miners.FirstOrDefault(m => m.Devices.Any(d => IsDevice(d, type, platform, deviceID)));
+
+            if (miner == null)
+                errorMessage = "Device not found";
+            else if (intensity < 0 || (intensity > 0 && intensity <= 1.0f) || intensity > MAX_INTENSITY)
+                errorMessage = string.Format("Intensity must be above 1 and up to {0}", MAX_INTENSITY);
+            else if (intensity > 0 && localWorkSize > 0 && intensity < Math.Log(localWorkSize, 2))
+                errorMessage = "Intensity must be at least log2 of local work size, to launch one work group";
+            else if (intensity == 0 && localWorkSize == 0)
+                errorMessage = "Nothing to change, set 'intensity' or 'localWorkSize'";
+            else
+            {
+                var device = miner.Devices.First(d => IsDevice(d, type, platform, deviceID));
+                if (miner.SetTuningByDevice(device.Platform, device.DeviceID, intensity, localWorkSize, out errorMessage))
+                {
+                    result["applied"] = true;
+                    Program.Print(string.Format("{0} [INFO] Device #{1} retune requested (intensity: {2}, local work size: {3})",
+                                                device.Type, device.DeviceID,
+                                                (intensity > 0) ? intensity.ToString() : "unchanged",
+                                                (localWorkSize > 0) ? localWorkSize.ToString() : "unchanged"));
+                }
+            }
+
+            if (!string.IsNullOrEmpty(errorMessage)) result["error"] = errorMessage;
+            return result;
+        }
+
+        private static JObject ApplyCpuThreads(int[] cpuIDs, Miner.IMiner[] miners)
+        {
+            var result = new JObject { ["cpuIDs"] = new JArray(cpuIDs), ["applied"] = false };
+
+            var cpuMiner = miners.OfType<Miner.CPU>().FirstOrDefault();
+            if (cpuMiner == null)
+                result["error"] = "CPU is not mining";
+            else if (cpuMiner.SetThreads(cpuIDs, out string errorMessage))
+            {
+                result["applied"] = true;
+                Program.Print(string.Format("CPU [INFO] Threads requested on CPU {0}", string.Join(",", cpuIDs)));
+            }
+            else
+                result["error"] = errorMessage;
+
+            return result;
+        }
+
+        private static bool IsDevice(Miner.Device device, string type, string platform, int deviceID)
+        {
+            return device.AllowDevice
+                && device.DeviceID == deviceID
+                && string.Equals(device.Type, type, StringComparison.OrdinalIgnoreCase)
+                && (string.IsNullOrEmpty(platform) || device.Platform == platform);
+        }
+    }
+}
@@ -1,5 +1,8 @@
-﻿using System;
+﻿using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Linq;
 using System.Net;
 using System.Net.Sockets;
@@ -12,11 +15,12 @@ namespace SoliditySHA3Miner.API
     {
         public bool IsSupported { get; }
 
-        private Miner.IMiner[] m_miners;
+        private TelemetrySampler m_sampler;
+        private string m_controlToken;
         private HttpListener m_Listener;
         private bool m_isOngoing;
 
-        public Json(params Miner.IMiner[] miners)
+        public Json(TelemetrySampler sampler, string controlToken)
         {
             IsSupported = HttpListener.IsSupported;
             if (!IsSupported)
@@ -24,7 +28,8 @@ namespace SoliditySHA3Miner.API
                 Program.Print("[ERROR] Obsolete OS detected, JSON-API will not start.");
                 return;
             }
-            m_miners = miners;
+            m_sampler = sampler;
+            m_controlToken = controlToken;
         }
 
         public void Start(string apiBind)
@@ -128,68 +133,34 @@ namespace SoliditySHA3Miner.API
                 {
                     response.AppendHeader("Pragma", "no-cache");
                     response.AppendHeader("Expires", "0");
-                    response.ContentType = "application/json";
                     response.StatusCode = (int)HttpStatusCode.OK;
 
-                    ProcessApiDataResponse(response);
+                    if (context.Request.Url.AbsolutePath.TrimEnd('/').Equals("/metrics", StringComparison.OrdinalIgnoreCase))
+                    {
+                        response.ContentType = Metrics.CONTENT_TYPE;
+                        ProcessApiDataResponse(response, () => Encoding.UTF8.GetBytes(m_sampler.Snapshot.MetricsResponse));
+                    }
+                    else if (context.Request.Url.AbsolutePath.TrimEnd('/').Equals(Control.PATH, StringComparison.OrdinalIgnoreCase))
+                    {
+                        response.ContentType = "application/json";
+                        ProcessApiDataResponse(response, () => GetControlResponse(context.Request, response));
+                    }
+                    else
+                    {
+                        response.ContentType = "application/json";
+                        ProcessApiDataResponse(response, () => m_sampler.Snapshot.JsonResponse);
+                    }
                 }
             }
         }
 
-        private void ProcessApiDataResponse(HttpListenerResponse response)
+        private void ProcessApiDataResponse(HttpListenerResponse response, Func<byte[]> getBuffer)
         {
             Task.Factory.StartNew(() =>
             {
                 try
                 {
-                    double divisor = 1;
-                    var api = new JsonAPI();
-
-                    PopulateCommonApiData(ref api, ref divisor);
-
-                    foreach (var miner in m_miners)
-                    {
-                        foreach (var device in miner.Devices.Where(d => d.AllowDevice))
-                        {
-                            if (miner.HasMonitoringAPI)
-                            {
-                                switch (device.Type)
-                                {
-                                    case "CUDA":
-                                        JsonAPI.CUDA_Miner cudaMiner = null;
-                                        PopulateCudaApiData((Miner.CUDA)miner, device, divisor, ref cudaMiner);
-                                        if (cudaMiner != null) api.Miners.Add(cudaMiner);
-                                        break;
-
-                                    case "OpenCL":
-                                        JsonAPI.AMD_Miner amdMiner = null;
-                                        PopulateAmdApiData((Miner.OpenCL)miner, device, divisor, ref amdMiner);
-                                        if (amdMiner != null) api.Miners.Add(amdMiner);
-                                        break;
-                                }
-                            }
-                            else
-                            {
-                                switch (device.Type)
-                                {
-                                    case "OpenCL":
-                                        JsonAPI.OpenCLMiner openClMiner = null;
-                                        PopulateOpenCLApiData((Miner.OpenCL)miner, device, divisor, ref openClMiner);
-                                        if (openClMiner != null) api.Miners.Add(openClMiner);
-                                        break;
-
-                                    default:
-                                        JsonAPI.Miner cpuMiner = null;
-                                        PopulateCpuApiData((Miner.CPU)miner, device, divisor, ref cpuMiner);
-                                        if (cpuMiner != null) api.Miners.Add(cpuMiner);
-                                        break;
-                                }
-                            }
-                        }
-                    }
-                    api.Miners.Sort((x, y) => x.PciBusID.CompareTo(y.PciBusID));
-
-                    byte[] buffer = Encoding.UTF8.GetBytes(Utils.Json.SerializeFromObject(api, Utils.Json.BaseClassFirstSettings));
+                    var buffer = getBuffer(); // pre-serialized by sampler
 
                     using (var output = response.OutputStream)
                     {
@@ -235,11 +206,105 @@ namespace SoliditySHA3Miner.API
                         Program.Print(string.Format("[ERROR] {0}", errorMessage));
                     }
                 }
-            },
-            TaskCreationOptions.LongRunning);
+            });
+        }
+
+        // Applied on request, never sampled, status code is set before body is written
+        private byte[] GetControlResponse(HttpListenerRequest request, HttpListenerResponse response)
+        {
+            var result = new JObject();
+
+            if (string.IsNullOrEmpty(m_controlToken))
+            {
+                response.StatusCode = (int)HttpStatusCode.Forbidden;
+                result["error"] = "Control is disabled, set 'minerControlToken' to enable";
+            }
+            else if (!Control.IsAuthorized(request, m_controlToken))
+            {
+                response.StatusCode = (int)HttpStatusCode.Unauthorized;
+                response.AppendHeader("WWW-Authenticate", "Bearer");
+                result["error"] = "Unauthorized";
+                Program.Print(string.Format("[WARN] JSON-API control request from {0} is unauthorized.", request.RemoteEndPoint));
+            }
+            else if (request.HttpMethod != "POST")
+            {
+                response.StatusCode = (int)HttpStatusCode.MethodNotAllowed;
+                result["error"] = "Use POST";
+            }
+            else
+            {
+                try
+                {
+                    string body;
+                    using (var reader = new StreamReader(request.InputStream, request.ContentEncoding))
+                        body = reader.ReadToEnd();
+
+                    result = Control.Apply(JObject.Parse(body), m_sampler.Miners, out bool isApplied);
+                    if (!isApplied) response.StatusCode = (int)HttpStatusCode.BadRequest;
+                }
+                catch (Exception ex) when (ex is JsonException || ex is FormatException || ex is InvalidCastException)
+                {
+                    response.StatusCode = (int)HttpStatusCode.BadRequest;
+                    result["error"] = "Invalid request: " + ex.Message;
+                }
+            }
+            return Encoding.UTF8.GetBytes(result.ToString(Formatting.None));
+        }
+
+        // Queries all devices (including sensors), to be called by sampler only
+        internal static byte[] GetApiDataResponse(Miner.IMiner[] miners)
+        {
+            double divisor = 1;
+            var api = new JsonAPI();
+
+            PopulateCommonApiData(miners, ref api, ref divisor);
+
+            foreach (var miner in miners)
+            {
+                foreach (var device in miner.Devices.Where(d => d.AllowDevice))
+                {
+                    if (miner.HasMonitoringAPI)
+                    {
+                        switch (device.Type)
+                        {
+                            case "CUDA":
+                                JsonAPI.CUDA_Miner cudaMiner = null;
+                                PopulateCudaApiData((Miner.CUDA)miner, device, divisor, ref cudaMiner);
+                                if (cudaMiner != null) api.Miners.Add(cudaMiner);
+                                break;
+
+                            case "OpenCL":
+                                JsonAPI.AMD_Miner amdMiner = null;
+                                PopulateAmdApiData((Miner.OpenCL)miner, device, divisor, ref amdMiner);
+                                if (amdMiner != null) api.Miners.Add(amdMiner);
+                                break;
+                        }
+                    }
+                    else
+                    {
+                        switch (device.Type)
+                        {
+                            case "OpenCL":
+                                JsonAPI.OpenCLMiner openClMiner = null;
+                                PopulateOpenCLApiData((Miner.OpenCL)miner, device, divisor, ref openClMiner);
+                                if (openClMiner != null) api.Miners.Add(openClMiner);
+                                break;
+
+                            default:
+                                JsonAPI.Miner cpuMiner = null;
+                                PopulateCpuApiData((Miner.CPU)miner, device, divisor, ref cpuMiner);
+                                if (cpuMiner != null) api.Miners.Add(cpuMiner);
+                                break;
+                        }
+                    }
+                }
+            }
+            api.Miners.Sort((x, y) => x.PciBusID.CompareTo(y.PciBusID));
+
+            return Encoding.UTF8.GetBytes(Utils.Json.SerializeFromObject(api, Utils.Json.BaseClassFirstSettings));
         }
 
-        private void GetHashRateUnit(ulong hashrate, ref double divisor, ref string unit)
+        private static void GetHashRateUnit(ulong hashrate, ref double divisor, ref string unit)
         {
             var sHashrate = hashrate.ToString();
             if (sHashrate.Length > 12 + 1)
@@ -264,16 +329,16 @@ namespace SoliditySHA3Miner.API
             }
         }
 
-        private void PopulateCommonApiData(ref JsonAPI api, ref double divisor)
+        private static void PopulateCommonApiData(Miner.IMiner[] miners, ref JsonAPI api, ref double divisor)
         {
             try
             {
-                var networkInterface = m_miners.Select(m => m.NetworkInterface).FirstOrDefault(m => m != null);
+                var networkInterface = miners.Select(m => m.NetworkInterface).FirstOrDefault(m => m != null);
 
                 ulong totalHashRate = 0ul;
                 var hashRateUnit = string.Empty;
 
-                foreach (var miner in m_miners)
+                foreach (var miner in miners)
                     totalHashRate += miner.GetTotalHashrate();
 
                 if (totalHashRate > 0)
@@ -304,11 +369,17 @@ namespace SoliditySHA3Miner.API
 
                 api.LatencyMS = networkInterface?.Latency ?? -1;
 
+                api.ParameterLatencyMS = networkInterface?.ParameterLatencyHistogram.GetSnapshot();
+
+                api.SubmitLatencyMS = networkInterface?.SubmitLatencyHistogram.GetSnapshot();
+
+                api.BroadcastLatencyMS = networkInterface?.BroadcastLatencyHistogram.GetSnapshot();
+
                 api.Uptime = (long)(DateTime.Now - Program.LaunchTime).TotalSeconds;
 
-                api.RejectedShares = m_miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.RejectedShares));
+                api.RejectedShares = miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.RejectedShares));
 
-                api.AcceptedShares = m_miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.SubmittedShares)) - api.RejectedShares;
+                api.AcceptedShares = miners.Select(m => m.NetworkInterface).Distinct().Sum(i => (long)(i.SubmittedShares)) - api.RejectedShares;
             }
             catch (Exception ex)
             {
@@ -325,7 +396,7 @@ namespace SoliditySHA3Miner.API
             }
         }
 
-        private void PopulateCudaApiData(Miner.CUDA miner, Miner.Device device, double divisor, ref JsonAPI.CUDA_Miner cudaMiner)
+        private static void PopulateCudaApiData(Miner.CUDA miner, Miner.Device device, double divisor, ref JsonAPI.CUDA_Miner cudaMiner)
         {
             try
             {
@@ -426,7 +497,7 @@ namespace SoliditySHA3Miner.API
             }
         }
 
-        private void PopulateAmdApiData(Miner.OpenCL miner, Miner.Device device, double divisor, ref JsonAPI.AMD_Miner amdMiner)
+        private static void PopulateAmdApiData(Miner.OpenCL miner, Miner.Device device, double divisor, ref JsonAPI.AMD_Miner amdMiner)
         {
             try
             {
@@ -464,7 +535,7 @@ namespace SoliditySHA3Miner.API
 
                     amdMiner.CurrentCoreClockMHz = Miner.API.AmdLinuxQuery.GetDeviceCurrentCoreClock(device.PciBusID);
 
-                    amdMiner.CurrentMemoryClockMHz = Miner.API.AmdLinuxQuery.GetDeviceCurrentCoreClock(device.PciBusID);
+                    amdMiner.CurrentMemoryClockMHz = Miner.API.AmdLinuxQuery.GetDeviceCurrentMemoryClock(device.PciBusID);
 
                     amdMiner.CurrentUtilizationPercent = Miner.API.AmdLinuxQuery.GetDeviceCurrentUtilizationPercent(device.PciBusID);
                 }
@@ -516,7 +587,7 @@ namespace SoliditySHA3Miner.API
             }
         }
 
-        private void PopulateOpenCLApiData(Miner.OpenCL miner, Miner.Device device, double divisor, ref JsonAPI.OpenCLMiner openCLMiner)
+        private static void PopulateOpenCLApiData(Miner.OpenCL miner, Miner.Device device, double divisor, ref JsonAPI.OpenCLMiner openCLMiner)
         {
             try
             {
@@ -547,7 +618,7 @@ namespace SoliditySHA3Miner.API
             }
         }
 
-        private void PopulateCpuApiData(Miner.CPU miner, Miner.Device device, double divisor, ref JsonAPI.Miner cpuMiner)
+        private static void PopulateCpuApiData(Miner.CPU miner, Miner.Device device, double divisor, ref JsonAPI.Miner cpuMiner)
         {
             try
             {
@@ -597,6 +668,9 @@ namespace SoliditySHA3Miner.API
             public string HashRateUnit { get; set; }
             public int LastSubmitLatencyMS { get; set; }
             public int LatencyMS { get; set; }
+            public Utils.LatencyHistogram.Snapshot ParameterLatencyMS { get; set; }
+            public Utils.LatencyHistogram.Snapshot SubmitLatencyMS { get; set; }
+            public Utils.LatencyHistogram.Snapshot BroadcastLatencyMS { get; set; }
             public long Uptime { get; set; }
             public long AcceptedShares { get; set; }
             public long RejectedShares { get; set; }
@@ -0,0 +1,168 @@
+﻿using System;
+using System.Globalization;
+using System.Linq;
+using System.Text;
+
+namespace SoliditySHA3Miner.API
+{
+    // Prometheus text exposition (version 0.0.4) of solver and network counters, served at '/metrics' of the JSON-API
+    public static class Metrics
+    {
+        public const string CONTENT_TYPE = "text/plain; version=0.0.4";
+
+        private const string PREFIX = "soliditysha3miner_";
+
+        // Queries all devices, to be called by sampler only
+        internal static string GetMetricsResponse(Miner.IMiner[] miners)
+        {
+            var response = new StringBuilder();
+
+            AppendMetric(response, "uptime_seconds", "gauge", "Seconds since miner launched.",
+                         string.Empty, (DateTime.Now - Program.LaunchTime).TotalSeconds);
+
+            AppendDeviceMetrics(response, miners);
+
+            AppendMetric(response, "nonces_reserved_total", "counter", "Nonces reserved by all solvers from the shared nonce pool.",
+                         string.Empty, Miner.Work.GetPosition());
+            AppendMetric(response, "nonces_abandoned_total", "counter", "Reserved nonces left unhashed when the challenge changed.",
+                         string.Empty, Miner.Work.GetAbandonedCount());
+
+            AppendNetworkMetrics(response, miners);
+
+            return response.ToString();
+        }
+
+        private static void AppendDeviceMetrics(StringBuilder response, Miner.IMiner[] miners)
+        {
+            var devices = miners.SelectMany(miner => miner.Devices.Where(d => d.AllowDevice).
+                                                                  Select(d => new { Miner = miner, Device = d })).
+                                 ToArray();
+
+            var metrics = devices.Select(d => new
+            {
+                Labels = string.Format("type=\"{0}\",platform=\"{1}\",device=\"{2}\",name=\"{3}\"",
+                                       Escape(d.Device.Type), Escape(d.Device.Platform), d.Device.DeviceID, Escape(d.Device.Name)),
+                Hashrate = d.Miner.GetHashrateByDevice(d.Device.Platform, d.Device.DeviceID),
+                Solver = d.Miner.GetMetricsByDevice(d.Device.Platform, d.Device.DeviceID)
+            }).ToArray();
+
+            AppendHeader(response, "device_hashrate", "gauge", "Current hashrate of device (or CPU thread) in H/s.");
+            foreach (var device in metrics)
+                AppendValue(response, "device_hashrate", device.Labels, device.Hashrate);
+
+            AppendHeader(response, "device_launch_duration_seconds", "histogram", "Duration of each kernel launch (work chunk on CPU, launch batch on OpenCL).");
+            foreach (var device in metrics)
+                AppendHistogram(response, "device_launch_duration_seconds", device.Labels, device.Solver.LaunchDuration);
+
+            AppendHeader(response, "device_challenge_switch_seconds", "histogram", "Time from a new challenge arriving (aborting in-flight launches) to the device relaunching on it.");
+            foreach (var device in metrics)
+                AppendHistogram(response, "device_challenge_switch_seconds", device.Labels, device.Solver.ChallengeSwitch);
+
+            AppendHeader(response, "device_solution_latency_seconds", "histogram", "Time from a candidate solution found to it handed to the network interface.");
+            foreach (var device in metrics)
+                AppendHistogram(response, "device_solution_latency_seconds", device.Labels, device.Solver.SolutionLatency);
+
+            AppendHeader(response, "device_solution_verify_seconds", "histogram", "Time for host to verify each candidate solution, valid or not.");
+            foreach (var device in metrics)
+                AppendHistogram(response, "device_solution_verify_seconds", device.Labels, device.Solver.SolutionVerify);
+
+            AppendHeader(response, "device_work_positions_allocated_total", "counter", "Nonces allocated to device from the shared nonce pool.");
+            foreach (var device in metrics)
+                AppendValue(response, "device_work_positions_allocated_total", device.Labels, device.Solver.PositionsAllocated);
+
+            AppendHeader(response, "device_hashes_completed_total", "counter", "Nonces hashed by kernel launches that were not aborted.");
+            foreach (var device in metrics)
+                AppendValue(response, "device_hashes_completed_total", device.Labels, device.Solver.HashesCompleted);
+
+            AppendHeader(response, "device_launches_aborted_total", "counter", "Kernel launches cut short by a new challenge.");
+            foreach (var device in metrics)
+                AppendValue(response, "device_launches_aborted_total", device.Labels, device.Solver.LaunchesAborted);
+
+            AppendHeader(response, "device_restarts_total", "counter", "Device torn down and re-initialized by watchdog while others kept mining.");
+            foreach (var device in metrics)
+                AppendValue(response, "device_restarts_total", device.Labels, device.Solver.Restarts);
+        }
+
+        private static void AppendNetworkMetrics(StringBuilder response, Miner.IMiner[] miners)
+        {
+            var networkInterfaces = miners.Select(m => m.NetworkInterface).Where(n => n != null).Distinct().ToArray();
+            if (!networkInterfaces.Any()) return;
+
+            AppendMetric(response, "shares_submitted_total", "counter", "Shares (or solutions) submitted.",
+                         string.Empty, networkInterfaces.Sum(n => (double)n.SubmittedShares));
+            AppendMetric(response, "shares_rejected_total", "counter", "Submitted shares (or solutions) rejected.",
+                         string.Empty, networkInterfaces.Sum(n => (double)n.RejectedShares));
+            AppendMetric(response, "shares_stale_total", "counter", "Shares (or solutions) of a previous challenge, submitted or cancelled.",
+                         string.Empty, networkInterfaces.Sum(n => (double)n.StaleShares));
+            AppendMetric(response, "shares_dropped_total", "counter", "Shares (or solutions) given up on after failed submissions.",
+                         string.Empty, networkInterfaces.Sum(n => (double)n.DroppedShares));
+
+            var networkInterface = networkInterfaces.First();
+            var labels = string.Format("url=\"{0}\"", Escape(networkInterface.SubmitURL));
+
+            AppendSummary(response, "submit_latency_seconds", "Round-trip time of share (or transaction) submissions.",
+                          labels, networkInterface.SubmitLatencyHistogram);
+            AppendSummary(response, "parameter_latency_seconds", "Round-trip time of mining parameter requests.",
+                          labels, networkInterface.ParameterLatencyHistogram);
+            AppendSummary(response, "broadcast_latency_seconds", "Time to first acknowledgement of a broadcast transaction.",
+                          labels, networkInterface.BroadcastLatencyHistogram);
+        }
+
+        private static void AppendMetric(StringBuilder response, string name, string type, string help, string labels, double value)
+        {
+            AppendHeader(response, name, type, help);
+            AppendValue(response, name, labels, value);
+        }
+
+        private static void AppendHeader(StringBuilder response, string name, string type, string help)
+        {
+            response.AppendFormat("# HELP {0}{1} {2}\n", PREFIX, name, help);
+            response.AppendFormat("# TYPE {0}{1} {2}\n", PREFIX, name, type);
+        }
+
+        private static void AppendValue(StringBuilder response, string name, string labels, double value)
+        {
+            response.Append(PREFIX).Append(name);
+            if (!string.IsNullOrEmpty(labels)) response.Append('{').Append(labels).Append('}');
+            response.Append(' ').Append(value.ToString(CultureInfo.InvariantCulture)).Append('\n');
+        }
+
+        // Native buckets are not cumulative, bucket i holds durations up to 2^i microseconds and the last one holds the rest
+        private static void AppendHistogram(StringBuilder response, string name, string labels, Miner.SolverMetrics.DurationHistogram histogram)
+        {
+            var cumulativeCount = 0ul;
+            for (var i = 0; i < Miner.SolverMetrics.HISTOGRAM_BUCKET_COUNT - 1; i++)
+            {
+                cumulativeCount += histogram.Buckets[i];
+                var upperBound = (double)(1ul << i) / 1000000;
+
+                AppendValue(response, name + "_bucket",
+                            string.Format("{0},le=\"{1}\"", labels, upperBound.ToString(CultureInfo.InvariantCulture)), cumulativeCount);
+            }
+            AppendValue(response, name + "_bucket", labels + ",le=\"+Inf\"", histogram.Count);
+            AppendValue(response, name + "_sum", labels, (double)histogram.SumMicroseconds / 1000000);
+            AppendValue(response, name + "_count", labels, histogram.Count);
+        }
+
+        // Latency histograms keep a window of recent samples, exported as summary of their percentiles
+        private static void AppendSummary(StringBuilder response, string name, string help, string labels, Utils.LatencyHistogram histogram)
+        {
+            var snapshot = histogram.GetSnapshot();
+
+            AppendHeader(response, name, "summary", help);
+            if (snapshot.Count > 0)
+            {
+                AppendValue(response, name, labels + ",quantile=\"0.5\"", (double)snapshot.P50 / 1000);
+                AppendValue(response, name, labels + ",quantile=\"0.95\"", (double)snapshot.P95 / 1000);
+                AppendValue(response, name, labels + ",quantile=\"0.99\"", (double)snapshot.P99 / 1000);
+            }
+            AppendValue(response, name + "_sum", labels, (double)histogram.Sum / 1000);
+            AppendValue(response, name + "_count", labels, snapshot.Count);
+        }
+
+        private static string Escape(string labelValue)
+        {
+            return (labelValue ?? string.Empty).Replace("\\", "\\\\").Replace("\"", "\\\"").Replace("\n", "\\n");
+        }
+    }
+}
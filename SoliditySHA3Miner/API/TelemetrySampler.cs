@@ -0,0 +1,71 @@
+﻿using System;
+using System.Timers;
+
+namespace SoliditySHA3Miner.API
+{
+    // Samples miners and device sensors in background, so API requests are served from the last snapshot
+    // without launching 'nvidia-smi' or walking sysfs per request
+    public class TelemetrySampler : IDisposable
+    {
+        private readonly Miner.IMiner[] m_miners;
+        private readonly Timer m_sampleTimer;
+        private int m_isSampling; // set by one timer callback at a time, sampling may outlast the interval
+
+        public TelemetrySnapshot Snapshot { get; private set; }
+
+        public Miner.IMiner[] Miners => m_miners;
+
+        public TelemetrySampler(int sampleInterval, params Miner.IMiner[] miners)
+        {
+            m_miners = miners;
+            Snapshot = new TelemetrySnapshot(new byte[] { }, string.Empty, string.Empty, string.Empty);
+
+            Sample();
+
+            m_sampleTimer = new Timer(Math.Max(sampleInterval, 100));
+            m_sampleTimer.Elapsed += (sender, e) => Sample();
+            m_sampleTimer.Start();
+        }
+
+        public void Dispose()
+        {
+            m_sampleTimer.Stop();
+            m_sampleTimer.Dispose();
+        }
+
+        private void Sample()
+        {
+            if (System.Threading.Interlocked.CompareExchange(ref m_isSampling, 1, 0) != 0) return; // slow sensors, skip rather than queue up
+            try
+            {
+                Snapshot = new TelemetrySnapshot(Json.GetApiDataResponse(m_miners),
+                                        Ccminer.GetSummaryResponse(m_miners),
+                                        Ccminer.GetPoolResponse(m_miners),
+                                        Metrics.GetMetricsResponse(m_miners));
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to sample API data: {0}", ex.Message));
+            }
+            finally { System.Threading.Interlocked.Exchange(ref m_isSampling, 0); }
+        }
+    }
+
+    public class TelemetrySnapshot
+    {
+        public DateTime SampleDateTime { get; }
+        public byte[] JsonResponse { get; }
+        public string CcminerSummary { get; }
+        public string CcminerPool { get; }
+        public string MetricsResponse { get; }
+
+        public TelemetrySnapshot(byte[] jsonResponse, string ccminerSummary, string ccminerPool, string metricsResponse)
+        {
+            SampleDateTime = DateTime.Now;
+            JsonResponse = jsonResponse;
+            CcminerSummary = ccminerSummary;
+            CcminerPool = ccminerPool;
+            MetricsResponse = metricsResponse;
+        }
+    }
+}
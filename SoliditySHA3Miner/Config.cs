@@ -11,7 +11,12 @@ namespace SoliditySHA3Miner
         public bool isLogFile { get; set; }
         public string minerJsonAPI { get; set; }
         public string minerCcminerAPI { get; set; }
+        public int apiSampleInterval { get; set; }
+        public string minerControlToken { get; set; }
         public string web3api { get; set; }
+        public string web3Subscription { get; set; }
+        public string[] web3BroadcastApis { get; set; }
+        public bool watchPendingMints { get; set; }
         public string contractAddress { get; set; }
         public string abiFile { get; set; }
         public HexBigInteger overrideMaxTarget { get; set; }
@@ -25,6 +30,11 @@ namespace SoliditySHA3Miner
         public string minerAddress { get; set; }
         public string primaryPool { get; set; }
         public string secondaryPool { get; set; }
+        public string proxy { get; set; }
+        public string proxyListen { get; set; }
+        public string proxyToken { get; set; }
+        public string poolStub { get; set; }
+        public string traceFile { get; set; }
         public string privateKey { get; set; }
         public float gasToMine { get; set; }
         public ulong gasLimit { get; set; }
@@ -40,13 +50,37 @@ namespace SoliditySHA3Miner
         public Miner.Device[] amdDevices { get; set; }
         public bool allowCUDA { get; set; }
         public Miner.Device[] cudaDevices { get; set; }
+        public int targetLaunchDuration { get; set; }
+        public int simulatedDevices { get; set; }
+        public uint simulatedLatency { get; set; }
+        public ulong simulatedHashrate { get; set; }
+        public uint simulatedCandidateRate { get; set; }
+        public bool benchmark { get; set; }
+        public string benchmarkDifficulty { get; set; }
+        public int benchmarkDuration { get; set; }
+        public ulong benchmarkHashes { get; set; }
+        public string benchmarkFile { get; set; }
+        public string recordJobs { get; set; }
+        public string replayJobs { get; set; }
+        public float replaySpeed { get; set; }
+        public ulong solutionSeed { get; set; }
+        public int targetTemperature { get; set; }
+        public int maxTemperature { get; set; }
+        public int targetPower { get; set; }
+        public int thermalInterval { get; set; }
+        public int watchdogTimeout { get; set; }
 
         public Config() // set defaults
         {
             isLogFile = false;
             minerJsonAPI = Defaults.JsonAPIPath;
             minerCcminerAPI = Defaults.CcminerAPIPath;
+            apiSampleInterval = Defaults.ApiSampleInterval;
+            minerControlToken = string.Empty;
             web3api= Defaults.InfuraAPI_mainnet;
+            web3Subscription = string.Empty;
+            web3BroadcastApis = new string[] { };
+            watchPendingMints = false;
             contractAddress = Defaults.Contract0xBTC_mainnet;
             abiFile = Defaults.AbiFile0xBTC;
             overrideMaxTarget = new HexBigInteger(BigInteger.Zero);
@@ -54,12 +88,18 @@ namespace SoliditySHA3Miner
             submitStale = Defaults.SubmitStale;
             maxScanRetry = Defaults.MaxScanRetry;
             pauseOnFailedScans = Defaults.PauseOnFailedScan;
+            targetLaunchDuration = Defaults.TargetLaunchDuration;
             networkUpdateInterval = Defaults.NetworkUpdateInterval;
             hashrateUpdateInterval = Defaults.HashrateUpdateInterval;
             kingAddress = string.Empty;
             minerAddress = string.Empty;
             primaryPool = string.Empty;
             secondaryPool = string.Empty;
+            proxy = string.Empty;
+            proxyListen = string.Empty;
+            proxyToken = string.Empty;
+            poolStub = string.Empty;
+            traceFile = string.Empty;
             privateKey = string.Empty;
             gasToMine = Defaults.GasToMine;
             gasLimit = Defaults.GasLimit;
@@ -71,6 +111,24 @@ namespace SoliditySHA3Miner
             amdDevices = new Miner.Device[] { };
             allowCUDA = true;
             cudaDevices = new Miner.Device[] { };
+            simulatedDevices = 0;
+            simulatedLatency = Defaults.SimulatedLatency;
+            simulatedHashrate = Defaults.SimulatedHashrate;
+            simulatedCandidateRate = 0u;
+            benchmark = false;
+            benchmarkDifficulty = Defaults.BenchmarkDifficulty;
+            benchmarkDuration = Defaults.BenchmarkDuration;
+            benchmarkHashes = 0ul;
+            benchmarkFile = Defaults.BenchmarkFile;
+            recordJobs = string.Empty;
+            replayJobs = string.Empty;
+            replaySpeed = Defaults.ReplaySpeed;
+            solutionSeed = 0ul;
+            targetTemperature = 0;
+            maxTemperature = 0;
+            targetPower = 0;
+            thermalInterval = Defaults.ThermalInterval;
+            watchdogTimeout = Defaults.WatchdogTimeout;
         }
 
         private static void PrintHelp()
@@ -91,8 +149,34 @@ namespace SoliditySHA3Miner
                 "  listCudaDevices         List of all CUDA devices in this system and exit (device ID: GPU name)\n" +
                 "  cudaDevice              Comma separated list of CUDA devices to use (default: all devices)\n" +
                 "  cudaIntensity           GPU (CUDA) intensity (default: auto, decimals allowed)\n" +
+                "  targetLaunchDuration    Target duration (miliseconds) of each kernel launch (or CPU work chunk), adapts intensity\n" +
+                "                          to measured launch times, e.g. 50 to 200 (default: " + Defaults.TargetLaunchDuration + ", fixed intensity)\n" +
+                "  simulatedDevices        Number of simulated OpenCL devices hashing on CPU threads, to run the OpenCL pipeline without a GPU (CUDA is not simulated) (default: 0)\n" +
+                "  simulatedLatency        Latency (microseconds) added to each launch of simulated devices (default: " + Defaults.SimulatedLatency + ")\n" +
+                "  simulatedHashrate       Hashrate (H/s) each simulated device is throttled to (default: " + Defaults.SimulatedHashrate + ", CPU speed)\n" +
+                "  simulatedCandidateRate  Invalid candidates per second injected by each simulated device, to stress verification and submission (default: 0)\n" +
+                "  benchmark               Mine offline on synthetic jobs, then save a report of each device and exit (default: false)\n" +
+                "                          Jobs switch on every 'networkUpdateInterval', config file is not updated\n" +
+                "  benchmarkDifficulty     'easy' (candidates to verify), 'hard' (no candidate) or a number (default: " + Defaults.BenchmarkDifficulty + ")\n" +
+                "  benchmarkDuration       Seconds to measure in benchmark, after warm-up of up to 10 seconds (default: " + Defaults.BenchmarkDuration + ")\n" +
+                "  benchmarkHashes         Hashes to measure in benchmark instead of 'benchmarkDuration' (default: 0, use duration)\n" +
+                "  benchmarkFile           JSON report of benchmark (default: '" + Defaults.BenchmarkFile + "' in the same folder as this miner)\n" +
+                "  recordJobs              Records jobs received from pool, web3 or proxy with their time to this file, for 'replayJobs' (default: none)\n" +
+                "  replayJobs              Mine offline on jobs recorded by 'recordJobs' in this file, then exit (default: none)\n" +
+                "  replaySpeed             Speed of 'replayJobs' relative to recording, e.g. 10 to replay 10 times faster (default: " + Defaults.ReplaySpeed + ")\n" +
+                "  solutionSeed            Seed of solution template, non-zero to mine the same nonces on every run (default: 0, random)\n" +
+                "  targetTemperature       Temperature (C) to hold each GPU at by mining only part of the time (duty cycle) (default: 0, disabled)\n" +
+                "  maxTemperature          Temperature (C) to pause a GPU at, until cooled below 'targetTemperature' (default: 0, disabled)\n" +
+                "  targetPower             Power draw (W) to hold each GPU at by duty cycle, read from 'nvidia-smi' or amdgpu sysfs (default: 0, disabled)\n" +
+                "  thermalInterval         Interval (miliseconds) to read sensors and adjust duty cycle of GPUs (default: " + Defaults.ThermalInterval + ")\n" +
+                "  watchdogTimeout         Time (miliseconds) a GPU may stall or hash nothing before it alone is restarted, also restarts\n" +
+                "                          a GPU stopped on error, 0 to exit miner on error instead (default: " + Defaults.WatchdogTimeout + ")\n" +
                 "  minerJsonAPI            'http://IP:port/' for the miner JSON-API (default: " + Defaults.JsonAPIPath + "), 0 disabled\n" +
+                "                          Prometheus metrics are served at 'http://IP:port/metrics'\n" +
                 "  minerCcminerAPI         'IP:port' for the ccminer-style API (default: " + Defaults.CcminerAPIPath + "), 0 disabled\n" +
+                "  apiSampleInterval       Interval (miliseconds) to sample miners and devices for the APIs (default: " + Defaults.ApiSampleInterval + ")\n" +
+                "  minerControlToken       Secret to retune intensity, local work size and CPU threads while mining with 'POST /control' on\n" +
+                "                          miner JSON-API, sent as 'Authorization: Bearer {token}' (default: none, disabled)\n" +
                 "  overrideMaxTarget       (Pool only) Use maximum target and skips query from web3\n" +
                 "  customDifficulty        (Pool only) Set custom difficulity (check with your pool operator)\n" +
                 "  maxScanRetry            Number of retries to scan for new work (default: " + Defaults.MaxScanRetry + ")\n" +
@@ -100,6 +184,9 @@ namespace SoliditySHA3Miner
                 "  submitStale             Submit stale jobs, may create more rejected shares (default: " + Defaults.SubmitStale.ToString().ToLower() + ")\n" +
                 "  abiFile                 Token abi in a file (default: 'ERC-541.abi' in the same folder as this miner)\n" +
                 "  web3api                 User-defined web3 provider URL (default: Infura mainnet provider)\n" +
+                "  web3BroadcastApis       (Solo only) Comma-separated list of additional web3 provider URLs to broadcast solutions to concurrently (default: none)\n" +
+                "  watchPendingMints       (Solo only) Watch pending 'mint' transactions from 'web3Subscription', to not submit when outbid (default: false)\n" +
+                "  web3Subscription        (Solo only) WebSocket URL or IPC path of web3 provider, to check for new work on 'Mint' events or new blocks instead of polling (default: none)\n" +
                 "  contract                Token contract address (default: 0xbtc contract address)\n" +
                 "  hashrateUpdateInterval  Interval (miliseconds) for GPU hashrate logs (default: " + Defaults.HashrateUpdateInterval + ")\n" +
                 "  networkUpdateInterval   Interval (miliseconds) to scan for new work (default: " + Defaults.NetworkUpdateInterval + ")\n" +
@@ -114,7 +201,13 @@ namespace SoliditySHA3Miner
                 "  gasApiOffset            (Solo only) Offset to dynamic gas price value from 'gasApiURL' => 'gasApiPath' (after 'gasApiMultiplier', decimals allowed)\n" +
                 "  pool                    (Pool only) URL of pool mining server (default: " + Defaults.PoolPrimary + ")\n" +
                 "  secondaryPool           (Optional) URL of failover pool mining server\n" +
+                "  proxy                   'IP:port' of a proxy instance to receive work from, instead of pool or web3 (default: none)\n" +
+                "  proxyListen             'IP:port' to serve work from pool or web3 to other miners as a proxy, or 'port' on localhost;\n" +
+                "                          other than localhost requires 'proxyToken' (default: none)\n" +
+                "  proxyToken              Secret of proxy, required by 'proxyListen' from miners and sent by 'proxy' on subscribe (default: none)\n" +
+                "  poolStub                'IP:port' to serve a local test pool with push notifications instead of mining (default: none)\n" +
                 "  logFile                 Enables logging of console output to '{appPath}\\Log\\{yyyy-MM-dd}.log' (default: false)\n" +
+                "  traceFile               Records solver and submission events to this file in Chrome trace format (default: none)\n" +
                 "  devFee                  Set dev fee in percentage (default: " + DevFee.Percent + "%, minimum: " + DevFee.MinimumPercent + "%)\n";
             Console.WriteLine(help);
         }
@@ -390,13 +483,72 @@ namespace SoliditySHA3Miner
                 else
                     Program.Print("[INFO] King making enabled, address: " + kingAddress);
 
+                if (thermalInterval < 1000) thermalInterval = 1000;
+
+                if (watchdogTimeout > 0 && watchdogTimeout < 10000) watchdogTimeout = 10000; // kernels are built on restart
+
+                if (maxTemperature > 0 && maxTemperature <= targetTemperature)
+                {
+                    Program.Print("[ERROR] 'maxTemperature' must be above 'targetTemperature'.");
+                    return false;
+                }
+
+                if (maxTemperature > 0 && targetTemperature <= 0)
+                {
+                    Program.Print("[ERROR] 'maxTemperature' requires 'targetTemperature'.");
+                    return false;
+                }
+
                 if (string.IsNullOrWhiteSpace(minerAddress) && string.IsNullOrWhiteSpace(privateKey))
                 {
                     Program.Print("[INFO] Miner address not specified, donating 100% to dev.");
                     minerAddress = DevFee.Address;
                 }
 
-                if (!string.IsNullOrWhiteSpace(privateKey))
+                if (benchmark)
+                {
+                    Program.Print(string.Format("[INFO] Benchmark mode, difficulty: {0}, no work is submitted.", benchmarkDifficulty));
+
+                    try { NetworkInterface.BenchmarkInterface.ParseDifficulty(benchmarkDifficulty); }
+                    catch (Exception)
+                    {
+                        Program.Print("[ERROR] Invalid 'benchmarkDifficulty': " + benchmarkDifficulty);
+                        return false;
+                    }
+
+                    if (benchmarkDuration < 1 && benchmarkHashes == 0)
+                    {
+                        Program.Print("[ERROR] 'benchmarkDuration' must be at least 1 second.");
+                        return false;
+                    }
+
+                    if (!string.IsNullOrWhiteSpace(replayJobs))
+                    {
+                        Program.Print("[ERROR] Cannot use both 'benchmark' and 'replayJobs'.");
+                        return false;
+                    }
+                }
+                else if (!string.IsNullOrWhiteSpace(replayJobs))
+                {
+                    Program.Print(string.Format("[INFO] Replay mode, using jobs recorded in {0}, no work is submitted.", replayJobs));
+
+                    if (replaySpeed <= 0)
+                    {
+                        Program.Print("[ERROR] 'replaySpeed' must be above zero.");
+                        return false;
+                    }
+                }
+                else if (!string.IsNullOrWhiteSpace(proxy))
+                {
+                    Program.Print("[INFO] Proxy mining mode, using " + proxy);
+
+                    if (!string.IsNullOrWhiteSpace(proxyListen))
+                    {
+                        Program.Print("[ERROR] Cannot use both 'proxy' and 'proxyListen'.");
+                        return false;
+                    }
+                }
+                else if (!string.IsNullOrWhiteSpace(privateKey))
                 {
                     Program.Print("[INFO] Solo mining mode.");
                 }
@@ -533,6 +685,82 @@ namespace SoliditySHA3Miner
                             Environment.Exit(0);
                             break;
 
+                        case "targetLaunchDuration":
+                            targetLaunchDuration = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "simulatedDevices":
+                            simulatedDevices = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "simulatedLatency":
+                            simulatedLatency = uint.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "simulatedHashrate":
+                            simulatedHashrate = ulong.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "simulatedCandidateRate":
+                            simulatedCandidateRate = uint.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "benchmark":
+                            benchmark = !arg.Contains('=') || bool.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "benchmarkDifficulty":
+                            benchmarkDifficulty = arg.Split('=')[1];
+                            break;
+
+                        case "benchmarkDuration":
+                            benchmarkDuration = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "benchmarkHashes":
+                            benchmarkHashes = ulong.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "benchmarkFile":
+                            benchmarkFile = arg.Split('=')[1];
+                            break;
+
+                        case "recordJobs":
+                            recordJobs = arg.Split('=')[1];
+                            break;
+
+                        case "replayJobs":
+                            replayJobs = arg.Split('=')[1];
+                            break;
+
+                        case "replaySpeed":
+                            replaySpeed = float.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "solutionSeed":
+                            solutionSeed = ulong.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "targetTemperature":
+                            targetTemperature = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "maxTemperature":
+                            maxTemperature = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "targetPower":
+                            targetPower = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "thermalInterval":
+                            thermalInterval = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "watchdogTimeout":
+                            watchdogTimeout = int.Parse(arg.Split('=')[1]);
+                            break;
+
                         case "minerJsonAPI":
                             minerJsonAPI = arg.Split('=')[1];
                             break;
@@ -541,6 +769,14 @@ namespace SoliditySHA3Miner
                             minerCcminerAPI = arg.Split('=')[1];
                             break;
 
+                        case "apiSampleInterval":
+                            apiSampleInterval = int.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "minerControlToken":
+                            minerControlToken = arg.Substring(arg.IndexOf('=') + 1); // may end with base64 padding
+                            break;
+
                         case "overrideMaxTarget":
                             var strValue = arg.Split('=')[1];
                             overrideMaxTarget = strValue.StartsWith("0x")
@@ -572,6 +808,18 @@ namespace SoliditySHA3Miner
                             web3api = arg.Split('=')[1];
                             break;
 
+                        case "web3BroadcastApis":
+                            web3BroadcastApis = arg.Split('=')[1].Split(new[] { ',' }, StringSplitOptions.RemoveEmptyEntries);
+                            break;
+
+                        case "watchPendingMints":
+                            watchPendingMints = bool.Parse(arg.Split('=')[1]);
+                            break;
+
+                        case "web3Subscription":
+                            web3Subscription = arg.Split('=')[1];
+                            break;
+
                         case "contract":
                             contractAddress = arg.Split('=')[1];
                             break;
@@ -628,6 +876,26 @@ namespace SoliditySHA3Miner
                             secondaryPool = arg.Split('=')[1];
                             break;
 
+                        case "proxy":
+                            proxy = arg.Split('=')[1];
+                            break;
+
+                        case "proxyListen":
+                            proxyListen = arg.Split('=')[1];
+                            break;
+
+                        case "proxyToken":
+                            proxyToken = arg.Substring(arg.IndexOf('=') + 1); // may end with base64 padding
+                            break;
+
+                        case "poolStub":
+                            poolStub = arg.Split('=')[1];
+                            break;
+
+                        case "traceFile":
+                            traceFile = arg.Split('=')[1];
+                            break;
+
                         case "devFee":
                             DevFee.UserPercent = float.Parse(arg.Split('=')[1]);
                             break;
@@ -655,12 +923,22 @@ namespace SoliditySHA3Miner
             public const string PoolSecondary = "http://mike.rs:8080";
             public const string JsonAPIPath = "http://127.0.0.1:4078";
             public const string CcminerAPIPath = "127.0.0.1:4068";
+            public const int ApiSampleInterval = 5000;
 
             public const bool SubmitStale = false;
             public const float GasToMine = 5.0f;
             public const ulong GasLimit = 1704624ul;
             public const int MaxScanRetry = 3;
             public const int PauseOnFailedScan = 3;
+            public const int TargetLaunchDuration = 0;
+            public const uint SimulatedLatency = 100;
+            public const ulong SimulatedHashrate = 0;
+            public const string BenchmarkDifficulty = "easy";
+            public const int BenchmarkDuration = 60;
+            public const string BenchmarkFile = "benchmark.json";
+            public const float ReplaySpeed = 1.0f;
+            public const int ThermalInterval = 5000;
+            public const int WatchdogTimeout = 60000;
             public const int NetworkUpdateInterval = 15000;
             public const int HashrateUpdateInterval = 30000;
 
@@ -317,8 +317,10 @@ static void keccak_skip_first_round(uint2* state)
 
 __kernel void hashMidstate(
 	__constant uint2 const *midstate, __constant ulong const *target, ulong const startPosition,
-	__global volatile ulong *restrict solutions, __global volatile uint *solutionCount)
+	__global volatile ulong *restrict solutions, __global volatile uint *solutionCount, __global volatile uint const *abortFlag)
 {
+	if (abortFlag[0]) return; // challenge changed, skip rest of launch
+
 	state_t state;
 	nonce_t nonce;
 	nonce.ulong_s = get_global_id(0) + startPosition;
@@ -379,8 +379,10 @@ static inline bool islessThan(uchar const *left, __constant uchar const *right)
 
 __kernel void hashMessage(
 	__constant uchar const *d_message, __constant uchar const *d_target, ulong const startPosition,
-	__global volatile ulong *restrict solutions, __global volatile uint *solutionCount)
+	__global volatile ulong *restrict solutions, __global volatile uint *solutionCount, __global volatile uint const *abortFlag)
 {
+	if (abortFlag[0]) return; // challenge changed, skip rest of launch
+
 	uchar digest[UINT256_LENGTH];
 
 	uchar message[MESSAGE_LENGTH];
@@ -9,6 +9,9 @@ namespace SoliditySHA3Miner.Miner.API
 {
     public static class AmdLinuxQuery
     {
+        public static string DebugDriPath = @"/sys/kernel/debug/dri/";
+        public static string DrmClassPath = @"/sys/class/drm/";
+
         private static object m_queryLock = new object();
         private static Regex m_deviceNameQueryRegex = new Regex(@"\[([^\[\]\/]+)\]");
 
@@ -42,7 +45,7 @@ namespace SoliditySHA3Miner.Miner.API
             lock(m_queryLock)
             {
                 deviceEnum = -1;
-                var queryDir = new DirectoryInfo(@"/sys/kernel/debug/dri/");
+                var queryDir = new DirectoryInfo(DebugDriPath);
                 if (!queryDir.Exists) return null;
 
                 queryDir = queryDir.GetDirectories().FirstOrDefault(d =>
@@ -91,7 +94,7 @@ namespace SoliditySHA3Miner.Miner.API
 
             lock(m_queryLock)
             {
-                var queryDir = new DirectoryInfo(@"/sys/kernel/debug/dri/");
+                var queryDir = new DirectoryInfo(DebugDriPath);
                 if (!queryDir.Exists) return false;
 
                 return queryDir.GetDirectories().Where(d => d.GetFiles("amdgpu_pm_info").Any()).Any();
@@ -171,6 +174,22 @@ namespace SoliditySHA3Miner.Miner.API
                 return Int32.MinValue;
         }
 
+        public static int GetDeviceCurrentPowerDraw(uint pciBusID)
+        {
+            var queryFile = QueryAmdgpuPmInfo(pciBusID, out int deviceEnum);
+            if (queryFile == null) return -1;
+            
+            var query = File.ReadAllLines(queryFile.FullName).FirstOrDefault(l => l.TrimEnd().EndsWith("(average GPU)"));
+            if (string.IsNullOrWhiteSpace(query)) return -1;
+
+            var value = (query.Split(' ', StringSplitOptions.RemoveEmptyEntries)[0] ?? string.Empty).Trim();
+
+            if (float.TryParse(value, NumberStyles.AllowDecimalPoint, CultureInfo.InvariantCulture, out float fValue))
+                return (int)Math.Round(fValue);
+            else
+                return -1;
+        }
+
         public static int GetDeviceCurrentUtilizationPercent(uint pciBusID)
         {
             var queryFile = QueryAmdgpuPmInfo(pciBusID, out int deviceEnum);
@@ -194,7 +213,7 @@ namespace SoliditySHA3Miner.Miner.API
 
             lock(m_queryLock)
             {
-                queryDir = new DirectoryInfo(@"/sys/class/drm/card" + deviceEnum.ToString() + "/device/hwmon");
+                queryDir = new DirectoryInfo(DrmClassPath + "card" + deviceEnum.ToString() + "/device/hwmon");
                 if (!queryDir.Exists) return -1;
                 
                 var queryFile = queryDir.GetFiles("fan1_input").FirstOrDefault()
@@ -218,7 +237,7 @@ namespace SoliditySHA3Miner.Miner.API
 
             lock(m_queryLock)
             {
-                queryDir = new DirectoryInfo(@"/sys/class/drm/card" + deviceEnum.ToString() + "/device/hwmon");
+                queryDir = new DirectoryInfo(DrmClassPath + "card" + deviceEnum.ToString() + "/device/hwmon");
                 if (!queryDir.Exists) return -1;
                 
                 var queryFile = queryDir.GetFiles("pwm1_max").FirstOrDefault()
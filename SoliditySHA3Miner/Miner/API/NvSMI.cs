@@ -10,8 +10,14 @@ namespace SoliditySHA3Miner.Miner.API
 {
     public static class NvSMI
     {
+        private static readonly TimeSpan OUTPUT_CACHE_TTL = TimeSpan.FromSeconds(1);
+
         public static string NvSMI_PATH = string.Empty;
 
+        private static object m_outputLock = new object();
+        private static string m_lastOutput;
+        private static DateTime m_lastOutputDateTime;
+
         public static bool FoundNvSMI()
         {
             if (RuntimeInformation.IsOSPlatform(OSPlatform.Windows))
@@ -37,7 +43,21 @@ namespace SoliditySHA3Miner.Miner.API
             return false;
         }
 
+        // One sample queries several values per device, reuse the output instead of launching 'nvidia-smi' for each
         private static string GetProcessOutput()
+        {
+            lock (m_outputLock)
+            {
+                if (m_lastOutput == null || (DateTime.Now - m_lastOutputDateTime) > OUTPUT_CACHE_TTL)
+                {
+                    m_lastOutput = GetNewProcessOutput();
+                    m_lastOutputDateTime = DateTime.Now;
+                }
+                return m_lastOutput;
+            }
+        }
+
+        private static string GetNewProcessOutput()
         {
             var smiProcess = new Process
             {
@@ -140,6 +160,20 @@ namespace SoliditySHA3Miner.Miner.API
                 return int.MinValue;
         }
 
+        public static int GetDeviceCurrentPowerDraw(uint pciBusID)
+        {
+            var smiDevice = GetDevice(pciBusID);
+            if (smiDevice == null) return -1;
+
+            var powDrawStr = smiDevice.Descendants("power_draw").FirstOrDefault()?.Value;
+            if (string.IsNullOrWhiteSpace(powDrawStr)) return -1;
+
+            if (float.TryParse(powDrawStr.Replace(" W", string.Empty), NumberStyles.AllowDecimalPoint, CultureInfo.InvariantCulture, out float powDraw))
+                return (int)Math.Round(powDraw);
+            else
+                return -1; // "N/A" on devices without power sensor
+        }
+
         public static int GetDeviceCurrentCoreClock(uint pciBusID)
         {
             var smiDevice = GetDevice(pciBusID);
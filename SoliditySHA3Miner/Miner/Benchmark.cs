@@ -0,0 +1,197 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Threading;
+
+namespace SoliditySHA3Miner.Miner
+{
+    // Offline run of miners on synthetic jobs of BenchmarkInterface, measured per device from solver metrics and saved as JSON
+    public static class Benchmark
+    {
+        private const int POLL_INTERVAL_MS = 500;
+        private const int START_TIMEOUT_MS = 60000; // kernels are built before first launch
+        private const double MAX_WARM_UP_SECONDS = 10.0;
+
+        private class DeviceRun
+        {
+            public IMiner Miner;
+            public Device Device;
+            public SolverMetrics StartMetrics;
+
+            public SolverMetrics GetMetrics() => Miner.GetMetricsByDevice(Device.Platform, Device.DeviceID);
+        }
+
+        // Blocks until run is done, returns false if miners failed to start or report could not be written
+        public static bool Run(IMiner[] miners, NetworkInterface.BenchmarkInterface networkInterface, Config config)
+        {
+            var devices = miners.SelectMany(m => m.Devices.Where(d => d.AllowDevice).
+                                                           Select(d => new DeviceRun { Miner = m, Device = d })).
+                                 ToArray();
+
+            var startWatch = Stopwatch.StartNew();
+            while (!miners.All(m => m.IsMining))
+            {
+                if (startWatch.ElapsedMilliseconds > START_TIMEOUT_MS)
+                {
+                    Program.Print("[ERROR] Benchmark aborted, miners failed to start.");
+                    return false;
+                }
+                Thread.Sleep(POLL_INTERVAL_MS);
+            }
+
+            // Skip first launches, intensity and caches are still settling
+            var warmUpSeconds = Math.Min(MAX_WARM_UP_SECONDS, config.benchmarkDuration / 5.0);
+            Program.Print(string.Format("[INFO] Benchmark warming up for {0:0.#}s...", warmUpSeconds));
+            Thread.Sleep(TimeSpan.FromSeconds(warmUpSeconds));
+
+            foreach (var device in devices) device.StartMetrics = device.GetMetrics();
+            var startJobCount = networkInterface.JobCount;
+            var startShares = networkInterface.SubmittedShares;
+            var startStaleShares = networkInterface.StaleShares;
+
+            Program.Print((config.benchmarkHashes > 0)
+                ? string.Format("[INFO] Benchmark measuring {0} hashes...", config.benchmarkHashes)
+                : string.Format("[INFO] Benchmark measuring for {0}s...", config.benchmarkDuration));
+
+            var stopwatch = Stopwatch.StartNew();
+            SolverMetrics[] endMetrics;
+            double elapsedSeconds;
+            while (true)
+            {
+                Thread.Sleep(POLL_INTERVAL_MS);
+
+                if (!miners.Any(m => m.IsMining))
+                {
+                    Program.Print("[ERROR] Benchmark aborted, miners stopped.");
+                    return false;
+                }
+
+                // Same sample as reported, so the run stops on the hashes it reports
+                endMetrics = devices.Select(d => d.GetMetrics()).ToArray();
+                elapsedSeconds = stopwatch.Elapsed.TotalSeconds;
+
+                if (config.benchmarkHashes > 0)
+                {
+                    var hashes = devices.Select((d, i) => endMetrics[i].HashesCompleted - d.StartMetrics.HashesCompleted).Aggregate(0ul, (sum, h) => sum + h);
+                    if (hashes >= config.benchmarkHashes) break;
+                }
+                else if (elapsedSeconds >= config.benchmarkDuration) break;
+            }
+
+            var deviceReports = devices.Select((d, i) => GetDeviceReport(d, endMetrics[i], elapsedSeconds)).ToArray();
+
+            var totalHashes = deviceReports.Aggregate(0ul, (sum, d) => sum + d.Value<ulong>("hashes"));
+            var totalCandidates = deviceReports.Aggregate(0ul, (sum, d) => sum + d.Value<ulong>("candidates"));
+            var shares = networkInterface.SubmittedShares - startShares;
+
+            var report = new JObject
+            {
+                ["application"] = Program.GetApplicationName(),
+                ["version"] = Program.GetApplicationVersion(),
+                ["timestamp"] = Program.GetCurrentTimestamp(),
+                ["machine"] = Environment.MachineName,
+                ["os"] = RuntimeInformation.OSDescription,
+                ["settings"] = new JObject
+                {
+                    ["difficulty"] = networkInterface.Difficulty,
+                    ["target"] = networkInterface.Target,
+                    ["warmUpSeconds"] = warmUpSeconds,
+                    ["duration"] = config.benchmarkDuration,
+                    ["hashes"] = config.benchmarkHashes,
+                    ["jobInterval"] = config.networkUpdateInterval,
+                    ["targetLaunchDuration"] = config.targetLaunchDuration,
+                    ["kingMaking"] = !string.IsNullOrWhiteSpace(config.kingAddress)
+                },
+                ["elapsedSeconds"] = elapsedSeconds,
+                ["devices"] = new JArray(deviceReports),
+                ["total"] = new JObject
+                {
+                    ["hashes"] = totalHashes,
+                    ["hashrate"] = totalHashes / elapsedSeconds,
+                    ["candidates"] = totalCandidates,
+                    ["candidateRate"] = totalCandidates / elapsedSeconds,
+                    ["jobs"] = networkInterface.JobCount - startJobCount,
+                    ["shares"] = shares,
+                    ["staleShares"] = networkInterface.StaleShares - startStaleShares,
+                    ["effectiveHashrate"] = (double)shares * networkInterface.Difficulty * Math.Pow(2, 22) / elapsedSeconds // 2^256 / 2^234 max target
+                }
+            };
+
+            foreach (var device in deviceReports)
+                Program.Print(string.Format("[INFO] Benchmark {0} {1} (#{2}): {3:0.###} MH/s, launch {4:0.###}ms, {5:0.#} candidates/s, verify {6:0.###}ms, job switch {7:0.###}ms",
+                                            device.Value<string>("type"), device.Value<string>("platform"), device.Value<int>("deviceID"),
+                                            device.Value<double>("hashrate") / 1000000, device["launch"].Value<double>("meanMs"),
+                                            device.Value<double>("candidateRate"), device["verify"].Value<double>("meanMs"),
+                                            device["jobSwitch"].Value<double>("meanMs")));
+
+            Program.Print(string.Format("[INFO] Benchmark total: {0:0.###} MH/s in {1:0.#}s", totalHashes / elapsedSeconds / 1000000, elapsedSeconds));
+
+            var reportPath = Path.IsPathRooted(config.benchmarkFile) ? config.benchmarkFile : Path.Combine(Program.AppDirPath, config.benchmarkFile);
+            if (!Utils.Json.SerializeToFile(report, reportPath))
+            {
+                Program.Print(string.Format("[ERROR] Failed to write benchmark report at {0}", reportPath));
+                return false;
+            }
+            Program.Print(string.Format("[INFO] Benchmark report saved at {0}", reportPath));
+            return true;
+        }
+
+        private static JObject GetDeviceReport(DeviceRun device, SolverMetrics endMetrics, double elapsedSeconds)
+        {
+            var start = device.StartMetrics;
+            var hashes = endMetrics.HashesCompleted - start.HashesCompleted; // excludes nonces dropped by aborted launches
+            var candidates = endMetrics.SolutionVerify.Count - start.SolutionVerify.Count;
+
+            return new JObject
+            {
+                ["type"] = device.Device.Type,
+                ["platform"] = device.Device.Platform,
+                ["deviceID"] = device.Device.DeviceID,
+                ["name"] = device.Device.Name,
+                ["intensity"] = device.Device.Intensity,
+                ["hashes"] = hashes,
+                ["hashrate"] = hashes / elapsedSeconds,
+                ["launch"] = GetDurationReport(start.LaunchDuration, endMetrics.LaunchDuration),
+                ["launchesAborted"] = endMetrics.LaunchesAborted - start.LaunchesAborted,
+                ["restarts"] = endMetrics.Restarts - start.Restarts,
+                ["candidates"] = candidates,
+                ["candidateRate"] = candidates / elapsedSeconds,
+                ["solutions"] = endMetrics.SolutionLatency.Count - start.SolutionLatency.Count,
+                ["verify"] = GetDurationReport(start.SolutionVerify, endMetrics.SolutionVerify),
+                ["jobSwitch"] = GetDurationReport(start.ChallengeSwitch, endMetrics.ChallengeSwitch)
+            };
+        }
+
+        private static JObject GetDurationReport(SolverMetrics.DurationHistogram start, SolverMetrics.DurationHistogram end)
+        {
+            var count = end.Count - start.Count;
+            var buckets = end.Buckets.Zip(start.Buckets, (e, s) => e - s).ToArray();
+
+            return new JObject
+            {
+                ["count"] = count,
+                ["meanMs"] = (count > 0) ? (end.SumMicroseconds - start.SumMicroseconds) / 1000.0 / count : 0.0,
+                ["p50Ms"] = GetPercentileMs(buckets, count, 0.5),
+                ["p95Ms"] = GetPercentileMs(buckets, count, 0.95)
+            };
+        }
+
+        // Upper bound of bucket holding the percentile, bucket widths double so it is coarse (within 2x)
+        private static double GetPercentileMs(ulong[] buckets, ulong count, double percentile)
+        {
+            if (count == 0) return 0.0;
+
+            var rank = (ulong)Math.Ceiling(count * percentile);
+            var cumulativeCount = 0ul;
+            for (var i = 0; i < buckets.Length - 1; i++)
+            {
+                cumulativeCount += buckets[i];
+                if (cumulativeCount >= rank) return (1ul << i) / 1000.0;
+            }
+            return (1ul << (buckets.Length - 1)) / 1000.0; // last bucket holds the rest
+        }
+    }
+}
@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
 using System.Text;
@@ -18,21 +19,13 @@ namespace SoliditySHA3Miner.Miner
 
             public unsafe delegate void GetKingAddressCallback(byte* kingAddress);
 
-            public delegate void GetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void ResetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void IncrementWorkPositionCallback(ref ulong lastWorkPosition, ulong incrementSize);
-
-            public delegate void MessageCallback([In]int threadID, [In]StringBuilder type, [In]StringBuilder message);
-
             public delegate void SolutionCallback([In]StringBuilder digest, [In]StringBuilder address, [In]StringBuilder challenge, [In]StringBuilder target, [In]StringBuilder solution);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetLogicalProcessorsCount(ref uint processorCount);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void GetNewSolutionTemplate(StringBuilder kingAddress, StringBuilder solutionTemplate);
+            public static extern void GetNewSolutionTemplate(StringBuilder kingAddress, ulong seed, StringBuilder solutionTemplate);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern IntPtr GetInstance(StringBuilder threads);
@@ -47,31 +40,40 @@ namespace SoliditySHA3Miner.Miner
             public static unsafe extern GetKingAddressCallback SetOnGetKingAddressHandler(IntPtr instance, GetKingAddressCallback getKingAddressCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern GetWorkPositionCallback SetOnGetWorkPositionHandler(IntPtr instance, GetWorkPositionCallback getWorkPositionCallback);
+            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern ResetWorkPositionCallback SetOnResetWorkPositionHandler(IntPtr instance, ResetWorkPositionCallback resetWorkPositionCallback);
+            public static extern void SetNoncePool(IntPtr instance, IntPtr noncePool);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(IntPtr instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
+            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern MessageCallback SetOnMessageHandler(IntPtr instance, MessageCallback messageCallback);
+            public static extern void SetTargetLaunchDuration(IntPtr instance, uint targetLaunchDuration);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
+            public static extern void IsMining(IntPtr instance, ref bool isMining);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
+            public static extern void IsPaused(IntPtr instance, ref bool isPaused);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void IsMining(IntPtr instance, ref bool isMining);
+            public static extern void GetHashRateByThreadID(IntPtr instance, uint threadID, ref ulong hashRate);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void IsPaused(IntPtr instance, ref bool isPaused);
+            public static extern void GetMetricsByThreadID(IntPtr instance, uint threadID, [Out] ulong[] metrics);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void GetHashRateByThreadID(IntPtr instance, uint threadID, ref ulong hashRate);
+            public static extern void SetTraceEnabled(IntPtr instance, bool isEnabled);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetTraceEventsByThreadID(IntPtr instance, uint threadID, [Out] TraceEvent[] events, uint maxCount, ref uint count);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetLogLevel(IntPtr instance, uint level);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetLogEntries(IntPtr instance, [Out] LogEntry[] entries, uint maxCount, ref uint count, ref ulong droppedCount);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetTotalHashRate(IntPtr instance, ref ulong totalHashRate);
@@ -90,14 +92,19 @@ namespace SoliditySHA3Miner.Miner
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void StopFinding(IntPtr instance);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetThreadAffinity(IntPtr instance, uint threadID, uint affinity, ref bool isFound);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetThreadEnabled(IntPtr instance, uint threadID, bool isEnabled, ref bool isFound);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void AddThread(IntPtr instance, uint affinity, ref int threadID);
         }
 
         private Solver.GetSolutionTemplateCallback m_GetSolutionTemplateCallback;
         private Solver.GetKingAddressCallback m_GetKingAddressCallback;
-        private Solver.GetWorkPositionCallback m_GetWorkPositionCallback;
-        private Solver.ResetWorkPositionCallback m_ResetWorkPositionCallback;
-        private Solver.IncrementWorkPositionCallback m_IncrementWorkPositionCallback;
-        private Solver.MessageCallback m_MessageCallback;
         private Solver.SolutionCallback m_SolutionCallback;
 
         #endregion P/Invoke interface
@@ -111,19 +118,25 @@ namespace SoliditySHA3Miner.Miner
             return processorCount;
         }
 
-        public static string GetNewSolutionTemplate(string kingAddress = "")
+        public static string GetNewSolutionTemplate(string kingAddress = "", ulong seed = 0)
         {
             var solutionTemplate = new StringBuilder(32 * 2 + 2);
-            Solver.GetNewSolutionTemplate(new StringBuilder(kingAddress), solutionTemplate);
+            Solver.GetNewSolutionTemplate(new StringBuilder(kingAddress), seed, solutionTemplate);
             return solutionTemplate.ToString();
         }
 
         #endregion Static
 
         private Timer m_hashPrintTimer;
+        private Timer m_logTimer;
+        private readonly LogEntry[] m_logEntries = new LogEntry[LogEntry.MAX_DRAIN_COUNT];
+        private ulong m_droppedLogCount;
         private int m_pauseOnFailedScan;
         private int m_failedScanCount;
         private bool m_isCurrentChallengeStopSolving;
+        private volatile bool m_isStarted;
+        private readonly List<int> m_threadAffinities = new List<int>(); // CPU ID of each solver thread, in order of thread ID
+        private readonly List<bool> m_isThreadEnabled = new List<bool>();
 
         public readonly IntPtr m_instance;
 
@@ -152,6 +165,8 @@ namespace SoliditySHA3Miner.Miner
             }
         }
 
+        public bool IsStarted => m_isStarted;
+
         public bool IsPaused
         {
             get
@@ -169,15 +184,17 @@ namespace SoliditySHA3Miner.Miner
         {
             try
             {
+                if (m_logTimer != null)
+                {
+                    m_logTimer.Stop();
+                    PrintLogEntries();
+                }
+
                 if (m_instance != null && m_instance.ToInt64() != 0)
                     Solver.DisposeInstance(m_instance);
 
                 m_GetSolutionTemplateCallback = null;
                 m_GetKingAddressCallback = null;
-                m_GetWorkPositionCallback = null;
-                m_ResetWorkPositionCallback = null;
-                m_IncrementWorkPositionCallback = null;
-                m_MessageCallback = null;
                 m_SolutionCallback = null;
             }
             catch (Exception ex)
@@ -193,11 +210,72 @@ namespace SoliditySHA3Miner.Miner
             var hashrate = 0ul;
 
             if (m_instance != null && m_instance.ToInt64() != 0)
-                Solver.GetHashRateByThreadID(m_instance, (uint)deviceID, ref hashrate);
+            {
+                var threadID = GetThreadID(deviceID);
+                if (threadID >= 0) Solver.GetHashRateByThreadID(m_instance, (uint)threadID, ref hashrate);
+            }
 
             return hashrate;
         }
 
+        public SolverMetrics GetMetricsByDevice(string platformName, int deviceID)
+        {
+            var metrics = new ulong[SolverMetrics.VALUE_COUNT];
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+            {
+                var threadID = GetThreadID(deviceID);
+                if (threadID >= 0) Solver.GetMetricsByThreadID(m_instance, (uint)threadID, metrics);
+            }
+
+            return new SolverMetrics(metrics);
+        }
+
+        public void SetTraceEnabled(bool isEnabled)
+        {
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetTraceEnabled(m_instance, isEnabled);
+        }
+
+        public TraceEvent[] GetTraceEventsByDevice(string platformName, int deviceID)
+        {
+            var events = new TraceEvent[TraceEvent.MAX_DRAIN_COUNT];
+            var count = 0u;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+            {
+                var threadID = GetThreadID(deviceID);
+                if (threadID >= 0) Solver.GetTraceEventsByThreadID(m_instance, (uint)threadID, events, (uint)events.Length, ref count);
+            }
+
+            return events.Take((int)count).ToArray();
+        }
+
+        public IDeviceSensor GetSensorByDevice(string platformName, int deviceID)
+        {
+            return null; // no monitoring of CPU
+        }
+
+        public void SetDutyCycleByDevice(string platformName, int deviceID, int dutyCycle)
+        {
+            // not controlled, threads run at full duty cycle
+        }
+
+        public bool SetTuningByDevice(string platformName, int deviceID, float intensity, uint localWorkSize, out string errorMessage)
+        {
+            errorMessage = "CPU has no intensity, set its threads by CPU IDs instead";
+            return false;
+        }
+
+        public bool IsMiningByDevice(string platformName, int deviceID) => IsMining && GetThreadID(deviceID) >= 0;
+
+        public bool IsPausedByDevice(string platformName, int deviceID) => IsPaused || GetThreadID(deviceID) < 0; // disabled thread idles
+
+        public bool RestartDevice(string platformName, int deviceID)
+        {
+            return false; // threads share one process and have no device state to reset
+        }
+
         public ulong GetTotalHashrate()
         {
             if (IsPaused) return 0ul;
@@ -222,6 +300,7 @@ namespace SoliditySHA3Miner.Miner
 
                 NetworkInterface.ResetEffectiveHashrate();
                 Solver.StartFinding(m_instance);
+                m_isStarted = true;
             }
             catch (Exception ex)
             {
@@ -232,6 +311,7 @@ namespace SoliditySHA3Miner.Miner
 
         public void StopMining()
         {
+            m_isStarted = false;
             try
             {
                 m_hashPrintTimer.Stop();
@@ -248,7 +328,90 @@ namespace SoliditySHA3Miner.Miner
 
         #endregion IMiner
 
-        public CPU(NetworkInterface.INetworkInterface networkInterface, Device[] devices, bool isSubmitStale, int pauseOnFailedScans)
+        // Solver thread mining on this CPU, -1 if none
+        private int GetThreadID(int cpuID)
+        {
+            lock (m_threadAffinities)
+            {
+                for (var threadID = 0; threadID < m_threadAffinities.Count; threadID++)
+                    if (m_threadAffinities[threadID] == cpuID && m_isThreadEnabled[threadID]) return threadID;
+
+                return -1;
+            }
+        }
+
+        // Mines on exactly these CPUs from the next work chunk of each thread: threads are moved, disabled or added rather than restarted
+        public bool SetThreads(int[] cpuIDs, out string errorMessage)
+        {
+            errorMessage = string.Empty;
+
+            var invalidIDs = cpuIDs.Where(id => Devices.All(d => d.DeviceID != id)).ToArray();
+            if (invalidIDs.Any())
+            {
+                errorMessage = "Invalid CPU ID: " + string.Join(",", invalidIDs);
+                return false;
+            }
+            if (m_instance == null || m_instance.ToInt64() == 0)
+            {
+                errorMessage = "CPU solver is not initialised";
+                return false;
+            }
+
+            lock (m_threadAffinities)
+            {
+                var isFound = false;
+                var cpuIDsToAssign = new Queue<int>(cpuIDs.Distinct().
+                                                           Where(id => !Enumerable.Range(0, m_threadAffinities.Count).
+                                                                                   Any(t => m_isThreadEnabled[t] && m_threadAffinities[t] == id)));
+                var freeThreadIDs = new Queue<int>(Enumerable.Range(0, m_threadAffinities.Count).
+                                                              Where(t => !m_isThreadEnabled[t] || !cpuIDs.Contains(m_threadAffinities[t])));
+
+                while (cpuIDsToAssign.Any())
+                {
+                    var cpuID = cpuIDsToAssign.Dequeue();
+                    if (freeThreadIDs.Any())
+                    {
+                        var threadID = freeThreadIDs.Dequeue();
+                        Solver.SetThreadAffinity(m_instance, (uint)threadID, (uint)cpuID, ref isFound);
+                        if (isFound) Solver.SetThreadEnabled(m_instance, (uint)threadID, true, ref isFound);
+                        if (!isFound)
+                        {
+                            errorMessage = string.Format("Failed to assign CPU {0} to thread {1}", cpuID, threadID);
+                            break;
+                        }
+                        m_threadAffinities[threadID] = cpuID;
+                        m_isThreadEnabled[threadID] = true;
+                    }
+                    else
+                    {
+                        var threadID = -1;
+                        Solver.AddThread(m_instance, (uint)cpuID, ref threadID);
+                        if (threadID < 0)
+                        {
+                            errorMessage = string.Format("Thread limit reached, CPU {0} not assigned", cpuID);
+                            break;
+                        }
+                        m_threadAffinities.Add(cpuID);
+                        m_isThreadEnabled.Add(true);
+                    }
+                }
+
+                foreach (var threadID in freeThreadIDs)
+                {
+                    Solver.SetThreadEnabled(m_instance, (uint)threadID, false, ref isFound);
+                    if (isFound)
+                        m_isThreadEnabled[threadID] = false;
+                    else if (string.IsNullOrEmpty(errorMessage))
+                        errorMessage = string.Format("Failed to disable thread {0}", threadID);
+                }
+
+                foreach (var device in Devices)
+                    device.AllowDevice = Enumerable.Range(0, m_threadAffinities.Count).Any(t => m_isThreadEnabled[t] && m_threadAffinities[t] == device.DeviceID);
+            }
+            return string.IsNullOrEmpty(errorMessage);
+        }
+
+        public CPU(NetworkInterface.INetworkInterface networkInterface, Device[] devices, bool isSubmitStale, int pauseOnFailedScans, int targetLaunchDuration)
         {
             try
             {
@@ -264,6 +427,9 @@ namespace SoliditySHA3Miner.Miner
 
                     if (!string.IsNullOrEmpty(devicesStr)) devicesStr += ',';
                     devicesStr += device.DeviceID.ToString("X64");
+
+                    m_threadAffinities.Add(device.DeviceID);
+                    m_isThreadEnabled.Add(true);
                 }
 
                 NetworkInterface.OnGetTotalHashrate += NetworkInterface_OnGetTotalHashrate;
@@ -274,11 +440,13 @@ namespace SoliditySHA3Miner.Miner
                     m_GetSolutionTemplateCallback = Solver.SetOnGetSolutionTemplateHandler(m_instance, Work.GetSolutionTemplate);
                     m_GetKingAddressCallback = Solver.SetOnGetKingAddressHandler(m_instance, Work.GetKingAddress);
                 }
-                m_GetWorkPositionCallback = Solver.SetOnGetWorkPositionHandler(m_instance, Work.GetPosition);
-                m_ResetWorkPositionCallback = Solver.SetOnResetWorkPositionHandler(m_instance, Work.ResetPosition);
-                m_IncrementWorkPositionCallback = Solver.SetOnIncrementWorkPositionHandler(m_instance, Work.IncrementPosition);
-                m_MessageCallback = Solver.SetOnMessageHandler(m_instance, m_instance_OnMessage);
+                Solver.SetLogLevel(m_instance, (uint)LogEntry.MINIMUM_LEVEL);
+                m_logTimer = new Timer(LogEntry.DRAIN_INTERVAL);
+                m_logTimer.Elapsed += (sender, e) => PrintLogEntries();
+                m_logTimer.Start();
+
                 m_SolutionCallback = Solver.SetOnSolutionHandler(m_instance, m_instance_OnSolution);
+                Solver.SetNoncePool(m_instance, Work.NoncePool);
 
                 NetworkInterface.OnGetMiningParameterStatus += NetworkInterface_OnGetMiningParameterStatus;
                 NetworkInterface.OnNewMessagePrefix += NetworkInterface_OnNewMessagePrefix;
@@ -286,6 +454,7 @@ namespace SoliditySHA3Miner.Miner
                 networkInterface.OnStopSolvingCurrentChallenge += NetworkInterface_OnStopSolvingCurrentChallenge;
 
                 Solver.SetSubmitStale(m_instance, isSubmitStale);
+                Solver.SetTargetLaunchDuration(m_instance, (uint)Math.Max(0, targetLaunchDuration));
 
                 if (string.IsNullOrWhiteSpace(devicesStr))
                 {
@@ -325,37 +494,58 @@ namespace SoliditySHA3Miner.Miner
             GC.Collect(GC.MaxGeneration, GCCollectionMode.Optimized, false);
         }
 
-        private void m_instance_OnMessage(int threadID, StringBuilder type, StringBuilder message)
+        private void PrintLogEntries()
+        {
+            lock (m_logEntries)
+            {
+                if (m_instance == null || m_instance.ToInt64() == 0) return;
+
+                var count = 0u;
+                var droppedCount = 0ul;
+                do
+                {
+                    Solver.GetLogEntries(m_instance, m_logEntries, (uint)m_logEntries.Length, ref count, ref droppedCount);
+
+                    for (var i = 0; i < count; i++)
+                        PrintLogEntry(m_logEntries[i]);
+                }
+                while (count == m_logEntries.Length);
+
+                if (droppedCount > m_droppedLogCount)
+                {
+                    Program.Print(string.Format("CPU [WARN] {0} solver messages dropped", droppedCount - m_droppedLogCount));
+                    m_droppedLogCount = droppedCount;
+                }
+            }
+        }
+
+        private void PrintLogEntry(LogEntry entry)
         {
             var sFormat = new StringBuilder();
-            if (threadID > -1) sFormat.Append("CPU Thread: {0} ");
+            if (entry.Device > -1) sFormat.Append("CPU Thread: {0} ");
 
-            switch (type.ToString().ToUpperInvariant())
+            switch (entry.Level)
             {
-                case "INFO":
-                    sFormat.Append(threadID > -1 ? "[INFO] {1}" : "[INFO] {0}");
+                case LogEntry.LogLevel.Info:
+                    sFormat.Append(entry.Device > -1 ? "[INFO] {1}" : "[INFO] {0}");
                     break;
 
-                case "WARN":
-                    sFormat.Append(threadID > -1 ? "[WARN] {1}" : "[WARN] {0}");
+                case LogEntry.LogLevel.Warn:
+                    sFormat.Append(entry.Device > -1 ? "[WARN] {1}" : "[WARN] {0}");
                     break;
 
-                case "ERROR":
-                    sFormat.Append(threadID > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
+                case LogEntry.LogLevel.Error:
+                    sFormat.Append(entry.Device > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
                     break;
 
-                case "DEBUG":
+                case LogEntry.LogLevel.Debug:
                 default:
-#if DEBUG
-                    sFormat.Append(threadID > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
+                    sFormat.Append(entry.Device > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
                     break;
-#else
-                    return;
-#endif
             }
-            Program.Print(threadID > -1
-                ? string.Format(sFormat.ToString(), threadID, message.ToString())
-                : string.Format(sFormat.ToString(), message.ToString()));
+            Program.Print(entry.Device > -1
+                ? string.Format(sFormat.ToString(), entry.Device, entry.Message)
+                : string.Format(sFormat.ToString(), entry.Message));
         }
 
         private void NetworkInterface_OnStopSolvingCurrentChallenge(NetworkInterface.INetworkInterface sender, string currentTarget)
@@ -456,8 +646,10 @@ namespace SoliditySHA3Miner.Miner
         private void m_instance_OnSolution(StringBuilder digest, StringBuilder address, StringBuilder challenge, StringBuilder target, StringBuilder solution)
         {
             var difficulty = NetworkInterface.Difficulty.ToString("X64");
+            var startSubmitTimestamp = Utils.ChromeTrace.GetTimestamp();
 
             NetworkInterface.SubmitSolution(digest.ToString(), address.ToString(), challenge.ToString(), difficulty, target.ToString(), solution.ToString(), this);
+            Utils.ChromeTrace.RecordSpan("Hand over solution", startSubmitTimestamp);
         }
     }
 }
\ No newline at end of file
@@ -18,14 +18,6 @@ namespace SoliditySHA3Miner.Miner
 
             public unsafe delegate void GetKingAddressCallback(byte* kingAddress);
 
-            public delegate void GetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void ResetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void IncrementWorkPositionCallback(ref ulong lastWorkPosition, ulong incrementSize);
-
-            public delegate void MessageCallback([In]int deviceID, [In]StringBuilder type, [In]StringBuilder message);
-
             public delegate void SolutionCallback([In]StringBuilder digest, [In]StringBuilder address, [In]StringBuilder challenge, [In]StringBuilder target, [In]StringBuilder solution);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
@@ -50,22 +42,16 @@ namespace SoliditySHA3Miner.Miner
             public static unsafe extern GetKingAddressCallback SetOnGetKingAddressHandler(IntPtr instance, GetKingAddressCallback getKingAddressCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern GetWorkPositionCallback SetOnGetWorkPositionHandler(IntPtr instance, GetWorkPositionCallback getWorkPositionCallback);
-
-            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern ResetWorkPositionCallback SetOnResetWorkPositionHandler(IntPtr instance, ResetWorkPositionCallback resetWorkPositionCallback);
-
-            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(IntPtr instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
+            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern MessageCallback SetOnMessageHandler(IntPtr instance, MessageCallback messageCallback);
+            public static extern void SetNoncePool(IntPtr instance, IntPtr noncePool);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
+            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
+            public static extern void SetTargetLaunchDuration(IntPtr instance, uint targetLaunchDuration);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void AssignDevice(IntPtr instance, int deviceID, ref uint pciBusID, ref float intensity);
@@ -85,6 +71,21 @@ namespace SoliditySHA3Miner.Miner
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetHashRateByDeviceID(IntPtr instance, uint deviceID, ref ulong hashRate);
 
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetMetricsByDeviceID(IntPtr instance, uint deviceID, [Out] ulong[] metrics);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetTraceEnabled(IntPtr instance, bool isEnabled);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetTraceEventsByDeviceID(IntPtr instance, uint deviceID, [Out] TraceEvent[] events, uint maxCount, ref uint count);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetLogLevel(IntPtr instance, uint level);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetLogEntries(IntPtr instance, [Out] LogEntry[] entries, uint maxCount, ref uint count, ref ulong droppedCount);
+
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetTotalHashRate(IntPtr instance, ref ulong totalHashRate);
 
@@ -97,6 +98,21 @@ namespace SoliditySHA3Miner.Miner
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void PauseFinding(IntPtr instance, bool pause);
 
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetDeviceDutyCycle(IntPtr instance, int deviceID, uint dutyCycle);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetDeviceTuning(IntPtr instance, int deviceID, float intensity, uint blockSize, ref bool isFound);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void IsDeviceMining(IntPtr instance, int deviceID, ref bool isMining);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void IsDevicePaused(IntPtr instance, int deviceID, ref bool isPaused);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void RestartDevice(IntPtr instance, int deviceID, ref bool isRestarted);
+
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void StartFinding(IntPtr instance);
 
@@ -142,10 +158,6 @@ namespace SoliditySHA3Miner.Miner
 
         private Solver.GetSolutionTemplateCallback m_GetSolutionTemplateCallback;
         private Solver.GetKingAddressCallback m_GetKingAddressCallback;
-        private Solver.GetWorkPositionCallback m_GetWorkPositionCallback;
-        private Solver.ResetWorkPositionCallback m_ResetWorkPositionCallback;
-        private Solver.IncrementWorkPositionCallback m_IncrementWorkPositionCallback;
-        private Solver.MessageCallback m_MessageCallback;
         private Solver.SolutionCallback m_SolutionCallback;
 
         #endregion P/Invoke interface
@@ -210,9 +222,13 @@ namespace SoliditySHA3Miner.Miner
         #endregion Static
 
         private Timer m_hashPrintTimer;
+        private Timer m_logTimer;
+        private readonly LogEntry[] m_logEntries = new LogEntry[LogEntry.MAX_DRAIN_COUNT];
+        private ulong m_droppedLogCount;
         private int m_pauseOnFailedScan;
         private int m_failedScanCount;
         private bool m_isCurrentChallengeStopSolving;
+        private volatile bool m_isStarted;
 
         public readonly IntPtr m_instance;
 
@@ -265,6 +281,8 @@ namespace SoliditySHA3Miner.Miner
             }
         }
 
+        public bool IsStarted => m_isStarted;
+
         public bool IsPaused
         {
             get
@@ -290,6 +308,7 @@ namespace SoliditySHA3Miner.Miner
 
                 NetworkInterface.ResetEffectiveHashrate();
                 Solver.StartFinding(m_instance);
+                m_isStarted = true;
             }
             catch (Exception ex)
             {
@@ -300,6 +319,7 @@ namespace SoliditySHA3Miner.Miner
 
         public void StopMining()
         {
+            m_isStarted = false;
             try
             {
                 m_hashPrintTimer.Stop();
@@ -326,6 +346,108 @@ namespace SoliditySHA3Miner.Miner
             return hashrate;
         }
 
+        public SolverMetrics GetMetricsByDevice(string platformName, int deviceID)
+        {
+            var metrics = new ulong[SolverMetrics.VALUE_COUNT];
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.GetMetricsByDeviceID(m_instance, (uint)deviceID, metrics);
+
+            return new SolverMetrics(metrics);
+        }
+
+        public void SetTraceEnabled(bool isEnabled)
+        {
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetTraceEnabled(m_instance, isEnabled);
+        }
+
+        public TraceEvent[] GetTraceEventsByDevice(string platformName, int deviceID)
+        {
+            var events = new TraceEvent[TraceEvent.MAX_DRAIN_COUNT];
+            var count = 0u;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.GetTraceEventsByDeviceID(m_instance, (uint)deviceID, events, (uint)events.Length, ref count);
+
+            return events.Take((int)count).ToArray();
+        }
+
+        public IDeviceSensor GetSensorByDevice(string platformName, int deviceID)
+        {
+            var device = Devices.FirstOrDefault(d => d.DeviceID == deviceID);
+            if (!HasMonitoringAPI || device == null) return null;
+
+            if (UseNvSMI)
+                return new DeviceSensor(() => API.NvSMI.GetDeviceCurrentTemperature(device.PciBusID),
+                                        () => API.NvSMI.GetDeviceCurrentPowerDraw(device.PciBusID));
+
+            return new DeviceSensor(() =>
+            {
+                var temperature = 0;
+                Solver.GetDeviceCurrentTemperature(m_instance, deviceID, ref temperature);
+                return temperature;
+            },
+            null); // NvAPI only reports power limit
+        }
+
+        public void SetDutyCycleByDevice(string platformName, int deviceID, int dutyCycle)
+        {
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetDeviceDutyCycle(m_instance, deviceID, (uint)dutyCycle);
+        }
+
+        // Local work size is block size, both take effect on next launch of device
+        public bool SetTuningByDevice(string platformName, int deviceID, float intensity, uint localWorkSize, out string errorMessage)
+        {
+            errorMessage = string.Empty;
+            var isFound = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetDeviceTuning(m_instance, deviceID, intensity, localWorkSize, ref isFound);
+
+            if (!isFound)
+            {
+                errorMessage = "Device is not mining";
+                return false;
+            }
+
+            var device = Devices.FirstOrDefault(d => d.DeviceID == deviceID);
+            if (device != null && intensity > 0) device.Intensity = intensity;
+            return true;
+        }
+
+        public bool IsMiningByDevice(string platformName, int deviceID)
+        {
+            var isMining = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.IsDeviceMining(m_instance, deviceID, ref isMining);
+
+            return isMining;
+        }
+
+        public bool IsPausedByDevice(string platformName, int deviceID)
+        {
+            var isPaused = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.IsDevicePaused(m_instance, deviceID, ref isPaused);
+
+            return isPaused;
+        }
+
+        // Resets and re-initializes device, blocks until its mining thread stopped (up to 10 seconds)
+        public bool RestartDevice(string platformName, int deviceID)
+        {
+            var isRestarted = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.RestartDevice(m_instance, deviceID, ref isRestarted);
+
+            return isRestarted;
+        }
+
         public ulong GetTotalHashrate()
         {
             if (IsPaused) return 0ul;
@@ -342,15 +464,17 @@ namespace SoliditySHA3Miner.Miner
         {
             try
             {
+                if (m_logTimer != null)
+                {
+                    m_logTimer.Stop();
+                    PrintLogEntries();
+                }
+
                 if (m_instance != null && m_instance.ToInt64() != 0)
                     Solver.DisposeInstance(m_instance);
 
                 m_GetSolutionTemplateCallback = null;
                 m_GetKingAddressCallback = null;
-                m_GetWorkPositionCallback = null;
-                m_ResetWorkPositionCallback = null;
-                m_IncrementWorkPositionCallback = null;
-                m_MessageCallback = null;
                 m_SolutionCallback = null;
             }
             catch (Exception ex)
@@ -361,7 +485,7 @@ namespace SoliditySHA3Miner.Miner
 
         #endregion IMiner
 
-        public CUDA(NetworkInterface.INetworkInterface networkInterface, Device[] cudaDevices, bool isSubmitStale, int pauseOnFailedScans)
+        public CUDA(NetworkInterface.INetworkInterface networkInterface, Device[] cudaDevices, bool isSubmitStale, int pauseOnFailedScans, int targetLaunchDuration)
         {
             try
             {
@@ -393,11 +517,13 @@ namespace SoliditySHA3Miner.Miner
                     m_GetSolutionTemplateCallback = Solver.SetOnGetSolutionTemplateHandler(m_instance, Work.GetSolutionTemplate);
                     m_GetKingAddressCallback = Solver.SetOnGetKingAddressHandler(m_instance, Work.GetKingAddress);
                 }
-                m_GetWorkPositionCallback = Solver.SetOnGetWorkPositionHandler(m_instance, Work.GetPosition);
-                m_ResetWorkPositionCallback = Solver.SetOnResetWorkPositionHandler(m_instance, Work.ResetPosition);
-                m_IncrementWorkPositionCallback = Solver.SetOnIncrementWorkPositionHandler(m_instance, Work.IncrementPosition);
-                m_MessageCallback = Solver.SetOnMessageHandler(m_instance, m_instance_OnMessage);
+                Solver.SetLogLevel(m_instance, (uint)LogEntry.MINIMUM_LEVEL);
+                m_logTimer = new Timer(LogEntry.DRAIN_INTERVAL);
+                m_logTimer.Elapsed += (sender, e) => PrintLogEntries();
+                m_logTimer.Start();
+
                 m_SolutionCallback = Solver.SetOnSolutionHandler(m_instance, m_instance_OnSolution);
+                Solver.SetNoncePool(m_instance, Work.NoncePool);
 
                 NetworkInterface.OnGetMiningParameterStatus += NetworkInterface_OnGetMiningParameterStatus;
                 NetworkInterface.OnNewMessagePrefix += NetworkInterface_OnNewMessagePrefix;
@@ -405,6 +531,7 @@ namespace SoliditySHA3Miner.Miner
                 networkInterface.OnStopSolvingCurrentChallenge += NetworkInterface_OnStopSolvingCurrentChallenge;
 
                 Solver.SetSubmitStale(m_instance, isSubmitStale);
+                Solver.SetTargetLaunchDuration(m_instance, (uint)Math.Max(0, targetLaunchDuration));
 
                 if (!Program.AllowCUDA || cudaDevices.All(d => !d.AllowDevice))
                 {
@@ -503,38 +630,59 @@ namespace SoliditySHA3Miner.Miner
             GC.Collect(GC.MaxGeneration, GCCollectionMode.Optimized, false);
         }
 
-        private void m_instance_OnMessage(int deviceID, StringBuilder type, StringBuilder message)
+        private void PrintLogEntries()
+        {
+            lock (m_logEntries)
+            {
+                if (m_instance == null || m_instance.ToInt64() == 0) return;
+
+                var count = 0u;
+                var droppedCount = 0ul;
+                do
+                {
+                    Solver.GetLogEntries(m_instance, m_logEntries, (uint)m_logEntries.Length, ref count, ref droppedCount);
+
+                    for (var i = 0; i < count; i++)
+                        PrintLogEntry(m_logEntries[i]);
+                }
+                while (count == m_logEntries.Length);
+
+                if (droppedCount > m_droppedLogCount)
+                {
+                    Program.Print(string.Format("CUDA [WARN] {0} solver messages dropped", droppedCount - m_droppedLogCount));
+                    m_droppedLogCount = droppedCount;
+                }
+            }
+        }
+
+        private void PrintLogEntry(LogEntry entry)
         {
             var sFormat = new StringBuilder();
-            if (deviceID > -1) sFormat.Append("CUDA ID: {0} ");
+            if (entry.Device > -1) sFormat.Append("CUDA ID: {0} ");
             else sFormat.Append("CUDA ");
 
-            switch (type.ToString().ToUpperInvariant())
+            switch (entry.Level)
             {
-                case "INFO":
-                    sFormat.Append(deviceID > -1 ? "[INFO] {1}" : "[INFO] {0}");
+                case LogEntry.LogLevel.Info:
+                    sFormat.Append(entry.Device > -1 ? "[INFO] {1}" : "[INFO] {0}");
                     break;
 
-                case "WARN":
-                    sFormat.Append(deviceID > -1 ? "[WARN] {1}" : "[WARN] {0}");
+                case LogEntry.LogLevel.Warn:
+                    sFormat.Append(entry.Device > -1 ? "[WARN] {1}" : "[WARN] {0}");
                     break;
 
-                case "ERROR":
-                    sFormat.Append(deviceID > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
+                case LogEntry.LogLevel.Error:
+                    sFormat.Append(entry.Device > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
                     break;
 
-                case "DEBUG":
+                case LogEntry.LogLevel.Debug:
                 default:
-#if DEBUG
-                    sFormat.Append(deviceID > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
+                    sFormat.Append(entry.Device > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
                     break;
-#else
-                    return;
-#endif
             }
-            Program.Print(deviceID > -1
-                ? string.Format(sFormat.ToString(), deviceID, message.ToString())
-                : string.Format(sFormat.ToString(), message.ToString()));
+            Program.Print(entry.Device > -1
+                ? string.Format(sFormat.ToString(), entry.Device, entry.Message)
+                : string.Format(sFormat.ToString(), entry.Message));
         }
 
         private void NetworkInterface_OnStopSolvingCurrentChallenge(NetworkInterface.INetworkInterface sender, string currentTarget)
@@ -619,8 +767,10 @@ namespace SoliditySHA3Miner.Miner
         private void m_instance_OnSolution(StringBuilder digest, StringBuilder address, StringBuilder challenge, StringBuilder target, StringBuilder solution)
         {
             var difficulty = NetworkInterface.Difficulty.ToString("X64");
+            var startSubmitTimestamp = Utils.ChromeTrace.GetTimestamp();
 
             NetworkInterface.SubmitSolution(digest.ToString(), address.ToString(), challenge.ToString(), difficulty, target.ToString(), solution.ToString(), this);
+            Utils.ChromeTrace.RecordSpan("Hand over solution", startSubmitTimestamp);
         }
     }
 }
\ No newline at end of file
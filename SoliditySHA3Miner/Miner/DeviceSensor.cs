@@ -0,0 +1,70 @@
+﻿using System;
+
+namespace SoliditySHA3Miner.Miner
+{
+    // Sensor readings of one device, read by DutyCycleController, so controller can be driven by recorded or simulated values
+    public interface IDeviceSensor
+    {
+        int GetTemperature(); // degree Celsius, negative if not available
+        int GetPowerDraw(); // watts, negative if not available
+    }
+
+    // Reads through the monitoring API of a miner (NvAPI, ADL, 'nvidia-smi' or sysfs)
+    public class DeviceSensor : IDeviceSensor
+    {
+        private readonly Func<int> m_getTemperature;
+        private readonly Func<int> m_getPowerDraw;
+
+        public DeviceSensor(Func<int> getTemperature, Func<int> getPowerDraw)
+        {
+            m_getTemperature = getTemperature;
+            m_getPowerDraw = getPowerDraw;
+        }
+
+        public int GetTemperature()
+        {
+            var temperature = m_getTemperature();
+            return (temperature == int.MinValue) ? -1 : temperature;
+        }
+
+        public int GetPowerDraw() => (m_getPowerDraw == null) ? -1 : m_getPowerDraw();
+    }
+
+    // First order thermal model of a simulated device, heating up with its duty cycle
+    public class SimulatedSensor : IDeviceSensor
+    {
+        private const double AMBIENT_TEMPERATURE = 30.0;
+        private const double FULL_LOAD_TEMPERATURE = 90.0; // settled at 100% duty cycle
+        private const double IDLE_POWER = 20.0;
+        private const double FULL_LOAD_POWER = 180.0;
+        private const double TIME_CONSTANT_SECONDS = 30.0;
+
+        private double m_temperature;
+        private DateTime m_lastUpdate;
+
+        public int DutyCycle { get; set; }
+
+        public SimulatedSensor()
+        {
+            m_temperature = AMBIENT_TEMPERATURE;
+            m_lastUpdate = DateTime.Now;
+            DutyCycle = 100;
+        }
+
+        public int GetTemperature()
+        {
+            lock (this)
+            {
+                var elapsedSeconds = (DateTime.Now - m_lastUpdate).TotalSeconds;
+                var settledTemperature = AMBIENT_TEMPERATURE + (FULL_LOAD_TEMPERATURE - AMBIENT_TEMPERATURE) * DutyCycle / 100;
+
+                m_temperature += (settledTemperature - m_temperature) * (1 - Math.Exp(-elapsedSeconds / TIME_CONSTANT_SECONDS));
+                m_lastUpdate = DateTime.Now;
+
+                return (int)Math.Round(m_temperature);
+            }
+        }
+
+        public int GetPowerDraw() => (int)Math.Round(IDLE_POWER + (FULL_LOAD_POWER - IDLE_POWER) * DutyCycle / 100);
+    }
+}
@@ -0,0 +1,161 @@
+﻿using System;
+using System.Linq;
+using System.Timers;
+
+namespace SoliditySHA3Miner.Miner
+{
+    // Restarts a single GPU that stopped on error, stalled or stopped hashing, while other devices keep mining.
+    // Restarts of a device back off exponentially so a failing card is retried less often instead of looping.
+    public class DeviceWatchdog : IDisposable
+    {
+        private const int CHECK_INTERVAL_MS = 1000;
+        private static readonly TimeSpan MIN_BACKOFF = TimeSpan.FromSeconds(10);
+        private static readonly TimeSpan MAX_BACKOFF = TimeSpan.FromMinutes(5);
+
+        private class WatchedDevice
+        {
+            public IMiner Miner;
+            public Device Device;
+            public bool IsArmed; // device reported mining since its miner started, watched from then on
+            public ulong LastLaunchCount;
+            public DateTime LastLaunchTime;
+            public DateTime LastHashTime;
+            public DateTime LastRestartTime;
+            public DateTime NextRestartTime;
+            public TimeSpan Backoff;
+        }
+
+        private readonly WatchedDevice[] m_devices;
+        private readonly TimeSpan m_timeout;
+        private readonly Timer m_checkTimer;
+        private int m_isChecking; // Interlocked, a restart blocks longer than the check interval
+
+        public DeviceWatchdog(IMiner[] miners, int timeout)
+        {
+            m_timeout = TimeSpan.FromMilliseconds(timeout);
+
+            m_devices = miners.Where(m => !(m is CPU)). // CPU threads have no device state to reset
+                               SelectMany(m => m.Devices.Where(d => d.AllowDevice).
+                                                         Select(d => new WatchedDevice
+                                                         {
+                                                             Miner = m,
+                                                             Device = d,
+                                                             LastRestartTime = DateTime.MinValue,
+                                                             Backoff = MIN_BACKOFF
+                                                         })).
+                               ToArray();
+
+            Program.Print(string.Format("[INFO] Watchdog of {0} device(s): restart after {1:0.#}s without progress",
+                                        m_devices.Length, m_timeout.TotalSeconds));
+
+            m_checkTimer = new Timer(CHECK_INTERVAL_MS);
+            m_checkTimer.Elapsed += (sender, e) => Check();
+            m_checkTimer.Start();
+        }
+
+        public void Dispose()
+        {
+            m_checkTimer.Stop();
+            m_checkTimer.Dispose();
+        }
+
+        private void Check()
+        {
+            if (System.Threading.Interlocked.CompareExchange(ref m_isChecking, 1, 0) != 0) return;
+            try
+            {
+                foreach (var device in m_devices)
+                {
+                    var reason = GetFailure(device);
+                    if (reason == null || DateTime.Now < device.NextRestartTime) continue;
+
+                    Restart(device, reason);
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to check devices: {0}", ex.Message));
+            }
+            finally { System.Threading.Interlocked.Exchange(ref m_isChecking, 0); }
+        }
+
+        // Reason to restart device, null if it is healthy or idle on purpose (paused or duty cycle)
+        private string GetFailure(WatchedDevice device)
+        {
+            var platform = device.Device.Platform;
+            var deviceID = device.Device.DeviceID;
+
+            // Miner stopped on purpose or failed to start, its devices are not restarted
+            if (!device.Miner.IsStarted)
+            {
+                device.IsArmed = false;
+                return null;
+            }
+
+            var isMining = device.Miner.IsMiningByDevice(platform, deviceID);
+            var metrics = device.Miner.GetMetricsByDevice(platform, deviceID);
+            var launchCount = metrics.LaunchDuration.Count + metrics.LaunchesAborted;
+
+            if (!device.IsArmed)
+            {
+                if (!isMining) return null; // still initializing, or never started
+
+                device.IsArmed = true;
+                device.LastLaunchCount = launchCount;
+                device.LastLaunchTime = DateTime.Now; // kernels are built before first launch
+                device.LastHashTime = DateTime.Now;
+                device.NextRestartTime = DateTime.Now + m_timeout;
+                return null;
+            }
+
+            if (!isMining) return "stopped mining";
+
+            if (device.Miner.IsPausedByDevice(platform, deviceID))
+            {
+                device.LastLaunchCount = launchCount;
+                device.LastLaunchTime = DateTime.Now;
+                device.LastHashTime = DateTime.Now;
+                return null;
+            }
+
+            if (launchCount != device.LastLaunchCount)
+            {
+                device.LastLaunchCount = launchCount;
+                device.LastLaunchTime = DateTime.Now;
+            }
+
+            if (device.Miner.GetHashrateByDevice(platform, deviceID) > 0)
+                device.LastHashTime = DateTime.Now;
+
+            if (DateTime.Now - device.LastLaunchTime > m_timeout) return "stalled";
+            if (DateTime.Now - device.LastHashTime > m_timeout) return "zero hashrate";
+
+            // Stable since last restart, next failure is retried soon again
+            if (device.Backoff > MIN_BACKOFF && DateTime.Now - device.LastRestartTime > MAX_BACKOFF)
+                device.Backoff = MIN_BACKOFF;
+
+            return null;
+        }
+
+        private void Restart(WatchedDevice device, string reason)
+        {
+            var restartCount = device.Miner.GetMetricsByDevice(device.Device.Platform, device.Device.DeviceID).Restarts + 1;
+
+            Program.Print(string.Format("{0} [WARN] Device #{1} ({2}) {3}, restarting (#{4})...",
+                                        device.Device.Type, device.Device.DeviceID, device.Device.Name, reason, restartCount));
+
+            var isRestarted = device.Miner.RestartDevice(device.Device.Platform, device.Device.DeviceID);
+
+            device.LastRestartTime = DateTime.Now;
+            device.LastLaunchTime = DateTime.Now;
+            device.LastHashTime = DateTime.Now;
+            device.NextRestartTime = DateTime.Now + device.Backoff;
+
+            if (!isRestarted)
+                Program.Print(string.Format("{0} [ERROR] Device #{1} ({2}) failed to restart, retrying in {3:0}s",
+                                            device.Device.Type, device.Device.DeviceID, device.Device.Name, device.Backoff.TotalSeconds));
+
+            device.Backoff = TimeSpan.FromTicks(Math.Min(device.Backoff.Ticks * 2, MAX_BACKOFF.Ticks));
+        }
+    }
+}
@@ -0,0 +1,103 @@
+﻿using System;
+
+namespace SoliditySHA3Miner.Miner
+{
+    // Keeps one device within temperature and power targets by the share of time it mines, instead of pausing all devices at a limit.
+    // Steps are proportional to the overshoot beyond a dead band, and stepping up is held off after a step down while the device
+    // is still settling, so duty cycle converges on the highest value within the targets (most hashes per joule at given clocks).
+    public class DutyCycleController
+    {
+        public const int FULL_DUTY_CYCLE = 100;
+        public const int MIN_DUTY_CYCLE = 10; // lower than this, device is paused at max temperature instead
+
+        private const int TEMPERATURE_DEAD_BAND = 1; // C
+        private const int POWER_DEAD_BAND_PERCENT = 3;
+        private const int STEP_PER_DEGREE = 5; // percent duty cycle per C from target
+        private const int MAX_STEP = 20;
+        private const int HOLD_UPDATES = 3; // updates after a step down before stepping up
+
+        private readonly int m_targetTemperature;
+        private readonly int m_maxTemperature;
+        private readonly int m_targetPower;
+        private int m_holdCount;
+
+        public int DutyCycle { get; private set; }
+        public string LastReason { get; private set; }
+
+        // Zero target temperature or power to ignore it, zero max temperature to never pause
+        public DutyCycleController(int targetTemperature, int maxTemperature, int targetPower)
+        {
+            m_targetTemperature = targetTemperature;
+            m_maxTemperature = maxTemperature;
+            m_targetPower = targetPower;
+
+            DutyCycle = FULL_DUTY_CYCLE;
+            LastReason = string.Empty;
+        }
+
+        // Negative reading if not available, returns true if duty cycle is changed
+        public bool Update(int temperature, int powerDraw)
+        {
+            var hasTemperature = m_targetTemperature > 0 && temperature >= 0;
+            var hasPower = m_targetPower > 0 && powerDraw >= 0;
+            if (!hasTemperature && !hasPower) return false;
+
+            var readings = string.Format("temperature {0}, power {1}",
+                                         hasTemperature ? string.Format("{0}C/{1}C", temperature, m_targetTemperature) : "n/a",
+                                         hasPower ? string.Format("{0}W/{1}W", powerDraw, m_targetPower) : "n/a");
+            var dutyCycle = DutyCycle;
+
+            if (hasTemperature && m_maxTemperature > 0 && temperature >= m_maxTemperature)
+            {
+                dutyCycle = 0;
+                LastReason = string.Format("at max temperature {0}C, {1}", m_maxTemperature, readings);
+            }
+            else if (DutyCycle == 0) // resumed at minimum, once cooled below target
+            {
+                if (hasTemperature && temperature >= m_targetTemperature) return false;
+
+                dutyCycle = MIN_DUTY_CYCLE;
+                m_holdCount = HOLD_UPDATES;
+                LastReason = "cooled down, " + readings;
+            }
+            else
+            {
+                // Most restrictive of the targets, a target within its dead band holds duty cycle
+                var step = int.MaxValue;
+                if (hasTemperature) step = Math.Min(step, GetTemperatureStep(temperature));
+                if (hasPower) step = Math.Min(step, GetPowerStep(powerDraw));
+
+                var isHeld = m_holdCount > 0;
+                if (isHeld) m_holdCount--;
+
+                if (step > 0 && isHeld) return false;
+                if (step < 0) m_holdCount = HOLD_UPDATES;
+
+                dutyCycle = Math.Max(MIN_DUTY_CYCLE, Math.Min(FULL_DUTY_CYCLE, DutyCycle + step));
+                LastReason = readings;
+            }
+
+            if (dutyCycle == DutyCycle) return false;
+
+            DutyCycle = dutyCycle;
+            return true;
+        }
+
+        private int GetTemperatureStep(int temperature)
+        {
+            var error = m_targetTemperature - temperature;
+            if (Math.Abs(error) <= TEMPERATURE_DEAD_BAND) return 0;
+
+            return Math.Max(-MAX_STEP, Math.Min(MAX_STEP, error * STEP_PER_DEGREE));
+        }
+
+        // Power above idle is taken as proportional to duty cycle
+        private int GetPowerStep(int powerDraw)
+        {
+            if (powerDraw == 0 || Math.Abs(m_targetPower - powerDraw) * 100 <= m_targetPower * POWER_DEAD_BAND_PERCENT) return 0;
+
+            var step = (int)Math.Round(DutyCycle * ((double)m_targetPower / powerDraw - 1));
+            return Math.Max(-MAX_STEP, Math.Min(MAX_STEP, step));
+        }
+    }
+}
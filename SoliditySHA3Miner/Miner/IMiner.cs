@@ -3,6 +3,8 @@ using Nethereum.Hex.HexTypes;
 using System;
 using System.Linq;
 using System.Runtime.CompilerServices;
+using System.Runtime.InteropServices;
+using System.Threading;
 
 namespace SoliditySHA3Miner.Miner
 {
@@ -15,6 +17,7 @@ namespace SoliditySHA3Miner.Miner
         bool IsAnyInitialised { get; }
         bool IsMining { get; }
         bool IsPaused { get; }
+        bool IsStarted { get; } // StartMining succeeded and StopMining was not called since
 
         void StartMining(int networkUpdateInterval, int hashratePrintInterval);
 
@@ -23,13 +26,48 @@ namespace SoliditySHA3Miner.Miner
         ulong GetTotalHashrate();
 
         ulong GetHashrateByDevice(string platformName, int deviceID);
+
+        SolverMetrics GetMetricsByDevice(string platformName, int deviceID);
+
+        void SetTraceEnabled(bool isEnabled);
+
+        TraceEvent[] GetTraceEventsByDevice(string platformName, int deviceID);
+
+        IDeviceSensor GetSensorByDevice(string platformName, int deviceID);
+
+        void SetDutyCycleByDevice(string platformName, int deviceID, int dutyCycle);
+
+        bool SetTuningByDevice(string platformName, int deviceID, float intensity, uint localWorkSize, out string errorMessage);
+
+        bool IsMiningByDevice(string platformName, int deviceID);
+
+        bool IsPausedByDevice(string platformName, int deviceID);
+
+        bool RestartDevice(string platformName, int deviceID);
     }
 
     public static class Work
     {
-        private static ulong m_Position = 0;
+        // Layout of nonce_pool_t in nonceSpace.h of each solver, every field on its own cache line
+        private const int NONCE_POOL_ALIGNMENT = 64;
+        private const int NONCE_POOL_POSITION_OFFSET = 0;
+        private const int NONCE_POOL_EPOCH_OFFSET = 64;
+        private const int NONCE_POOL_ABANDONED_OFFSET = 128;
+        private const int NONCE_POOL_SIZE = 192;
+
+        private static readonly IntPtr m_noncePoolAllocation;
+
+        // Unmanaged nonce pool shared by all solver instances, solvers reserve disjoint ranges from it lock-free.
+        public static readonly IntPtr NoncePool;
+
+        static Work()
+        {
+            m_noncePoolAllocation = Marshal.AllocHGlobal(NONCE_POOL_SIZE + NONCE_POOL_ALIGNMENT);
+            NoncePool = new IntPtr((m_noncePoolAllocation.ToInt64() + NONCE_POOL_ALIGNMENT - 1) & ~(long)(NONCE_POOL_ALIGNMENT - 1));
 
-        private static readonly object m_positionLock = new object();
+            for (var offset = 0; offset < NONCE_POOL_SIZE; offset += sizeof(long))
+                Marshal.WriteInt64(NoncePool, offset, 0L);
+        }
 
         public static byte[] KingAddress { get; set; }
 
@@ -78,30 +116,21 @@ namespace SoliditySHA3Miner.Miner
 
         public static void SetSolutionTemplate(string solutionTemplate) => SolutionTemplate = new HexBigInteger(solutionTemplate).ToHexByteArray();
 
-        [MethodImpl(MethodImplOptions.AggressiveInlining)]
-        public static void GetPosition(ref ulong workPosition)
-        {
-            lock (m_positionLock) { workPosition = m_Position; }
-        }
+        // Total nonces reserved by all solvers since launch.
+        public static unsafe ulong GetPosition() => (ulong)Interlocked.Read(ref *(long*)(NoncePool + NONCE_POOL_POSITION_OFFSET).ToPointer());
 
-        [MethodImpl(MethodImplOptions.AggressiveInlining)]
-        public static void ResetPosition(ref ulong lastPosition)
-        {
-            lock (m_positionLock)
-            {
-                lastPosition = m_Position;
-                m_Position = 0u;
-            }
-        }
+        // Nonces reserved but left unhashed when the challenge changed.
+        public static unsafe ulong GetAbandonedCount() => (ulong)Interlocked.Read(ref *(long*)(NoncePool + NONCE_POOL_ABANDONED_OFFSET).ToPointer());
 
-        [MethodImpl(MethodImplOptions.AggressiveInlining)]
-        public static void IncrementPosition(ref ulong lastPosition, ulong increment)
+        // Starts a new epoch on new challenge, solvers drop their reserved ranges on next allocation.
+        // Position is not rewound so ranges from the previous epoch never overlap with new ones.
+        public static unsafe void ResetPosition() => Interlocked.Increment(ref *(long*)(NoncePool + NONCE_POOL_EPOCH_OFFSET).ToPointer());
+
+        // Moves the shared position to the start of an assigned nonce partition (i.e. from proxy), reserved ranges are dropped.
+        public static unsafe void SetPosition(ulong position)
         {
-            lock (m_positionLock)
-            {
-                lastPosition = m_Position;
-                m_Position += increment;
-            }
+            Interlocked.Exchange(ref *(long*)(NoncePool + NONCE_POOL_POSITION_OFFSET).ToPointer(), (long)position);
+            ResetPosition();
         }
     }
 
@@ -115,4 +144,91 @@ namespace SoliditySHA3Miner.Miner
         public string Name;
         public float Intensity;
     }
+
+    // Counters recorded by solver per device (or CPU thread), layout must match SolverMetrics::getValues in solverMetrics.cpp
+    public class SolverMetrics
+    {
+        public const int HISTOGRAM_BUCKET_COUNT = 24; // bucket i counts durations up to 2^i microseconds, last bucket counts the rest
+        public const int VALUE_COUNT = (HISTOGRAM_BUCKET_COUNT + 2) * 4 + 4;
+
+        public DurationHistogram LaunchDuration { get; }
+        public DurationHistogram ChallengeSwitch { get; }
+        public DurationHistogram SolutionLatency { get; }
+        public DurationHistogram SolutionVerify { get; }
+        public ulong PositionsAllocated { get; }
+        public ulong LaunchesAborted { get; }
+        public ulong Restarts { get; }
+        public ulong HashesCompleted { get; } // by launches not aborted, unlike PositionsAllocated
+
+        public SolverMetrics(ulong[] values)
+        {
+            LaunchDuration = new DurationHistogram(values, 0);
+            ChallengeSwitch = new DurationHistogram(values, HISTOGRAM_BUCKET_COUNT + 2);
+            SolutionLatency = new DurationHistogram(values, (HISTOGRAM_BUCKET_COUNT + 2) * 2);
+            SolutionVerify = new DurationHistogram(values, (HISTOGRAM_BUCKET_COUNT + 2) * 3);
+            PositionsAllocated = values[(HISTOGRAM_BUCKET_COUNT + 2) * 4];
+            LaunchesAborted = values[(HISTOGRAM_BUCKET_COUNT + 2) * 4 + 1];
+            Restarts = values[(HISTOGRAM_BUCKET_COUNT + 2) * 4 + 2];
+            HashesCompleted = values[(HISTOGRAM_BUCKET_COUNT + 2) * 4 + 3];
+        }
+
+        public class DurationHistogram
+        {
+            public ulong[] Buckets { get; }
+            public ulong Count { get; }
+            public ulong SumMicroseconds { get; }
+
+            public DurationHistogram(ulong[] values, int offset)
+            {
+                Buckets = values.Skip(offset).Take(HISTOGRAM_BUCKET_COUNT).ToArray();
+                Count = values[offset + HISTOGRAM_BUCKET_COUNT];
+                SumMicroseconds = values[offset + HISTOGRAM_BUCKET_COUNT + 1];
+            }
+        }
+    }
+
+    // Event recorded by solver per device (or CPU thread), layout must match trace_event_t in traceBuffer.h
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TraceEvent
+    {
+        public const int MAX_DRAIN_COUNT = 4096; // capacity of native buffer
+
+        private static readonly string[] m_typeNames =
+        {
+            "Allocate work", "Enqueue kernel", "Kernel", "Readback", "Job switch", "Verify solution"
+        };
+
+        public ulong Timestamp; // microseconds of monotonic clock
+        public ulong Duration; // microseconds, zero for instant events
+        public ulong Value;
+        public ulong Type;
+
+        public string TypeName => (Type < (ulong)m_typeNames.Length) ? m_typeNames[Type] : "Unknown";
+    }
+
+    // Message logged by solver, layout must match log_entry_t in logRing.h
+    [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
+    public struct LogEntry
+    {
+        public const int DRAIN_INTERVAL = 100; // milliseconds
+        public const int MAX_DRAIN_COUNT = 64;
+
+        public enum LogLevel : uint { Debug, Info, Warn, Error }
+
+        // Messages below this level are discarded by solvers before being formatted
+#if DEBUG
+        public const LogLevel MINIMUM_LEVEL = LogLevel.Debug;
+#else
+        public const LogLevel MINIMUM_LEVEL = LogLevel.Info;
+#endif
+
+        public int Device; // -1 for messages not from a device (or CPU thread)
+        public LogLevel Level;
+
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 64)]
+        public string Source; // platform name on OpenCL, empty otherwise
+
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 952)]
+        public string Message;
+    }
 }
\ No newline at end of file
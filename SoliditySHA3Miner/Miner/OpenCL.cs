@@ -1,4 +1,5 @@
 ﻿using System;
+using System.Collections.Generic;
 using System.Linq;
 using System.Runtime.InteropServices;
 using System.Text;
@@ -13,19 +14,12 @@ namespace SoliditySHA3Miner.Miner
         public static class Solver
         {
             public const string SOLVER_NAME = "OpenCLSoliditySHA3Solver";
+            public const string SIMULATED_PLATFORM = "Simulated";
 
             public unsafe delegate void GetSolutionTemplateCallback(byte* solutionTemplate);
 
             public unsafe delegate void GetKingAddressCallback(byte* kingAddress);
 
-            public delegate void GetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void ResetWorkPositionCallback(ref ulong lastWorkPosition);
-
-            public delegate void IncrementWorkPositionCallback(ref ulong lastWorkPosition, ulong incrementSize);
-
-            public delegate void MessageCallback([In]StringBuilder platform, [In]int deviceID, [In]StringBuilder type, [In]StringBuilder message);
-
             public delegate void SolutionCallback([In]StringBuilder digest, [In]StringBuilder address, [In]StringBuilder challenge, [In]StringBuilder target, [In]StringBuilder solution);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
@@ -56,22 +50,19 @@ namespace SoliditySHA3Miner.Miner
             public static unsafe extern GetKingAddressCallback SetOnGetKingAddressHandler(IntPtr instance, GetKingAddressCallback getKingAddressCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern GetWorkPositionCallback SetOnGetWorkPositionHandler(IntPtr instance, GetWorkPositionCallback getWorkPositionCallback);
+            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern ResetWorkPositionCallback SetOnResetWorkPositionHandler(IntPtr instance, ResetWorkPositionCallback resetWorkPositionCallback);
+            public static extern void SetNoncePool(IntPtr instance, IntPtr noncePool);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern IncrementWorkPositionCallback SetOnIncrementWorkPositionHandler(IntPtr instance, IncrementWorkPositionCallback incrementWorkPositionCallback);
+            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern MessageCallback SetOnMessageHandler(IntPtr instance, MessageCallback messageCallback);
+            public static extern void SetTargetLaunchDuration(IntPtr instance, uint targetLaunchDuration);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern SolutionCallback SetOnSolutionHandler(IntPtr instance, SolutionCallback solutionCallback);
-
-            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-            public static extern void SetSubmitStale(IntPtr instance, bool submitStale);
+            public static extern void SetSimulation(IntPtr instance, uint launchLatency, ulong hashRate, uint candidateRate);
 
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void AssignDevice(IntPtr instance, StringBuilder platformName, int deviceEnum, ref float intensity, ref uint pciBusID, StringBuilder deviceName, ref ulong nameSize);
@@ -91,6 +82,21 @@ namespace SoliditySHA3Miner.Miner
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetHashRateByDevice(IntPtr instance, StringBuilder platformName, int deviceEnum, ref ulong hashRate);
 
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetMetricsByDevice(IntPtr instance, StringBuilder platformName, int deviceEnum, [Out] ulong[] metrics);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetTraceEnabled(IntPtr instance, bool isEnabled);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetTraceEventsByDevice(IntPtr instance, StringBuilder platformName, int deviceEnum, [Out] TraceEvent[] events, uint maxCount, ref uint count);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetLogLevel(IntPtr instance, uint level);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void GetLogEntries(IntPtr instance, [Out] LogEntry[] entries, uint maxCount, ref uint count, ref ulong droppedCount);
+
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void GetTotalHashRate(IntPtr instance, ref ulong totalHashRate);
 
@@ -103,6 +109,21 @@ namespace SoliditySHA3Miner.Miner
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void PauseFinding(IntPtr instance, bool pause);
 
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetDeviceDutyCycle(IntPtr instance, StringBuilder platformName, int deviceEnum, uint dutyCycle);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void SetDeviceTuning(IntPtr instance, StringBuilder platformName, int deviceEnum, float intensity, uint localWorkSize, ref bool isFound);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void IsDeviceMining(IntPtr instance, StringBuilder platformName, int deviceEnum, ref bool isMining);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void IsDevicePaused(IntPtr instance, StringBuilder platformName, int deviceEnum, ref bool isPaused);
+
+            [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+            public static extern void RestartDevice(IntPtr instance, StringBuilder platformName, int deviceEnum, ref bool isRestarted);
+
             [DllImport(SOLVER_NAME, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
             public static extern void StartFinding(IntPtr instance);
 
@@ -142,10 +163,6 @@ namespace SoliditySHA3Miner.Miner
 
         private Solver.GetSolutionTemplateCallback m_GetSolutionTemplateCallback;
         private Solver.GetKingAddressCallback m_GetKingAddressCallback;
-        private Solver.GetWorkPositionCallback m_GetWorkPositionCallback;
-        private Solver.ResetWorkPositionCallback m_ResetWorkPositionCallback;
-        private Solver.IncrementWorkPositionCallback m_IncrementWorkPositionCallback;
-        private Solver.MessageCallback m_MessageCallback;
         private Solver.SolutionCallback m_SolutionCallback;
 
         #endregion P/Invoke interface
@@ -231,9 +248,14 @@ namespace SoliditySHA3Miner.Miner
         #endregion static
 
         private Timer m_hashPrintTimer;
+        private Timer m_logTimer;
+        private readonly LogEntry[] m_logEntries = new LogEntry[LogEntry.MAX_DRAIN_COUNT];
+        private ulong m_droppedLogCount;
         private int m_pauseOnFailedScan;
         private int m_failedScanCount;
         private bool m_isCurrentChallengeStopSolving;
+        private volatile bool m_isStarted;
+        private readonly Dictionary<int, SimulatedSensor> m_simulatedSensors = new Dictionary<int, SimulatedSensor>();
 
         public readonly IntPtr m_instance;
 
@@ -286,6 +308,8 @@ namespace SoliditySHA3Miner.Miner
             }
         }
 
+        public bool IsStarted => m_isStarted;
+
         public bool IsPaused
         {
             get
@@ -311,6 +335,7 @@ namespace SoliditySHA3Miner.Miner
 
                 NetworkInterface.ResetEffectiveHashrate();
                 Solver.StartFinding(m_instance);
+                m_isStarted = true;
             }
             catch (Exception ex)
             {
@@ -321,6 +346,7 @@ namespace SoliditySHA3Miner.Miner
 
         public void StopMining()
         {
+            m_isStarted = false;
             try
             {
                 m_hashPrintTimer.Stop();
@@ -347,6 +373,124 @@ namespace SoliditySHA3Miner.Miner
             return hashrate;
         }
 
+        public SolverMetrics GetMetricsByDevice(string platformName, int deviceID)
+        {
+            var metrics = new ulong[SolverMetrics.VALUE_COUNT];
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.GetMetricsByDevice(m_instance, new StringBuilder(platformName), deviceID, metrics);
+
+            return new SolverMetrics(metrics);
+        }
+
+        public void SetTraceEnabled(bool isEnabled)
+        {
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetTraceEnabled(m_instance, isEnabled);
+        }
+
+        public TraceEvent[] GetTraceEventsByDevice(string platformName, int deviceID)
+        {
+            var events = new TraceEvent[TraceEvent.MAX_DRAIN_COUNT];
+            var count = 0u;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.GetTraceEventsByDevice(m_instance, new StringBuilder(platformName), deviceID, events, (uint)events.Length, ref count);
+
+            return events.Take((int)count).ToArray();
+        }
+
+        public IDeviceSensor GetSensorByDevice(string platformName, int deviceID)
+        {
+            if (platformName == Solver.SIMULATED_PLATFORM)
+            {
+                lock (m_simulatedSensors)
+                {
+                    if (!m_simulatedSensors.TryGetValue(deviceID, out SimulatedSensor sensor))
+                        m_simulatedSensors.Add(deviceID, sensor = new SimulatedSensor());
+                    return sensor;
+                }
+            }
+
+            var device = Devices.FirstOrDefault(d => d.Platform == platformName && d.DeviceID == deviceID);
+            if (!HasMonitoringAPI || device == null) return null;
+
+            if (UseLinuxQuery)
+                return new DeviceSensor(() => API.AmdLinuxQuery.GetDeviceCurrentTemperature(device.PciBusID),
+                                        () => API.AmdLinuxQuery.GetDeviceCurrentPowerDraw(device.PciBusID));
+
+            return new DeviceSensor(() =>
+            {
+                var temperature = 0;
+                Solver.GetDeviceCurrentTemperature(m_instance, new StringBuilder(platformName), deviceID, ref temperature);
+                return temperature;
+            },
+            null); // ADL only reports power limit
+        }
+
+        public void SetDutyCycleByDevice(string platformName, int deviceID, int dutyCycle)
+        {
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetDeviceDutyCycle(m_instance, new StringBuilder(platformName), deviceID, (uint)dutyCycle);
+
+            lock (m_simulatedSensors)
+            {
+                if (platformName == Solver.SIMULATED_PLATFORM && m_simulatedSensors.TryGetValue(deviceID, out SimulatedSensor sensor))
+                    sensor.DutyCycle = dutyCycle;
+            }
+        }
+
+        // Takes effect on next launch of device
+        public bool SetTuningByDevice(string platformName, int deviceID, float intensity, uint localWorkSize, out string errorMessage)
+        {
+            errorMessage = string.Empty;
+            var isFound = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.SetDeviceTuning(m_instance, new StringBuilder(platformName), deviceID, intensity, localWorkSize, ref isFound);
+
+            if (!isFound)
+            {
+                errorMessage = "Device is not mining";
+                return false;
+            }
+
+            var device = Devices.FirstOrDefault(d => d.Platform == platformName && d.DeviceID == deviceID);
+            if (device != null && intensity > 0) device.Intensity = intensity;
+            return true;
+        }
+
+        public bool IsMiningByDevice(string platformName, int deviceID)
+        {
+            var isMining = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.IsDeviceMining(m_instance, new StringBuilder(platformName), deviceID, ref isMining);
+
+            return isMining;
+        }
+
+        public bool IsPausedByDevice(string platformName, int deviceID)
+        {
+            var isPaused = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.IsDevicePaused(m_instance, new StringBuilder(platformName), deviceID, ref isPaused);
+
+            return isPaused;
+        }
+
+        // Releases and re-creates context of device, blocks until its mining thread stopped (up to 10 seconds)
+        public bool RestartDevice(string platformName, int deviceID)
+        {
+            var isRestarted = false;
+
+            if (m_instance != null && m_instance.ToInt64() != 0)
+                Solver.RestartDevice(m_instance, new StringBuilder(platformName), deviceID, ref isRestarted);
+
+            return isRestarted;
+        }
+
         public ulong GetTotalHashrate()
         {
             if (IsPaused) return 0ul;
@@ -363,15 +507,17 @@ namespace SoliditySHA3Miner.Miner
         {
             try
             {
+                if (m_logTimer != null)
+                {
+                    m_logTimer.Stop();
+                    PrintLogEntries();
+                }
+
                 if (m_instance != null && m_instance.ToInt64() != 0)
                     Solver.DisposeInstance(m_instance);
 
                 m_GetSolutionTemplateCallback = null;
                 m_GetKingAddressCallback = null;
-                m_GetWorkPositionCallback = null;
-                m_ResetWorkPositionCallback = null;
-                m_IncrementWorkPositionCallback = null;
-                m_MessageCallback = null;
                 m_SolutionCallback = null;
             }
             catch (Exception ex)
@@ -383,7 +529,8 @@ namespace SoliditySHA3Miner.Miner
         #endregion IMiner
 
         public OpenCL(NetworkInterface.INetworkInterface networkInterface,
-                      Device[] intelDevices, Device[] amdDevices, bool isSubmitStale, int pauseOnFailedScans)
+                      Device[] intelDevices, Device[] amdDevices, bool isSubmitStale, int pauseOnFailedScans, int targetLaunchDuration,
+                      int simulatedDeviceCount, uint simulatedLatency, ulong simulatedHashrate, uint simulatedCandidateRate)
         {
             try
             {
@@ -413,11 +560,13 @@ namespace SoliditySHA3Miner.Miner
                     m_GetSolutionTemplateCallback = Solver.SetOnGetSolutionTemplateHandler(m_instance, Work.GetSolutionTemplate);
                     m_GetKingAddressCallback = Solver.SetOnGetKingAddressHandler(m_instance, Work.GetKingAddress);
                 }
-                m_GetWorkPositionCallback = Solver.SetOnGetWorkPositionHandler(m_instance, Work.GetPosition);
-                m_ResetWorkPositionCallback = Solver.SetOnResetWorkPositionHandler(m_instance, Work.ResetPosition);
-                m_IncrementWorkPositionCallback = Solver.SetOnIncrementWorkPositionHandler(m_instance, Work.IncrementPosition);
-                m_MessageCallback = Solver.SetOnMessageHandler(m_instance, m_instance_OnMessage);
+                Solver.SetLogLevel(m_instance, (uint)LogEntry.MINIMUM_LEVEL);
+                m_logTimer = new Timer(LogEntry.DRAIN_INTERVAL);
+                m_logTimer.Elapsed += (sender, e) => PrintLogEntries();
+                m_logTimer.Start();
+
                 m_SolutionCallback = Solver.SetOnSolutionHandler(m_instance, m_instance_OnSolution);
+                Solver.SetNoncePool(m_instance, Work.NoncePool);
 
                 NetworkInterface.OnGetMiningParameterStatus += NetworkInterface_OnGetMiningParameterStatus;
                 NetworkInterface.OnNewMessagePrefix += NetworkInterface_OnNewMessagePrefix;
@@ -425,8 +574,21 @@ namespace SoliditySHA3Miner.Miner
                 networkInterface.OnStopSolvingCurrentChallenge += NetworkInterface_OnStopSolvingCurrentChallenge;
 
                 Solver.SetSubmitStale(m_instance, isSubmitStale);
-
-                if ((!Program.AllowIntel && !Program.AllowAMD) || (intelDevices.All(d => !d.AllowDevice) && amdDevices.All(d => !d.AllowDevice)))
+                Solver.SetTargetLaunchDuration(m_instance, (uint)Math.Max(0, targetLaunchDuration));
+
+                var simulatedDevices = Enumerable.Range(0, Math.Max(0, simulatedDeviceCount)).
+                                                  Select(i => new Device
+                                                  {
+                                                      AllowDevice = true,
+                                                      Type = "OpenCL",
+                                                      Platform = Solver.SIMULATED_PLATFORM,
+                                                      DeviceID = i,
+                                                      Name = "Simulated device"
+                                                  }).
+                                                  ToArray();
+
+                if (((!Program.AllowIntel && !Program.AllowAMD) || (intelDevices.All(d => !d.AllowDevice) && amdDevices.All(d => !d.AllowDevice)))
+                    && !simulatedDevices.Any())
                 {
                     Program.Print("OpenCL [INFO] Device not set.");
                     return;
@@ -460,12 +622,25 @@ namespace SoliditySHA3Miner.Miner
                             }
                         }
 
+                if (simulatedDevices.Any())
+                {
+                    Solver.SetSimulation(m_instance, simulatedLatency, simulatedHashrate, simulatedCandidateRate);
+
+                    for (int i = 0; i < simulatedDevices.Length; i++)
+                        Solver.AssignDevice(m_instance, new StringBuilder(simulatedDevices[i].Platform), simulatedDevices[i].DeviceID,
+                                            ref simulatedDevices[i].Intensity, ref simulatedDevices[i].PciBusID, deviceName, ref deviceNameSize);
+                }
+
                 if (Program.AllowIntel && Program.AllowAMD)
                     Devices = intelDevices.Union(amdDevices).ToArray();
                 else if (Program.AllowIntel)
                     Devices = intelDevices;
                 else if (Program.AllowAMD)
                     Devices = amdDevices;
+                else
+                    Devices = new Device[] { };
+
+                Devices = Devices.Union(simulatedDevices).ToArray(); // not kept in config, recreated on each launch
 
             }
             catch (Exception ex)
@@ -558,38 +733,59 @@ namespace SoliditySHA3Miner.Miner
             GC.Collect(GC.MaxGeneration, GCCollectionMode.Optimized, false);
         }
 
-        private void m_instance_OnMessage(StringBuilder platform, int deviceEnum, StringBuilder type, StringBuilder message)
+        private void PrintLogEntries()
+        {
+            lock (m_logEntries)
+            {
+                if (m_instance == null || m_instance.ToInt64() == 0) return;
+
+                var count = 0u;
+                var droppedCount = 0ul;
+                do
+                {
+                    Solver.GetLogEntries(m_instance, m_logEntries, (uint)m_logEntries.Length, ref count, ref droppedCount);
+
+                    for (var i = 0; i < count; i++)
+                        PrintLogEntry(m_logEntries[i]);
+                }
+                while (count == m_logEntries.Length);
+
+                if (droppedCount > m_droppedLogCount)
+                {
+                    Program.Print(string.Format("OpenCL [WARN] {0} solver messages dropped", droppedCount - m_droppedLogCount));
+                    m_droppedLogCount = droppedCount;
+                }
+            }
+        }
+
+        private void PrintLogEntry(LogEntry entry)
         {
             var sFormat = new StringBuilder();
-            if (!string.IsNullOrWhiteSpace(platform.ToString())) sFormat.Append(platform.ToString() + " ");
-            if (deviceEnum > -1) sFormat.Append("ID: {0} ");
+            sFormat.Append(string.IsNullOrEmpty(entry.Source) ? "OpenCL " : entry.Source + " (OpenCL) ");
+            if (entry.Device > -1) sFormat.Append("ID: {0} ");
 
-            switch (type.ToString().ToUpperInvariant())
+            switch (entry.Level)
             {
-                case "INFO":
-                    sFormat.Append(deviceEnum > -1 ? "[INFO] {1}" : "[INFO] {0}");
+                case LogEntry.LogLevel.Info:
+                    sFormat.Append(entry.Device > -1 ? "[INFO] {1}" : "[INFO] {0}");
                     break;
 
-                case "WARN":
-                    sFormat.Append(deviceEnum > -1 ? "[WARN] {1}" : "[WARN] {0}");
+                case LogEntry.LogLevel.Warn:
+                    sFormat.Append(entry.Device > -1 ? "[WARN] {1}" : "[WARN] {0}");
                     break;
 
-                case "ERROR":
-                    sFormat.Append(deviceEnum > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
+                case LogEntry.LogLevel.Error:
+                    sFormat.Append(entry.Device > -1 ? "[ERROR] {1}" : "[ERROR] {0}");
                     break;
 
-                case "DEBUG":
+                case LogEntry.LogLevel.Debug:
                 default:
-#if DEBUG
-                    sFormat.Append(deviceEnum > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
+                    sFormat.Append(entry.Device > -1 ? "[DEBUG] {1}" : "[DEBUG] {0}");
                     break;
-#else
-                    return;
-#endif
             }
-            Program.Print(deviceEnum > -1
-                ? string.Format(sFormat.ToString(), deviceEnum, message)
-                : string.Format(sFormat.ToString(), message));
+            Program.Print(entry.Device > -1
+                ? string.Format(sFormat.ToString(), entry.Device, entry.Message)
+                : string.Format(sFormat.ToString(), entry.Message));
         }
 
         private void NetworkInterface_OnStopSolvingCurrentChallenge(NetworkInterface.INetworkInterface sender, string currentTarget)
@@ -674,8 +870,10 @@ namespace SoliditySHA3Miner.Miner
         private void m_instance_OnSolution(StringBuilder digest, StringBuilder address, StringBuilder challenge, StringBuilder target, StringBuilder solution)
         {
             var difficulty = NetworkInterface.Difficulty.ToString("X64");
+            var startSubmitTimestamp = Utils.ChromeTrace.GetTimestamp();
 
             NetworkInterface.SubmitSolution(digest.ToString(), address.ToString(), challenge.ToString(), difficulty, target.ToString(), solution.ToString(), this);
+            Utils.ChromeTrace.RecordSpan("Hand over solution", startSubmitTimestamp);
         }
     }
 }
\ No newline at end of file
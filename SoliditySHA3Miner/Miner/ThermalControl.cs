@@ -0,0 +1,78 @@
+﻿using System;
+using System.Linq;
+using System.Timers;
+
+namespace SoliditySHA3Miner.Miner
+{
+    // Drives a DutyCycleController for each allowed device with a sensor, on its own timer so slow sensors do not hold up API sampling
+    public class ThermalControl : IDisposable
+    {
+        private class ControlledDevice
+        {
+            public IMiner Miner;
+            public Device Device;
+            public IDeviceSensor Sensor;
+            public DutyCycleController Controller;
+        }
+
+        private readonly ControlledDevice[] m_devices;
+        private readonly Timer m_updateTimer;
+        private int m_isUpdating; // Interlocked, so overlapping timer callbacks never update a controller twice
+
+        public ThermalControl(IMiner[] miners, int interval, int targetTemperature, int maxTemperature, int targetPower)
+        {
+            m_devices = miners.SelectMany(m => m.Devices.Where(d => d.AllowDevice).
+                                                         Select(d => new ControlledDevice
+                                                         {
+                                                             Miner = m,
+                                                             Device = d,
+                                                             Sensor = m.GetSensorByDevice(d.Platform, d.DeviceID),
+                                                             Controller = new DutyCycleController(targetTemperature, maxTemperature, targetPower)
+                                                         })).
+                               Where(d => d.Sensor != null).
+                               ToArray();
+
+            Program.Print(string.Format("[INFO] Thermal control of {0} device(s): target {1}, max {2}, power {3}",
+                                        m_devices.Length,
+                                        (targetTemperature > 0) ? targetTemperature + "C" : "n/a",
+                                        (maxTemperature > 0) ? maxTemperature + "C" : "n/a",
+                                        (targetPower > 0) ? targetPower + "W" : "n/a"));
+
+            m_updateTimer = new Timer(Math.Max(interval, 1000));
+            m_updateTimer.Elapsed += (sender, e) => Update();
+            m_updateTimer.Start();
+        }
+
+        public void Dispose()
+        {
+            m_updateTimer.Stop();
+            m_updateTimer.Dispose();
+        }
+
+        private void Update()
+        {
+            if (System.Threading.Interlocked.CompareExchange(ref m_isUpdating, 1, 0) != 0) return;
+            try
+            {
+                foreach (var device in m_devices)
+                {
+                    if (!device.Miner.IsMining) continue;
+
+                    var lastDutyCycle = device.Controller.DutyCycle;
+                    if (!device.Controller.Update(device.Sensor.GetTemperature(), device.Sensor.GetPowerDraw())) continue;
+
+                    device.Miner.SetDutyCycleByDevice(device.Device.Platform, device.Device.DeviceID, device.Controller.DutyCycle);
+
+                    Program.Print(string.Format("{0} [INFO] Device #{1} ({2}) duty cycle {3}% -> {4}% ({5})",
+                                                device.Device.Type, device.Device.DeviceID, device.Device.Name,
+                                                lastDutyCycle, device.Controller.DutyCycle, device.Controller.LastReason));
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to update thermal control: {0}", ex.Message));
+            }
+            finally { System.Threading.Interlocked.Exchange(ref m_isUpdating, 0); }
+        }
+    }
+}
@@ -0,0 +1,177 @@
+﻿using Nethereum.Hex.HexTypes;
+using System;
+using System.Numerics;
+using System.Timers;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Offline source of synthetic jobs for benchmark mode, solutions are only counted and nothing is sent to a network
+    public class BenchmarkInterface : INetworkInterface
+    {
+        public const ulong EASY_DIFFICULTY = 1ul; // ~1 candidate per 4.2 MH, to measure readback and verification
+        public const ulong HARD_DIFFICULTY = 1ul << 40; // no candidate expected, to measure raw hashing
+
+        private const int CHALLENGE_SEED = 0x0B7C; // challenges repeat across runs
+
+        private readonly BigInteger uint256_MaxValue = BigInteger.Pow(2, 256);
+        private readonly BigInteger m_maxTarget = BigInteger.Pow(2, 234); // as of 0xBTC contract
+
+        private readonly Random m_random;
+        private readonly int m_jobInterval;
+        private System.Timers.Timer m_newJobTimer;
+        private System.Timers.Timer m_hashPrintTimer;
+        private DateTime m_effectiveStartDateTime;
+        private ulong m_effectiveShareCount;
+        private string m_lastMessagePrefix;
+        private string m_target;
+
+        public event GetMiningParameterStatusEvent OnGetMiningParameterStatus;
+        public event NewMessagePrefixEvent OnNewMessagePrefix;
+        public event NewTargetEvent OnNewTarget;
+        public event StopSolvingCurrentChallengeEvent OnStopSolvingCurrentChallenge;
+
+        public event GetTotalHashrateEvent OnGetTotalHashrate;
+
+        public bool IsPool => true;
+        public ulong SubmittedShares { get; private set; }
+        public ulong RejectedShares => 0ul;
+        public ulong StaleShares { get; private set; }
+        public ulong DroppedShares => 0ul;
+        public ulong Difficulty { get; }
+        public string DifficultyHex { get; }
+        public int LastSubmitLatency => 0;
+        public int Latency => 0;
+        public Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        public Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        public Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
+        public string MinerAddress { get; }
+        public string SubmitURL => "benchmark";
+        public string CurrentChallenge { get; private set; }
+
+        public ulong JobCount { get; private set; }
+        public string Target => m_target;
+
+        public static ulong ParseDifficulty(string difficulty)
+        {
+            switch (difficulty.ToLower())
+            {
+                case "easy": return EASY_DIFFICULTY;
+                case "hard": return HARD_DIFFICULTY;
+                default: return ulong.Parse(difficulty);
+            }
+        }
+
+        public BenchmarkInterface(string minerAddress, ulong difficulty, int jobInterval, int hashratePrintInterval)
+        {
+            if (difficulty == 0) throw new ArgumentException("Benchmark difficulty must be above zero.");
+
+            m_random = new Random(CHALLENGE_SEED);
+            m_jobInterval = jobInterval;
+            MinerAddress = minerAddress;
+            Difficulty = difficulty;
+            DifficultyHex = new HexBigInteger(new BigInteger(difficulty)).HexValue;
+            ParameterLatencyHistogram = new Utils.LatencyHistogram(); // not applicable, jobs are generated locally
+            SubmitLatencyHistogram = new Utils.LatencyHistogram();
+            BroadcastLatencyHistogram = new Utils.LatencyHistogram();
+
+            m_target = Utils.Numerics.BigIntegerToByte32HexString(m_maxTarget / difficulty);
+            m_effectiveStartDateTime = DateTime.Now;
+            NewJob();
+
+            if (hashratePrintInterval > 0)
+            {
+                m_hashPrintTimer = new System.Timers.Timer(hashratePrintInterval);
+                m_hashPrintTimer.Elapsed += m_hashPrintTimer_Elapsed;
+                m_hashPrintTimer.Start();
+            }
+        }
+
+        public void Dispose()
+        {
+            if (m_newJobTimer != null) m_newJobTimer.Stop();
+            if (m_hashPrintTimer != null) m_hashPrintTimer.Stop();
+        }
+
+        private void NewJob()
+        {
+            var challenge = new byte[32];
+            lock (m_random) { m_random.NextBytes(challenge); }
+
+            CurrentChallenge = "0x" + BitConverter.ToString(challenge).Replace("-", string.Empty).ToLower();
+            m_lastMessagePrefix = CurrentChallenge + MinerAddress.Replace("0x", string.Empty);
+            JobCount++;
+
+            Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
+
+            Miner.Work.ResetPosition();
+            OnNewMessagePrefix?.Invoke(this, m_lastMessagePrefix);
+        }
+
+        private void m_newJobTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            NewJob(); // job switch on every interval, to measure challenge switch of devices
+        }
+
+        private void m_hashPrintTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            var totalHashRate = 0ul;
+            OnGetTotalHashrate?.Invoke(this, ref totalHashRate);
+            Program.Print(string.Format("[INFO] Total Hashrate: {0} MH/s (Effective) / {1} MH/s (Local)",
+                                        GetEffectiveHashrate() / 1000000.0f, totalHashRate / 1000000.0f));
+        }
+
+        public TimeSpan GetTimeLeftToSolveBlock(ulong hashrate)
+        {
+            return TimeSpan.Zero; // no block to solve
+        }
+
+        // Hashrate implied by shares found since reset, should match local hashrate over a long run at low difficulty
+        public ulong GetEffectiveHashrate()
+        {
+            var seconds = (DateTime.Now - m_effectiveStartDateTime).TotalSeconds;
+            if (seconds < 1 || m_effectiveShareCount == 0) return 0ul;
+
+            return (ulong)(new BigInteger(Difficulty) * uint256_MaxValue / m_maxTarget * m_effectiveShareCount / new BigInteger(seconds));
+        }
+
+        public void ResetEffectiveHashrate()
+        {
+            lock (this)
+            {
+                m_effectiveStartDateTime = DateTime.Now;
+                m_effectiveShareCount = 0ul;
+            }
+        }
+
+        public void UpdateMiningParameters()
+        {
+            // Replay current job to newly started miners, new jobs are generated on timer
+            OnGetMiningParameterStatus?.Invoke(this, true, null);
+            OnNewMessagePrefix?.Invoke(this, m_lastMessagePrefix);
+            OnNewTarget?.Invoke(this, m_target);
+
+            if (m_newJobTimer == null && m_jobInterval > 0)
+            {
+                m_newJobTimer = new System.Timers.Timer(m_jobInterval);
+                m_newJobTimer.Elapsed += m_newJobTimer_Elapsed;
+                m_newJobTimer.Start();
+            }
+        }
+
+        public bool SubmitSolution(string digest, string fromAddress, string challenge, string difficulty, string target, string solution, Miner.IMiner sender)
+        {
+            if (string.IsNullOrWhiteSpace(solution) || solution == "0x") return false;
+
+            lock (this)
+            {
+                if (challenge != CurrentChallenge) StaleShares++;
+                else
+                {
+                    SubmittedShares++;
+                    m_effectiveShareCount++;
+                }
+            }
+            return true; // not printed, logging each share would skew the benchmark at low difficulty
+        }
+    }
+}
@@ -0,0 +1,87 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.Threading.Tasks;
+using System.Timers;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Refreshes gas price from a JSON API in background, submissions read the cached value without waiting on the API
+    public class GasPriceOracle : IDisposable
+    {
+        private const int REFRESH_INTERVAL_MS = 15000;
+        private static readonly TimeSpan CACHE_TTL = TimeSpan.FromMinutes(2);
+
+        private readonly string m_apiURL;
+        private readonly string m_apiPath;
+        private readonly float m_multiplier;
+        private readonly float m_offset;
+        private readonly Timer m_refreshTimer;
+        private int m_isRefreshing; // API request may take longer than refresh interval
+
+        private float m_gasPrice;
+        private DateTime m_lastUpdateDateTime;
+
+        public string URL => m_apiURL;
+
+        public GasPriceOracle(string apiURL, string apiPath, float multiplier, float offset)
+        {
+            m_apiURL = apiURL;
+            m_apiPath = apiPath;
+            m_multiplier = multiplier;
+            m_offset = offset;
+            m_lastUpdateDateTime = DateTime.MinValue;
+
+            m_refreshTimer = new Timer(REFRESH_INTERVAL_MS);
+            m_refreshTimer.Elapsed += (sender, e) => Refresh();
+            m_refreshTimer.Start();
+
+            Task.Run(() => Refresh());
+        }
+
+        public void Dispose()
+        {
+            m_refreshTimer.Stop();
+            m_refreshTimer.Dispose();
+        }
+
+        // Gas price in GWei (after multiplier and offset), false if there is no value within TTL
+        public bool TryGetGasPrice(out float gasPrice)
+        {
+            lock (this)
+            {
+                gasPrice = m_gasPrice;
+                return (DateTime.Now - m_lastUpdateDateTime) < CACHE_TTL;
+            }
+        }
+
+        private void Refresh()
+        {
+            if (System.Threading.Interlocked.CompareExchange(ref m_isRefreshing, 1, 0) != 0) return;
+            try
+            {
+                var apiGasPrice = Utils.Json.DeserializeFromURLAsync(m_apiURL).Result.SelectToken(m_apiPath).Value<float>();
+                if (apiGasPrice > 0)
+                {
+                    apiGasPrice *= m_multiplier;
+                    apiGasPrice += m_offset;
+
+                    lock (this)
+                    {
+                        if (apiGasPrice != m_gasPrice)
+                            Program.Print(string.Format("[INFO] Gas price of {0} GWei (after {1} offset) from API: {2}", apiGasPrice, m_offset, m_apiURL));
+
+                        m_gasPrice = apiGasPrice;
+                        m_lastUpdateDateTime = DateTime.Now;
+                    }
+                }
+                else
+                    Program.Print(string.Format("[ERROR] Gas price of 0 GWei was retuned by API: {0}", m_apiURL));
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to read gas price from API: {0}\n{1}", m_apiURL, (ex.InnerException ?? ex).Message));
+            }
+            finally { System.Threading.Interlocked.Exchange(ref m_isRefreshing, 0); }
+        }
+    }
+}
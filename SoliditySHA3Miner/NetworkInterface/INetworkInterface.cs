@@ -21,10 +21,15 @@ namespace SoliditySHA3Miner.NetworkInterface
         bool IsPool { get; }
         ulong SubmittedShares { get; }
         ulong RejectedShares { get; }
+        ulong StaleShares { get; }
+        ulong DroppedShares { get; }
         ulong Difficulty { get; }
         string DifficultyHex { get; }
         int LastSubmitLatency { get; }
         int Latency { get; }
+        Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
         string MinerAddress { get; }
         string SubmitURL { get; }
         string CurrentChallenge { get; }
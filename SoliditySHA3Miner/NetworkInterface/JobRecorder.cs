@@ -0,0 +1,132 @@
+﻿using Nethereum.Hex.HexTypes;
+using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.Text;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Records jobs delivered by a network interface with their time, one JSON line each, to be fed back to miners by ReplayInterface.
+    // Lines are proxy notifications ('notify', 'status', 'stopSolving') with milliseconds since recording started, and 'end' on dispose.
+    public class JobRecorder : IDisposable
+    {
+        private readonly INetworkInterface m_upstream;
+        private readonly HexBigInteger m_maxTarget;
+        private readonly StreamWriter m_writer;
+        private readonly Stopwatch m_stopwatch;
+
+        private string m_lastMessagePrefix;
+        private string m_lastTarget;
+        private string m_lastRecordedJob;
+        private bool? m_lastStatus;
+        private ulong m_jobCount;
+
+        public JobRecorder(INetworkInterface upstream, HexBigInteger maxTarget, string filePath)
+        {
+            m_upstream = upstream;
+            m_maxTarget = maxTarget;
+            m_writer = new StreamWriter(filePath, false, new UTF8Encoding(false)) { AutoFlush = true, NewLine = "\n" };
+            m_stopwatch = Stopwatch.StartNew();
+
+            m_upstream.OnGetMiningParameterStatus += Upstream_OnGetMiningParameterStatus;
+            m_upstream.OnNewMessagePrefix += Upstream_OnNewMessagePrefix;
+            m_upstream.OnNewTarget += Upstream_OnNewTarget;
+            m_upstream.OnStopSolvingCurrentChallenge += Upstream_OnStopSolvingCurrentChallenge;
+
+            Program.Print(string.Format("[INFO] Recording jobs to {0}", filePath));
+        }
+
+        public void Dispose()
+        {
+            m_upstream.OnGetMiningParameterStatus -= Upstream_OnGetMiningParameterStatus;
+            m_upstream.OnNewMessagePrefix -= Upstream_OnNewMessagePrefix;
+            m_upstream.OnNewTarget -= Upstream_OnNewTarget;
+            m_upstream.OnStopSolvingCurrentChallenge -= Upstream_OnStopSolvingCurrentChallenge;
+
+            lock (m_writer)
+            {
+                Record("end", new JArray()); // replay runs until here, so last job keeps its duration
+                m_writer.Dispose();
+            }
+            Program.Print(string.Format("[INFO] Recorded {0} jobs.", m_jobCount));
+        }
+
+        private void Record(string method, JToken parameters)
+        {
+            try
+            {
+                var record = new JObject
+                {
+                    ["time"] = m_stopwatch.ElapsedMilliseconds,
+                    ["timestamp"] = Program.GetCurrentTimestamp(),
+                    ["method"] = method,
+                    ["params"] = parameters
+                };
+                m_writer.WriteLine(record.ToString(Formatting.None));
+            }
+            catch (Exception ex)
+            {
+                Program.Print("[ERROR] Failed to record job: " + ex.Message);
+            }
+        }
+
+        // Same job as sent by ProxyServer, recorded once per change since current job is replayed to each starting miner
+        private void RecordJob()
+        {
+            if (string.IsNullOrWhiteSpace(m_lastMessagePrefix) || string.IsNullOrWhiteSpace(m_lastTarget)) return;
+
+            var job = new JObject
+            {
+                ["messagePrefix"] = m_lastMessagePrefix,
+                ["target"] = m_lastTarget,
+                ["difficulty"] = m_upstream.Difficulty,
+                ["isPool"] = m_upstream.IsPool,
+                ["minerAddress"] = m_upstream.MinerAddress,
+                ["maxTarget"] = m_maxTarget?.HexValue
+            };
+
+            var jobString = job.ToString(Formatting.None);
+            if (jobString == m_lastRecordedJob) return;
+
+            m_lastRecordedJob = jobString;
+            m_jobCount++;
+            Record("notify", job);
+        }
+
+        private void Upstream_OnGetMiningParameterStatus(INetworkInterface sender, bool success, MiningParameters miningParameters)
+        {
+            lock (m_writer)
+            {
+                if (m_lastStatus == success) return;
+
+                m_lastStatus = success;
+                Record("status", new JArray(success));
+            }
+        }
+
+        private void Upstream_OnNewMessagePrefix(INetworkInterface sender, string messagePrefix)
+        {
+            lock (m_writer)
+            {
+                m_lastMessagePrefix = messagePrefix;
+                RecordJob();
+            }
+        }
+
+        private void Upstream_OnNewTarget(INetworkInterface sender, string target)
+        {
+            lock (m_writer)
+            {
+                m_lastTarget = target;
+                RecordJob();
+            }
+        }
+
+        private void Upstream_OnStopSolvingCurrentChallenge(INetworkInterface sender, string currentTarget)
+        {
+            lock (m_writer) { Record("stopSolving", new JArray(currentTarget)); }
+        }
+    }
+}
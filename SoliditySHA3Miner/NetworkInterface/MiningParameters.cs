@@ -38,6 +38,11 @@ namespace SoliditySHA3Miner.NetworkInterface
             return new MiningParameters(poolURL, getPoolEthAddress, getChallengeNumber, getMinimumShareDifficulty, getMinimumShareTarget);
         }
 
+        public static MiningParameters GetPoolMiningParameters(JObject pushParameters)
+        {
+            return new MiningParameters(pushParameters);
+        }
+
         private MiningParameters(string ethAddress,
                                  Function getMiningDifficulty,
                                  Function getMiningTarget,
@@ -48,22 +53,29 @@ namespace SoliditySHA3Miner.NetworkInterface
             var retryCount = 0;
             var exceptions = new List<Exception>();
 
+            // Independent calls are sent concurrently, retries are sent individually
+            var miningDifficultyTask = getMiningDifficulty.CallAsync<BigInteger>();
+            var miningTargetTask = getMiningTarget.CallAsync<BigInteger>();
+            var challengeNumberTask = getChallengeNumber.CallAsync<byte[]>();
+
             while (retryCount < 10)
             {
                 try
                 {
-                    MiningDifficulty = new HexBigInteger(getMiningDifficulty.CallAsync<BigInteger>().Result);
+                    MiningDifficulty = new HexBigInteger((miningDifficultyTask ?? getMiningDifficulty.CallAsync<BigInteger>()).Result);
                     break;
                 }
                 catch (AggregateException ex)
                 {
                     retryCount++;
+                    miningDifficultyTask = null;
                     if (retryCount == 10) exceptions.Add(ex.InnerExceptions[0]);
                     else { Task.Delay(200).Wait(); }
                 }
                 catch (Exception ex)
                 {
                     retryCount++;
+                    miningDifficultyTask = null;
                     if (retryCount == 10) exceptions.Add(ex);
                     else { Task.Delay(200).Wait(); }
                 }
@@ -73,7 +85,7 @@ namespace SoliditySHA3Miner.NetworkInterface
             {
                 try
                 {
-                    MiningTarget = new HexBigInteger(getMiningTarget.CallAsync<BigInteger>().Result);
+                    MiningTarget = new HexBigInteger((miningTargetTask ?? getMiningTarget.CallAsync<BigInteger>()).Result);
                     MiningTargetByte32 = Utils.Numerics.FilterByte32Array(MiningTarget.Value.ToByteArray(littleEndian: false));
                     MiningTargetByte32String = Utils.Numerics.BigIntegerToByte32HexString(MiningTarget.Value);
                     break;
@@ -81,12 +93,14 @@ namespace SoliditySHA3Miner.NetworkInterface
                 catch (AggregateException ex)
                 {
                     retryCount++;
+                    miningTargetTask = null;
                     if (retryCount == 10) exceptions.Add(ex.InnerExceptions[0]);
                     else { Task.Delay(200).Wait(); }
                 }
                 catch (Exception ex)
                 {
                     retryCount++;
+                    miningTargetTask = null;
                     if (retryCount == 10) exceptions.Add(ex);
                     else { Task.Delay(200).Wait(); }
                 }
@@ -96,7 +110,7 @@ namespace SoliditySHA3Miner.NetworkInterface
             {
                 try
                 {
-                    ChallengeNumberByte32 = Utils.Numerics.FilterByte32Array(getChallengeNumber.CallAsync<byte[]>().Result);
+                    ChallengeNumberByte32 = Utils.Numerics.FilterByte32Array((challengeNumberTask ?? getChallengeNumber.CallAsync<byte[]>()).Result);
                     ChallengeNumber = new HexBigInteger(HexByteConvertorExtensions.ToHex(ChallengeNumberByte32, prefix: true));
                     ChallengeNumberByte32String = Utils.Numerics.BigIntegerToByte32HexString(ChallengeNumber.Value);
                     break;
@@ -104,12 +118,14 @@ namespace SoliditySHA3Miner.NetworkInterface
                 catch (AggregateException ex)
                 {
                     retryCount++;
+                    challengeNumberTask = null;
                     if (retryCount == 10) exceptions.Add(ex.InnerExceptions[0]);
                     else { Task.Delay(200).Wait(); }
                 }
                 catch (Exception ex)
                 {
                     retryCount++;
+                    challengeNumberTask = null;
                     if (retryCount == 10) exceptions.Add(ex);
                     else { Task.Delay(200).Wait(); }
                 }
@@ -125,12 +141,27 @@ namespace SoliditySHA3Miner.NetworkInterface
                                  JObject getMinimumShareDifficulty,
                                  JObject getMinimumShareTarget)
         {
-            EthAddress = Utils.Json.InvokeJObjectRPC(poolURL, getPoolEthAddress).SelectToken("$.result").Value<string>();
-            ChallengeNumber = new HexBigInteger(Utils.Json.InvokeJObjectRPC(poolURL, getChallengeNumber).SelectToken("$.result").Value<string>());
+            var responses = Utils.Json.InvokeJObjectRPCBatch(poolURL, getPoolEthAddress, getChallengeNumber, getMinimumShareDifficulty, getMinimumShareTarget);
+
+            EthAddress = responses[0].SelectToken("$.result").Value<string>();
+            ChallengeNumber = new HexBigInteger(responses[1].SelectToken("$.result").Value<string>());
+            ChallengeNumberByte32 = Utils.Numerics.FilterByte32Array(ChallengeNumber.Value.ToByteArray(littleEndian: false));
+            ChallengeNumberByte32String = Utils.Numerics.BigIntegerToByte32HexString(ChallengeNumber.Value);
+            MiningDifficulty = new HexBigInteger(BigInteger.Parse(responses[2].SelectToken("$.result").Value<string>()));
+            MiningTarget = new HexBigInteger(BigInteger.Parse(responses[3].SelectToken("$.result").Value<string>()));
+            MiningTargetByte32 = Utils.Numerics.FilterByte32Array(MiningTarget.Value.ToByteArray(littleEndian: false));
+            MiningTargetByte32String = Utils.Numerics.BigIntegerToByte32HexString(MiningTarget.Value);
+        }
+
+        // Parameters pushed by pool in a single object, same values as the individual pool RPC calls
+        private MiningParameters(JObject pushParameters)
+        {
+            EthAddress = pushParameters.Value<string>("poolEthAddress");
+            ChallengeNumber = new HexBigInteger(pushParameters.Value<string>("challengeNumber"));
             ChallengeNumberByte32 = Utils.Numerics.FilterByte32Array(ChallengeNumber.Value.ToByteArray(littleEndian: false));
             ChallengeNumberByte32String = Utils.Numerics.BigIntegerToByte32HexString(ChallengeNumber.Value);
-            MiningDifficulty = new HexBigInteger(BigInteger.Parse(Utils.Json.InvokeJObjectRPC(poolURL, getMinimumShareDifficulty).SelectToken("$.result").Value<string>()));
-            MiningTarget = new HexBigInteger(BigInteger.Parse(Utils.Json.InvokeJObjectRPC(poolURL, getMinimumShareTarget).SelectToken("$.result").Value<string>()));
+            MiningDifficulty = new HexBigInteger(BigInteger.Parse(pushParameters.Value<string>("minimumShareDifficulty")));
+            MiningTarget = new HexBigInteger(BigInteger.Parse(pushParameters.Value<string>("minimumShareTarget")));
             MiningTargetByte32 = Utils.Numerics.FilterByte32Array(MiningTarget.Value.ToByteArray(littleEndian: false));
             MiningTargetByte32String = Utils.Numerics.BigIntegerToByte32HexString(MiningTarget.Value);
         }
@@ -0,0 +1,149 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.Numerics;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    public delegate void PendingMintEvent(PendingMintWatcher sender, string transactionID, string fromAddress, string solution, string digest, BigInteger gasPrice);
+
+    // Follows pending transactions from a subscription endpoint, and raises an event for each 'mint' call to the token contract
+    // Full transaction objects are requested first, nodes that only send hashes are looked up with 'eth_getTransactionByHash'
+    public class PendingMintWatcher : IDisposable
+    {
+        private const int SUBSCRIPTION_TIMEOUT_MS = 5000;
+        private const int RECONNECT_DELAY_MS = 5000;
+        private const int MAX_CONCURRENT_LOOKUPS = 8;
+
+        private readonly string m_subscriptionURL;
+        private readonly string m_web3URL;
+        private readonly string m_contractAddress;
+        private readonly string m_mintCallDataPrefix;
+        private readonly int m_mintInputParamCount;
+        private readonly SemaphoreSlim m_lookupSlots;
+        private Web3Subscription m_subscription;
+        private bool m_isRunning;
+
+        public event PendingMintEvent OnPendingMint;
+
+        public PendingMintWatcher(string subscriptionURL, string web3URL, string contractAddress, string mintCallDataPrefix, int mintInputParamCount)
+        {
+            m_subscriptionURL = subscriptionURL;
+            m_web3URL = web3URL;
+            m_contractAddress = contractAddress;
+            m_mintCallDataPrefix = mintCallDataPrefix;
+            m_mintInputParamCount = mintInputParamCount;
+            m_lookupSlots = new SemaphoreSlim(MAX_CONCURRENT_LOOKUPS);
+        }
+
+        public void Dispose()
+        {
+            m_isRunning = false;
+            if (m_subscription != null) m_subscription.Dispose();
+        }
+
+        public void Start()
+        {
+            m_isRunning = true;
+            Task.Factory.StartNew(() => Run(), TaskCreationOptions.LongRunning);
+        }
+
+        private void Run()
+        {
+            var isFullTransaction = true;
+
+            while (m_isRunning)
+            {
+                var subscription = new Web3Subscription(m_subscriptionURL);
+                try
+                {
+                    subscription.Connect(SUBSCRIPTION_TIMEOUT_MS);
+
+                    string subscriptionID;
+                    try
+                    {
+                        subscriptionID = isFullTransaction
+                                       ? subscription.Subscribe(SUBSCRIPTION_TIMEOUT_MS, "newPendingTransactions", true)
+                                       : subscription.Subscribe(SUBSCRIPTION_TIMEOUT_MS, "newPendingTransactions");
+                    }
+                    catch (NotSupportedException) when (isFullTransaction)
+                    {
+                        isFullTransaction = false;
+                        subscriptionID = subscription.Subscribe(SUBSCRIPTION_TIMEOUT_MS, "newPendingTransactions");
+                    }
+
+                    m_subscription = subscription;
+                    Program.Print(string.Format("[INFO] Watching pending 'mint' transactions from {0}", m_subscriptionURL));
+
+                    while (m_isRunning)
+                    {
+                        var notification = subscription.Receive().Result;
+                        if (notification == null) break;
+
+                        if (notification.SelectToken("$.params.subscription")?.Value<string>() != subscriptionID) continue;
+
+                        var result = notification.SelectToken("$.params.result");
+                        if (result is JObject transaction)
+                            CheckTransaction(transaction);
+
+                        else if (result?.Type == JTokenType.String && m_lookupSlots.Wait(0)) // skip lookups when falling behind
+                            Task.Run(() => LookupTransaction(result.Value<string>()));
+                    }
+                }
+                catch (NotSupportedException ex)
+                {
+                    Program.Print(string.Format("[ERROR] Pending transactions not available ({0}), stopped watching 'mint' transactions", ex.Message));
+                    m_isRunning = false;
+                }
+                catch (Exception ex)
+                {
+                    if (m_isRunning) Program.Print("[ERROR] " + (ex.InnerException ?? ex).Message);
+                }
+                finally { subscription.Dispose(); }
+
+                if (m_isRunning)
+                {
+                    Program.Print("[WARN] Pending transactions disconnected, reconnecting...");
+                    Thread.Sleep(RECONNECT_DELAY_MS);
+                }
+            }
+        }
+
+        private async Task LookupTransaction(string transactionID)
+        {
+            try
+            {
+                var request = new JObject
+                {
+                    ["jsonrpc"] = "2.0",
+                    ["id"] = "1",
+                    ["method"] = "eth_getTransactionByHash",
+                    ["params"] = new JArray(transactionID)
+                };
+                var response = await Utils.Json.InvokeJObjectRPCAsync(m_web3URL, request);
+
+                if (response.SelectToken("$.result") is JObject transaction) CheckTransaction(transaction);
+            }
+            catch { } // transaction may already be dropped or mined
+            finally { m_lookupSlots.Release(); }
+        }
+
+        private void CheckTransaction(JObject transaction)
+        {
+            var to = transaction.Value<string>("to");
+            var input = transaction.Value<string>("input");
+
+            if (!m_contractAddress.Equals(to, StringComparison.OrdinalIgnoreCase) || input == null ||
+                !input.StartsWith(m_mintCallDataPrefix, StringComparison.OrdinalIgnoreCase) ||
+                input.Length < m_mintCallDataPrefix.Length + 64 * m_mintInputParamCount)
+                return;
+
+            var solution = "0x" + input.Substring(m_mintCallDataPrefix.Length, 64);
+            var digest = (m_mintInputParamCount > 1) ? "0x" + input.Substring(m_mintCallDataPrefix.Length + 64, 64) : null;
+            var gasPrice = new Nethereum.Hex.HexTypes.HexBigInteger(transaction.Value<string>("gasPrice") ?? "0x0").Value;
+
+            OnPendingMint?.Invoke(this, transaction.Value<string>("hash"), transaction.Value<string>("from"), solution, digest, gasPrice);
+        }
+    }
+}
@@ -2,9 +2,11 @@
 using Newtonsoft.Json.Linq;
 using System;
 using System.Collections.Generic;
+using System.IO;
 using System.Linq;
-using System.Net.NetworkInformation;
+using System.Net.WebSockets;
 using System.Numerics;
+using System.Text;
 using System.Threading.Tasks;
 using System.Timers;
 
@@ -30,6 +32,21 @@ namespace SoliditySHA3Miner.NetworkInterface
         private int m_retryCount;
         private MiningParameters m_lastParameters;
 
+        private const int PUSH_TIMEOUT_MS = 5000;
+        private static readonly TimeSpan MIN_PUSH_RETRY_DELAY = TimeSpan.FromSeconds(5);
+        private static readonly TimeSpan MAX_PUSH_RETRY_DELAY = TimeSpan.FromMinutes(5);
+        private ClientWebSocket m_pushSocket;
+        private Timer m_pushRetryTimer;
+        private TimeSpan m_pushRetryDelay = MIN_PUSH_RETRY_DELAY;
+        private int m_isPushConnecting;
+        private bool m_isPushSupported;
+        private bool m_isPushConnected;
+        private readonly object m_updateParametersLock = new object();
+
+        private readonly SubmissionQueue m_submissionQueue;
+        private ulong m_queuedShares;
+        private bool m_isJournalResubmitted;
+
         public event GetMiningParameterStatusEvent OnGetMiningParameterStatus;
         public event NewMessagePrefixEvent OnNewMessagePrefix;
         public event NewTargetEvent OnNewTarget;
@@ -41,11 +58,16 @@ namespace SoliditySHA3Miner.NetworkInterface
         public bool IsSecondaryPool { get; }
         public ulong SubmittedShares { get; private set; }
         public ulong RejectedShares { get; private set; }
+        public ulong StaleShares { get; private set; }
+        public ulong DroppedShares => m_submissionQueue.DroppedCount;
         public PoolInterface SecondaryPool { get; }
         public ulong Difficulty { get; private set; }
         public string DifficultyHex { get; private set; }
         public int LastSubmitLatency { get; private set; }
         public int Latency { get; private set; }
+        public Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        public Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        public Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
         public string MinerAddress { get; }
 
         public string SubmitURL
@@ -70,8 +92,12 @@ namespace SoliditySHA3Miner.NetworkInterface
             m_maxTarget = maxTarget;
             m_updateInterval = updateInterval;
             m_isGetMiningParameters = false;
+            m_isPushSupported = !isSecondary;
             LastSubmitLatency = -1;
             Latency = -1;
+            ParameterLatencyHistogram = new Utils.LatencyHistogram();
+            SubmitLatencyHistogram = new Utils.LatencyHistogram();
+            BroadcastLatencyHistogram = new Utils.LatencyHistogram(); // not applicable, shares are not broadcast as transactions
             SecondaryPool = secondaryPool;
             IsSecondaryPool = isSecondary;
 
@@ -84,6 +110,8 @@ namespace SoliditySHA3Miner.NetworkInterface
             RejectedShares = 0ul;
 
             m_submitDateTimeList = new List<DateTime>(MAX_SUBMIT_DTM_COUNT + 1);
+            m_submissionQueue = new SubmissionQueue(SubmitSharesAsync, IsShareStale,
+                                                    isSecondary ? null : Path.Combine(Program.AppDirPath, "Journal", "PoolShares.json"));
 
             if (hashratePrintInterval > 0)
             {
@@ -95,9 +123,147 @@ namespace SoliditySHA3Miner.NetworkInterface
 
         public void Dispose()
         {
+            m_isPushSupported = false;
+            if (m_pushRetryTimer != null) m_pushRetryTimer.Stop();
+            if (m_pushSocket != null) m_pushSocket.Abort();
+
+            m_submissionQueue.Dispose();
+
             if (SecondaryPool != null) SecondaryPool.Dispose();
         }
 
+        public string PushURL
+        {
+            get
+            {
+                if (s_PoolURL.StartsWith("https://")) return "wss://" + s_PoolURL.Substring("https://".Length);
+                if (s_PoolURL.StartsWith("http://")) return "ws://" + s_PoolURL.Substring("http://".Length);
+                return "ws://" + s_PoolURL;
+            }
+        }
+
+        // Runs off the polling timer, so polling carries on while the pool is slow to answer a subscription
+        private void ConnectPush()
+        {
+            if (!m_isPushSupported || System.Threading.Interlocked.CompareExchange(ref m_isPushConnecting, 1, 0) != 0) return;
+
+            var socket = new ClientWebSocket();
+            try
+            {
+                var startTime = DateTime.Now;
+
+                if (!socket.ConnectAsync(new Uri(PushURL), System.Threading.CancellationToken.None).Wait(PUSH_TIMEOUT_MS))
+                    throw new TimeoutException("Connection timed out.");
+
+                if (!SendPushMessage(socket, GetPoolParameter("subscribeMiningParameters", MinerAddress)).Wait(PUSH_TIMEOUT_MS))
+                    throw new TimeoutException("Subscribe timed out.");
+
+                var subscribe = ReceivePushMessage(socket);
+                if (!subscribe.Wait(PUSH_TIMEOUT_MS))
+                    throw new TimeoutException("Subscription timed out.");
+
+                var result = subscribe.Result?.SelectToken("$.result") as JObject;
+                if (result == null)
+                    throw new NotSupportedException(subscribe.Result?.SelectToken("$.error.message")?.Value<string>() ?? "Subscription rejected.");
+
+                Latency = (int)(DateTime.Now - startTime).TotalMilliseconds;
+                m_pushSocket = socket;
+                m_isPushConnected = true;
+                m_pushRetryDelay = MIN_PUSH_RETRY_DELAY;
+
+                Program.Print(string.Format("[INFO] Subscribed to push notifications from {0}", PushURL));
+                UpdateMiningParameters(MiningParameters.GetPoolMiningParameters(result));
+
+                Task.Factory.StartNew(() => ReceivePushNotifications(socket), TaskCreationOptions.LongRunning);
+            }
+            catch (Exception ex)
+            {
+                socket.Abort();
+
+                // Only give up on push if the pool never accepted a subscription
+                if (m_pushSocket == null)
+                {
+                    m_isPushSupported = false;
+                    Program.Print(string.Format("[INFO] Push notifications not available ({0}), polling every {1}ms",
+                                                (ex.InnerException ?? ex).Message, m_updateInterval));
+                }
+                else
+                {
+                    Program.Print(string.Format("[WARN] Failed to resubscribe to push notifications: {0}", (ex.InnerException ?? ex).Message));
+                    SchedulePushRetry();
+                }
+            }
+            finally { m_isPushConnecting = 0; }
+        }
+
+        private void SchedulePushRetry()
+        {
+            if (!m_isPushSupported) return;
+
+            var delay = m_pushRetryDelay;
+            m_pushRetryDelay = TimeSpan.FromTicks(Math.Min(m_pushRetryDelay.Ticks * 2, MAX_PUSH_RETRY_DELAY.Ticks));
+
+            if (m_pushRetryTimer != null) m_pushRetryTimer.Dispose();
+            m_pushRetryTimer = new Timer(delay.TotalMilliseconds) { AutoReset = false };
+            m_pushRetryTimer.Elapsed += (sender, e) => ConnectPush();
+            m_pushRetryTimer.Start();
+        }
+
+        private void ReceivePushNotifications(ClientWebSocket socket)
+        {
+            try
+            {
+                while (socket.State == WebSocketState.Open)
+                {
+                    var notification = ReceivePushMessage(socket).Result;
+                    if (notification == null) break;
+
+                    if (notification.SelectToken("$.method")?.Value<string>() == "miningParameters")
+                        UpdateMiningParameters(MiningParameters.GetPoolMiningParameters((JObject)notification.SelectToken("$.params")));
+                }
+            }
+            catch (Exception ex)
+            {
+                if (m_isPushSupported) Program.Print("[ERROR] " + (ex.InnerException ?? ex).Message);
+            }
+            finally
+            {
+                m_isPushConnected = false;
+                socket.Abort();
+
+                if (m_isPushSupported)
+                {
+                    Program.Print(string.Format("[WARN] Push notifications disconnected, polling until resubscribed in {0:0}s...", m_pushRetryDelay.TotalSeconds));
+                    SchedulePushRetry();
+                }
+            }
+        }
+
+        private static Task SendPushMessage(ClientWebSocket socket, JObject message)
+        {
+            var buffer = Encoding.UTF8.GetBytes(message.ToString(Newtonsoft.Json.Formatting.None));
+            return socket.SendAsync(new ArraySegment<byte>(buffer), WebSocketMessageType.Text, true, System.Threading.CancellationToken.None);
+        }
+
+        private static async Task<JObject> ReceivePushMessage(ClientWebSocket socket)
+        {
+            var buffer = new ArraySegment<byte>(new byte[4096]);
+
+            using (var message = new MemoryStream())
+            {
+                WebSocketReceiveResult result;
+                do
+                {
+                    result = await socket.ReceiveAsync(buffer, System.Threading.CancellationToken.None);
+                    if (result.MessageType == WebSocketMessageType.Close) return null;
+
+                    message.Write(buffer.Array, buffer.Offset, result.Count);
+                } while (!result.EndOfMessage);
+
+                return JObject.Parse(Encoding.UTF8.GetString(message.ToArray()));
+            }
+        }
+
         private JObject GetPoolParameter(string method, params string[] parameters)
         {
             var paramObject = new JObject
@@ -155,43 +321,7 @@ namespace SoliditySHA3Miner.NetworkInterface
                 if (success)
                 {
                     m_runFailover = false;
-                    var tempLatency = (int)(DateTime.Now - startTime).TotalMilliseconds;
-                    try
-                    {
-                        using (var ping = new Ping())
-                        {
-                            var poolURL = s_PoolURL.Contains("://") ? s_PoolURL.Split("://")[1] : s_PoolURL;
-                            try
-                            {
-                                var response = ping.Send(poolURL);
-                                if (response.RoundtripTime > 0)
-                                    tempLatency = (int)response.RoundtripTime;
-                            }
-                            catch
-                            {
-                                try
-                                {
-                                    poolURL = poolURL.Split('/').First();
-                                    var response = ping.Send(poolURL);
-                                    if (response.RoundtripTime > 0)
-                                        tempLatency = (int)response.RoundtripTime;
-                                }
-                                catch
-                                {
-                                    try
-                                    {
-                                        poolURL = poolURL.Split(':').First();
-                                        var response = ping.Send(poolURL);
-                                        if (response.RoundtripTime > 0)
-                                            tempLatency = (int)response.RoundtripTime;
-                                    }
-                                    catch { }
-                                }
-                            }
-                        }
-                    }
-                    catch { }
-                    Latency = tempLatency;
+                    Latency = ParameterLatencyHistogram.Record(startTime);
                 }
             }
 
@@ -234,10 +364,11 @@ namespace SoliditySHA3Miner.NetworkInterface
 
         private void m_updateMinerTimer_Elapsed(object sender, ElapsedEventArgs e)
         {
-            if (m_isGetMiningParameters) return;
+            if (m_isGetMiningParameters || m_isPushConnected) return;
             try
             {
                 m_isGetMiningParameters = true;
+
                 var miningParameters = GetMiningParameters();
                 if (miningParameters == null)
                 {
@@ -245,58 +376,80 @@ namespace SoliditySHA3Miner.NetworkInterface
                     return;
                 }
 
-                var address = miningParameters.EthAddress;
-                var target = miningParameters.MiningTargetByte32String;
-                CurrentChallenge = miningParameters.ChallengeNumberByte32String;
-
-                if (m_lastParameters == null || miningParameters.ChallengeNumber.Value != m_lastParameters.ChallengeNumber.Value)
-                {
-                    Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
-                    OnNewMessagePrefix(this, CurrentChallenge + address.Replace("0x", string.Empty));
-                    if (m_challengeReceiveDateTime == DateTime.MinValue) m_challengeReceiveDateTime = DateTime.Now;
-                }
+                UpdateMiningParameters(miningParameters);
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] {0}", ex.Message));
+            }
+            finally { m_isGetMiningParameters = false; }
+        }
 
-                if (m_customDifficulity == 0)
+        private void UpdateMiningParameters(MiningParameters miningParameters)
+        {
+            lock (m_updateParametersLock) // either from polling or push notification
+            {
+                try
                 {
-                    DifficultyHex = miningParameters.MiningDifficulty.HexValue;
+                    var address = miningParameters.EthAddress;
+                    var target = miningParameters.MiningTargetByte32String;
+                    CurrentChallenge = miningParameters.ChallengeNumberByte32String;
 
-                    if (m_lastParameters == null || miningParameters.MiningTarget.Value != m_lastParameters.MiningTarget.Value)
+                    if (m_lastParameters == null || miningParameters.ChallengeNumber.Value != m_lastParameters.ChallengeNumber.Value)
                     {
-                        Program.Print(string.Format("[INFO] New target detected {0}...", target));
-                        OnNewTarget(this, target);
+                        Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
+                        Miner.Work.ResetPosition();
+                        OnNewMessagePrefix(this, CurrentChallenge + address.Replace("0x", string.Empty));
+                        if (m_challengeReceiveDateTime == DateTime.MinValue) m_challengeReceiveDateTime = DateTime.Now;
                     }
 
-                    if (m_lastParameters == null || miningParameters.MiningDifficulty.Value != m_lastParameters.MiningDifficulty.Value)
+                    if (m_customDifficulity == 0)
                     {
-                        Program.Print(string.Format("[INFO] New difficulity detected ({0})...", miningParameters.MiningDifficulty.Value));
-                        Difficulty = Convert.ToUInt64(miningParameters.MiningDifficulty.Value.ToString());
+                        DifficultyHex = miningParameters.MiningDifficulty.HexValue;
 
-                        var calculatedTarget = m_maxTarget.Value / Difficulty;
-                        if (calculatedTarget != miningParameters.MiningTarget.Value)
+                        if (m_lastParameters == null || miningParameters.MiningTarget.Value != m_lastParameters.MiningTarget.Value)
                         {
-                            var newTarget = calculatedTarget.ToString();
-                            Program.Print(string.Format("[INFO] Update target {0}...", newTarget));
-                            OnNewTarget(this, newTarget);
+                            Program.Print(string.Format("[INFO] New target detected {0}...", target));
+                            OnNewTarget(this, target);
+                        }
+
+                        if (m_lastParameters == null || miningParameters.MiningDifficulty.Value != m_lastParameters.MiningDifficulty.Value)
+                        {
+                            Program.Print(string.Format("[INFO] New difficulity detected ({0})...", miningParameters.MiningDifficulty.Value));
+                            Difficulty = Convert.ToUInt64(miningParameters.MiningDifficulty.Value.ToString());
+
+                            var calculatedTarget = m_maxTarget.Value / Difficulty;
+                            if (calculatedTarget != miningParameters.MiningTarget.Value)
+                            {
+                                var newTarget = calculatedTarget.ToString();
+                                Program.Print(string.Format("[INFO] Update target {0}...", newTarget));
+                                OnNewTarget(this, newTarget);
+                            }
                         }
                     }
+                    else
+                    {
+                        Difficulty = m_customDifficulity;
+                        var calculatedTarget = m_maxTarget.Value / m_customDifficulity;
+                        var newTarget = new HexBigInteger(new BigInteger(m_customDifficulity)).HexValue;
+
+                        OnNewTarget(this, newTarget);
+                    }
+
+                    m_lastParameters = miningParameters;
+                    OnGetMiningParameterStatus(this, true, miningParameters);
+
+                    if (!m_isJournalResubmitted)
+                    {
+                        m_isJournalResubmitted = true;
+                        m_submissionQueue.ResubmitJournal();
+                    }
                 }
-                else
+                catch (Exception ex)
                 {
-                    Difficulty = m_customDifficulity;
-                    var calculatedTarget = m_maxTarget.Value / m_customDifficulity;
-                    var newTarget = new HexBigInteger(new BigInteger(m_customDifficulity)).HexValue;
-
-                    OnNewTarget(this, newTarget);
+                    Program.Print(string.Format("[ERROR] {0}", ex.Message));
                 }
-
-                m_lastParameters = miningParameters;
-                OnGetMiningParameterStatus(this, true, miningParameters);
             }
-            catch (Exception ex)
-            {
-                Program.Print(string.Format("[ERROR] {0}", ex.Message));
-            }
-            finally { m_isGetMiningParameters = false; }
         }
 
         /// <summary>
@@ -353,96 +506,112 @@ namespace SoliditySHA3Miner.NetworkInterface
 
             if (m_updateMinerTimer == null && m_updateInterval > 0)
             {
+                if (m_isPushSupported) Task.Run(() => ConnectPush()); // first job is polled, push takes over once subscribed
+
                 m_updateMinerTimer = new Timer(m_updateInterval);
                 m_updateMinerTimer.Elapsed += m_updateMinerTimer_Elapsed;
                 m_updateMinerTimer.Start();
             }
         }
 
+        // Blocks until the submission queue has the pool response (shares of other threads are batched meanwhile), false if rejected or failed
         public bool SubmitSolution(string digest, string fromAddress, string challenge, string difficulty, string target, string solution, Miner.IMiner sender)
         {
             if (string.IsNullOrWhiteSpace(solution) || solution == "0x") return false;
 
-            m_challengeReceiveDateTime = DateTime.Now;
-            var startSubmitDateTime = DateTime.Now;
+            return SubmitSolutionAsync(digest, fromAddress, challenge, difficulty, target, solution).GetAwaiter().GetResult();
+        }
 
-            if (m_runFailover)
-            {
-                if (SecondaryPool.SubmitSolution(digest, fromAddress, challenge, difficulty, target, solution, sender))
-                {
-                    LastSubmitLatency = (int)((DateTime.Now - startSubmitDateTime).TotalMilliseconds);
-                    Program.Print(string.Format("[INFO] Submission roundtrip latency: {0}ms", LastSubmitLatency));
+        public Task<bool> SubmitSolutionAsync(string digest, string fromAddress, string challenge, string difficulty, string target, string solution)
+        {
+            if (string.IsNullOrWhiteSpace(solution) || solution == "0x") return Task.FromResult(false);
 
-                    if (m_submitDateTimeList.Count >= MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
-                    m_submitDateTimeList.Add(DateTime.Now);
-                }
-                return false;
-            }
+            m_challengeReceiveDateTime = DateTime.Now;
 
-            difficulty = new HexBigInteger(difficulty).Value.ToString(); // change from hex to base 10 numerics
+            if (m_runFailover)
+                return SecondaryPool.SubmitSolutionAsync(digest, fromAddress, challenge, difficulty, target, solution);
 
-            var success = false;
-            var submitted = false;
-            int retryCount = 0, maxRetries = 10;
             var devFee = (ulong)Math.Round(100 / Math.Abs(DevFee.UserPercent));
-            do
-            {
-                try
-                {
-                    var poolAddress = fromAddress;
-                    lock (this)
-                    {
-                        if (SubmittedShares == ulong.MaxValue)
-                        {
-                            SubmittedShares = 0ul;
-                            RejectedShares = 0ul;
-                        }
-                        var minerAddress = ((SubmittedShares - RejectedShares) % devFee) == 0 ? DevFee.Address : MinerAddress;
+            string minerAddress;
+            lock (m_submissionQueue) { minerAddress = (m_queuedShares++ % devFee) == 0 ? DevFee.Address : MinerAddress; }
 
-                        JObject submitShare;
-                        submitShare = GetPoolParameter("submitShare", solution, minerAddress, digest, difficulty, challenge,
-                                                       m_customDifficulity > 0 ? "true" : "false", Miner.Work.GetKingAddressString());
+            return m_submissionQueue.Enqueue(new Share
+            {
+                Digest = digest,
+                FromAddress = fromAddress,
+                MinerAddress = minerAddress,
+                Challenge = challenge,
+                Difficulty = new HexBigInteger(difficulty).Value.ToString(), // change from hex to base 10 numerics
+                Target = target,
+                Solution = solution,
+                FoundDateTime = DateTime.Now
+            });
+        }
 
-                        var response = Utils.Json.InvokeJObjectRPC(s_PoolURL, submitShare);
+        private bool IsShareStale(Share share)
+        {
+            return !string.IsNullOrWhiteSpace(CurrentChallenge) && !CurrentChallenge.Equals(share.Challenge, StringComparison.OrdinalIgnoreCase);
+        }
 
-                        LastSubmitLatency = (int)((DateTime.Now - startSubmitDateTime).TotalMilliseconds);
+        // Shares without a response are returned as null, to be retried on their own
+        private async Task<bool?[]> SubmitSharesAsync(Share[] shares)
+        {
+            var submitShares = shares.Select(share =>
+                GetPoolParameter("submitShare", share.Solution, share.MinerAddress, share.Digest, share.Difficulty, share.Challenge,
+                                 m_customDifficulity > 0 ? "true" : "false", Miner.Work.GetKingAddressString())).ToArray();
 
-                        var result = response.SelectToken("$.result")?.Value<string>();
+            // Multiple shares are sent as one JSON-RPC batch, falls back to single requests if pool does not support it
+            var startSubmitDateTime = DateTime.Now;
+            var responses = (submitShares.Length > 1)
+                          ? await Utils.Json.InvokeJObjectRPCBatchAsync(s_PoolURL, submitShares)
+                          : new[] { await Utils.Json.InvokeJObjectRPCAsync(s_PoolURL, submitShares[0]) };
+            LastSubmitLatency = SubmitLatencyHistogram.Record(startSubmitDateTime);
+            Utils.ChromeTrace.RecordSpan("Submit solution", startSubmitDateTime);
+
+            var results = new bool?[shares.Length];
+            for (var i = 0; i < shares.Length; i++)
+            {
+                if (responses[i] == null) continue;
 
-                        success = (result ?? string.Empty).Equals("true", StringComparison.OrdinalIgnoreCase);
-                        if (!success) RejectedShares++;
-                        SubmittedShares++;
+                var result = responses[i].SelectToken("$.result")?.Value<string>();
+                var success = (result ?? string.Empty).Equals("true", StringComparison.OrdinalIgnoreCase);
+                results[i] = success;
 
-                        Program.Print(string.Format("[INFO] {0} [{1}] submitted to {2} pool: {3} ({4}ms)",
-                                                    (minerAddress == DevFee.Address ? "Dev. fee share" : "Miner share"),
-                                                    SubmittedShares,
-                                                    IsSecondaryPool ? "secondary" : "primary",
-                                                    (success ? "success" : "failed"),
-                                                    LastSubmitLatency));
-#if DEBUG
-                        Program.Print(submitShare.ToString());
-                        Program.Print(response.ToString());
-#endif
-                    }
-                    submitted = true;
-                }
-                catch (Exception ex)
+                ulong submittedShares;
+                lock (this)
                 {
-                    Program.Print(string.Format("[ERROR] {0}", ex.Message));
+                    if (SubmittedShares == ulong.MaxValue)
+                    {
+                        SubmittedShares = 0ul;
+                        RejectedShares = 0ul;
+                    }
+                    if (!success) RejectedShares++;
+                    if (IsShareStale(shares[i])) StaleShares++;
+                    submittedShares = ++SubmittedShares;
 
-                    retryCount += 1;
-                    if (retryCount < maxRetries) Task.Delay(500);
+                    if (success)
+                    {
+                        if (m_submitDateTimeList.Count > MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
+                        m_submitDateTimeList.Add(DateTime.Now);
+                    }
                 }
-            } while (!submitted && retryCount < maxRetries);
 
-            if (success)
-            {
-                if (m_submitDateTimeList.Count > MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
-                m_submitDateTimeList.Add(DateTime.Now);
+                Program.Print(string.Format("[INFO] {0} [{1}] submitted to {2} pool: {3} ({4}ms{5})",
+                                            (shares[i].MinerAddress == DevFee.Address ? "Dev. fee share" : "Miner share"),
+                                            submittedShares,
+                                            IsSecondaryPool ? "secondary" : "primary",
+                                            (success ? "success" : "failed"),
+                                            LastSubmitLatency,
+                                            (shares.Length > 1) ? string.Format(", batch of {0}", shares.Length) : string.Empty));
+#if DEBUG
+                Program.Print(submitShares[i].ToString());
+                Program.Print(responses[i].ToString());
+#endif
             }
-            else UpdateMiningParameters();
 
-            return success;
+            if (results.Any(success => success == false)) _ = Task.Run(() => UpdateMiningParameters());
+
+            return results;
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,229 @@
+﻿using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Net;
+using System.Net.WebSockets;
+using System.Numerics;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Local pool to test PoolInterface without a network: answers the polled pool calls (single or batched) over HTTP
+    // and pushes 'miningParameters' to WebSocket subscribers on every new challenge. Shares are accepted without checking.
+    public class PoolStubServer : IDisposable
+    {
+        private const string POOL_ADDRESS = "0x0000000000000000000000000000000000000b7c";
+        private const ulong DIFFICULTY = BenchmarkInterface.EASY_DIFFICULTY;
+
+        private readonly BigInteger m_maxTarget = BigInteger.Pow(2, 234); // as of 0xBTC contract
+        private readonly Random m_random;
+        private readonly HttpListener m_listener;
+        private readonly System.Timers.Timer m_newJobTimer;
+        private readonly List<WebSocket> m_subscribers;
+        private string m_challenge;
+        private long m_shareCount;
+
+        public PoolStubServer(string listen, int jobInterval)
+        {
+            m_random = new Random();
+            m_subscribers = new List<WebSocket>();
+            NewChallenge();
+
+            m_listener = new HttpListener();
+            m_listener.Prefixes.Add("http://" + listen.TrimEnd('/') + "/");
+            m_listener.Start();
+            Task.Factory.StartNew(Listen, TaskCreationOptions.LongRunning);
+
+            m_newJobTimer = new System.Timers.Timer(jobInterval);
+            m_newJobTimer.Elapsed += (sender, e) =>
+            {
+                NewChallenge();
+                PushParameters();
+            };
+            m_newJobTimer.Start();
+
+            Program.Print(string.Format("PoolStub [INFO] Serving pool at http://{0}/ (push at ws://{0}/), new challenge every {1}ms", listen.TrimEnd('/'), jobInterval));
+        }
+
+        public void Dispose()
+        {
+            m_newJobTimer.Stop();
+
+            lock (m_subscribers)
+            {
+                m_subscribers.ForEach(s => s.Abort());
+                m_subscribers.Clear();
+            }
+            m_listener.Stop();
+
+            Program.Print(string.Format("PoolStub [INFO] Stopped, {0} shares accepted.", m_shareCount));
+        }
+
+        private void NewChallenge()
+        {
+            var challenge = new byte[32];
+            lock (m_random) { m_random.NextBytes(challenge); }
+
+            m_challenge = "0x" + BitConverter.ToString(challenge).Replace("-", string.Empty).ToLower();
+            Program.Print(string.Format("PoolStub [INFO] New challenge {0}", m_challenge));
+        }
+
+        private JObject GetParameters()
+        {
+            return new JObject
+            {
+                ["poolEthAddress"] = POOL_ADDRESS,
+                ["challengeNumber"] = m_challenge,
+                ["minimumShareDifficulty"] = DIFFICULTY.ToString(),
+                ["minimumShareTarget"] = (m_maxTarget / DIFFICULTY).ToString()
+            };
+        }
+
+        private void Listen()
+        {
+            while (m_listener.IsListening)
+            {
+                HttpListenerContext context;
+                try { context = m_listener.GetContext(); }
+                catch { break; } // stopped
+
+                Task.Run(() => HandleContext(context));
+            }
+        }
+
+        private async Task HandleContext(HttpListenerContext context)
+        {
+            try
+            {
+                if (context.Request.IsWebSocketRequest)
+                {
+                    await HandleSubscriber((await context.AcceptWebSocketAsync(null)).WebSocket);
+                    return;
+                }
+
+                string body;
+                using (var reader = new StreamReader(context.Request.InputStream, Encoding.UTF8))
+                    body = await reader.ReadToEndAsync();
+
+                var request = JToken.Parse(body);
+                var response = (request is JArray batch)
+                             ? new JArray(batch.Select(r => HandleRequest((JObject)r)))
+                             : (JToken)HandleRequest((JObject)request);
+
+                var buffer = Encoding.UTF8.GetBytes(response.ToString(Formatting.None));
+                context.Response.ContentType = "application/json";
+                context.Response.ContentLength64 = buffer.Length;
+                await context.Response.OutputStream.WriteAsync(buffer, 0, buffer.Length);
+                context.Response.Close();
+            }
+            catch (Exception ex)
+            {
+                Program.Print("PoolStub [ERROR] " + ex.Message);
+                try
+                {
+                    context.Response.StatusCode = 400;
+                    context.Response.Close();
+                }
+                catch { }
+            }
+        }
+
+        private JObject HandleRequest(JObject request)
+        {
+            var id = request["id"];
+            switch (request.Value<string>("method"))
+            {
+                case "getPoolEthAddress": return GetResult(id, POOL_ADDRESS);
+                case "getChallengeNumber": return GetResult(id, m_challenge);
+                case "getMinimumShareDifficulty": return GetResult(id, DIFFICULTY.ToString());
+                case "getMinimumShareTarget": return GetResult(id, (m_maxTarget / DIFFICULTY).ToString());
+
+                case "submitShare":
+                    Program.Print(string.Format("PoolStub [INFO] Share [{0}] accepted", Interlocked.Increment(ref m_shareCount)));
+                    return GetResult(id, true);
+
+                default:
+                    return new JObject
+                    {
+                        ["jsonrpc"] = "2.0",
+                        ["id"] = id,
+                        ["error"] = new JObject { ["code"] = -32601, ["message"] = "Method not found" }
+                    };
+            }
+        }
+
+        private static JObject GetResult(JToken id, JToken result)
+        {
+            return new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = id,
+                ["result"] = result
+            };
+        }
+
+        private async Task HandleSubscriber(WebSocket socket)
+        {
+            var buffer = new byte[4096];
+
+            var received = await socket.ReceiveAsync(new ArraySegment<byte>(buffer), CancellationToken.None);
+            if (received.MessageType == WebSocketMessageType.Close) return;
+
+            var request = JObject.Parse(Encoding.UTF8.GetString(buffer, 0, received.Count));
+            if (request.Value<string>("method") != "subscribeMiningParameters")
+            {
+                Send(socket, HandleRequest(request));
+                return;
+            }
+
+            Send(socket, GetResult(request["id"], GetParameters()));
+            lock (m_subscribers) { m_subscribers.Add(socket); }
+            Program.Print("PoolStub [INFO] Push subscriber connected");
+
+            try
+            {
+                while (socket.State == WebSocketState.Open) // nothing else is expected, read until closed
+                {
+                    received = await socket.ReceiveAsync(new ArraySegment<byte>(buffer), CancellationToken.None);
+                    if (received.MessageType == WebSocketMessageType.Close) break;
+                }
+            }
+            finally
+            {
+                lock (m_subscribers) { m_subscribers.Remove(socket); }
+                Program.Print("PoolStub [INFO] Push subscriber disconnected");
+            }
+        }
+
+        private void PushParameters()
+        {
+            var notification = new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["method"] = "miningParameters",
+                ["params"] = GetParameters()
+            };
+
+            WebSocket[] subscribers;
+            lock (m_subscribers) { subscribers = m_subscribers.ToArray(); }
+
+            foreach (var socket in subscribers)
+            {
+                try { Send(socket, notification); }
+                catch (Exception ex) { Program.Print("PoolStub [ERROR] " + (ex.InnerException ?? ex).Message); }
+            }
+        }
+
+        private static void Send(WebSocket socket, JObject message)
+        {
+            var buffer = Encoding.UTF8.GetBytes(message.ToString(Formatting.None));
+            lock (socket) // one send at a time per socket
+                socket.SendAsync(new ArraySegment<byte>(buffer), WebSocketMessageType.Text, true, CancellationToken.None).Wait();
+        }
+    }
+}
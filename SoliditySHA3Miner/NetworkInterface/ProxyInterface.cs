@@ -0,0 +1,416 @@
+﻿using Nethereum.Hex.HexTypes;
+using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Net.Sockets;
+using System.Numerics;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+using System.Timers;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Downstream side of ProxyServer, receives jobs pushed over a persistent connection instead of polling upstream
+    public class ProxyInterface : INetworkInterface
+    {
+        private const int SUBMIT_TIMEOUT_MS = 60000;
+        private const int CONNECT_TIMEOUT_MS = 5000;
+
+        private readonly BigInteger uint256_MaxValue = BigInteger.Pow(2, 256);
+        private HexBigInteger m_maxTarget;
+        private DateTime m_challengeReceiveDateTime;
+
+        private const int MAX_SUBMIT_DTM_COUNT = 50;
+        private readonly List<DateTime> m_submitDateTimeList;
+
+        private readonly string s_ProxyURL;
+        private readonly string m_token;
+        private readonly int m_updateInterval;
+        private readonly ConcurrentDictionary<long, TaskCompletionSource<JObject>> m_pendingRequests;
+
+        private TcpClient m_client;
+        private StreamWriter m_writer;
+        private Thread m_receiveThread;
+        private System.Timers.Timer m_updateMinerTimer;
+        private System.Timers.Timer m_hashPrintTimer;
+        private long m_lastRequestID;
+        private bool m_isSubscribed;
+        private string m_lastMessagePrefix;
+        private string m_lastTarget;
+
+        public event GetMiningParameterStatusEvent OnGetMiningParameterStatus;
+        public event NewMessagePrefixEvent OnNewMessagePrefix;
+        public event NewTargetEvent OnNewTarget;
+        public event StopSolvingCurrentChallengeEvent OnStopSolvingCurrentChallenge;
+
+        public event GetTotalHashrateEvent OnGetTotalHashrate;
+
+        public bool IsPool { get; private set; }
+        public ulong SubmittedShares { get; private set; }
+        public ulong RejectedShares { get; private set; }
+        public ulong StaleShares => 0ul; // not known here, stale shares are counted by upstream pool interface of proxy
+        public ulong DroppedShares { get; private set; }
+        public ulong Difficulty { get; private set; }
+        public string DifficultyHex { get; private set; }
+        public int LastSubmitLatency { get; private set; }
+        public int Latency { get; private set; }
+        public Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        public Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        public Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
+        public string MinerAddress { get; private set; }
+        public string SubmitURL => s_ProxyURL;
+        public string CurrentChallenge { get; private set; }
+
+        public uint Partition { get; private set; }
+
+        public ProxyInterface(string proxyURL, string token, int updateInterval, int hashratePrintInterval)
+        {
+            s_ProxyURL = proxyURL;
+            m_token = token;
+            m_updateInterval = updateInterval;
+            m_pendingRequests = new ConcurrentDictionary<long, TaskCompletionSource<JObject>>();
+            m_submitDateTimeList = new List<DateTime>(MAX_SUBMIT_DTM_COUNT + 1);
+            LastSubmitLatency = -1;
+            Latency = -1;
+            ParameterLatencyHistogram = new Utils.LatencyHistogram(); // not applicable, jobs are pushed by proxy
+            SubmitLatencyHistogram = new Utils.LatencyHistogram();
+            BroadcastLatencyHistogram = new Utils.LatencyHistogram(); // not applicable, proxy submits upstream
+            SubmittedShares = 0ul;
+            RejectedShares = 0ul;
+
+            if (!Connect()) throw new Exception("Failed to connect to proxy at " + proxyURL);
+
+            if (hashratePrintInterval > 0)
+            {
+                m_hashPrintTimer = new System.Timers.Timer(hashratePrintInterval);
+                m_hashPrintTimer.Elapsed += m_hashPrintTimer_Elapsed;
+                m_hashPrintTimer.Start();
+            }
+        }
+
+        public void Dispose()
+        {
+            if (m_updateMinerTimer != null) m_updateMinerTimer.Stop();
+            if (m_hashPrintTimer != null) m_hashPrintTimer.Stop();
+            Disconnect();
+        }
+
+        private bool Connect()
+        {
+            try
+            {
+                var client = new TcpClient { NoDelay = true };
+                var startTime = DateTime.Now;
+
+                if (!client.ConnectAsync(s_ProxyURL.Split(':')[0], int.Parse(s_ProxyURL.Split(':')[1])).Wait(CONNECT_TIMEOUT_MS))
+                {
+                    client.Close();
+                    Program.Print("Proxy [ERROR] Connection timed out: " + s_ProxyURL);
+                    return false;
+                }
+                Latency = (int)(DateTime.Now - startTime).TotalMilliseconds;
+
+                m_client = client;
+                m_writer = new StreamWriter(client.GetStream(), new UTF8Encoding(false)) { AutoFlush = true, NewLine = "\n" };
+                m_receiveThread = new Thread(() => Receive(client)) { IsBackground = true };
+                m_receiveThread.Start();
+
+                // Ask for the previous partition on reconnect, so solvers still running on its template stay disjoint
+                var subscribe = Request("subscribe", Environment.MachineName, Partition.ToString(), m_token ?? string.Empty);
+                var response = subscribe.Wait(CONNECT_TIMEOUT_MS) ? subscribe.Result : null;
+                var result = response?["result"] as JObject;
+                if (result == null)
+                {
+                    Program.Print("Proxy [ERROR] Subscribe failed: " + response?["error"]?["message"]);
+                    Disconnect();
+                    return false;
+                }
+
+                if (!uint.TryParse(result.Value<string>("partition"), out uint partition) ||
+                    !ulong.TryParse(result.Value<string>("noncePosition"), out ulong noncePosition) ||
+                    !TryParseSolutionTemplate(result.Value<string>("solutionTemplate"), out byte[] solutionTemplate))
+                {
+                    Program.Print("Proxy [ERROR] Invalid subscription from " + s_ProxyURL);
+                    Disconnect();
+                    return false;
+                }
+
+                // Same partition keeps the local position, solvers may still be on the same challenge and would repeat nonces
+                var isSamePartition = (partition == Partition && Miner.Work.SolutionTemplate != null &&
+                                       solutionTemplate.SequenceEqual(Miner.Work.SolutionTemplate));
+
+                Partition = partition;
+                Miner.Work.SetKingAddress(result.Value<string>("kingAddress"));
+                Miner.Work.SolutionTemplate = solutionTemplate;
+                if (!isSamePartition) Miner.Work.SetPosition(noncePosition);
+                m_isSubscribed = true;
+
+                Program.Print(string.Format("Proxy [INFO] Connected to {0}, partition #{1}", s_ProxyURL, Partition));
+                return true;
+            }
+            catch (Exception ex)
+            {
+                Program.Print("Proxy [ERROR] " + (ex.InnerException ?? ex).Message);
+                Disconnect();
+                return false;
+            }
+        }
+
+        private static bool TryParseSolutionTemplate(string hex, out byte[] solutionTemplate)
+        {
+            solutionTemplate = null;
+            if (string.IsNullOrWhiteSpace(hex)) return false;
+
+            hex = hex.StartsWith("0x") ? hex.Substring(2) : hex;
+            if (hex.Length != ProxyServer.SOLUTION_TEMPLATE_LENGTH * 2) return false;
+
+            solutionTemplate = new byte[ProxyServer.SOLUTION_TEMPLATE_LENGTH];
+            for (var i = 0; i < solutionTemplate.Length; i++)
+                if (!byte.TryParse(hex.Substring(i * 2, 2), NumberStyles.HexNumber, CultureInfo.InvariantCulture, out solutionTemplate[i])) return false;
+
+            return true;
+        }
+
+        private void Disconnect()
+        {
+            m_isSubscribed = false;
+            try { m_client?.Close(); }
+            catch { }
+
+            foreach (var request in m_pendingRequests.Values) request.TrySetResult(null);
+            m_pendingRequests.Clear();
+        }
+
+        private Task<JObject> Request(string method, params string[] parameters)
+        {
+            var id = Interlocked.Increment(ref m_lastRequestID);
+            var completion = new TaskCompletionSource<JObject>();
+            m_pendingRequests[id] = completion;
+
+            var request = new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = id,
+                ["method"] = method,
+                ["params"] = new JArray(parameters)
+            };
+            lock (m_writer) { m_writer.WriteLine(request.ToString(Formatting.None)); }
+
+            return completion.Task;
+        }
+
+        private void Receive(TcpClient client)
+        {
+            try
+            {
+                using (var reader = new StreamReader(client.GetStream(), Encoding.UTF8))
+                {
+                    string line;
+                    while ((line = reader.ReadLine()) != null)
+                    {
+                        if (string.IsNullOrWhiteSpace(line)) continue;
+
+                        var message = JObject.Parse(line);
+                        if (message["method"] == null)
+                        {
+                            if (m_pendingRequests.TryRemove(message.Value<long>("id"), out var completion))
+                                completion.TrySetResult(message);
+                        }
+                        else HandleNotification(message.Value<string>("method"), message["params"]);
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                if (m_isSubscribed) Program.Print("Proxy [ERROR] " + ex.Message);
+            }
+            finally
+            {
+                if (client == m_client) // not replaced by a reconnection
+                {
+                    if (m_isSubscribed) Program.Print("Proxy [WARN] Disconnected from " + s_ProxyURL);
+                    Disconnect();
+                    OnGetMiningParameterStatus?.Invoke(this, false, null);
+                }
+            }
+        }
+
+        private void HandleNotification(string method, JToken parameters)
+        {
+            try
+            {
+                switch (method)
+                {
+                    case "notify":
+                        HandleJob((JObject)parameters);
+                        break;
+
+                    case "status":
+                        OnGetMiningParameterStatus?.Invoke(this, parameters[0].Value<bool>(), null);
+                        break;
+
+                    case "stopSolving":
+                        OnStopSolvingCurrentChallenge?.Invoke(this, parameters[0].Value<string>());
+                        break;
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("Proxy [ERROR] {0}", ex.Message));
+            }
+        }
+
+        private void HandleJob(JObject job)
+        {
+            var messagePrefix = job.Value<string>("messagePrefix");
+            var target = job.Value<string>("target");
+
+            IsPool = job.Value<bool>("isPool");
+            MinerAddress = job.Value<string>("minerAddress");
+            Difficulty = job.Value<ulong>("difficulty");
+            DifficultyHex = new HexBigInteger(new BigInteger(Difficulty)).HexValue;
+
+            var maxTarget = job.Value<string>("maxTarget");
+            if (!string.IsNullOrWhiteSpace(maxTarget)) m_maxTarget = new HexBigInteger(maxTarget);
+
+            if (messagePrefix != m_lastMessagePrefix)
+            {
+                CurrentChallenge = messagePrefix.Substring(0, 66);
+                Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
+
+                m_lastMessagePrefix = messagePrefix;
+                Miner.Work.ResetPosition();
+                OnNewMessagePrefix?.Invoke(this, messagePrefix);
+                m_challengeReceiveDateTime = DateTime.Now;
+            }
+
+            if (target != m_lastTarget)
+            {
+                Program.Print(string.Format("[INFO] New target detected {0}...", target));
+
+                m_lastTarget = target;
+                OnNewTarget?.Invoke(this, target);
+            }
+        }
+
+        private void m_updateMinerTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            if (!m_isSubscribed)
+            {
+                Program.Print("Proxy [INFO] Reconnecting to " + s_ProxyURL + "...");
+                if (!Connect()) return;
+            }
+
+            var totalHashrate = 0ul;
+            OnGetTotalHashrate?.Invoke(this, ref totalHashrate);
+
+            try { Request("reportHashrate", totalHashrate.ToString()); }
+            catch (Exception ex) { Program.Print("Proxy [ERROR] " + ex.Message); }
+        }
+
+        private void m_hashPrintTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            var totalHashRate = 0ul;
+            OnGetTotalHashrate?.Invoke(this, ref totalHashRate);
+            Program.Print(string.Format("[INFO] Total Hashrate: {0} MH/s (Effective) / {1} MH/s (Local)",
+                                        GetEffectiveHashrate() / 1000000.0f, totalHashRate / 1000000.0f));
+        }
+
+        public TimeSpan GetTimeLeftToSolveBlock(ulong hashrate)
+        {
+            if (m_maxTarget == null || m_maxTarget.Value == 0 || Difficulty == 0 || hashrate == 0 || m_challengeReceiveDateTime == DateTime.MinValue)
+                return TimeSpan.Zero;
+
+            var timeToSolveBlock = new BigInteger(Difficulty) * uint256_MaxValue / m_maxTarget.Value / new BigInteger(hashrate);
+
+            var secondsLeftToSolveBlock = timeToSolveBlock - (long)(DateTime.Now - m_challengeReceiveDateTime).TotalSeconds;
+
+            return (secondsLeftToSolveBlock > (long)TimeSpan.MaxValue.TotalSeconds)
+                ? TimeSpan.MaxValue
+                : TimeSpan.FromSeconds((long)secondsLeftToSolveBlock);
+        }
+
+        public ulong GetEffectiveHashrate()
+        {
+            var hashrate = 0ul;
+
+            if (m_submitDateTimeList.Count > 1 && m_maxTarget != null && m_maxTarget.Value > 0)
+            {
+                var avgSolveTime = (ulong)((DateTime.Now - m_submitDateTimeList.First()).TotalSeconds / m_submitDateTimeList.Count - 1);
+                if (avgSolveTime > 0)
+                    hashrate = (ulong)(new BigInteger(Difficulty) * uint256_MaxValue / m_maxTarget.Value / new BigInteger(avgSolveTime));
+            }
+
+            return hashrate;
+        }
+
+        public void ResetEffectiveHashrate()
+        {
+            m_submitDateTimeList.Clear();
+            m_submitDateTimeList.Add(DateTime.Now);
+        }
+
+        public void UpdateMiningParameters()
+        {
+            // Jobs are pushed by the proxy, only replay the last one received to newly started miners
+            if (!string.IsNullOrWhiteSpace(m_lastMessagePrefix)) OnNewMessagePrefix?.Invoke(this, m_lastMessagePrefix);
+            if (!string.IsNullOrWhiteSpace(m_lastTarget)) OnNewTarget?.Invoke(this, m_lastTarget);
+
+            if (m_updateMinerTimer == null && m_updateInterval > 0)
+            {
+                m_updateMinerTimer = new System.Timers.Timer(m_updateInterval);
+                m_updateMinerTimer.Elapsed += m_updateMinerTimer_Elapsed;
+                m_updateMinerTimer.Start();
+            }
+        }
+
+        public bool SubmitSolution(string digest, string fromAddress, string challenge, string difficulty, string target, string solution, Miner.IMiner sender)
+        {
+            if (string.IsNullOrWhiteSpace(solution) || solution == "0x") return false;
+
+            m_challengeReceiveDateTime = DateTime.Now;
+            var startSubmitDateTime = DateTime.Now;
+            var success = false;
+            try
+            {
+                var response = Request("submitShare", digest, fromAddress, challenge, difficulty, target, solution);
+
+                if (!response.Wait(SUBMIT_TIMEOUT_MS))
+                {
+                    Program.Print("Proxy [ERROR] Share submission timed out.");
+                    lock (this) { DroppedShares++; }
+                }
+                else
+                    success = response.Result?["result"]?.Value<bool>() ?? false;
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("Proxy [ERROR] {0}", (ex.InnerException ?? ex).Message));
+                lock (this) { DroppedShares++; }
+            }
+
+            LastSubmitLatency = SubmitLatencyHistogram.Record(startSubmitDateTime);
+            Utils.ChromeTrace.RecordSpan("Submit solution", startSubmitDateTime);
+            lock (this)
+            {
+                SubmittedShares++;
+                if (!success) RejectedShares++;
+
+                Program.Print(string.Format("[INFO] Share [{0}] submitted to proxy: {1} ({2}ms)",
+                                            SubmittedShares, (success ? "success" : "failed"), LastSubmitLatency));
+                if (success)
+                {
+                    if (m_submitDateTimeList.Count > MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
+                    m_submitDateTimeList.Add(DateTime.Now);
+                }
+            }
+            return success;
+        }
+    }
+}
@@ -0,0 +1,462 @@
+﻿using Nethereum.Hex.HexConvertors.Extensions;
+using Nethereum.Hex.HexTypes;
+using Newtonsoft.Json;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Net;
+using System.Net.Sockets;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Serves jobs from a single upstream (pool or web3) to downstream miners over newline-delimited JSON-RPC 2.0,
+    // and relays their shares upstream. Each downstream is assigned its own partition, written into the solution
+    // template (last 4 bytes, outside of nonce and King address) and used as its nonce start position.
+    // Listens on localhost unless a token is set, which downstream miners must then send on subscribe.
+    public class ProxyServer : IDisposable
+    {
+        public const int NONCE_PARTITION_SHIFT = 48;
+        public const uint LOCAL_PARTITION = 0u; // reserved for devices of this instance
+        public const uint MAX_PARTITION = (1u << (64 - NONCE_PARTITION_SHIFT)) - 1u; // so nonce start position does not wrap around to 0
+        public const int TEMPLATE_PARTITION_OFFSET = 28;
+        public const int SOLUTION_TEMPLATE_LENGTH = 32;
+
+        private class Downstream
+        {
+            public TcpClient Client;
+            public StreamWriter Writer;
+            public string EndPoint;
+            public string Name;
+            public uint Partition;
+            public long Hashrate; // Interlocked, reported by receive thread and summed on hashrate updates
+            public bool IsSubscribed;
+        }
+
+        private readonly INetworkInterface m_upstream;
+        private readonly HexBigInteger m_maxTarget;
+        private readonly List<Downstream> m_downstreams;
+        private readonly byte[] m_baseSolutionTemplate;
+        private readonly string m_token;
+
+        private Thread m_listenThread;
+        private TcpListener m_listener;
+        private bool m_isRunning;
+        private uint m_lastPartition;
+
+        private string m_lastMessagePrefix;
+        private string m_lastTarget;
+
+        public ulong SubmittedShares { get; private set; }
+        public ulong RejectedShares { get; private set; }
+
+        public int DownstreamCount
+        {
+            get { lock (m_downstreams) { return m_downstreams.Count(d => d.IsSubscribed); } }
+        }
+
+        public ProxyServer(INetworkInterface upstream, HexBigInteger maxTarget, string token)
+        {
+            m_upstream = upstream;
+            m_maxTarget = maxTarget;
+            m_token = token;
+            m_downstreams = new List<Downstream>();
+            m_lastPartition = LOCAL_PARTITION;
+
+            // Local miners of this instance take their own partition, starting at its nonce position
+            // Hex parsing drops leading zero bytes, pad so partition bytes always land at the end
+            var solutionTemplate = Miner.Work.SolutionTemplate ?? new byte[0];
+            if (solutionTemplate.Length > SOLUTION_TEMPLATE_LENGTH) throw new ArgumentException("Solution template is longer than 32 bytes.");
+
+            m_baseSolutionTemplate = new byte[SOLUTION_TEMPLATE_LENGTH];
+            Buffer.BlockCopy(solutionTemplate, 0, m_baseSolutionTemplate, SOLUTION_TEMPLATE_LENGTH - solutionTemplate.Length, solutionTemplate.Length);
+            Miner.Work.SolutionTemplate = GetPartitionSolutionTemplate(LOCAL_PARTITION);
+            Miner.Work.SetPosition((ulong)LOCAL_PARTITION << NONCE_PARTITION_SHIFT);
+
+            m_upstream.OnGetMiningParameterStatus += Upstream_OnGetMiningParameterStatus;
+            m_upstream.OnNewMessagePrefix += Upstream_OnNewMessagePrefix;
+            m_upstream.OnNewTarget += Upstream_OnNewTarget;
+            m_upstream.OnStopSolvingCurrentChallenge += Upstream_OnStopSolvingCurrentChallenge;
+            m_upstream.OnGetTotalHashrate += Upstream_OnGetTotalHashrate;
+        }
+
+        // Binds to 'IP:port', or to 'port' on localhost
+        public bool Start(string proxyBind)
+        {
+            if (string.IsNullOrWhiteSpace(proxyBind))
+            {
+                Program.Print("Proxy [ERROR] Invalid bind address: " + proxyBind);
+                return false;
+            }
+            if (!proxyBind.Contains(':')) proxyBind = IPAddress.Loopback + ":" + proxyBind;
+
+            if (!int.TryParse(proxyBind.Split(':')[1], out int port))
+            {
+                Program.Print("Proxy [ERROR] Invalid port provided: " + proxyBind);
+                return false;
+            }
+            else if (!IPAddress.TryParse(proxyBind.Split(':')[0], out IPAddress ipAddress))
+            {
+                Program.Print("Proxy [ERROR] Invalid IP address provided: " + proxyBind);
+                return false;
+            }
+            else if (!IPAddress.IsLoopback(ipAddress) && string.IsNullOrEmpty(m_token))
+            {
+                Program.Print("Proxy [ERROR] 'proxyToken' is required to serve other than localhost: " + proxyBind);
+                return false;
+            }
+            else
+            {
+                try
+                {
+                    m_listener = new TcpListener(ipAddress, port);
+                    m_listener.Start();
+                }
+                catch (Exception)
+                {
+                    Program.Print("Proxy [ERROR] Failed to bind to: " + proxyBind);
+                    return false;
+                }
+
+                m_isRunning = true;
+                m_listenThread = new Thread(Listen) { IsBackground = true };
+                m_listenThread.Start();
+
+                Program.Print(string.Format("Proxy [INFO] Service started at {0}...", m_listener.LocalEndpoint));
+
+                m_upstream.UpdateMiningParameters();
+                return true;
+            }
+        }
+
+        public void Dispose()
+        {
+            if (!m_isRunning) return;
+
+            Program.Print("Proxy [INFO] Service stopping...");
+            m_isRunning = false;
+
+            m_upstream.OnGetMiningParameterStatus -= Upstream_OnGetMiningParameterStatus;
+            m_upstream.OnNewMessagePrefix -= Upstream_OnNewMessagePrefix;
+            m_upstream.OnNewTarget -= Upstream_OnNewTarget;
+            m_upstream.OnStopSolvingCurrentChallenge -= Upstream_OnStopSolvingCurrentChallenge;
+            m_upstream.OnGetTotalHashrate -= Upstream_OnGetTotalHashrate;
+
+            try
+            {
+                m_listener.Stop();
+                m_listenThread.Join(2000);
+            }
+            catch (Exception ex)
+            {
+                Program.Print("Proxy [ERROR] An error has occured while stopping: " + ex.Message);
+            }
+
+            lock (m_downstreams)
+            {
+                m_downstreams.ForEach(d => d.Client.Close());
+                m_downstreams.Clear();
+            }
+        }
+
+        private byte[] GetPartitionSolutionTemplate(uint partition)
+        {
+            var solutionTemplate = m_baseSolutionTemplate.ToArray();
+            var partitionBytes = BitConverter.GetBytes(partition);
+            if (BitConverter.IsLittleEndian) Array.Reverse(partitionBytes);
+
+            Buffer.BlockCopy(partitionBytes, 0, solutionTemplate, TEMPLATE_PARTITION_OFFSET, partitionBytes.Length);
+            return solutionTemplate;
+        }
+
+        private static JObject GetNotification(string method, JToken parameters)
+        {
+            return new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["method"] = method,
+                ["params"] = parameters
+            };
+        }
+
+        private JObject GetJobNotification()
+        {
+            return GetNotification("notify", new JObject
+            {
+                ["messagePrefix"] = m_lastMessagePrefix,
+                ["target"] = m_lastTarget,
+                ["difficulty"] = m_upstream.Difficulty,
+                ["isPool"] = m_upstream.IsPool,
+                ["minerAddress"] = m_upstream.MinerAddress,
+                ["maxTarget"] = m_maxTarget?.HexValue
+            });
+        }
+
+        private void Send(Downstream downstream, JObject message)
+        {
+            try
+            {
+                var line = message.ToString(Formatting.None);
+                lock (downstream.Writer) { downstream.Writer.WriteLine(line); }
+            }
+            catch (Exception)
+            {
+                Disconnect(downstream);
+            }
+        }
+
+        private void Broadcast(JObject message)
+        {
+            Downstream[] downstreams;
+            lock (m_downstreams) { downstreams = m_downstreams.Where(d => d.IsSubscribed).ToArray(); }
+
+            foreach (var downstream in downstreams) Send(downstream, message);
+        }
+
+        private void Disconnect(Downstream downstream)
+        {
+            lock (m_downstreams)
+            {
+                if (!m_downstreams.Remove(downstream)) return;
+            }
+            try { downstream.Client.Close(); }
+            catch { }
+
+            Program.Print(string.Format("Proxy [INFO] Miner {0} ({1}) disconnected.", downstream.Name ?? string.Empty, downstream.EndPoint));
+        }
+
+        private void Listen()
+        {
+            while (m_isRunning)
+            {
+                try
+                {
+                    var client = m_listener.AcceptTcpClient();
+                    if (!m_isRunning) break;
+
+                    client.NoDelay = true;
+                    var downstream = new Downstream
+                    {
+                        Client = client,
+                        Writer = new StreamWriter(client.GetStream(), new UTF8Encoding(false)) { AutoFlush = true, NewLine = "\n" },
+                        EndPoint = client.Client.RemoteEndPoint.ToString()
+                    };
+                    lock (m_downstreams) { m_downstreams.Add(downstream); }
+
+                    new Thread(() => Receive(downstream)) { IsBackground = true }.Start();
+                }
+                catch (Exception ex)
+                {
+                    if (m_isRunning) Program.Print("Proxy [ERROR] " + ex.Message);
+                }
+            }
+        }
+
+        private void Receive(Downstream downstream)
+        {
+            try
+            {
+                using (var reader = new StreamReader(downstream.Client.GetStream(), Encoding.UTF8))
+                {
+                    string line;
+                    while (m_isRunning && (line = reader.ReadLine()) != null)
+                    {
+                        if (string.IsNullOrWhiteSpace(line)) continue;
+
+                        JObject request;
+                        try { request = JObject.Parse(line); }
+                        catch (JsonReaderException)
+                        {
+                            Program.Print(string.Format("Proxy [WARN] Invalid request from {0}", downstream.EndPoint));
+                            continue;
+                        }
+                        HandleRequest(downstream, request);
+                    }
+                }
+            }
+            catch (Exception ex)
+            {
+                bool isConnected;
+                lock (m_downstreams) { isConnected = m_downstreams.Contains(downstream); } // otherwise closed on purpose (i.e. unauthorized)
+
+                if (m_isRunning && isConnected) Program.Print(string.Format("Proxy [ERROR] {0}: {1}", downstream.EndPoint, ex.Message));
+            }
+            finally { Disconnect(downstream); }
+        }
+
+        private void HandleRequest(Downstream downstream, JObject request)
+        {
+            var id = request["id"];
+            var parameters = request["params"] as JArray ?? new JArray();
+
+            switch (request.Value<string>("method"))
+            {
+                case "subscribe":
+                    if (!string.IsNullOrEmpty(m_token) && !API.Control.IsTokenMatch(m_token, (parameters.Count > 2) ? parameters[2].Value<string>() : null))
+                    {
+                        Program.Print(string.Format("Proxy [WARN] Unauthorized subscribe from {0}", downstream.EndPoint));
+                        SendError(downstream, id, "Unauthorized");
+                        Disconnect(downstream);
+                        break;
+                    }
+
+                    lock (m_downstreams)
+                    {
+                        // Reuse partition from previous connection if it is not taken
+                        var lastPartition = LOCAL_PARTITION;
+                        if (parameters.Count > 1) uint.TryParse(parameters[1].Value<string>(), out lastPartition); // invalid is a new partition
+
+                        if (lastPartition != LOCAL_PARTITION && lastPartition <= MAX_PARTITION && !IsPartitionTaken(lastPartition))
+                            downstream.Partition = lastPartition;
+                        else
+                            downstream.Partition = GetFreePartition();
+
+                        if (downstream.Partition != LOCAL_PARTITION)
+                        {
+                            m_lastPartition = downstream.Partition;
+                            downstream.IsSubscribed = true;
+                        }
+                    }
+
+                    if (!downstream.IsSubscribed)
+                    {
+                        Program.Print(string.Format("Proxy [ERROR] No free partition for {0}", downstream.EndPoint));
+                        SendError(downstream, id, "No free partition");
+                        Disconnect(downstream);
+                        break;
+                    }
+                    downstream.Name = parameters.Count > 0 ? parameters[0].Value<string>() : downstream.EndPoint;
+
+                    Program.Print(string.Format("Proxy [INFO] Miner {0} ({1}) subscribed, partition #{2}",
+                                                downstream.Name, downstream.EndPoint, downstream.Partition));
+
+                    SendResult(downstream, id, new JObject
+                    {
+                        ["partition"] = downstream.Partition,
+                        ["noncePosition"] = ((ulong)downstream.Partition << NONCE_PARTITION_SHIFT).ToString(),
+                        ["solutionTemplate"] = GetPartitionSolutionTemplate(downstream.Partition).ToHex(prefix: true),
+                        ["kingAddress"] = Miner.Work.GetKingAddressString()
+                    });
+
+                    if (!string.IsNullOrWhiteSpace(m_lastMessagePrefix)) Send(downstream, GetJobNotification());
+                    break;
+
+                case "submitShare":
+                    if (!downstream.IsSubscribed || parameters.Count < 6)
+                    {
+                        SendError(downstream, id, "Not subscribed or invalid parameters");
+                        break;
+                    }
+                    var share = parameters.Select(p => p.Value<string>()).ToArray();
+
+                    Task.Factory.StartNew(() =>
+                    {
+                        var success = false;
+                        try
+                        {
+                            success = m_upstream.SubmitSolution(share[0], share[1], share[2], share[3], share[4], share[5], null);
+                        }
+                        catch (Exception ex)
+                        {
+                            Program.Print("Proxy [ERROR] " + ex.Message);
+                        }
+                        lock (this)
+                        {
+                            SubmittedShares++;
+                            if (!success) RejectedShares++;
+                        }
+                        Program.Print(string.Format("Proxy [INFO] Share from {0} relayed: {1}", downstream.Name, success ? "success" : "failed"));
+                        SendResult(downstream, id, success);
+                    });
+                    break;
+
+                case "reportHashrate":
+                    if (parameters.Count > 0 && ulong.TryParse(parameters[0].Value<string>(), out ulong hashrate))
+                    {
+                        Interlocked.Exchange(ref downstream.Hashrate, (long)hashrate);
+                        SendResult(downstream, id, true);
+                    }
+                    else SendError(downstream, id, "Invalid parameters");
+                    break;
+
+                default:
+                    SendError(downstream, id, "Method not found");
+                    break;
+            }
+        }
+
+        // Must be called under m_downstreams lock
+        private bool IsPartitionTaken(uint partition)
+        {
+            return m_downstreams.Any(d => d.IsSubscribed && d.Partition == partition);
+        }
+
+        // Next partition after the last one assigned, wrapping around within 1 to MAX_PARTITION; LOCAL_PARTITION if all are taken.
+        // Must be called under m_downstreams lock
+        private uint GetFreePartition()
+        {
+            var partition = m_lastPartition;
+            for (var i = 0u; i < MAX_PARTITION; i++)
+            {
+                partition = (partition >= MAX_PARTITION) ? 1u : partition + 1u;
+                if (!IsPartitionTaken(partition)) return partition;
+            }
+            return LOCAL_PARTITION;
+        }
+
+        private void SendResult(Downstream downstream, JToken id, JToken result)
+        {
+            Send(downstream, new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = id,
+                ["result"] = result
+            });
+        }
+
+        private void SendError(Downstream downstream, JToken id, string message)
+        {
+            Send(downstream, new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = id,
+                ["error"] = new JObject { ["code"] = -32600, ["message"] = message }
+            });
+        }
+
+        private void Upstream_OnGetMiningParameterStatus(INetworkInterface sender, bool success, MiningParameters miningParameters)
+        {
+            Broadcast(GetNotification("status", new JArray(success)));
+        }
+
+        private void Upstream_OnNewMessagePrefix(INetworkInterface sender, string messagePrefix)
+        {
+            m_lastMessagePrefix = messagePrefix;
+            if (!string.IsNullOrWhiteSpace(m_lastTarget)) Broadcast(GetJobNotification());
+        }
+
+        private void Upstream_OnNewTarget(INetworkInterface sender, string target)
+        {
+            m_lastTarget = target;
+            if (!string.IsNullOrWhiteSpace(m_lastMessagePrefix)) Broadcast(GetJobNotification());
+        }
+
+        private void Upstream_OnStopSolvingCurrentChallenge(INetworkInterface sender, string currentTarget)
+        {
+            Broadcast(GetNotification("stopSolving", new JArray(currentTarget)));
+        }
+
+        private void Upstream_OnGetTotalHashrate(INetworkInterface sender, ref ulong totalHashrate)
+        {
+            lock (m_downstreams)
+            {
+                foreach (var downstream in m_downstreams.Where(d => d.IsSubscribed))
+                    totalHashrate += (ulong)Interlocked.Read(ref downstream.Hashrate);
+            }
+        }
+    }
+}
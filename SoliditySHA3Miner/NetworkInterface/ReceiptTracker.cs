@@ -0,0 +1,119 @@
+﻿using Nethereum.Hex.HexTypes;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Concurrent;
+using System.Linq;
+using System.Timers;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    public delegate void TransactionReceiptEvent(ReceiptTracker sender, PendingTransaction transaction, bool success, ulong blockNumber);
+
+    public class PendingTransaction
+    {
+        public string TransactionID { get; set; }
+        public string FromAddress { get; set; }
+        public HexBigInteger GasLimit { get; set; }
+        public HexBigInteger GasPrice { get; set; }
+        public int ResponseTime { get; set; }
+        public DateTime SubmitDateTime { get; set; }
+        public bool IsDevFee { get; set; }
+        public ulong ShareNo { get; set; }
+    }
+
+    // Checks receipts of all pending transactions in a single batch request, once per new block
+    public class ReceiptTracker : IDisposable
+    {
+        private static readonly TimeSpan MAX_PENDING_AGE = TimeSpan.FromHours(1);
+
+        private readonly string m_web3URL;
+        private readonly ConcurrentDictionary<string, PendingTransaction> m_pendingTransactions;
+        private readonly Timer m_checkTimer;
+        private string m_lastCheckedBlock;
+        private int m_isChecking; // timer and CheckNow may run concurrently
+
+        public event TransactionReceiptEvent OnReceipt;
+
+        public int PendingCount => m_pendingTransactions.Count;
+
+        public ReceiptTracker(string web3URL, int checkInterval)
+        {
+            m_web3URL = web3URL;
+            m_pendingTransactions = new ConcurrentDictionary<string, PendingTransaction>();
+
+            m_checkTimer = new Timer(Math.Max(checkInterval, 1000));
+            m_checkTimer.Elapsed += (sender, e) => CheckReceipts(false);
+            m_checkTimer.Start();
+        }
+
+        public void Dispose()
+        {
+            m_checkTimer.Stop();
+            m_checkTimer.Dispose();
+        }
+
+        public void Track(PendingTransaction transaction)
+        {
+            m_pendingTransactions[transaction.TransactionID] = transaction;
+        }
+
+        // To be called when a block with a mint is known to be mined (i.e. new challenge), skips block number check
+        public void CheckNow()
+        {
+            System.Threading.Tasks.Task.Run(() => CheckReceipts(true));
+        }
+
+        private void CheckReceipts(bool isNewBlock)
+        {
+            if (m_pendingTransactions.IsEmpty) return;
+            if (System.Threading.Interlocked.CompareExchange(ref m_isChecking, 1, 0) != 0) return;
+            try
+            {
+                var blockNumber = Utils.Json.InvokeJObjectRPC(m_web3URL, GetRequest("eth_blockNumber")).SelectToken("$.result")?.Value<string>();
+                if (!isNewBlock && blockNumber == m_lastCheckedBlock) return;
+
+                var pendingTransactions = m_pendingTransactions.Values.ToArray();
+                var receipts = Utils.Json.InvokeJObjectRPCBatch(m_web3URL,
+                                                                pendingTransactions.Select(t => GetRequest("eth_getTransactionReceipt", t.TransactionID)).ToArray());
+
+                for (var i = 0; i < pendingTransactions.Length; i++)
+                {
+                    var transaction = pendingTransactions[i];
+
+                    if (receipts[i]?.SelectToken("$.result") is JObject receipt)
+                    {
+                        if (!m_pendingTransactions.TryRemove(transaction.TransactionID, out _)) continue; // already reported
+
+                        var success = new HexBigInteger(receipt.Value<string>("status") ?? "0x0").Value == 1;
+                        var receiptBlockNumber = (ulong)new HexBigInteger(receipt.Value<string>("blockNumber") ?? "0x0").Value;
+
+                        OnReceipt?.Invoke(this, transaction, success, receiptBlockNumber);
+                    }
+                    else if (DateTime.Now - transaction.SubmitDateTime > MAX_PENDING_AGE)
+                    {
+                        m_pendingTransactions.TryRemove(transaction.TransactionID, out _);
+                        Program.Print(string.Format("[WARN] No receipt after {0} minutes, stopped tracking transaction ID: {1}",
+                                                    MAX_PENDING_AGE.TotalMinutes, transaction.TransactionID));
+                    }
+                }
+                m_lastCheckedBlock = blockNumber;
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to check transaction receipts: {0}", (ex.InnerException ?? ex).Message));
+            }
+            finally { System.Threading.Interlocked.Exchange(ref m_isChecking, 0); }
+        }
+
+        private static JObject GetRequest(string method, params string[] parameters)
+        {
+            return new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = "1",
+                ["method"] = method,
+                ["params"] = new JArray(parameters)
+            };
+        }
+    }
+}
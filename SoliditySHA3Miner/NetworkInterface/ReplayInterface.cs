@@ -0,0 +1,258 @@
+﻿using Nethereum.Hex.HexTypes;
+using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Numerics;
+using System.Threading.Tasks;
+using System.Timers;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Feeds jobs recorded by JobRecorder to miners at original or accelerated speed, solutions are only counted.
+    // Jobs are applied as ProxyInterface applies pushed jobs, so challenge switches and stale shares follow the recording.
+    public class ReplayInterface : INetworkInterface
+    {
+        private readonly BigInteger uint256_MaxValue = BigInteger.Pow(2, 256);
+        private HexBigInteger m_maxTarget;
+        private DateTime m_challengeReceiveDateTime;
+
+        private const int MAX_SUBMIT_DTM_COUNT = 50;
+        private readonly List<DateTime> m_submitDateTimeList;
+
+        private readonly string s_ReplayPath;
+        private readonly JObject[] m_records;
+        private readonly float m_speed;
+        private readonly System.Threading.ManualResetEvent m_stopEvent;
+        private readonly TaskCompletionSource<bool> m_completion;
+        private System.Threading.Thread m_replayThread;
+        private System.Timers.Timer m_hashPrintTimer;
+        private int m_nextRecord;
+        private ulong m_jobCount;
+        private string m_lastMessagePrefix;
+        private string m_lastTarget;
+
+        public event GetMiningParameterStatusEvent OnGetMiningParameterStatus;
+        public event NewMessagePrefixEvent OnNewMessagePrefix;
+        public event NewTargetEvent OnNewTarget;
+        public event StopSolvingCurrentChallengeEvent OnStopSolvingCurrentChallenge;
+
+        public event GetTotalHashrateEvent OnGetTotalHashrate;
+
+        public bool IsPool { get; private set; }
+        public ulong SubmittedShares { get; private set; }
+        public ulong RejectedShares => 0ul;
+        public ulong StaleShares { get; private set; }
+        public ulong DroppedShares => 0ul;
+        public ulong Difficulty { get; private set; }
+        public string DifficultyHex { get; private set; }
+        public int LastSubmitLatency => 0;
+        public int Latency => 0;
+        public Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        public Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        public Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
+        public string MinerAddress { get; private set; }
+        public string SubmitURL => s_ReplayPath;
+        public string CurrentChallenge { get; private set; }
+
+        // Completed after the last record is replayed
+        public Task Completion => m_completion.Task;
+
+        public ReplayInterface(string replayPath, float speed, int hashratePrintInterval)
+        {
+            s_ReplayPath = replayPath;
+            m_speed = speed;
+            m_records = File.ReadAllLines(replayPath).
+                             Where(line => !string.IsNullOrWhiteSpace(line)).
+                             Select(line => JObject.Parse(line)).
+                             ToArray();
+
+            m_nextRecord = Array.FindIndex(m_records, r => r.Value<string>("method") == "notify");
+            if (m_nextRecord < 0) throw new Exception("No job recorded in " + replayPath);
+
+            m_submitDateTimeList = new List<DateTime>(MAX_SUBMIT_DTM_COUNT + 1);
+            m_stopEvent = new System.Threading.ManualResetEvent(false);
+            m_completion = new TaskCompletionSource<bool>();
+            ParameterLatencyHistogram = new Utils.LatencyHistogram(); // not applicable, jobs are read from file
+            SubmitLatencyHistogram = new Utils.LatencyHistogram();
+            BroadcastLatencyHistogram = new Utils.LatencyHistogram();
+
+            Program.Print(string.Format("[INFO] Replaying {0} records from {1} at {2}x speed",
+                                        m_records.Length - m_nextRecord, replayPath, speed));
+
+            HandleRecord(m_records[m_nextRecord++]); // first job is ready before miners start, replay is timed from it
+
+            if (hashratePrintInterval > 0)
+            {
+                m_hashPrintTimer = new System.Timers.Timer(hashratePrintInterval);
+                m_hashPrintTimer.Elapsed += m_hashPrintTimer_Elapsed;
+                m_hashPrintTimer.Start();
+            }
+        }
+
+        public void Dispose()
+        {
+            m_stopEvent.Set();
+            if (m_hashPrintTimer != null) m_hashPrintTimer.Stop();
+            if (m_replayThread != null) m_replayThread.Join(1000);
+            m_completion.TrySetResult(false);
+        }
+
+        private void Replay()
+        {
+            var startTime = m_records[m_nextRecord - 1].Value<long>("time");
+            var stopwatch = Stopwatch.StartNew();
+
+            for (; m_nextRecord < m_records.Length; m_nextRecord++)
+            {
+                var record = m_records[m_nextRecord];
+                var delay = (long)((record.Value<long>("time") - startTime) / m_speed) - stopwatch.ElapsedMilliseconds;
+
+                if (delay > 0 && m_stopEvent.WaitOne(TimeSpan.FromMilliseconds(delay))) return;
+                HandleRecord(record);
+            }
+
+            Program.Print(string.Format("[INFO] Replay finished in {0:0.#}s: {1} jobs, {2} shares ({3} stale)",
+                                        stopwatch.Elapsed.TotalSeconds, m_jobCount, SubmittedShares, StaleShares));
+            m_completion.TrySetResult(true);
+        }
+
+        private void HandleRecord(JObject record)
+        {
+            try
+            {
+                var parameters = record["params"];
+                switch (record.Value<string>("method"))
+                {
+                    case "notify":
+                        HandleJob((JObject)parameters);
+                        break;
+
+                    case "status":
+                        OnGetMiningParameterStatus?.Invoke(this, parameters[0].Value<bool>(), null);
+                        break;
+
+                    case "stopSolving":
+                        OnStopSolvingCurrentChallenge?.Invoke(this, parameters[0].Value<string>());
+                        break;
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Replay: {0}", ex.Message));
+            }
+        }
+
+        private void HandleJob(JObject job)
+        {
+            var messagePrefix = job.Value<string>("messagePrefix");
+            var target = job.Value<string>("target");
+
+            IsPool = job.Value<bool>("isPool");
+            MinerAddress = job.Value<string>("minerAddress");
+            Difficulty = job.Value<ulong>("difficulty");
+            DifficultyHex = new HexBigInteger(new BigInteger(Difficulty)).HexValue;
+
+            var maxTarget = job.Value<string>("maxTarget");
+            if (!string.IsNullOrWhiteSpace(maxTarget)) m_maxTarget = new HexBigInteger(maxTarget);
+
+            if (messagePrefix != m_lastMessagePrefix)
+            {
+                CurrentChallenge = messagePrefix.Substring(0, 66);
+                Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
+
+                m_lastMessagePrefix = messagePrefix;
+                m_jobCount++;
+                Miner.Work.ResetPosition();
+                OnNewMessagePrefix?.Invoke(this, messagePrefix);
+                m_challengeReceiveDateTime = DateTime.Now;
+            }
+
+            if (target != m_lastTarget)
+            {
+                Program.Print(string.Format("[INFO] New target detected {0}...", target));
+
+                m_lastTarget = target;
+                OnNewTarget?.Invoke(this, target);
+            }
+        }
+
+        private void m_hashPrintTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            var totalHashRate = 0ul;
+            OnGetTotalHashrate?.Invoke(this, ref totalHashRate);
+            Program.Print(string.Format("[INFO] Total Hashrate: {0} MH/s (Effective) / {1} MH/s (Local)",
+                                        GetEffectiveHashrate() / 1000000.0f, totalHashRate / 1000000.0f));
+        }
+
+        public TimeSpan GetTimeLeftToSolveBlock(ulong hashrate)
+        {
+            if (m_maxTarget == null || m_maxTarget.Value == 0 || Difficulty == 0 || hashrate == 0 || m_challengeReceiveDateTime == DateTime.MinValue)
+                return TimeSpan.Zero;
+
+            var timeToSolveBlock = new BigInteger(Difficulty) * uint256_MaxValue / m_maxTarget.Value / new BigInteger(hashrate);
+
+            var secondsLeftToSolveBlock = timeToSolveBlock - (long)(DateTime.Now - m_challengeReceiveDateTime).TotalSeconds;
+
+            return (secondsLeftToSolveBlock > (long)TimeSpan.MaxValue.TotalSeconds)
+                ? TimeSpan.MaxValue
+                : TimeSpan.FromSeconds((long)secondsLeftToSolveBlock);
+        }
+
+        public ulong GetEffectiveHashrate()
+        {
+            var hashrate = 0ul;
+
+            if (m_submitDateTimeList.Count > 1 && m_maxTarget != null && m_maxTarget.Value > 0)
+            {
+                var avgSolveTime = (ulong)((DateTime.Now - m_submitDateTimeList.First()).TotalSeconds / (m_submitDateTimeList.Count - 1)); // per interval between submits
+                if (avgSolveTime > 0)
+                    hashrate = (ulong)(new BigInteger(Difficulty) * uint256_MaxValue / m_maxTarget.Value / new BigInteger(avgSolveTime));
+            }
+
+            return hashrate;
+        }
+
+        public void ResetEffectiveHashrate()
+        {
+            m_submitDateTimeList.Clear();
+            m_submitDateTimeList.Add(DateTime.Now);
+        }
+
+        public void UpdateMiningParameters()
+        {
+            // Replay current job to newly started miners, following jobs are applied on their recorded time
+            if (!string.IsNullOrWhiteSpace(m_lastMessagePrefix)) OnNewMessagePrefix?.Invoke(this, m_lastMessagePrefix);
+            if (!string.IsNullOrWhiteSpace(m_lastTarget)) OnNewTarget?.Invoke(this, m_lastTarget);
+
+            lock (m_records)
+            {
+                if (m_replayThread != null) return;
+
+                m_replayThread = new System.Threading.Thread(Replay) { IsBackground = true };
+                m_replayThread.Start();
+            }
+        }
+
+        public bool SubmitSolution(string digest, string fromAddress, string challenge, string difficulty, string target, string solution, Miner.IMiner sender)
+        {
+            if (string.IsNullOrWhiteSpace(solution) || solution == "0x") return false;
+
+            m_challengeReceiveDateTime = DateTime.Now;
+            lock (this)
+            {
+                var isStale = (challenge != CurrentChallenge);
+                SubmittedShares++;
+                if (isStale) StaleShares++;
+
+                Program.Print(string.Format("[INFO] Share [{0}] replayed: {1}", SubmittedShares, (isStale ? "stale" : "current")));
+
+                if (m_submitDateTimeList.Count > MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
+                m_submitDateTimeList.Add(DateTime.Now);
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,248 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    public class Share
+    {
+        public string Digest { get; set; }
+        public string FromAddress { get; set; }
+        public string MinerAddress { get; set; }
+        public string Challenge { get; set; }
+        public string Difficulty { get; set; }
+        public string Target { get; set; }
+        public string Solution { get; set; }
+        public DateTime FoundDateTime { get; set; }
+    }
+
+    // Submits shares concurrently (bounded) and retries transient failures with jittered exponential backoff.
+    // A lone share is submitted at once, shares found while an earlier submit is in flight wait up to BATCH_WINDOW_MS
+    // and are submitted together in one request.
+    // A share is retried only while its challenge is current (up to MAX_SHARE_AGE), pending shares are journaled
+    // to disk (by a background write at most every JOURNAL_WRITE_DELAY_MS) so they can be resubmitted after a restart.
+    public class SubmissionQueue : IDisposable
+    {
+        private const int MAX_CONCURRENT_SUBMITS = 4;
+        private const int BASE_RETRY_DELAY_MS = 250;
+        private const int MAX_RETRY_DELAY_MS = 8000;
+        private const int BATCH_WINDOW_MS = 50;
+        private const int MAX_BATCH_SIZE = 32;
+        private const int JOURNAL_WRITE_DELAY_MS = 500;
+        private static readonly TimeSpan MAX_SHARE_AGE = TimeSpan.FromMinutes(10);
+
+        private readonly Func<Share[], Task<bool?[]>> m_submit;
+        private readonly Func<Share, bool> m_isStale;
+        private readonly string m_journalPath;
+        private readonly SemaphoreSlim m_submitSlots;
+        private readonly ConcurrentDictionary<string, Share> m_pendingShares;
+        private readonly Random m_random;
+        private readonly List<Tuple<Share, TaskCompletionSource<bool>>> m_batch;
+        private readonly Timer m_journalTimer;
+        private int m_isJournalWriteScheduled;
+        private int m_inFlightCount;
+        private long m_batchId;
+        private bool m_isDisposed;
+        private long m_droppedCount;
+
+        public int PendingCount => m_pendingShares.Count;
+
+        public ulong DroppedCount => (ulong)Interlocked.Read(ref m_droppedCount);
+
+        /// <param name="submit">Returns pool acceptance of each share (null if share got no response),
+        /// throws on transient (network) failure, both to be retried</param>
+        /// <param name="isStale">Whether share no longer belongs to current challenge</param>
+        /// <param name="journalPath">File to persist pending shares, null to disable</param>
+        public SubmissionQueue(Func<Share[], Task<bool?[]>> submit, Func<Share, bool> isStale, string journalPath)
+        {
+            m_submit = submit;
+            m_isStale = isStale;
+            m_journalPath = journalPath;
+            m_submitSlots = new SemaphoreSlim(MAX_CONCURRENT_SUBMITS);
+            m_pendingShares = new ConcurrentDictionary<string, Share>();
+            m_random = new Random();
+            m_batch = new List<Tuple<Share, TaskCompletionSource<bool>>>();
+            m_journalTimer = new Timer(state => WriteJournal(), null, Timeout.Infinite, Timeout.Infinite);
+        }
+
+        public void Dispose()
+        {
+            m_isDisposed = true; // pending shares are kept in journal
+
+            m_journalTimer.Dispose();
+            if (!string.IsNullOrWhiteSpace(m_journalPath)) WriteJournal();
+        }
+
+        public Task<bool> Enqueue(Share share)
+        {
+            m_pendingShares[share.Solution] = share;
+            SaveJournal();
+
+            return Task.Run(() => ProcessAsync(share));
+        }
+
+        // Resubmits journaled shares of the current challenge, to be called once parameters are known
+        public void ResubmitJournal()
+        {
+            if (string.IsNullOrWhiteSpace(m_journalPath) || !File.Exists(m_journalPath)) return;
+
+            var journalShares = new List<Share>();
+            try { journalShares = Utils.Json.DeserializeFromFile<List<Share>>(m_journalPath) ?? journalShares; }
+            catch (Exception ex) { Program.Print(string.Format("[ERROR] Failed to read share journal: {0}", ex.Message)); }
+
+            var currentShares = journalShares.Where(s => !m_isStale(s) && DateTime.Now - s.FoundDateTime < MAX_SHARE_AGE).ToArray();
+
+            Program.Print(string.Format("[INFO] Share journal: {0} pending, {1} to resubmit", journalShares.Count, currentShares.Length));
+
+            if (currentShares.Any())
+                foreach (var share in currentShares) Enqueue(share);
+            else
+                SaveJournal();
+        }
+
+        private async Task<bool> ProcessAsync(Share share)
+        {
+            try
+            {
+                for (var attempt = 0; !m_isDisposed; attempt++)
+                {
+                    // First attempt is always made (submitStale is decided by solver), retries end with the challenge
+                    if (attempt > 0 && (m_isStale(share) || DateTime.Now - share.FoundDateTime > MAX_SHARE_AGE))
+                    {
+                        Program.Print(string.Format("[WARN] Share {0} expired after {1} attempt(s), challenge has changed", share.Solution, attempt));
+                        Interlocked.Increment(ref m_droppedCount);
+                        return false;
+                    }
+
+                    try
+                    {
+                        return await SubmitBatchedAsync(share);
+                    }
+                    catch (Exception ex)
+                    {
+                        Program.Print(string.Format("[ERROR] Share submission attempt {0} failed: {1}", attempt + 1, (ex.InnerException ?? ex).Message));
+                    }
+
+                    await Task.Delay(GetRetryDelay(attempt));
+                }
+                return false;
+            }
+            finally
+            {
+                if (!m_isDisposed && m_pendingShares.TryRemove(share.Solution, out _)) SaveJournal();
+            }
+        }
+
+        // Sends a lone share at once, otherwise adds share to the open batch and the first share of a batch starts its window
+        private Task<bool> SubmitBatchedAsync(Share share)
+        {
+            var completion = new TaskCompletionSource<bool>(TaskCreationOptions.RunContinuationsAsynchronously);
+            Tuple<Share, TaskCompletionSource<bool>>[] batch = null;
+
+            lock (m_batch)
+            {
+                m_batch.Add(Tuple.Create(share, completion));
+
+                if (m_batch.Count >= MAX_BATCH_SIZE || m_inFlightCount == 0)
+                    batch = TakeBatch();
+                else if (m_batch.Count == 1)
+                {
+                    var batchId = m_batchId;
+                    Task.Delay(BATCH_WINDOW_MS).ContinueWith(t => FlushWindow(batchId));
+                }
+            }
+
+            if (batch != null) _ = FlushBatchAsync(batch);
+
+            return completion.Task;
+        }
+
+        // Must be called under m_batch lock
+        private Tuple<Share, TaskCompletionSource<bool>>[] TakeBatch()
+        {
+            var batch = m_batch.ToArray();
+            m_batch.Clear();
+            m_batchId++;
+            m_inFlightCount++;
+            return batch;
+        }
+
+        private void FlushWindow(long batchId)
+        {
+            Tuple<Share, TaskCompletionSource<bool>>[] batch = null;
+
+            lock (m_batch)
+            {
+                if (batchId == m_batchId && m_batch.Any()) // otherwise already flushed when full
+                    batch = TakeBatch();
+            }
+
+            if (batch != null) _ = FlushBatchAsync(batch);
+        }
+
+        private async Task FlushBatchAsync(Tuple<Share, TaskCompletionSource<bool>>[] batch)
+        {
+            await m_submitSlots.WaitAsync();
+            try
+            {
+                var results = await m_submit(batch.Select(b => b.Item1).ToArray());
+
+                for (var i = 0; i < batch.Length; i++)
+                {
+                    if (results[i].HasValue)
+                        batch[i].Item2.TrySetResult(results[i].Value);
+                    else
+                        batch[i].Item2.TrySetException(new Exception("No response from pool"));
+                }
+            }
+            catch (Exception ex)
+            {
+                foreach (var item in batch) item.Item2.TrySetException(ex);
+            }
+            finally
+            {
+                m_submitSlots.Release();
+                lock (m_batch) { m_inFlightCount--; }
+            }
+        }
+
+        // "Equal jitter", half of the exponential delay is fixed and the other half random
+        private int GetRetryDelay(int attempt)
+        {
+            var delay = (int)Math.Min(MAX_RETRY_DELAY_MS, BASE_RETRY_DELAY_MS * Math.Pow(2, attempt));
+            lock (m_random) { return delay / 2 + m_random.Next(delay / 2 + 1); }
+        }
+
+        // Schedules a background write, changes made before the write starts are included in it
+        private void SaveJournal()
+        {
+            if (string.IsNullOrWhiteSpace(m_journalPath) || m_isDisposed) return;
+
+            if (Interlocked.CompareExchange(ref m_isJournalWriteScheduled, 1, 0) == 0)
+                m_journalTimer.Change(JOURNAL_WRITE_DELAY_MS, Timeout.Infinite);
+        }
+
+        private void WriteJournal()
+        {
+            Interlocked.Exchange(ref m_isJournalWriteScheduled, 0);
+            try
+            {
+                if (!Directory.Exists(Path.GetDirectoryName(m_journalPath))) Directory.CreateDirectory(Path.GetDirectoryName(m_journalPath));
+
+                lock (m_journalTimer)
+                {
+                    if (!Utils.Json.SerializeToFile(m_pendingShares.Values.ToArray(), m_journalPath))
+                        Program.Print(string.Format("[ERROR] Failed to write share journal at {0}", m_journalPath));
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to write share journal: {0}", ex.Message));
+            }
+        }
+    }
+}
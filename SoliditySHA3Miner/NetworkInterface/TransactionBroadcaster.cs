@@ -0,0 +1,85 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Broadcasts signed raw transactions to all web3 endpoints at once, the first acknowledgement is returned while
+    // the remaining requests complete in background to help propagation. Endpoints are sent to in order of median latency.
+    public class TransactionBroadcaster
+    {
+        private readonly Endpoint[] m_endpoints;
+
+        public Endpoint[] Endpoints => m_endpoints;
+
+        public TransactionBroadcaster(IEnumerable<string> urls)
+        {
+            m_endpoints = urls.Where(url => !string.IsNullOrWhiteSpace(url)).
+                               Distinct(StringComparer.OrdinalIgnoreCase).
+                               Select(url => new Endpoint(url)).
+                               ToArray();
+        }
+
+        // Returns transaction ID and the endpoint that acknowledged it first, throws if none did
+        public async Task<Tuple<string, Endpoint>> BroadcastAsync(string signedTransaction)
+        {
+            var request = new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = "1",
+                ["method"] = "eth_sendRawTransaction",
+                ["params"] = new JArray(signedTransaction)
+            };
+
+            var broadcasts = m_endpoints.OrderBy(endpoint => endpoint.LatencyHistogram.GetSnapshot().P50). // unknown (-1) first
+                                         Select(endpoint => SendAsync(endpoint, request)).
+                                         ToList();
+            Exception firstException = null;
+
+            while (broadcasts.Any())
+            {
+                var broadcast = await Task.WhenAny(broadcasts);
+                broadcasts.Remove(broadcast);
+
+                if (broadcast.Status == TaskStatus.RanToCompletion) return broadcast.Result;
+
+                firstException = firstException ?? broadcast.Exception.InnerException;
+            }
+            throw firstException ?? new InvalidOperationException("No web3 endpoint to broadcast to.");
+        }
+
+        private static async Task<Tuple<string, Endpoint>> SendAsync(Endpoint endpoint, JObject request)
+        {
+            var startTime = DateTime.Now;
+            try
+            {
+                var response = await Utils.Json.InvokeJObjectRPCAsync(endpoint.URL, request);
+
+                var error = response.SelectToken("$.error.message")?.Value<string>();
+                if (!string.IsNullOrWhiteSpace(error))
+                    throw new InvalidOperationException(string.Format("{0} ({1})", error, endpoint.URL));
+
+                var transactionID = response.SelectToken("$.result")?.Value<string>();
+                if (string.IsNullOrWhiteSpace(transactionID))
+                    throw new InvalidOperationException(string.Format("Empty transaction ID ({0})", endpoint.URL));
+
+                return Tuple.Create(transactionID, endpoint);
+            }
+            finally { endpoint.LatencyHistogram.Record(startTime); }
+        }
+
+        public class Endpoint
+        {
+            public string URL { get; }
+            public Utils.LatencyHistogram LatencyHistogram { get; }
+
+            public Endpoint(string url)
+            {
+                URL = url;
+                LatencyHistogram = new Utils.LatencyHistogram();
+            }
+        }
+    }
+}
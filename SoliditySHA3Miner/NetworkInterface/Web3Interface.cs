@@ -11,7 +11,6 @@ using System;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
-using System.Net.NetworkInformation;
 using System.Numerics;
 using System.Threading.Tasks;
 using System.Timers;
@@ -43,6 +42,11 @@ namespace SoliditySHA3Miner.NetworkInterface
         private readonly Function m_CLM_ContractProgress;
 
         private readonly int m_mintMethodInputParamCount;
+        private readonly string m_mintCallDataPrefix;
+
+        private BigInteger? m_accountNonce;
+        private int m_accountNonceVersion;
+        private readonly object m_accountNonceLock = new object();
 
         private readonly float m_gasToMine;
         private readonly ulong m_gasLimit;
@@ -51,12 +55,24 @@ namespace SoliditySHA3Miner.NetworkInterface
         private Timer m_updateMinerTimer;
         private Timer m_hashPrintTimer;
         private MiningParameters m_lastParameters;
-        private System.Threading.ManualResetEvent m_newChallengeResetEvent;
+        private ReceiptTracker m_receiptTracker;
+
+        private const int SUBSCRIPTION_TIMEOUT_MS = 5000;
+        private readonly string m_subscriptionURL;
+        private Web3Subscription m_subscription;
+        private bool m_isSubscriptionSupported;
+        private bool m_isSubscribed;
+        private bool m_isGetMiningParameters;
+        private string m_mintEventTopic;
+        private readonly object m_updateParametersLock = new object();
 
-        private string m_gasApiURL;
-        private string m_gasApiPath;
-        private float m_gasApiOffset;
-        private float m_gasApiMultiplier;
+        private GasPriceOracle m_gasPriceOracle;
+        private readonly TransactionBroadcaster m_broadcaster;
+
+        private PendingMintWatcher m_pendingMintWatcher;
+        private readonly object m_competingMintLock = new object(); // not held across RPC, unlike m_updateParametersLock
+        private string m_competingMintChallenge;
+        private BigInteger m_competingMintGasPrice;
 
         public event GetMiningParameterStatusEvent OnGetMiningParameterStatus;
         public event NewMessagePrefixEvent OnNewMessagePrefix;
@@ -68,10 +84,15 @@ namespace SoliditySHA3Miner.NetworkInterface
         public bool IsPool => false;
         public ulong SubmittedShares { get; private set; }
         public ulong RejectedShares { get; private set; }
+        public ulong StaleShares { get; private set; }
+        public ulong DroppedShares { get; private set; }
         public ulong Difficulty { get; private set; }
         public string DifficultyHex { get; private set; }
         public int LastSubmitLatency { get; private set; }
         public int Latency { get; private set; }
+        public Utils.LatencyHistogram ParameterLatencyHistogram { get; }
+        public Utils.LatencyHistogram SubmitLatencyHistogram { get; }
+        public Utils.LatencyHistogram BroadcastLatencyHistogram { get; }
         public string MinerAddress { get; }
         public string SubmitURL { get; private set; }
         public string CurrentChallenge { get; private set; }
@@ -80,16 +101,20 @@ namespace SoliditySHA3Miner.NetworkInterface
 
         public Web3Interface(string web3ApiPath, string contractAddress, string minerAddress, string privateKey,
                              float gasToMine, string abiFileName, int updateInterval, int hashratePrintInterval,
-                             ulong gasLimit, string gasApiURL, string gasApiPath, float gasApiMultiplier, float gasApiOffset)
+                             ulong gasLimit, string gasApiURL, string gasApiPath, float gasApiMultiplier, float gasApiOffset,
+                             string subscriptionURL = null, string[] broadcastURLs = null, bool watchPendingMints = false)
         {
             m_updateInterval = updateInterval;
+            m_subscriptionURL = subscriptionURL;
             m_submittedChallengeList = new List<string>();
             m_submitDateTimeList = new List<DateTime>(MAX_SUBMIT_DTM_COUNT + 1);
-            m_newChallengeResetEvent = new System.Threading.ManualResetEvent(false);
 
             Nethereum.JsonRpc.Client.ClientBase.ConnectionTimeout = MAX_TIMEOUT * 1000;
             LastSubmitLatency = -1;
             Latency = -1;
+            ParameterLatencyHistogram = new Utils.LatencyHistogram();
+            SubmitLatencyHistogram = new Utils.LatencyHistogram();
+            BroadcastLatencyHistogram = new Utils.LatencyHistogram();
 
             if (string.IsNullOrWhiteSpace(contractAddress))
             {
@@ -130,6 +155,10 @@ namespace SoliditySHA3Miner.NetworkInterface
             SubmitURL = string.IsNullOrWhiteSpace(web3ApiPath) ? DEFAULT_WEB3_API : web3ApiPath;
 
             m_web3 = new Web3(SubmitURL);
+            m_broadcaster = new TransactionBroadcaster(new[] { SubmitURL }.Concat(broadcastURLs ?? new string[] { }));
+
+            if (m_account != null && m_broadcaster.Endpoints.Length > 1)
+                Program.Print("[INFO] Broadcast solutions to: " + string.Join(", ", m_broadcaster.Endpoints.Select(e => e.URL)));
 
             var erc20AbiPath = Path.Combine(Path.GetDirectoryName(typeof(Program).Assembly.Location), "ERC-20.abi");
             var tokenAbiPath = Path.Combine(Path.GetDirectoryName(typeof(Program).Assembly.Location), abiFileName);
@@ -203,17 +232,12 @@ namespace SoliditySHA3Miner.NetworkInterface
 
                 if (!string.IsNullOrWhiteSpace(gasApiURL))
                 {
-                    m_gasApiURL = gasApiURL;
-                    Program.Print(string.Format("[INFO] Gas API URL: {0}", m_gasApiURL));
+                    Program.Print(string.Format("[INFO] Gas API URL: {0}", gasApiURL));
+                    Program.Print(string.Format("[INFO] Gas API path: {0}", gasApiPath));
+                    Program.Print(string.Format("[INFO] Gas API offset: {0}", gasApiOffset));
+                    Program.Print(string.Format("[INFO] Gas API multiplier: {0}", gasApiMultiplier));
 
-                    m_gasApiPath = gasApiPath;
-                    Program.Print(string.Format("[INFO] Gas API path: {0}", m_gasApiPath));
-
-                    m_gasApiOffset = gasApiOffset;
-                    Program.Print(string.Format("[INFO] Gas API offset: {0}", m_gasApiOffset));
-
-                    m_gasApiMultiplier = gasApiMultiplier;
-                    Program.Print(string.Format("[INFO] Gas API multiplier: {0}", m_gasApiMultiplier));
+                    m_gasPriceOracle = new GasPriceOracle(gasApiURL, gasApiPath, gasApiMultiplier, gasApiOffset);
                 }
 
                 #region ERC20 methods
@@ -389,8 +413,53 @@ namespace SoliditySHA3Miner.NetworkInterface
 
                 m_mintMethodInputParamCount = mintABI?.InputParameters.Count() ?? 0;
 
+                // Pre-encode function selector of standard 'mint' signatures, only solution fields are appended on submission
+                var mintInputTypes = mintABI.InputParameters.OrderBy(p => p.Order).Select(p => p.Type).ToArray();
+                if (mintInputTypes.SequenceEqual(new[] { "uint256", "bytes32" }) || mintInputTypes.SequenceEqual(new[] { "uint256" }))
+                {
+                    var mintSignature = string.Format("{0}({1})", mintABI.Name, string.Join(",", mintInputTypes));
+                    m_mintCallDataPrefix = "0x" + new Sha3Keccack().CalculateHash(mintSignature).Substring(0, 8);
+                }
+
+                if (watchPendingMints)
+                {
+                    if (string.IsNullOrWhiteSpace(m_subscriptionURL))
+                        Program.Print("[ERROR] 'watchPendingMints' requires 'web3Subscription', pending transactions will not be watched.");
+
+                    else if (m_mintCallDataPrefix == null)
+                        Program.Print("[ERROR] Non-standard 'mint' function, pending transactions will not be watched.");
+
+                    else
+                    {
+                        m_pendingMintWatcher = new PendingMintWatcher(m_subscriptionURL, SubmitURL, m_contract.Address,
+                                                                      m_mintCallDataPrefix, m_mintMethodInputParamCount);
+                        m_pendingMintWatcher.OnPendingMint += m_pendingMintWatcher_OnPendingMint;
+                        m_pendingMintWatcher.Start();
+                    }
+                }
+
+                #endregion
+
+                #region Subscription
+
+                if (!string.IsNullOrWhiteSpace(m_subscriptionURL))
+                {
+                    m_isSubscriptionSupported = true;
+
+                    // Subscribe to 'Mint' logs if available, as challenge, target and difficulty can only change on mint
+                    var mintEventABI = contractABI.Events.FirstOrDefault(e => e.Name == "Mint");
+                    if (mintEventABI != null)
+                    {
+                        var mintEventSignature = string.Format("{0}({1})", mintEventABI.Name, string.Join(",", mintEventABI.InputParameters.Select(p => p.Type)));
+                        m_mintEventTopic = "0x" + new Sha3Keccack().CalculateHash(mintEventSignature);
+                    }
+                }
+
                 #endregion
 
+                m_receiptTracker = new ReceiptTracker(SubmitURL, m_updateInterval);
+                m_receiptTracker.OnReceipt += m_receiptTracker_OnReceipt;
+
                 m_hashPrintTimer = new Timer(hashratePrintInterval);
                 m_hashPrintTimer.Elapsed += m_hashPrintTimer_Elapsed;
                 m_hashPrintTimer.Start();
@@ -399,6 +468,12 @@ namespace SoliditySHA3Miner.NetworkInterface
 
         public void Dispose()
         {
+            m_isSubscriptionSupported = false;
+            if (m_subscription != null) m_subscription.Dispose();
+            if (m_gasPriceOracle != null) m_gasPriceOracle.Dispose();
+            if (m_pendingMintWatcher != null) m_pendingMintWatcher.Dispose();
+            if (m_receiptTracker != null) m_receiptTracker.Dispose();
+
             m_submittedChallengeList.Clear();
             m_submittedChallengeList.TrimExcess();
         }
@@ -461,46 +536,7 @@ namespace SoliditySHA3Miner.NetworkInterface
             }
             finally
             {
-                if (success)
-                {
-                    var tempLatency = (int)(DateTime.Now - startTime).TotalMilliseconds;
-                    try
-                    {
-                        using (var ping = new Ping())
-                        {
-                            var submitUrl = SubmitURL.Contains("://") ? SubmitURL.Split("://")[1] : SubmitURL;
-                            try
-                            {
-                                var response = ping.Send(submitUrl);
-                                if (response.RoundtripTime > 0)
-                                    tempLatency = (int)response.RoundtripTime;
-                            }
-                            catch
-                            {
-                                try
-                                {
-                                    submitUrl = submitUrl.Split('/').First();
-                                    var response = ping.Send(submitUrl);
-                                    if (response.RoundtripTime > 0)
-                                        tempLatency = (int)response.RoundtripTime;
-                                }
-                                catch
-                                {
-                                    try
-                                    {
-                                        submitUrl = submitUrl.Split(':').First();
-                                        var response = ping.Send(submitUrl);
-                                        if (response.RoundtripTime > 0)
-                                            tempLatency = (int)response.RoundtripTime;
-                                    }
-                                    catch { }
-                                }
-                            }
-                        }
-                    }
-                    catch { }
-                    Latency = tempLatency;
-                }
+                if (success) Latency = ParameterLatencyHistogram.Record(startTime);
             }
         }
 
@@ -531,59 +567,102 @@ namespace SoliditySHA3Miner.NetworkInterface
             }
         }
 
-        private void m_updateMinerTimer_Elapsed(object sender, ElapsedEventArgs e)
+        private bool ConnectSubscription()
         {
+            var subscription = new Web3Subscription(m_subscriptionURL);
             try
             {
-                var miningParameters = GetMiningParameters();
-                if (miningParameters == null)
-                {
-                    OnGetMiningParameterStatus(this, false, null);
-                    return;
-                }
+                subscription.Connect(SUBSCRIPTION_TIMEOUT_MS);
 
-                var address = miningParameters.EthAddress;
-                var target = miningParameters.MiningTargetByte32String;
-                CurrentChallenge = miningParameters.ChallengeNumberByte32String;
-                DifficultyHex = miningParameters.MiningDifficulty.HexValue;
+                var subscriptionID = (m_mintEventTopic != null)
+                                   ? subscription.Subscribe(SUBSCRIPTION_TIMEOUT_MS, "logs", new JObject
+                                   {
+                                       ["address"] = m_contract.Address,
+                                       ["topics"] = new JArray(m_mintEventTopic)
+                                   })
+                                   : subscription.Subscribe(SUBSCRIPTION_TIMEOUT_MS, "newHeads");
 
-                if (m_lastParameters == null || miningParameters.ChallengeNumber.Value != m_lastParameters.ChallengeNumber.Value)
+                m_subscription = subscription;
+                m_isSubscribed = true;
+
+                Program.Print(string.Format("[INFO] Subscribed to {0} from {1}", (m_mintEventTopic != null) ? "'Mint' events" : "new blocks", m_subscriptionURL));
+                UpdateMiningParametersFromNetwork(); // in case of changes before subscription
+
+                Task.Factory.StartNew(() => ReceiveSubscriptionNotifications(subscription, subscriptionID), TaskCreationOptions.LongRunning);
+                return true;
+            }
+            catch (Exception ex)
+            {
+                subscription.Dispose();
+
+                // Only give up on subscription if the node never accepted one
+                if (m_subscription == null)
                 {
-                    Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
-                    OnNewMessagePrefix(this, CurrentChallenge + address.Replace("0x", string.Empty));
-                    if (m_challengeReceiveDateTime == DateTime.MinValue) m_challengeReceiveDateTime = DateTime.Now;
-                    m_newChallengeResetEvent.Set();
+                    m_isSubscriptionSupported = false;
+                    Program.Print(string.Format("[INFO] Subscription not available ({0}), polling every {1}ms",
+                                                (ex.InnerException ?? ex).Message, m_updateInterval));
                 }
+                return false;
+            }
+        }
 
-                if (m_lastParameters == null || miningParameters.MiningTarget.Value != m_lastParameters.MiningTarget.Value)
+        private void ReceiveSubscriptionNotifications(Web3Subscription subscription, string subscriptionID)
+        {
+            try
+            {
+                while (true)
                 {
-                    Program.Print(string.Format("[INFO] New target detected {0}...", target));
-                    OnNewTarget(this, target);
+                    var notification = subscription.Receive().Result;
+                    if (notification == null) break;
+
+                    if (notification.SelectToken("$.method")?.Value<string>() == "eth_subscription" &&
+                        notification.SelectToken("$.params.subscription")?.Value<string>() == subscriptionID)
+                        UpdateMiningParametersFromNetwork();
                 }
+            }
+            catch (Exception ex)
+            {
+                if (m_isSubscriptionSupported) Program.Print("[ERROR] " + (ex.InnerException ?? ex).Message);
+            }
+            finally
+            {
+                m_isSubscribed = false;
+                subscription.Dispose();
 
-                if (m_lastParameters == null || miningParameters.MiningDifficulty.Value != m_lastParameters.MiningDifficulty.Value)
-                {
-                    Program.Print(string.Format("[INFO] New difficulity detected ({0})...", miningParameters.MiningDifficulty.Value));
-                    Difficulty = Convert.ToUInt64(miningParameters.MiningDifficulty.Value.ToString());
+                if (m_isSubscriptionSupported) Program.Print("[WARN] Subscription disconnected, falling back to polling...");
+            }
+        }
 
-                    // Actual difficulty should have decimals
-                    var calculatedDifficulty = Math.Exp(BigInteger.Log(m_maxTarget.Value) - BigInteger.Log(miningParameters.MiningTarget.Value));
+        // Competing solution for current challenge is verified the same way as the contract, before treating challenge as at risk
+        private void m_pendingMintWatcher_OnPendingMint(PendingMintWatcher sender, string transactionID, string fromAddress,
+                                                        string solution, string digest, BigInteger gasPrice)
+        {
+            try
+            {
+                var challenge = CurrentChallenge;
+                var lastParameters = m_lastParameters;
+                if (lastParameters == null || MinerAddress.Equals(fromAddress, StringComparison.OrdinalIgnoreCase)) return;
 
-                    if ((ulong)calculatedDifficulty != Difficulty) // Only replace if the integer portion is different
-                    {
-                        Difficulty = (ulong)calculatedDifficulty;
+                var message = HexByteConvertorExtensions.HexToByteArray(challenge).
+                                                         Concat(HexByteConvertorExtensions.HexToByteArray(fromAddress)).
+                                                         Concat(HexByteConvertorExtensions.HexToByteArray(solution)).
+                                                         ToArray();
+                var calculatedDigest = new Sha3Keccack().CalculateHash(message);
 
-                        var expValue = BitConverter.GetBytes(decimal.GetBits((decimal)calculatedDifficulty)[3])[2];
+                if (digest != null && !HexByteConvertorExtensions.HexToByteArray(digest).SequenceEqual(calculatedDigest)) return;
+                if (new BigInteger(calculatedDigest.Reverse().Concat(new byte[] { 0 }).ToArray()) > lastParameters.MiningTarget.Value) return;
 
-                        var calculatedTarget = m_maxTarget.Value * (ulong)Math.Pow(10, expValue) / (ulong)(calculatedDifficulty * Math.Pow(10, expValue));
+                lock (m_competingMintLock)
+                {
+                    if (challenge != CurrentChallenge) return;
 
-                        Program.Print(string.Format("[INFO] Update target {0}...", Utils.Numerics.BigIntegerToByte32HexString(calculatedTarget)));
-                        OnNewTarget(this, Utils.Numerics.BigIntegerToByte32HexString(calculatedTarget));
-                    }
+                    if (m_competingMintChallenge != challenge) m_competingMintGasPrice = 0;
+                    m_competingMintChallenge = challenge;
+                    m_competingMintGasPrice = BigInteger.Max(m_competingMintGasPrice, gasPrice);
                 }
 
-                m_lastParameters = miningParameters;
-                OnGetMiningParameterStatus(this, true, miningParameters);
+                Program.Print(string.Format("[WARN] Competing mint pending for current challenge from {0} at {1} GWei ({2})",
+                                            fromAddress, UnitConversion.Convert.FromWei(gasPrice, UnitConversion.EthUnit.Gwei), transactionID));
             }
             catch (Exception ex)
             {
@@ -591,6 +670,95 @@ namespace SoliditySHA3Miner.NetworkInterface
             }
         }
 
+        // Whether a valid competing mint for the challenge is pending at gas price higher than or equal to ours
+        private bool IsOutbidByPendingMint(string challenge, BigInteger gasPrice)
+        {
+            lock (m_competingMintLock)
+            {
+                return challenge.Equals(m_competingMintChallenge, StringComparison.OrdinalIgnoreCase) && m_competingMintGasPrice >= gasPrice;
+            }
+        }
+
+        private void m_updateMinerTimer_Elapsed(object sender, ElapsedEventArgs e)
+        {
+            if (m_isGetMiningParameters || m_isSubscribed) return;
+            try
+            {
+                m_isGetMiningParameters = true;
+
+                if (m_isSubscriptionSupported && ConnectSubscription()) return;
+
+                UpdateMiningParametersFromNetwork();
+            }
+            finally { m_isGetMiningParameters = false; }
+        }
+
+        private void UpdateMiningParametersFromNetwork()
+        {
+            lock (m_updateParametersLock) // either from polling or subscription
+            {
+                try
+                {
+                    var miningParameters = GetMiningParameters();
+                    if (miningParameters == null)
+                    {
+                        OnGetMiningParameterStatus(this, false, null);
+                        return;
+                    }
+
+                    var address = miningParameters.EthAddress;
+                    var target = miningParameters.MiningTargetByte32String;
+                    CurrentChallenge = miningParameters.ChallengeNumberByte32String;
+                    DifficultyHex = miningParameters.MiningDifficulty.HexValue;
+
+                    if (m_lastParameters == null || miningParameters.ChallengeNumber.Value != m_lastParameters.ChallengeNumber.Value)
+                    {
+                        Program.Print(string.Format("[INFO] New challenge detected {0}...", CurrentChallenge));
+                        Miner.Work.ResetPosition();
+                        OnNewMessagePrefix(this, CurrentChallenge + address.Replace("0x", string.Empty));
+                        if (m_challengeReceiveDateTime == DateTime.MinValue) m_challengeReceiveDateTime = DateTime.Now;
+                        if (m_receiptTracker != null) m_receiptTracker.CheckNow(); // new challenge comes with a mined mint
+
+                        if (m_account != null) Task.Run(() => SyncAccountNonce());
+                    }
+
+                    if (m_lastParameters == null || miningParameters.MiningTarget.Value != m_lastParameters.MiningTarget.Value)
+                    {
+                        Program.Print(string.Format("[INFO] New target detected {0}...", target));
+                        OnNewTarget(this, target);
+                    }
+
+                    if (m_lastParameters == null || miningParameters.MiningDifficulty.Value != m_lastParameters.MiningDifficulty.Value)
+                    {
+                        Program.Print(string.Format("[INFO] New difficulity detected ({0})...", miningParameters.MiningDifficulty.Value));
+                        Difficulty = Convert.ToUInt64(miningParameters.MiningDifficulty.Value.ToString());
+
+                        // Actual difficulty should have decimals
+                        var calculatedDifficulty = Math.Exp(BigInteger.Log(m_maxTarget.Value) - BigInteger.Log(miningParameters.MiningTarget.Value));
+
+                        if ((ulong)calculatedDifficulty != Difficulty) // Only replace if the integer portion is different
+                        {
+                            Difficulty = (ulong)calculatedDifficulty;
+
+                            var expValue = BitConverter.GetBytes(decimal.GetBits((decimal)calculatedDifficulty)[3])[2];
+
+                            var calculatedTarget = m_maxTarget.Value * (ulong)Math.Pow(10, expValue) / (ulong)(calculatedDifficulty * Math.Pow(10, expValue));
+
+                            Program.Print(string.Format("[INFO] Update target {0}...", Utils.Numerics.BigIntegerToByte32HexString(calculatedTarget)));
+                            OnNewTarget(this, Utils.Numerics.BigIntegerToByte32HexString(calculatedTarget));
+                        }
+                    }
+
+                    m_lastParameters = miningParameters;
+                    OnGetMiningParameterStatus(this, true, miningParameters);
+                }
+                catch (Exception ex)
+                {
+                    Program.Print(string.Format("[ERROR] {0}", ex.Message));
+                }
+            }
+        }
+
         /// <summary>
         /// <para>Since a single hash is a random number between 1 and 2^256, and difficulty [1] target = 2^234</para>
         /// <para>Then we can find difficulty [N] target = 2^234 / N</para>
@@ -659,6 +827,7 @@ namespace SoliditySHA3Miner.NetworkInterface
                 {
                     OnStopSolvingCurrentChallenge(this, challenge);
                     Program.Print(string.Format("[INFO] Submission cancelled, nonce has been submitted for the current challenge."));
+                    StaleShares++;
                     return false;
                 }
                 m_challengeReceiveDateTime = DateTime.MinValue;
@@ -667,55 +836,63 @@ namespace SoliditySHA3Miner.NetworkInterface
                 var gasLimit = new HexBigInteger(m_gasLimit);
                 var userGas = new HexBigInteger(UnitConversion.Convert.ToWei(new BigDecimal(m_gasToMine), UnitConversion.EthUnit.Gwei));
 
-                if (!string.IsNullOrWhiteSpace(m_gasApiURL))
+                if (m_gasPriceOracle != null) // cached from background refresh, do not wait on the API here
                 {
-                    try
+                    if (!m_gasPriceOracle.TryGetGasPrice(out float apiGasPrice))
                     {
-                        var apiGasPrice = Utils.Json.DeserializeFromURL(m_gasApiURL).SelectToken(m_gasApiPath).Value<float>();
-                        if (apiGasPrice > 0)
-                        {
-                            apiGasPrice *= m_gasApiMultiplier;
-                            apiGasPrice += m_gasApiOffset;
-
-                            if (apiGasPrice < m_gasToMine)
-                            {
-                                Program.Print(string.Format("[INFO] Using 'gasToMine' price of {0} GWei, due to lower gas price from API: {1}",
-                                                            m_gasToMine, m_gasApiURL));
-                            }
-                            else
-                            {
-                                userGas = new HexBigInteger(UnitConversion.Convert.ToWei(new BigDecimal(apiGasPrice), UnitConversion.EthUnit.Gwei));
-                                Program.Print(string.Format("[INFO] Using gas price of {0} GWei (after {1} offset) from API: {2}",
-                                                            apiGasPrice, m_gasApiOffset, m_gasApiURL));
-                            }
-                        }
-                        else
-                        {
-                            Program.Print(string.Format("[ERROR] Gas price of 0 GWei was retuned by API: {0}", m_gasApiURL));
-                            Program.Print(string.Format("[INFO] Using 'gasToMine' parameter of {0} GWei.", m_gasToMine));
-                        }
+                        Program.Print(string.Format("[WARN] No recent gas price from API: {0}", m_gasPriceOracle.URL));
+                        Program.Print(string.Format("[INFO] Using 'gasToMine' parameter of {0} GWei.", m_gasToMine));
                     }
-                    catch (Exception ex)
+                    else if (apiGasPrice < m_gasToMine)
                     {
-                        Program.Print(string.Format("[ERROR] Failed to read gas price from API: {0}\n{1}", m_gasApiURL, ex.ToString()));
-                        Program.Print(string.Format("[INFO] Using 'gasToMine' parameter of {0} GWei.", m_gasToMine));
+                        Program.Print(string.Format("[INFO] Using 'gasToMine' price of {0} GWei, due to lower gas price from API: {1}",
+                                                    m_gasToMine, m_gasPriceOracle.URL));
+                    }
+                    else
+                    {
+                        userGas = new HexBigInteger(UnitConversion.Convert.ToWei(new BigDecimal(apiGasPrice), UnitConversion.EthUnit.Gwei));
+                        Program.Print(string.Format("[INFO] Using gas price of {0} GWei from API: {1}", apiGasPrice, m_gasPriceOracle.URL));
                     }
                 }
 
-                var oSolution = new BigInteger(Utils.Numerics.HexStringToByte32Array(solution).ToArray());
-                // Note: do not directly use -> new HexBigInteger(solution).Value
-                //Because two's complement representation always interprets the highest-order bit of the last byte in the array
-                //(the byte at position Array.Length - 1) as the sign bit,
-                //the method returns a byte array with an extra element whose value is zero
-                //to disambiguate positive values that could otherwise be interpreted as having their sign bits set.
-
-                object[] dataInput = null;
-
-                if (m_mintMethodInputParamCount > 1) // 0xBitcoin compatibility
-                    dataInput = new object[] { oSolution, HexByteConvertorExtensions.HexToByteArray(digest) };
+                // Keep hashing in case competing mint fails, but do not spend gas on a mint that will most likely revert
+                if (IsOutbidByPendingMint(challenge, userGas.Value))
+                {
+                    Program.Print("[INFO] Submission cancelled, competing mint is pending at higher or equal gas price.");
+                    StaleShares++;
+                    return false;
+                }
 
-                else // Draft EIP-918 compatibility [2018-03-07]
-                    dataInput = new object[] { oSolution };
+                var mintCallData = GetMintCallData(solution, digest);
+                if (mintCallData == null) // non-standard 'mint' signature, use ABI encoder
+                {
+                    var oSolution = new BigInteger(Utils.Numerics.HexStringToByte32Array(solution).ToArray());
+                    // Note: do not directly use -> new HexBigInteger(solution).Value
+                    //Because two's complement representation always interprets the highest-order bit of the last byte in the array
+                    //(the byte at position Array.Length - 1) as the sign bit,
+                    //the method returns a byte array with an extra element whose value is zero
+                    //to disambiguate positive values that could otherwise be interpreted as having their sign bits set.
+
+                    object[] dataInput = null;
+
+                    if (m_mintMethodInputParamCount > 1) // 0xBitcoin compatibility
+                        dataInput = new object[] { oSolution, HexByteConvertorExtensions.HexToByteArray(digest) };
+
+                    else // Draft EIP-918 compatibility [2018-03-07]
+                        dataInput = new object[] { oSolution };
+
+                    // Commented as gas limit is dynamic in between submissions and confirmations
+                    //var estimatedGasLimit = m_mintMethod.EstimateGasAsync(from: fromAddress,
+                    //                                                      gas: gasLimit,
+                    //                                                      value: new HexBigInteger(0),
+                    //                                                      functionInput: dataInput).Result;
+
+                    mintCallData = m_mintMethod.CreateTransactionInput(from: fromAddress,
+                                                                       gas: gasLimit /*estimatedGasLimit*/,
+                                                                       gasPrice: userGas,
+                                                                       value: new HexBigInteger(0),
+                                                                       functionInput: dataInput).Data;
+                }
 
                 var retryCount = 0u;
                 var startSubmitDateTime = DateTime.Now;
@@ -723,34 +900,27 @@ namespace SoliditySHA3Miner.NetworkInterface
                 {
                     try
                     {
-                        var txCount = m_web3.Eth.Transactions.GetTransactionCount.SendRequestAsync(fromAddress).Result;
-
-                        // Commented as gas limit is dynamic in between submissions and confirmations
-                        //var estimatedGasLimit = m_mintMethod.EstimateGasAsync(from: fromAddress,
-                        //                                                      gas: gasLimit,
-                        //                                                      value: new HexBigInteger(0),
-                        //                                                      functionInput: dataInput).Result;
-
-                        var transaction = m_mintMethod.CreateTransactionInput(from: fromAddress,
-                                                                              gas: gasLimit /*estimatedGasLimit*/,
-                                                                              gasPrice: userGas,
-                                                                              value: new HexBigInteger(0),
-                                                                              functionInput: dataInput);
-
                         var encodedTx = Web3.OfflineTransactionSigner.SignTransaction(privateKey: m_account.PrivateKey,
                                                                                       to: m_contract.Address,
                                                                                       amount: 0,
-                                                                                      nonce: txCount.Value,
+                                                                                      nonce: ReserveAccountNonce(fromAddress),
                                                                                       gasPrice: userGas,
                                                                                       gasLimit: gasLimit /*estimatedGasLimit*/,
-                                                                                      data: transaction.Data);
+                                                                                      data: mintCallData);
 
                         if (!Web3.OfflineTransactionSigner.VerifyTransaction(encodedTx))
                             throw new Exception("Failed to verify transaction.");
 
-                        transactionID = m_web3.Eth.Transactions.SendRawTransaction.SendRequestAsync("0x" + encodedTx).Result;
+                        var startBroadcastDateTime = DateTime.Now;
+                        var broadcast = m_broadcaster.BroadcastAsync("0x" + encodedTx).Result;
+                        var broadcastLatency = BroadcastLatencyHistogram.Record(startBroadcastDateTime);
 
-                        LastSubmitLatency = (int)((DateTime.Now - startSubmitDateTime).TotalMilliseconds);
+                        transactionID = broadcast.Item1;
+                        if (m_broadcaster.Endpoints.Length > 1)
+                            Program.Print(string.Format("[INFO] Transaction acknowledged first by {0} ({1}ms)", broadcast.Item2.URL, broadcastLatency));
+
+                        LastSubmitLatency = SubmitLatencyHistogram.Record(startSubmitDateTime);
+                        Utils.ChromeTrace.RecordSpan("Submit solution", startSubmitDateTime);
 
                         if (!string.IsNullOrWhiteSpace(transactionID))
                         {
@@ -760,28 +930,47 @@ namespace SoliditySHA3Miner.NetworkInterface
                                 if (m_submittedChallengeList.Count > 100) m_submittedChallengeList.Remove(m_submittedChallengeList.Last());
                             }
 
-                            Task.Factory.StartNew(() => GetTransactionReciept(transactionID, fromAddress, gasLimit, userGas, LastSubmitLatency, DateTime.Now));
+                            m_receiptTracker.Track(new PendingTransaction
+                            {
+                                TransactionID = transactionID,
+                                FromAddress = fromAddress,
+                                GasLimit = gasLimit,
+                                GasPrice = userGas,
+                                ResponseTime = LastSubmitLatency,
+                                SubmitDateTime = DateTime.Now
+                            });
                         }
+                        else InvalidateAccountNonce();
                     }
                     catch (AggregateException ex)
                     {
+                        InvalidateAccountNonce();
                         var errorMessage = "[ERROR] " + ex.Message;
 
                         foreach (var iEx in ex.InnerExceptions)
                             errorMessage += "\n " + iEx.Message;
 
                         Program.Print(errorMessage);
-                        if (IsChallengedSubmitted(challenge)) return false;
+                        if (IsChallengedSubmitted(challenge))
+                        {
+                            DroppedShares++;
+                            return false;
+                        }
                     }
                     catch (Exception ex)
                     {
+                        InvalidateAccountNonce();
                         var errorMessage = "[ERROR] " + ex.Message;
 
                         if (ex.InnerException != null)
                             errorMessage += "\n " + ex.InnerException.Message;
 
                         Program.Print(errorMessage);
-                        if (IsChallengedSubmitted(challenge) || ex.Message == "Failed to verify transaction.") return false;
+                        if (IsChallengedSubmitted(challenge) || ex.Message == "Failed to verify transaction.")
+                        {
+                            DroppedShares++;
+                            return false;
+                        }
                     }
 
                     System.Threading.Thread.Sleep(1000);
@@ -790,105 +979,131 @@ namespace SoliditySHA3Miner.NetworkInterface
                     if (retryCount > 10)
                     {
                         Program.Print("[ERROR] Failed to submit solution for more than 10 times, please check settings.");
-                        sender.StopMining();
+                        sender?.StopMining();
                     }
                 }
                 return true;
             }
         }
 
-        private void GetTransactionReciept(string transactionID, string fromAddress, HexBigInteger gasLimit, HexBigInteger userGas,
-                                           int responseTime, DateTime submitDateTime)
+        // Appends solution (and digest) to pre-encoded 'mint' selector, null if signature is not standard
+        private string GetMintCallData(string solution, string digest)
+        {
+            if (m_mintCallDataPrefix == null) return null;
+
+            var callData = new System.Text.StringBuilder(m_mintCallDataPrefix, m_mintCallDataPrefix.Length + 128);
+            callData.Append(solution.Replace("0x", string.Empty).PadLeft(64, '0')); // uint256
+
+            if (m_mintMethodInputParamCount > 1)
+                callData.Append(digest.Replace("0x", string.Empty).PadRight(64, '0')); // bytes32
+
+            return callData.ToString();
+        }
+
+        // Account nonce is tracked locally so submissions do not wait on 'eth_getTransactionCount',
+        // it is synced from the pending count on new challenge and after a failed broadcast
+        private void SyncAccountNonce()
         {
+            int version;
+            lock (m_accountNonceLock) { version = m_accountNonceVersion; }
             try
             {
-                var success = false;
-                var hasWaited = false;
-                TransactionReceipt reciept = null;
-                while (reciept == null)
-                {
-                    try
-                    {
-                        reciept = m_web3.Eth.Transactions.GetTransactionReceipt.SendRequestAsync(transactionID).Result;
-                    }
-                    catch (AggregateException ex)
-                    {
-                        var errorMessage = "[ERROR] " + ex.Message;
+                var txCount = m_web3.Eth.Transactions.GetTransactionCount.SendRequestAsync(MinerAddress, BlockParameter.CreatePending()).Result;
 
-                        foreach (var iEx in ex.InnerExceptions)
-                            errorMessage += "\n " + iEx.Message;
+                lock (m_accountNonceLock)
+                {
+                    if (version == m_accountNonceVersion) // not reserved in between
+                        m_accountNonce = txCount.Value;
+                }
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to sync account nonce: {0}", (ex.InnerException ?? ex).Message));
+            }
+        }
 
-                        Program.Print(errorMessage);
-                    }
-                    catch (Exception ex)
-                    {
-                        var errorMessage = "[ERROR] " + ex.Message;
+        private BigInteger ReserveAccountNonce(string fromAddress)
+        {
+            lock (m_accountNonceLock)
+            {
+                if (m_accountNonce == null)
+                    m_accountNonce = m_web3.Eth.Transactions.GetTransactionCount.SendRequestAsync(fromAddress, BlockParameter.CreatePending()).Result.Value;
 
-                        if (ex.InnerException != null)
-                            errorMessage += "\n " + ex.InnerException.Message;
+                m_accountNonceVersion++;
+                m_accountNonce++;
+                return m_accountNonce.Value - 1;
+            }
+        }
 
-                        Program.Print(errorMessage);
-                    }
+        private void InvalidateAccountNonce()
+        {
+            lock (m_accountNonceLock)
+            {
+                m_accountNonceVersion++;
+                m_accountNonce = null;
+            }
+        }
 
-                    if (reciept == null)
+        private void m_receiptTracker_OnReceipt(ReceiptTracker sender, PendingTransaction transaction, bool success, ulong blockNumber)
+        {
+            try
+            {
+                if (transaction.IsDevFee)
+                {
+                    if (!success) Program.Print("[ERROR] Failed to submit dev fee.");
+                    else
                     {
-                        if (hasWaited) Task.Delay(m_updateInterval).Wait();
-                        else
-                        {
-                            m_newChallengeResetEvent.Reset();
-                            m_newChallengeResetEvent.WaitOne();
-                            hasWaited = true;
-                        }
+                        Program.Print(string.Format("[INFO] Transferred dev fee for successful mint share [{0}] : {1}, block: {2}," +
+                                                    "\n transaction ID: {3}",
+                                                    transaction.ShareNo,
+                                                    success ? "success" : "failed",
+                                                    blockNumber,
+                                                    transaction.TransactionID));
                     }
+                    return;
                 }
 
-                success = (reciept.Status.Value == 1);
+                ulong submittedShares, rejectedShares;
+                lock (m_submitDateTimeList)
+                {
+                    if (!success) RejectedShares++;
+
+                    if (SubmittedShares == ulong.MaxValue)
+                    {
+                        SubmittedShares = 0ul;
+                        RejectedShares = 0ul;
+                    }
+                    else SubmittedShares++;
 
-                if (!success) RejectedShares++;
+                    submittedShares = SubmittedShares;
+                    rejectedShares = RejectedShares;
 
-                if (SubmittedShares == ulong.MaxValue)
-                {
-                    SubmittedShares = 0ul;
-                    RejectedShares = 0ul;
+                    if (success)
+                    {
+                        if (m_submitDateTimeList.Count >= MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
+                        m_submitDateTimeList.Add(transaction.SubmitDateTime);
+                    }
                 }
-                else SubmittedShares++;
 
                 Program.Print(string.Format("[INFO] Miner share [{0}] submitted: {1} ({2}ms), block: {3}," +
                                             "\n transaction ID: {4}",
-                                            SubmittedShares,
+                                            submittedShares,
                                             success ? "success" : "failed",
-                                            responseTime,
-                                            reciept.BlockNumber.Value,
-                                            reciept.TransactionHash));
+                                            transaction.ResponseTime,
+                                            blockNumber,
+                                            transaction.TransactionID));
 
                 if (success)
                 {
-                    if (m_submitDateTimeList.Count >= MAX_SUBMIT_DTM_COUNT) m_submitDateTimeList.RemoveAt(0);
-                    m_submitDateTimeList.Add(submitDateTime);
-
                     var devFee = (ulong)Math.Round(100 / Math.Abs(DevFee.UserPercent));
 
-                    if (((SubmittedShares - RejectedShares) % devFee) == 0)
-                        SubmitDevFee(fromAddress, gasLimit, userGas, SubmittedShares);
+                    if (((submittedShares - rejectedShares) % devFee) == 0)
+                        Task.Run(() => SubmitDevFee(transaction.FromAddress, transaction.GasLimit, transaction.GasPrice, submittedShares));
                 }
             }
-            catch (AggregateException ex)
-            {
-                var errorMessage = "[ERROR] " + ex.Message;
-
-                foreach (var iEx in ex.InnerExceptions)
-                    errorMessage += "\n " + iEx.Message;
-
-                Program.Print(errorMessage);
-            }
             catch (Exception ex)
             {
-                var errorMessage = "[ERROR] " + ex.Message;
-
-                if (ex.InnerException != null)
-                    errorMessage += "\n " + ex.InnerException.Message;
-
-                Program.Print(errorMessage);
+                Program.Print(string.Format("[ERROR] {0}", ex.Message));
             }
         }
 
@@ -912,9 +1127,7 @@ namespace SoliditySHA3Miner.NetworkInterface
 
         private void SubmitDevFee(string fromAddress, HexBigInteger gasLimit, HexBigInteger userGas, ulong shareNo)
         {
-            var success = false;
             var devTransactionID = string.Empty;
-            TransactionReceipt devReciept = null;
             try
             {
                 var miningReward = GetMiningReward();
@@ -923,8 +1136,6 @@ namespace SoliditySHA3Miner.NetworkInterface
 
                 var txInput = new object[] { DevFee.Address, miningReward };
 
-                var txCount = m_web3.Eth.Transactions.GetTransactionCount.SendRequestAsync(fromAddress).Result;
-
                 // Commented as gas limit is dynamic in between submissions and confirmations
                 //var estimatedGasLimit = m_transferMethod.EstimateGasAsync(from: fromAddress,
                 //                                                          gas: gasLimit,
@@ -940,7 +1151,7 @@ namespace SoliditySHA3Miner.NetworkInterface
                 var encodedTx = Web3.OfflineTransactionSigner.SignTransaction(privateKey: m_account.PrivateKey,
                                                                               to: m_contract.Address,
                                                                               amount: 0,
-                                                                              nonce: txCount.Value,
+                                                                              nonce: ReserveAccountNonce(fromAddress),
                                                                               gasPrice: userGas,
                                                                               gasLimit: gasLimit /*estimatedGasLimit*/,
                                                                               data: transaction.Data);
@@ -952,48 +1163,20 @@ namespace SoliditySHA3Miner.NetworkInterface
 
                 if (string.IsNullOrWhiteSpace(devTransactionID)) throw new Exception("Failed to submit dev fee.");
 
-                while (devReciept == null)
+                m_receiptTracker.Track(new PendingTransaction
                 {
-                    try
-                    {
-                        System.Threading.Thread.Sleep(3000);
-                        devReciept = m_web3.Eth.Transactions.GetTransactionReceipt.SendRequestAsync(devTransactionID).Result;
-                    }
-                    catch (AggregateException ex)
-                    {
-                        var errorMessage = "[ERROR] " + ex.Message;
-
-                        foreach (var iEx in ex.InnerExceptions)
-                            errorMessage += "\n " + iEx.Message;
-
-                        Program.Print(errorMessage);
-                    }
-                    catch (Exception ex)
-                    {
-                        var errorMessage = "[ERROR] " + ex.Message;
-
-                        if (ex.InnerException != null)
-                            errorMessage += "\n " + ex.InnerException.Message;
-
-                        Program.Print(errorMessage);
-                    }
-                }
-
-                success = (devReciept.Status.Value == 1);
-
-                if (!success) throw new Exception("Failed to submit dev fee.");
-                else
-                {
-                    Program.Print(string.Format("[INFO] Transferred dev fee for successful mint share [{0}] : {1}, block: {2}," +
-                                                "\n transaction ID: {3}",
-                                                shareNo,
-                                                success ? "success" : "failed",
-                                                devReciept.BlockNumber.Value,
-                                                devReciept.TransactionHash));
-                }
+                    TransactionID = devTransactionID,
+                    FromAddress = fromAddress,
+                    GasLimit = gasLimit,
+                    GasPrice = userGas,
+                    SubmitDateTime = DateTime.Now,
+                    IsDevFee = true,
+                    ShareNo = shareNo
+                });
             }
             catch (AggregateException ex)
             {
+                if (string.IsNullOrWhiteSpace(devTransactionID)) InvalidateAccountNonce();
                 var errorMessage = "[ERROR] " + ex.Message;
 
                 foreach (var iEx in ex.InnerExceptions)
@@ -1003,6 +1186,7 @@ namespace SoliditySHA3Miner.NetworkInterface
             }
             catch (Exception ex)
             {
+                if (string.IsNullOrWhiteSpace(devTransactionID)) InvalidateAccountNonce();
                 var errorMessage = "[ERROR] " + ex.Message;
 
                 if (ex.InnerException != null)
@@ -0,0 +1,139 @@
+﻿using Newtonsoft.Json.Linq;
+using System;
+using System.IO;
+using System.IO.Pipes;
+using System.Net.Sockets;
+using System.Net.WebSockets;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace SoliditySHA3Miner.NetworkInterface
+{
+    // Minimal 'eth_subscribe' client, over WebSocket (ws://, wss://) or IPC (unix socket path or Windows named pipe)
+    // IPC messages are expected to be newline-delimited, as written by Geth and Parity
+    public class Web3Subscription : IDisposable
+    {
+        private readonly string m_url;
+        private ClientWebSocket m_webSocket;
+        private Stream m_ipcStream;
+        private StreamReader m_ipcReader;
+        private int m_lastRequestID;
+
+        public string URL => m_url;
+
+        public bool IsWebSocket => m_url.StartsWith("ws://", StringComparison.OrdinalIgnoreCase) ||
+                                   m_url.StartsWith("wss://", StringComparison.OrdinalIgnoreCase);
+
+        public Web3Subscription(string url)
+        {
+            m_url = url;
+        }
+
+        public void Dispose()
+        {
+            try
+            {
+                if (m_webSocket != null) m_webSocket.Abort();
+                if (m_ipcStream != null) m_ipcStream.Dispose();
+            }
+            catch { }
+        }
+
+        public void Connect(int timeoutMS)
+        {
+            if (IsWebSocket)
+            {
+                m_webSocket = new ClientWebSocket();
+                if (!m_webSocket.ConnectAsync(new Uri(m_url), CancellationToken.None).Wait(timeoutMS))
+                    throw new TimeoutException("Connection timed out.");
+            }
+            else if (m_url.StartsWith(@"\\.\pipe\", StringComparison.OrdinalIgnoreCase))
+            {
+                var pipe = new NamedPipeClientStream(".", m_url.Substring(@"\\.\pipe\".Length), PipeDirection.InOut, PipeOptions.Asynchronous);
+                pipe.Connect(timeoutMS);
+                m_ipcStream = pipe;
+            }
+            else
+            {
+                var socket = new Socket(AddressFamily.Unix, SocketType.Stream, ProtocolType.Unspecified);
+                if (!socket.ConnectAsync(new UnixDomainSocketEndPoint(m_url)).Wait(timeoutMS))
+                {
+                    socket.Dispose();
+                    throw new TimeoutException("Connection timed out.");
+                }
+                m_ipcStream = new NetworkStream(socket, ownsSocket: true);
+            }
+
+            if (m_ipcStream != null) m_ipcReader = new StreamReader(m_ipcStream, Encoding.UTF8);
+        }
+
+        // Returns the subscription ID, notifications are then read with Receive()
+        public string Subscribe(int timeoutMS, params object[] parameters)
+        {
+            var id = Interlocked.Increment(ref m_lastRequestID);
+            var request = new JObject
+            {
+                ["jsonrpc"] = "2.0",
+                ["id"] = id,
+                ["method"] = "eth_subscribe",
+                ["params"] = JArray.FromObject(parameters)
+            };
+            Send(request).Wait(timeoutMS);
+
+            while (true)
+            {
+                var receive = Receive();
+                if (!receive.Wait(timeoutMS))
+                    throw new TimeoutException("Subscription timed out.");
+
+                var response = receive.Result;
+                if (response == null)
+                    throw new IOException("Connection closed.");
+
+                if (response.Value<int?>("id") != id) continue; // notification of earlier subscription
+
+                var subscriptionID = response.SelectToken("$.result")?.Value<string>();
+                if (string.IsNullOrWhiteSpace(subscriptionID))
+                    throw new NotSupportedException(response.SelectToken("$.error.message")?.Value<string>() ?? "Subscription rejected.");
+
+                return subscriptionID;
+            }
+        }
+
+        // Returns next message, null when connection is closed
+        public async Task<JObject> Receive()
+        {
+            if (m_ipcReader != null)
+            {
+                var line = await m_ipcReader.ReadLineAsync();
+                return (line == null) ? null : JObject.Parse(line);
+            }
+
+            var buffer = new ArraySegment<byte>(new byte[4096]);
+            using (var message = new MemoryStream())
+            {
+                WebSocketReceiveResult result;
+                do
+                {
+                    result = await m_webSocket.ReceiveAsync(buffer, CancellationToken.None);
+                    if (result.MessageType == WebSocketMessageType.Close) return null;
+
+                    message.Write(buffer.Array, buffer.Offset, result.Count);
+                } while (!result.EndOfMessage);
+
+                return JObject.Parse(Encoding.UTF8.GetString(message.ToArray()));
+            }
+        }
+
+        private Task Send(JObject message)
+        {
+            var buffer = Encoding.UTF8.GetBytes(message.ToString(Newtonsoft.Json.Formatting.None) + (m_ipcStream != null ? "\n" : string.Empty));
+
+            if (m_ipcStream != null)
+                return m_ipcStream.WriteAsync(buffer, 0, buffer.Length);
+            else
+                return m_webSocket.SendAsync(new ArraySegment<byte>(buffer), WebSocketMessageType.Text, true, CancellationToken.None);
+        }
+    }
+}
@@ -51,6 +51,10 @@ namespace SoliditySHA3Miner
 
             lock (m_handler)
             {
+                Utils.ChromeTrace.Stop(); // before miners are disposed
+                if (m_thermalControl != null) m_thermalControl.Dispose();
+                if (m_deviceWatchdog != null) m_deviceWatchdog.Dispose();
+
                 if (m_allMiners != null)
                     m_allMiners.AsParallel()
                                 .ForAll(miner =>
@@ -59,6 +63,9 @@ namespace SoliditySHA3Miner
                                     catch (Exception ex) { Print(ex.Message); }
                                 });
 
+                if (m_proxyServer != null) m_proxyServer.Dispose();
+                if (m_jobRecorder != null) m_jobRecorder.Dispose();
+
                 if (m_waitCheckTimer != null) m_waitCheckTimer.Stop();
                 if (m_manualResetEvent != null) m_manualResetEvent.Set();
 
@@ -98,42 +105,14 @@ namespace SoliditySHA3Miner
 
         public static void Print(string message, bool excludePrefix = false)
         {
-            new TaskFactory().StartNew(() =>
-            {
-                message = message.Replace("Accelerated Parallel Processing", "APP").Replace("\n", Environment.NewLine);
-                if (!excludePrefix) message = string.Format("[{0}] {1}", GetCurrentTimestamp(), message);
-
-                if (Config.isLogFile)
-                {
-                    var logFilePath = Path.Combine(AppDirPath, "Log", LogFileFormat);
+            message = message.Replace("Accelerated Parallel Processing", "APP").Replace("\n", Environment.NewLine);
+            if (!excludePrefix) message = string.Format("[{0}] {1}", GetCurrentTimestamp(), message);
 
-                    lock (m_manualResetEvent)
-                    {
-                        try
-                        {
-                            if (!Directory.Exists(Path.GetDirectoryName(logFilePath))) Directory.CreateDirectory(Path.GetDirectoryName(logFilePath));
-
-                            using (var logStream = File.AppendText(logFilePath))
-                            {
-                                logStream.WriteLine(message);
-                                logStream.Close();
-                            }
-                        }
-                        catch (Exception)
-                        {
-                            Console.WriteLine(string.Format("[ERROR] Failed writing to log file '{0}'", logFilePath));
-                        }
-                    }
-                }
+            Utils.LogWriter.Write(message);
 
-                Console.WriteLine(message);
-
-                if (message.Contains("Kernel launch failed") || message.Contains("Stop mining"))
-                {
-                    Task.Delay(5000);
-                    Environment.Exit(22);
-                }
-            });
+            // Queued lines are flushed on exit, a failed GPU is restarted by watchdog instead if enabled
+            if (m_deviceWatchdog == null && (message.Contains("Kernel launch failed") || message.Contains("Stop mining")))
+                Task.Run(() => Environment.Exit(22));
         }
 
         private static ManualResetEvent m_manualResetEvent = new ManualResetEvent(false);
@@ -143,6 +122,12 @@ namespace SoliditySHA3Miner
         private static Miner.OpenCL m_openCLMiner;
         private static Miner.IMiner[] m_allMiners;
         private static API.Json m_apiJson;
+        private static API.TelemetrySampler m_telemetrySampler;
+        private static NetworkInterface.ProxyServer m_proxyServer;
+        private static NetworkInterface.JobRecorder m_jobRecorder;
+        private static Miner.ThermalControl m_thermalControl;
+        private static Miner.DeviceWatchdog m_deviceWatchdog;
+        private static int m_exitCode;
 
         private static string GetHeader()
         {
@@ -238,67 +223,115 @@ namespace SoliditySHA3Miner
                 Config.networkUpdateInterval = Config.networkUpdateInterval < 1000 ? Config.Defaults.NetworkUpdateInterval : Config.networkUpdateInterval;
                 Config.hashrateUpdateInterval = Config.hashrateUpdateInterval < 1000 ? Config.Defaults.HashrateUpdateInterval : Config.hashrateUpdateInterval;
 
-                Miner.Work.SetKingAddress(Config.kingAddress);
-                Miner.Work.SetSolutionTemplate(Miner.CPU.GetNewSolutionTemplate(Miner.Work.GetKingAddressString()));
-
-                var web3Interface = new NetworkInterface.Web3Interface(Config.web3api, Config.contractAddress, Config.minerAddress, Config.privateKey, Config.gasToMine,
-                                                                       Config.abiFile, Config.networkUpdateInterval, Config.hashrateUpdateInterval,
-                                                                       Config.gasLimit, Config.gasApiURL, Config.gasApiPath, Config.gasApiMultiplier, Config.gasApiOffset);
+                if (!string.IsNullOrWhiteSpace(Config.poolStub))
+                {
+                    // Test pool only, another instance mines on it with 'pool=http://IP:port'
+                    using (new NetworkInterface.PoolStubServer(Config.poolStub, Config.networkUpdateInterval))
+                        m_manualResetEvent.WaitOne();
 
-                web3Interface.OverrideMaxTarget(Config.overrideMaxTarget);
+                    Environment.Exit(0);
+                }
 
-                if (Config.customDifficulty > 0)
-                    Print("[INFO] Custom difficulity: " + Config.customDifficulty.ToString());
+                Miner.Work.SetKingAddress(Config.kingAddress);
+                Miner.Work.SetSolutionTemplate(Miner.CPU.GetNewSolutionTemplate(Miner.Work.GetKingAddressString(), Config.solutionSeed));
 
                 NetworkInterface.INetworkInterface mainNetworkInterface = null;
+                Nethereum.Hex.HexTypes.HexBigInteger maxTarget = null;
+                var isProxyMining = !(string.IsNullOrWhiteSpace(Config.proxy));
                 var isSoloMining = !(string.IsNullOrWhiteSpace(Config.privateKey));
 
-                if (isSoloMining) { mainNetworkInterface = web3Interface; }
+                if (Config.benchmark)
+                {
+                    mainNetworkInterface = new NetworkInterface.BenchmarkInterface(Config.minerAddress, NetworkInterface.BenchmarkInterface.ParseDifficulty(Config.benchmarkDifficulty),
+                                                                                   Config.networkUpdateInterval, Config.hashrateUpdateInterval);
+                }
+                else if (!string.IsNullOrWhiteSpace(Config.replayJobs))
+                {
+                    mainNetworkInterface = new NetworkInterface.ReplayInterface(Config.replayJobs, Config.replaySpeed, Config.hashrateUpdateInterval);
+                }
+                else if (isProxyMining)
+                {
+                    mainNetworkInterface = new NetworkInterface.ProxyInterface(Config.proxy, Config.proxyToken, Config.networkUpdateInterval, Config.hashrateUpdateInterval);
+                }
                 else
                 {
-                    var secondaryPoolInterface = string.IsNullOrWhiteSpace(Config.secondaryPool)
-                                               ? null
-                                               : new NetworkInterface.PoolInterface(Config.minerAddress, Config.secondaryPool, Config.maxScanRetry,
-                                                                                    -1, -1, Config.customDifficulty, true, web3Interface.GetMaxTarget());
-
-                    var primaryPoolInterface = new NetworkInterface.PoolInterface(Config.minerAddress, Config.primaryPool, Config.maxScanRetry,
-                                                                                  Config.networkUpdateInterval, Config.hashrateUpdateInterval,
-                                                                                  Config.customDifficulty, false, web3Interface.GetMaxTarget(), secondaryPoolInterface);
-                    mainNetworkInterface = primaryPoolInterface;
+                    var web3Interface = new NetworkInterface.Web3Interface(Config.web3api, Config.contractAddress, Config.minerAddress, Config.privateKey, Config.gasToMine,
+                                                                           Config.abiFile, Config.networkUpdateInterval, Config.hashrateUpdateInterval,
+                                                                           Config.gasLimit, Config.gasApiURL, Config.gasApiPath, Config.gasApiMultiplier, Config.gasApiOffset,
+                                                                           Config.web3Subscription, Config.web3BroadcastApis, Config.watchPendingMints);
+
+                    web3Interface.OverrideMaxTarget(Config.overrideMaxTarget);
+                    maxTarget = web3Interface.GetMaxTarget();
+
+                    if (Config.customDifficulty > 0)
+                        Print("[INFO] Custom difficulity: " + Config.customDifficulty.ToString());
+
+                    if (isSoloMining) { mainNetworkInterface = web3Interface; }
+                    else
+                    {
+                        var secondaryPoolInterface = string.IsNullOrWhiteSpace(Config.secondaryPool)
+                                                   ? null
+                                                   : new NetworkInterface.PoolInterface(Config.minerAddress, Config.secondaryPool, Config.maxScanRetry,
+                                                                                        -1, -1, Config.customDifficulty, true, web3Interface.GetMaxTarget());
+
+                        var primaryPoolInterface = new NetworkInterface.PoolInterface(Config.minerAddress, Config.primaryPool, Config.maxScanRetry,
+                                                                                      Config.networkUpdateInterval, Config.hashrateUpdateInterval,
+                                                                                      Config.customDifficulty, false, web3Interface.GetMaxTarget(), secondaryPoolInterface);
+                        mainNetworkInterface = primaryPoolInterface;
+                    }
+
+                    if (!string.IsNullOrWhiteSpace(Config.proxyListen))
+                        m_proxyServer = new NetworkInterface.ProxyServer(mainNetworkInterface, web3Interface.GetMaxTarget(), Config.proxyToken);
                 }
 
+                if (!string.IsNullOrWhiteSpace(Config.recordJobs))
+                    m_jobRecorder = new NetworkInterface.JobRecorder(mainNetworkInterface, maxTarget, Config.recordJobs);
+
                 if (Config.cpuMode)
                 {
                     if (Config.cpuDevices.Any())
-                        m_cpuMiner = new Miner.CPU(mainNetworkInterface, Config.cpuDevices, Config.submitStale, Config.pauseOnFailedScans);
+                        m_cpuMiner = new Miner.CPU(mainNetworkInterface, Config.cpuDevices, Config.submitStale, Config.pauseOnFailedScans, Config.targetLaunchDuration);
                 }
                 else
                 {
                     if (AllowCUDA && Config.cudaDevices.Any(d => d.AllowDevice))
-                        m_cudaMiner = new Miner.CUDA(mainNetworkInterface, Config.cudaDevices, Config.submitStale, Config.pauseOnFailedScans);
+                        m_cudaMiner = new Miner.CUDA(mainNetworkInterface, Config.cudaDevices, Config.submitStale, Config.pauseOnFailedScans, Config.targetLaunchDuration);
                     
-                    if ((AllowAMD || AllowIntel) && Config.intelDevices.Union(Config.amdDevices).Any(d => d.AllowDevice))
-                        m_openCLMiner = new Miner.OpenCL(mainNetworkInterface, Config.intelDevices, Config.amdDevices, Config.submitStale, Config.pauseOnFailedScans);
+                    if (((AllowAMD || AllowIntel) && Config.intelDevices.Union(Config.amdDevices).Any(d => d.AllowDevice)) || Config.simulatedDevices > 0)
+                        m_openCLMiner = new Miner.OpenCL(mainNetworkInterface, Config.intelDevices, Config.amdDevices, Config.submitStale, Config.pauseOnFailedScans, Config.targetLaunchDuration,
+                                                         Config.simulatedDevices, Config.simulatedLatency, Config.simulatedHashrate, Config.simulatedCandidateRate);
                 }
                 m_allMiners = new Miner.IMiner[] { m_openCLMiner, m_cudaMiner, m_cpuMiner }.Where(m => m != null).ToArray();
 
-                if (!m_allMiners.Any() || m_allMiners.All(m => !m.HasAssignedDevices))
+                if (m_proxyServer == null && (!m_allMiners.Any() || m_allMiners.All(m => !m.HasAssignedDevices)))
                 {
                     Console.WriteLine("[ERROR] No miner assigned.");
                     Environment.Exit(1);
                 }
 
-                if (!Utils.Json.SerializeToFile(Config, GetAppConfigPath()))
+                var isOfflineMode = Config.benchmark || !string.IsNullOrWhiteSpace(Config.replayJobs);
+                if (!isOfflineMode && !Utils.Json.SerializeToFile(Config, GetAppConfigPath()))
                     Print(string.Format("[ERROR] Failed to write config file at {0}", GetAppConfigPath()));
 
-                m_apiJson = new API.Json(m_allMiners);
+                if (Config.minerJsonAPI != "0" || Config.minerCcminerAPI != "0")
+                    m_telemetrySampler = new API.TelemetrySampler(Config.apiSampleInterval, m_allMiners);
+
+                m_apiJson = new API.Json(m_telemetrySampler, Config.minerControlToken);
                 if (m_apiJson.IsSupported) m_apiJson.Start(Config.minerJsonAPI);
 
-                API.Ccminer.StartListening(Config.minerCcminerAPI, m_allMiners);
+                API.Ccminer.StartListening(Config.minerCcminerAPI, m_telemetrySampler);
+
+                if (m_proxyServer != null && !m_proxyServer.Start(Config.proxyListen))
+                    Environment.Exit(1);
+
+                Utils.ChromeTrace.Start(Config.traceFile, m_allMiners);
+
+                if (Config.watchdogTimeout > 0) // before miners start, so a device failing on start is restarted too
+                    m_deviceWatchdog = new Miner.DeviceWatchdog(m_allMiners, Config.watchdogTimeout);
 
                 if (Config.cpuMode)
                 {
-                    if (m_cpuMiner.HasAssignedDevices)
+                    if (m_cpuMiner != null && m_cpuMiner.HasAssignedDevices)
                         m_cpuMiner.StartMining(Config.networkUpdateInterval, Config.hashrateUpdateInterval);
                 }
                 else
@@ -310,6 +343,10 @@ namespace SoliditySHA3Miner
                         m_cudaMiner.StartMining(Config.networkUpdateInterval, Config.hashrateUpdateInterval);
                 }
 
+                if (Config.targetTemperature > 0 || Config.targetPower > 0)
+                    m_thermalControl = new Miner.ThermalControl(m_allMiners, Config.thermalInterval,
+                                                                Config.targetTemperature, Config.maxTemperature, Config.targetPower);
+
                 m_waitCheckTimer = new System.Timers.Timer(1000);
                 m_waitCheckTimer.Elapsed +=
                     delegate
@@ -318,6 +355,17 @@ namespace SoliditySHA3Miner
                     };
                 m_waitCheckTimer.Start();
                 WaitSeconds = (ulong)(LaunchTime - DateTime.Now).TotalSeconds;
+
+                if (Config.benchmark)
+                    Task.Run(() =>
+                    {
+                        var isReported = Miner.Benchmark.Run(m_allMiners, (NetworkInterface.BenchmarkInterface)mainNetworkInterface, Config);
+                        m_exitCode = isReported ? 0 : 1;
+                        Handler(CtrlType.CTRL_CLOSE_EVENT);
+                    });
+
+                if (mainNetworkInterface is NetworkInterface.ReplayInterface replayInterface)
+                    replayInterface.Completion.ContinueWith(replay => Handler(CtrlType.CTRL_CLOSE_EVENT));
             }
             catch (Exception ex)
             {
@@ -332,9 +380,11 @@ namespace SoliditySHA3Miner
             Console.WriteLine("[INFO] Exiting application...");
 
             API.Ccminer.StopListening();
+            if (m_telemetrySampler != null) m_telemetrySampler.Dispose();
+            Utils.ChromeTrace.Stop();
             m_waitCheckTimer.Stop();
 
-            Environment.Exit(0);
+            Environment.Exit(m_exitCode);
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Timers;
+
+namespace SoliditySHA3Miner.Utils
+{
+    // Writes solver and host events to a Chrome trace (JSON array format), to be opened in chrome://tracing or Perfetto.
+    // Native events are drained from per-device ring buffers on a timer, so the mining loops never wait on file I/O.
+    public static class ChromeTrace
+    {
+        private const int FLUSH_INTERVAL = 1000;
+        private const int HOST_PROCESS_ID = 0;
+
+        private static readonly object m_fileLock = new object();
+        private static readonly ConcurrentQueue<string> m_hostEvents = new ConcurrentQueue<string>();
+
+        private static StreamWriter m_writer;
+        private static Miner.IMiner[] m_miners;
+        private static Timer m_flushTimer;
+        private static bool m_isFirstEvent;
+
+        public static bool IsEnabled => m_writer != null;
+
+        // Same monotonic clock as std::chrono::steady_clock of solvers, in microseconds
+        public static long GetTimestamp() => (long)(Stopwatch.GetTimestamp() * (1000000.0 / Stopwatch.Frequency));
+
+        public static void Start(string path, params Miner.IMiner[] miners)
+        {
+            if (string.IsNullOrWhiteSpace(path)) return;
+            try
+            {
+                lock (m_fileLock)
+                {
+                    m_writer = new StreamWriter(path, false, new UTF8Encoding(false));
+                    m_writer.Write('[');
+                    m_isFirstEvent = true;
+                    m_miners = miners;
+
+                    WriteMetadata("process_name", HOST_PROCESS_ID, 0, "Host");
+
+                    for (var m = 0; m < m_miners.Length; m++)
+                    {
+                        WriteMetadata("process_name", m + 1, 0, m_miners[m].GetType().Name + " solver");
+
+                        for (var d = 0; d < m_miners[m].Devices.Length; d++)
+                        {
+                            var device = m_miners[m].Devices[d];
+                            if (device.AllowDevice)
+                                WriteMetadata("thread_name", m + 1, d, string.Format("{0} {1}", device.Platform ?? device.Type, device.DeviceID));
+                        }
+                        m_miners[m].SetTraceEnabled(true);
+                    }
+                }
+                m_flushTimer = new Timer(FLUSH_INTERVAL);
+                m_flushTimer.Elapsed += (sender, e) => Flush();
+                m_flushTimer.Start();
+
+                Program.Print(string.Format("[INFO] Recording trace to {0}", Path.GetFullPath(path)));
+            }
+            catch (Exception ex)
+            {
+                Program.Print(string.Format("[ERROR] Failed to start trace: {0}", ex.Message));
+                m_writer = null;
+            }
+        }
+
+        public static void Stop()
+        {
+            if (!IsEnabled) return;
+
+            m_flushTimer?.Stop();
+            m_flushTimer?.Dispose();
+
+            foreach (var miner in m_miners)
+                miner.SetTraceEnabled(false);
+
+            Flush();
+
+            lock (m_fileLock)
+            {
+                m_writer.Write("\n]\n");
+                m_writer.Dispose();
+                m_writer = null;
+            }
+        }
+
+        public static void RecordSpan(string name, long startTimestamp)
+        {
+            if (!IsEnabled) return;
+
+            var timestamp = GetTimestamp();
+            m_hostEvents.Enqueue(GetEvent(name, HOST_PROCESS_ID, System.Threading.Thread.CurrentThread.ManagedThreadId,
+                                          startTimestamp, timestamp - startTimestamp, null));
+        }
+
+        public static void RecordSpan(string name, DateTime startTime)
+        {
+            if (!IsEnabled) return;
+
+            RecordSpan(name, GetTimestamp() - (long)((DateTime.Now - startTime).TotalMilliseconds * 1000));
+        }
+
+        private static void Flush()
+        {
+            lock (m_fileLock)
+            {
+                if (m_writer == null) return;
+                try
+                {
+                    for (var m = 0; m < m_miners.Length; m++)
+                    {
+                        for (var d = 0; d < m_miners[m].Devices.Length; d++)
+                        {
+                            var device = m_miners[m].Devices[d];
+                            if (!device.AllowDevice) continue;
+
+                            foreach (var traceEvent in m_miners[m].GetTraceEventsByDevice(device.Platform, device.DeviceID))
+                                WriteEvent(GetEvent(traceEvent.TypeName, m + 1, d,
+                                                    (long)traceEvent.Timestamp, (long)traceEvent.Duration, traceEvent.Value));
+                        }
+                    }
+
+                    while (m_hostEvents.TryDequeue(out var hostEvent))
+                        WriteEvent(hostEvent);
+
+                    m_writer.Flush();
+                }
+                catch (Exception ex)
+                {
+                    Program.Print(string.Format("[ERROR] Failed to write trace: {0}", ex.Message));
+                }
+            }
+        }
+
+        private static string GetEvent(string name, int processID, int threadID, long timestamp, long duration, ulong? value)
+        {
+            return string.Format(CultureInfo.InvariantCulture,
+                                 "{{\"name\":\"{0}\",\"ph\":\"X\",\"pid\":{1},\"tid\":{2},\"ts\":{3},\"dur\":{4}{5}}}",
+                                 name, processID, threadID, timestamp, duration,
+                                 value.HasValue ? string.Format(CultureInfo.InvariantCulture, ",\"args\":{{\"value\":{0}}}", value.Value) : string.Empty);
+        }
+
+        private static void WriteMetadata(string name, int processID, int threadID, string value)
+        {
+            WriteEvent(string.Format(CultureInfo.InvariantCulture,
+                                     "{{\"name\":\"{0}\",\"ph\":\"M\",\"pid\":{1},\"tid\":{2},\"args\":{{\"name\":\"{3}\"}}}}",
+                                     name, processID, threadID, value.Replace("\\", "\\\\").Replace("\"", "\\\"")));
+        }
+
+        private static void WriteEvent(string traceEvent)
+        {
+            m_writer.Write(m_isFirstEvent ? "\n" : ",\n");
+            m_writer.Write(traceEvent);
+            m_isFirstEvent = false;
+        }
+    }
+}
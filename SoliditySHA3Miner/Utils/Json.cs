@@ -2,93 +2,80 @@
 using Newtonsoft.Json.Linq;
 using Newtonsoft.Json.Serialization;
 using System;
+using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.IO;
 using System.Linq;
-using System.Net;
 using System.Net.Http;
+using System.Text;
+using System.Threading.Tasks;
 
 namespace SoliditySHA3Miner.Utils
 {
     internal static class Json
     {
         private const int MAX_TIMEOUT = 5;
-        private static object _Object1 = new object();
-        private static object _Object2 = new object();
-        private static object _Object3 = new object();
-        private static object _Object4 = new object();
-        private static object _Object5 = new object();
-        private static object _Object6 = new object();
-        private static object _Object7 = new object();
+        private const int MAX_CONNECTIONS_PER_SERVER = 16;
+        private static readonly TimeSpan BATCH_RETRY_INTERVAL = TimeSpan.FromMinutes(10);
+        private static readonly object m_fileLock = new object();
+
+        // Shared by all network calls, keeps connections alive between polls and submissions.
+        // Pooled connections are recycled periodically so DNS changes are picked up.
+        private static readonly HttpClient m_httpClient = new HttpClient(new SocketsHttpHandler
+        {
+            PooledConnectionLifetime = TimeSpan.FromMinutes(5),
+            PooledConnectionIdleTimeout = TimeSpan.FromMinutes(1),
+            MaxConnectionsPerServer = MAX_CONNECTIONS_PER_SERVER
+        })
+        { Timeout = TimeSpan.FromSeconds(MAX_TIMEOUT) };
+
+        // URLs that rejected a JSON-RPC batch request with a single error, batching is tried again after BATCH_RETRY_INTERVAL
+        private static readonly ConcurrentDictionary<string, DateTime> m_batchUnsupportedURLs = new ConcurrentDictionary<string, DateTime>();
 
         public static readonly JsonSerializerSettings BaseClassFirstSettings =
             new JsonSerializerSettings { ContractResolver = BaseFirstContractResolver.Instance };
 
         public static string SerializeFromObject(object obj, JsonSerializerSettings settings = null)
         {
-            lock (_Object1)
+            try
             {
-                try
-                {
-                    return (settings == null) ?
-                        JsonConvert.SerializeObject(obj, Formatting.Indented) :
-                        JsonConvert.SerializeObject(obj, Formatting.Indented, settings);
-                }
-                catch { }
-                return string.Empty;
+                return (settings == null) ?
+                    JsonConvert.SerializeObject(obj, Formatting.Indented) :
+                    JsonConvert.SerializeObject(obj, Formatting.Indented, settings);
             }
+            catch { }
+            return string.Empty;
         }
 
-        public static JObject DeserializeFromURL(string url)
+        public static async Task<JObject> DeserializeFromURLAsync(string url)
         {
-            lock (_Object2)
+            using (var oResponse = await m_httpClient.GetAsync(url).ConfigureAwait(false))
             {
-                string sJSON = string.Empty;
-
-                using (var oClient = new HttpClient())
-                {
-                    oClient.Timeout = new TimeSpan(0, 0, MAX_TIMEOUT);
-                    using (HttpResponseMessage oResponse = oClient.GetAsync(url).Result)
-                    {
-                        using (HttpContent oContent = oResponse.Content)
-                        {
-                            sJSON = oContent.ReadAsStringAsync().Result;
-                        }
-                    }
-                }
+                var sJSON = await oResponse.Content.ReadAsStringAsync().ConfigureAwait(false);
                 return (JObject)JsonConvert.DeserializeObject(sJSON);
             }
         }
 
+        public static JObject DeserializeFromURL(string url) => DeserializeFromURLAsync(url).GetAwaiter().GetResult();
+
         public static T DeserializeFromURL<T>(string url)
         {
-            lock (_Object3)
+            var jObject = (T)Activator.CreateInstance(typeof(T));
+            try
             {
-                string sJSON = string.Empty;
-                var jObject = (T)Activator.CreateInstance(typeof(T));
-                try
+                using (var oResponse = m_httpClient.GetAsync(url).GetAwaiter().GetResult())
                 {
-                    using (var oClient = new HttpClient())
-                    {
-                        oClient.Timeout = new TimeSpan(0, 0, MAX_TIMEOUT);
-                        using (HttpResponseMessage oResponse = oClient.GetAsync(url).Result)
-                        {
-                            using (HttpContent oContent = oResponse.Content)
-                            {
-                                sJSON = oContent.ReadAsStringAsync().Result;
-                            }
-                        }
-                    }
+                    var sJSON = oResponse.Content.ReadAsStringAsync().GetAwaiter().GetResult();
                     jObject = JsonConvert.DeserializeObject<T>(sJSON);
                 }
-                catch { }
-                return jObject;
             }
+            catch { }
+            return jObject;
         }
 
         public static T DeserializeFromFile<T>(string filePath)
         {
-            lock(_Object6)
+            lock (m_fileLock)
             {
                 string sJSON = File.ReadAllText(filePath);
                 T jObject = (T)Activator.CreateInstance(typeof(T));
@@ -103,7 +90,7 @@ namespace SoliditySHA3Miner.Utils
 
         public static bool SerializeToFile(object jObject, string filePath, JsonSerializerSettings settings = null)
         {
-            lock(_Object7)
+            lock (m_fileLock)
             {
                 try
                 {
@@ -121,48 +108,93 @@ namespace SoliditySHA3Miner.Utils
             }
         }
 
-        public static JObject InvokeJObjectRPC(string url, JObject obj, JsonSerializerSettings settings = null)
+        private static async Task<JToken> PostJsonRPCAsync(string url, string serializedJSON)
         {
-            lock (_Object5)
+            using (var content = new StringContent(serializedJSON, Encoding.UTF8, "application/json-rpc"))
+            using (var httpResponse = await m_httpClient.PostAsync(url, content).ConfigureAwait(false))
             {
-                var serializedJSON = SerializeFromObject(obj, settings);
+                var sResponse = await httpResponse.Content.ReadAsStringAsync().ConfigureAwait(false);
+                return JsonConvert.DeserializeObject<JToken>(sResponse);
+            }
+        }
 
-                var httpRequest = (HttpWebRequest)WebRequest.Create(url);
-                httpRequest.Timeout = MAX_TIMEOUT * 1000;
-                httpRequest.ReadWriteTimeout = MAX_TIMEOUT * 1000;
-                httpRequest.ContentLength = serializedJSON.Length;
-                httpRequest.ContentType = "application/json-rpc";
-                httpRequest.Method = "POST";
+        public static async Task<JObject> InvokeJObjectRPCAsync(string url, JObject obj, JsonSerializerSettings settings = null)
+        {
+            var serializedJSON = (settings == null)
+                               ? JsonConvert.SerializeObject(obj, Formatting.None)
+                               : JsonConvert.SerializeObject(obj, Formatting.None, settings);
 
-                using (var streamWriter = new StreamWriter(httpRequest.GetRequestStream()))
+            return (JObject)await PostJsonRPCAsync(url, serializedJSON).ConfigureAwait(false);
+        }
+
+        public static JObject InvokeJObjectRPC(string url, JObject obj, JsonSerializerSettings settings = null)
+        {
+            return InvokeJObjectRPCAsync(url, obj, settings).GetAwaiter().GetResult();
+        }
+
+        /// <summary>
+        /// <para>Sends requests as a single JSON-RPC batch, responses are returned in the same order as requests.</para>
+        /// <para>Falls back to concurrent single requests if the server does not support batching,</para>
+        /// <para>and sends requests missing from a batch response again on their own.</para>
+        /// <para>Requests that still got no response are left null, throws if none of the requests got one.</para>
+        /// </summary>
+        public static async Task<JObject[]> InvokeJObjectRPCBatchAsync(string url, params JObject[] requests)
+        {
+            var results = new JObject[requests.Length];
+
+            if (!m_batchUnsupportedURLs.TryGetValue(url, out DateTime unsupportedTime) || DateTime.Now - unsupportedTime > BATCH_RETRY_INTERVAL)
+            {
+                var batch = new JArray();
+                for (var i = 0; i < requests.Length; i++)
                 {
-                    streamWriter.Write(serializedJSON);
-                    streamWriter.Flush();
-                    streamWriter.Close();
+                    var request = (JObject)requests[i].DeepClone();
+                    request["id"] = (i + 1).ToString();
+                    batch.Add(request);
                 }
 
-                var httpResponse = (HttpWebResponse)httpRequest.GetResponse();
-                using (var streamReader = new StreamReader(httpResponse.GetResponseStream()))
+                JToken response = null;
+                try { response = await PostJsonRPCAsync(url, batch.ToString(Formatting.None)).ConfigureAwait(false); }
+                catch (JsonException) { } // non-JSON error page or timeout body, not a rejection of batching
+
+                if (response is JArray responses)
                 {
-                    var sResponse = streamReader.ReadToEnd();
-                    var jResponse = JsonConvert.DeserializeObject<JObject>(sResponse);
-                    return jResponse;
+                    m_batchUnsupportedURLs.TryRemove(url, out _);
+
+                    for (var i = 0; i < requests.Length; i++)
+                        results[i] = responses.OfType<JObject>().FirstOrDefault(r => r.Value<string>("id") == (i + 1).ToString());
                 }
+                else if (response is JObject rejection && rejection["error"] != null)
+                    m_batchUnsupportedURLs[url] = DateTime.Now; // JSON-RPC server without batch support
             }
+
+            var failures = await Task.WhenAll(Enumerable.Range(0, requests.Length).
+                                                         Where(i => results[i] == null).
+                                                         Select(async i =>
+                                                         {
+                                                             try { results[i] = await InvokeJObjectRPCAsync(url, requests[i]).ConfigureAwait(false); }
+                                                             catch (Exception ex) { return ex; }
+                                                             return null;
+                                                         })).
+                                      ConfigureAwait(false);
+
+            if (results.All(result => result == null) && failures.Any()) throw failures.First(ex => ex != null);
+            return results;
+        }
+
+        public static JObject[] InvokeJObjectRPCBatch(string url, params JObject[] requests)
+        {
+            return InvokeJObjectRPCBatchAsync(url, requests).GetAwaiter().GetResult();
         }
 
         public static T CloneObject<T>(T objectToClone)
         {
-            lock (_Object4)
+            if (objectToClone == null) { return default(T); }
+            try
             {
-                if (objectToClone == null) { return default(T); }
-                try
-                {
-                    return JsonConvert.DeserializeObject<T>(JsonConvert.SerializeObject(objectToClone),
-                                                            new JsonSerializerSettings() { ObjectCreationHandling = ObjectCreationHandling.Replace });
-                }
-                catch { return default(T); }
+                return JsonConvert.DeserializeObject<T>(JsonConvert.SerializeObject(objectToClone),
+                                                        new JsonSerializerSettings() { ObjectCreationHandling = ObjectCreationHandling.Replace });
             }
+            catch { return default(T); }
         }
 
         public class ClassNameContractResolver : DefaultContractResolver
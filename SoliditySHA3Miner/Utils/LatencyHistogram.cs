@@ -0,0 +1,83 @@
+﻿using System;
+using System.Linq;
+
+namespace SoliditySHA3Miner.Utils
+{
+    // Round-trip times (in milliseconds) of the most recent requests, measured passively on real RPC calls
+    public class LatencyHistogram
+    {
+        private const int DEFAULT_WINDOW_SIZE = 1000;
+
+        private readonly int[] m_samples;
+        private int m_nextIndex;
+
+        public long Count { get; private set; }
+
+        public long Sum { get; private set; }
+
+        public LatencyHistogram(int windowSize = DEFAULT_WINDOW_SIZE)
+        {
+            m_samples = new int[windowSize];
+            m_nextIndex = 0;
+            Count = 0;
+            Sum = 0;
+        }
+
+        public int Record(DateTime startTime)
+        {
+            var latency = (int)(DateTime.Now - startTime).TotalMilliseconds;
+            Record(latency);
+            return latency;
+        }
+
+        public void Record(int latency)
+        {
+            lock (m_samples)
+            {
+                m_samples[m_nextIndex] = latency;
+                m_nextIndex = (m_nextIndex + 1) % m_samples.Length;
+                Count++;
+                Sum += latency;
+            }
+        }
+
+        public Snapshot GetSnapshot()
+        {
+            int[] samples;
+            long count;
+            lock (m_samples)
+            {
+                count = Count;
+                samples = m_samples.Take((int)Math.Min(count, m_samples.Length)).ToArray();
+            }
+            Array.Sort(samples);
+
+            return new Snapshot
+            {
+                Count = count,
+                P50 = GetPercentile(samples, 50),
+                P95 = GetPercentile(samples, 95),
+                P99 = GetPercentile(samples, 99),
+                Max = samples.Any() ? samples.Last() : -1
+            };
+        }
+
+        // Nearest-rank percentile of sorted samples, -1 if none recorded
+        private static int GetPercentile(int[] sortedSamples, double percentile)
+        {
+            if (!sortedSamples.Any()) return -1;
+
+            var rank = (int)Math.Ceiling(percentile / 100 * sortedSamples.Length);
+            return sortedSamples[Math.Max(rank, 1) - 1];
+        }
+
+        public class Snapshot
+        {
+            public long Count { get; set; }
+            public int P50 { get; set; }
+            public int P95 { get; set; }
+            public int P99 { get; set; }
+            public int Max { get; set; }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.IO;
+using System.Threading;
+
+namespace SoliditySHA3Miner.Utils
+{
+    // Single background writer of console and log file output, callers only queue formatted lines.
+    // Log file is kept open and flushed once the queue is empty, it is reopened when the dated file name changes.
+    public static class LogWriter
+    {
+        private const int EXIT_FLUSH_TIMEOUT = 2000;
+
+        private static readonly BlockingCollection<string> m_lines = new BlockingCollection<string>();
+        private static readonly Thread m_writerThread;
+        private static int m_pendingCount;
+
+        private static StreamWriter m_logFile;
+        private static string m_logFilePath;
+
+        static LogWriter()
+        {
+            m_writerThread = new Thread(WriteLines) { IsBackground = true, Name = "Log writer" };
+            m_writerThread.Start();
+
+            AppDomain.CurrentDomain.ProcessExit += (sender, e) => Flush(EXIT_FLUSH_TIMEOUT);
+        }
+
+        public static void Write(string line)
+        {
+            Interlocked.Increment(ref m_pendingCount);
+            m_lines.Add(line);
+        }
+
+        // Waits for queued lines to be written, returns false on timeout
+        public static bool Flush(int timeout)
+        {
+            return SpinWait.SpinUntil(() => Volatile.Read(ref m_pendingCount) == 0, timeout);
+        }
+
+        private static void WriteLines()
+        {
+            foreach (var line in m_lines.GetConsumingEnumerable())
+            {
+                Console.WriteLine(line);
+
+                if (Program.Config != null && Program.Config.isLogFile)
+                    WriteLogFile(line);
+
+                if (m_lines.Count == 0)
+                    m_logFile?.Flush();
+
+                Interlocked.Decrement(ref m_pendingCount);
+            }
+        }
+
+        private static void WriteLogFile(string line)
+        {
+            var logFilePath = Path.Combine(Program.AppDirPath, "Log", Program.LogFileFormat);
+            try
+            {
+                if (logFilePath != m_logFilePath)
+                {
+                    m_logFile?.Dispose();
+                    m_logFile = null;
+                    m_logFilePath = null;
+
+                    if (!Directory.Exists(Path.GetDirectoryName(logFilePath))) Directory.CreateDirectory(Path.GetDirectoryName(logFilePath));
+
+                    m_logFile = File.AppendText(logFilePath);
+                    m_logFilePath = logFilePath;
+                }
+                m_logFile.WriteLine(line);
+            }
+            catch (Exception)
+            {
+                Console.WriteLine(string.Format("[ERROR] Failed writing to log file '{0}'", logFilePath));
+            }
+        }
+    }
+}